@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: Example program to benchmark ISO 8601 duration parsing
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <stdlib.h>
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "libmpd++/macros.hh"
+
+// Private library header, this benchmarks an internal function
+#include "conversions.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+using duration_type = std::chrono::microseconds;
+
+// The std::regex based parser previously used by the library, kept here for comparison
+static duration_type regex_str_to_duration(const std::string &str)
+{
+    duration_type ret = duration_type();
+    static const std::regex durn_parse_regex("^P(?!$)(?:(\\d+)Y)?(?:(\\d+)M)?(?:(\\d+)W)?(?:(\\d+)D)?(?:T(?=\\d+(?:[HM]|(?:\\.\\d+)?S))(?:(\\d+)H)?(?:(\\d+)M)?(?:(\\d+(\\.\\d+)?)S)?)?$");
+    std::smatch matches;
+    if (std::regex_match(str, matches, durn_parse_regex)) {
+        if (matches[1].matched) ret += std::chrono::years(std::stol(matches[1]));
+        if (matches[2].matched) ret += std::chrono::months(std::stol(matches[2]));
+        if (matches[3].matched) ret += std::chrono::weeks(std::stol(matches[3]));
+        if (matches[4].matched) ret += std::chrono::days(std::stol(matches[4]));
+        if (matches[5].matched) ret += std::chrono::hours(std::stol(matches[5]));
+        if (matches[6].matched) ret += std::chrono::minutes(std::stol(matches[6]));
+        if (matches[7].matched) ret += std::chrono::milliseconds(static_cast<long int>(std::stod(matches[7])*1000));
+    }
+    return ret;
+}
+
+static double run_benchmark(const char *name, const std::vector<std::string> &inputs, unsigned int iterations,
+                            const std::function<duration_type(const std::string&)> &fn)
+{
+    duration_type total(0);
+    for (const auto &input : inputs) total += fn(input); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++) {
+        for (const auto &input : inputs) total += fn(input);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double per_parse = elapsed.count() / (static_cast<double>(iterations) * inputs.size());
+    std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << per_parse << " ns/parse (checksum " << total.count() << ")" << std::endl;
+    return per_parse;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int iterations = 100000;
+    if (argc > 1) iterations = static_cast<unsigned int>(strtoul(argv[1], nullptr, 10));
+    if (iterations == 0) iterations = 1;
+
+    // A mix of the duration values typically found in MPDs
+    static const std::vector<std::string> inputs = {
+        "PT2S", "PT1.920S", "PT30M", "PT1H2M3.5S", "P1DT12H", "PT0S", "PT3600S", "PT0.04S", "P1Y2M3W4DT5H6M7.891S", "PT10M"
+    };
+
+    for (const auto &input : inputs) {
+        auto old_val = regex_str_to_duration(input);
+        auto new_val = str_to_duration<duration_type>(input);
+        if (old_val != new_val) {
+            std::cerr << "Parsers disagree on " << input << ": " << old_val.count() << "us vs " << new_val.count() << "us"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Parsing " << inputs.size() << " durations " << iterations << " times" << std::endl;
+    auto regex_time = run_benchmark("std::regex", inputs, iterations, regex_str_to_duration);
+    auto new_time = run_benchmark("from_chars", inputs, iterations, str_to_duration<duration_type>);
+    std::cout << "Speedup: " << std::setprecision(1) << (regex_time / new_time) << "x" << std::endl;
+
+    return 0;
+}
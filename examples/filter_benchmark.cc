@@ -0,0 +1,143 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: Example program to benchmark parsing with a ParseFilter
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <stdlib.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/MPD.hh"
+#include "libmpd++/ParseFilter.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+// Make a manifest with several languages of audio and subtitles, trick play tracks and the descriptive elements a player
+// typically ignores
+static std::vector<char> make_manifest(unsigned int channel)
+{
+    static const char *drm_systems[] = {
+        "urn:uuid:edef8ba9-79d6-4ace-a3c8-27dcd51d21ed",
+        "urn:uuid:9a04f079-9840-4286-ab92-e65be0885f95",
+        "urn:uuid:94ce86fb-07ff-4f43-adb8-93d2fa968ca2"
+    };
+    static const char *languages[] = {"en", "fr", "de", "es", "it", "nl"};
+
+    std::ostringstream os;
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+       << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\" minBufferTime=\"PT4S\""
+          " mediaPresentationDuration=\"PT2H\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\">\n"
+       << "  <ProgramInformation lang=\"en\"><Title>Channel " << channel << "</Title>"
+          "<Source>Example broadcaster</Source><Copyright>(C) Example broadcaster</Copyright></ProgramInformation>\n"
+       << "  <BaseURL>https://vod-dash.example.com/channel_" << channel << "/</BaseURL>\n";
+    for (unsigned int period = 0; period < 4; period++) {
+        os << "  <Period id=\"p" << period << "\" duration=\"PT30M\">\n";
+        auto adaptation_set = [&](const char *content_type, const char *mime_type, const char *lang, bool trick_play) {
+            os << "    <AdaptationSet contentType=\"" << content_type << "\" mimeType=\"" << mime_type << "\""
+               << (lang?" lang=\"":"") << (lang?lang:"") << (lang?"\"":"") << " segmentAlignment=\"true\">\n";
+            if (trick_play) {
+                os << "      <EssentialProperty schemeIdUri=\"http://dashif.org/guidelines/trickmode\" value=\"1\"/>\n";
+            }
+            os << "      <ContentProtection schemeIdUri=\"urn:mpeg:dash:mp4protection:2011\" value=\"cenc\"/>\n";
+            for (const char *drm_system : drm_systems) {
+                os << "      <ContentProtection schemeIdUri=\"" << drm_system << "\" robustness=\"SW_SECURE_CRYPTO\"/>\n";
+            }
+            os << "      <Role schemeIdUri=\"urn:mpeg:dash:role:2011\" value=\"main\"/>\n"
+               << "      <Viewpoint schemeIdUri=\"urn:example:viewpoint\" value=\"camera1\"/>\n"
+               << "      <Label lang=\"en\">" << content_type << (lang?" ":"") << (lang?lang:"") << "</Label>\n"
+               << "      <SegmentTemplate timescale=\"1000\" duration=\"3840\" startNumber=\"1\""
+                  " initialization=\"$RepresentationID$/init.mp4\" media=\"$RepresentationID$/$Number%09d$.m4s\"/>\n";
+            for (unsigned int rep = 0; rep < 4; rep++) {
+                os << "      <Representation id=\"" << content_type << (lang?lang:"") << rep << "\" bandwidth=\""
+                   << (rep + 1) * 100000 << "\"/>\n";
+            }
+            os << "    </AdaptationSet>\n";
+        };
+        adaptation_set("video", "video/mp4", nullptr, false);
+        adaptation_set("video", "video/mp4", nullptr, true);
+        for (const char *lang : languages) {
+            adaptation_set("audio", "audio/mp4", lang, false);
+            adaptation_set("text", "application/mp4", lang, false);
+        }
+        os << "  </Period>\n";
+    }
+    os << "  <Metrics metrics=\"DVBErrors\"><Reporting schemeIdUri=\"urn:dvb:dash:reporting:2014\" value=\"1\""
+          " reportingUrl=\"https://report.example.com/\" probability=\"50\"/></Metrics>\n"
+       << "</MPD>\n";
+
+    std::string str(os.str());
+    return std::vector<char>(str.begin(), str.end());
+}
+
+static std::size_t heap_in_use()
+{
+#if defined(__GLIBC__)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static void run_benchmark(const char *name, const std::vector<std::vector<char> > &manifests, const MPD::ParseOptions &options)
+{
+    std::size_t before = heap_in_use();
+    auto start = std::chrono::steady_clock::now();
+    std::list<MPD> mpds;
+    for (const auto &manifest : manifests) {
+        mpds.emplace_back(manifest, std::nullopt, options);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::size_t used = heap_in_use() - before;
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << (used / 1024.0 / manifests.size()) << " KiB/MPD"
+              << std::setw(12) << (elapsed.count() / manifests.size()) << " us/parse" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int count = 200;
+    if (argc > 1) count = static_cast<unsigned int>(strtoul(argv[1], nullptr, 10));
+    if (count == 0) count = 1;
+
+    std::vector<std::vector<char> > manifests;
+    manifests.reserve(count);
+    for (unsigned int i = 0; i < count; i++) {
+        manifests.push_back(make_manifest(i));
+    }
+
+    // Keep only what a player needs to fetch video and audio segments
+    ParseFilter filter;
+    for (const char *element : {"ProgramInformation", "Metrics", "ContentProtection", "Label", "Viewpoint"}) {
+        filter.skipElement(element);
+    }
+    filter.skipAdaptationSetContentType("text")
+          .skipAdaptationSetEssentialProperty("http://dashif.org/guidelines/trickmode");
+
+#if !defined(__GLIBC__)
+    std::cout << "Heap usage is only measured when using the GNU C library" << std::endl;
+#endif
+    std::cout << "Parsing " << count << " MPDs (" << manifests.front().size() << " bytes of XML each)" << std::endl;
+
+    run_benchmark("DOM", manifests, MPD::ParseOptions());
+    run_benchmark("DOM filtered", manifests, MPD::ParseOptions().parseFilter(filter));
+    run_benchmark("streaming", manifests, MPD::ParseOptions().parserBackend(MPD::PARSER_STREAMING));
+    run_benchmark("streaming filtered", manifests,
+                  MPD::ParseOptions().parserBackend(MPD::PARSER_STREAMING).parseFilter(filter));
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: Example program to benchmark the memory saved by a StringPool
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <stdlib.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/MPD.hh"
+#include "libmpd++/StringPool.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+// Make a manifest for one channel, all channels use the same packager settings so only the channel name and URLs differ
+static std::vector<char> make_manifest(unsigned int channel)
+{
+    static const char *drm_systems[] = {
+        "urn:uuid:edef8ba9-79d6-4ace-a3c8-27dcd51d21ed",
+        "urn:uuid:9a04f079-9840-4286-ab92-e65be0885f95",
+        "urn:uuid:94ce86fb-07ff-4f43-adb8-93d2fa968ca2"
+    };
+    static const struct {
+        const char *codecs;
+        unsigned int width, height, bandwidth;
+    } video_reps[] = {
+        {"avc1.640028", 1920, 1080, 8000000},
+        {"avc1.64001f", 1280, 720, 4000000},
+        {"avc1.64001e", 960, 540, 2000000},
+        {"avc1.4d401e", 704, 396, 1200000},
+        {"avc1.4d4015", 512, 288, 600000}
+    };
+
+    std::ostringstream os;
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+       << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"dynamic\" minBufferTime=\"PT4S\""
+          " availabilityStartTime=\"1970-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:00Z\""
+          " minimumUpdatePeriod=\"PT8S\" timeShiftBufferDepth=\"PT2H\""
+          " profiles=\"urn:mpeg:dash:profile:isoff-live:2011,urn:dvb:dash:profile:dvb-dash:2014\">\n"
+       << "  <BaseURL>https://vod-dash-live.example.com/pool_" << (channel % 16) << "/live/channel_" << channel << "/</BaseURL>\n"
+       << "  <UTCTiming schemeIdUri=\"urn:mpeg:dash:utc:http-xsdate:2014\" value=\"https://time.example.com/iso\"/>\n";
+    for (unsigned int period = 0; period < 2; period++) {
+        os << "  <Period id=\"p" << period << "\" start=\"PT" << period * 3600 << "S\">\n";
+        for (const char *content_type : {"video", "audio"}) {
+            bool video = std::string(content_type) == "video";
+            os << "    <AdaptationSet contentType=\"" << content_type << "\" mimeType=\"" << content_type << "/mp4\""
+               << " segmentAlignment=\"true\" startWithSAP=\"1\"" << (video?"":" lang=\"en\"") << ">\n";
+            os << "      <ContentProtection schemeIdUri=\"urn:mpeg:dash:mp4protection:2011\" value=\"cenc\"/>\n";
+            for (const char *drm_system : drm_systems) {
+                os << "      <ContentProtection schemeIdUri=\"" << drm_system << "\" robustness=\"SW_SECURE_CRYPTO\"/>\n";
+            }
+            os << "      <Role schemeIdUri=\"urn:mpeg:dash:role:2011\" value=\"main\"/>\n";
+            os << "      <SegmentTemplate timescale=\"1000\" duration=\"3840\" startNumber=\"1\""
+                  " initialization=\"$RepresentationID$/init_segment_for_$RepresentationID$.mp4\""
+                  " media=\"$RepresentationID$/media_segment_$Number%09d$_for_$RepresentationID$.m4s\"/>\n";
+            if (video) {
+                for (const auto &rep : video_reps) {
+                    os << "      <Representation id=\"video=" << rep.bandwidth << "\" bandwidth=\"" << rep.bandwidth
+                       << "\" codecs=\"" << rep.codecs << "\" width=\"" << rep.width << "\" height=\"" << rep.height
+                       << "\" frameRate=\"25\" sar=\"1:1\" scanType=\"progressive\"/>\n";
+                }
+            } else {
+                os << "      <Representation id=\"audio=128000\" bandwidth=\"128000\" codecs=\"mp4a.40.2\""
+                      " audioSamplingRate=\"48000\">\n"
+                   << "        <AudioChannelConfiguration schemeIdUri=\"urn:mpeg:mpegB:cicp:ChannelConfiguration\""
+                      " value=\"2\"/>\n"
+                   << "      </Representation>\n";
+            }
+            os << "    </AdaptationSet>\n";
+        }
+        os << "  </Period>\n";
+    }
+    os << "</MPD>\n";
+
+    std::string str(os.str());
+    return std::vector<char>(str.begin(), str.end());
+}
+
+static std::size_t heap_in_use()
+{
+#if defined(__GLIBC__)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static std::size_t run_benchmark(const char *name, const std::vector<std::vector<char> > &manifests,
+                                 const std::shared_ptr<StringPool> &pool)
+{
+    std::size_t before = heap_in_use();
+    auto start = std::chrono::steady_clock::now();
+    std::list<MPD> mpds;
+    for (const auto &manifest : manifests) {
+        mpds.emplace_back(manifest, std::nullopt, MPD::ParseOptions().stringPool(pool));
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::size_t used = heap_in_use() - before;
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << (used / 1024.0) << " KiB" << std::setw(12) << (used / 1024.0 / manifests.size())
+              << " KiB/MPD" << std::setw(12) << (elapsed.count() / manifests.size()) << " us/parse";
+    if (pool) std::cout << " (" << pool->size() << " pooled values)";
+    std::cout << std::endl;
+    return used;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int count = 1000;
+    if (argc > 1) count = static_cast<unsigned int>(strtoul(argv[1], nullptr, 10));
+    if (count == 0) count = 1;
+
+    std::vector<std::vector<char> > manifests;
+    manifests.reserve(count);
+    for (unsigned int i = 0; i < count; i++) {
+        manifests.push_back(make_manifest(i));
+    }
+
+#if !defined(__GLIBC__)
+    std::cout << "Heap usage is only measured when using the GNU C library" << std::endl;
+#endif
+    std::cout << "Holding " << count << " similar MPDs (" << manifests.front().size() << " bytes of XML each) in memory"
+              << std::endl;
+
+    std::size_t unpooled = run_benchmark("no pool", manifests, nullptr);
+    std::size_t pooled = run_benchmark("shared pool", manifests, std::make_shared<StringPool>());
+    if (pooled > 0) {
+        std::cout << "Memory reduction: " << std::setprecision(1) << (100.0 - pooled * 100.0 / unpooled) << "%" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: Example program to benchmark MPD parsing
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <stdlib.h>
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "libmpd++/MPD.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+static void run_benchmark(const char *name, unsigned int iterations, const std::function<void()> &fn)
+{
+    fn(); // warm up caches
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++) {
+        fn();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << (elapsed.count() / iterations) << " us/parse" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <mpd-file> [<iterations>]" << std::endl;
+        return 1;
+    }
+
+    std::string filename(argv[1]);
+    unsigned int iterations = 100;
+    if (argc > 2) iterations = static_cast<unsigned int>(strtoul(argv[2], nullptr, 10));
+    if (iterations == 0) iterations = 1;
+
+    std::vector<char> contents;
+    {
+        std::ifstream ifs(filename, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    std::cout << "Parsing " << filename << " (" << contents.size() << " bytes) " << iterations << " times" << std::endl;
+
+    for (auto backend : {MPD::PARSER_DOM, MPD::PARSER_STREAMING}) {
+        std::string backend_name(backend == MPD::PARSER_DOM?"DOM":"streaming");
+
+        run_benchmark((backend_name + " file").c_str(), iterations, [&]() {
+            MPD mpd(filename, std::nullopt, backend);
+        });
+
+        run_benchmark((backend_name + " istream").c_str(), iterations, [&]() {
+            std::ifstream ifs(filename, std::ios::binary);
+            MPD mpd(ifs, std::nullopt, backend);
+        });
+
+        run_benchmark((backend_name + " vector (read+parse)").c_str(), iterations, [&]() {
+            std::ifstream ifs(filename, std::ios::binary);
+            std::vector<char> mpd_xml((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+            MPD mpd(mpd_xml, std::nullopt, backend);
+        });
+
+        run_benchmark((backend_name + " vector (parse only)").c_str(), iterations, [&]() {
+            MPD mpd(contents, std::nullopt, backend);
+        });
+
+        run_benchmark((backend_name + " vector (parallel)").c_str(), iterations, [&]() {
+            MPD mpd(contents, std::nullopt, backend, 0);
+        });
+
+        run_benchmark((backend_name + " vector (lazy Periods)").c_str(), iterations, [&]() {
+            MPD mpd(contents, std::nullopt, MPD::ParseOptions().parserBackend(backend).lazyPeriods(true));
+        });
+    }
+
+    {
+        MPD mpd(contents, std::nullopt);
+        auto snapshot = mpd.saveSnapshot();
+        std::cout << "Snapshot size " << snapshot.size() << " bytes" << std::endl;
+        run_benchmark("snapshot load", iterations, [&]() {
+            MPD loaded(MPD::loadSnapshot(snapshot));
+        });
+        run_benchmark("snapshot save", iterations, [&]() {
+            auto saved = mpd.saveSnapshot();
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: Example program to benchmark MPD Patches
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <stdlib.h>
+
+#include <chrono>
+#include <format>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/MPD.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+/* Publish time for update number @p update, each update adds a 2 second segment */
+static std::string publish_time(unsigned int update)
+{
+    return std::format("{:%FT%TZ}", std::chrono::sys_seconds(std::chrono::seconds(1735689600 + 2 * update)));
+}
+
+/* Build a live MPD with @p periods Periods, each with a video and an audio AdaptationSet using a SegmentTimeline */
+static std::string make_mpd(unsigned int periods, unsigned int segments, unsigned int update)
+{
+    std::string timeline;
+    for (unsigned int i = 0; i < segments + update; i++) {
+        timeline += std::format("<S t=\"{}\" d=\"2000\"/>", i * 2000);
+    }
+
+    std::string mpd = "<?xml version=\"1.0\"?>"
+                      "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" id=\"bench\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+                      " type=\"dynamic\" availabilityStartTime=\"1970-01-01T00:00:00Z\" publishTime=\"" + publish_time(update) +
+                      "\" minimumUpdatePeriod=\"PT2S\" minBufferTime=\"PT2S\">"
+                      "<PatchLocation ttl=\"60\">patch.mpp</PatchLocation>";
+    for (unsigned int p = 0; p < periods; p++) {
+        mpd += std::format("<Period id=\"p{}\" start=\"PT{}S\">", p, p * 3600);
+        for (const char *type : {"video", "audio"}) {
+            mpd += std::format("<AdaptationSet id=\"{}\" contentType=\"{}\" mimeType=\"{}/mp4\">"
+                               "<SegmentTemplate timescale=\"1000\" media=\"$RepresentationID$/$Time$.m4s\""
+                               " initialization=\"$RepresentationID$/init.m4s\">"
+                               "<SegmentTimeline>{}</SegmentTimeline></SegmentTemplate>",
+                               type[0] == 'v'?1:2, type, type, (p + 1 == periods)?timeline:std::string("<S t=\"0\" d=\"3600000\"/>"));
+            for (unsigned int r = 0; r < 4; r++) {
+                mpd += std::format("<Representation id=\"{}{}\" bandwidth=\"{}\"/>", type[0], r, (r + 1) * 500000);
+            }
+            mpd += "</AdaptationSet>";
+        }
+        mpd += "</Period>";
+    }
+    mpd += "</MPD>";
+    return mpd;
+}
+
+/* Build the patch taking update @p update - 1 to update @p update */
+static std::string make_patch(unsigned int periods, unsigned int segments, unsigned int update)
+{
+    std::string patch = "<?xml version=\"1.0\"?>"
+                        "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"bench\" originalPublishTime=\"" +
+                        publish_time(update - 1) + "\" publishTime=\"" + publish_time(update) + "\">"
+                        "<replace sel=\"/MPD/@publishTime\">" + publish_time(update) + "</replace>";
+    for (unsigned int as_id = 1; as_id <= 2; as_id++) {
+        patch += std::format("<add sel=\"/MPD/Period[@id='p{}']/AdaptationSet[@id='{}']/SegmentTemplate/SegmentTimeline\">"
+                             "<S t=\"{}\" d=\"2000\"/></add>", periods - 1, as_id, (segments + update - 1) * 2000);
+    }
+    patch += "</Patch>";
+    return patch;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int periods = 10;
+    unsigned int segments = 100;
+    unsigned int iterations = 100;
+    if (argc > 1) periods = static_cast<unsigned int>(strtoul(argv[1], nullptr, 10));
+    if (argc > 2) segments = static_cast<unsigned int>(strtoul(argv[2], nullptr, 10));
+    if (argc > 3) iterations = static_cast<unsigned int>(strtoul(argv[3], nullptr, 10));
+    if (periods == 0) periods = 1;
+    if (iterations == 0) iterations = 1;
+
+    // Generate the documents up front so that only the parsing and patching is timed
+    std::vector<std::vector<char> > full_mpds;
+    std::vector<std::vector<char> > patches;
+    for (unsigned int update = 1; update <= iterations; update++) {
+        auto mpd = make_mpd(periods, segments, update);
+        auto patch = make_patch(periods, segments, update);
+        full_mpds.emplace_back(mpd.begin(), mpd.end());
+        patches.emplace_back(patch.begin(), patch.end());
+    }
+    std::string initial_xml = make_mpd(periods, segments, 0);
+    std::vector<char> initial(initial_xml.begin(), initial_xml.end());
+
+    std::cout << "Updating an MPD with " << periods << " Periods and " << segments << " segments " << iterations << " times"
+              << std::endl;
+    std::cout << "Full MPD " << full_mpds.back().size() << " bytes, patch " << patches.back().size() << " bytes" << std::endl;
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &mpd_xml : full_mpds) {
+            MPD mpd(mpd_xml, std::nullopt);
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << std::left << std::setw(28) << "full reparse" << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << (elapsed.count() / iterations) << " us/update" << std::endl;
+    }
+
+    {
+        MPD mpd(initial, std::nullopt);
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &patch_xml : patches) {
+            mpd.applyPatch(patch_xml);
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << std::left << std::setw(28) << "apply patch" << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << (elapsed.count() / iterations) << " us/update" << std::endl;
+
+        if (mpd != MPD(full_mpds.back(), std::nullopt)) {
+            std::cerr << "Patched MPD differs from the full MPD" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: Example program to benchmark segment range enumeration
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <stdlib.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/MPD.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+/* A one hour Period with the SegmentTemplate and BaseURLs inherited from the AdaptationSet, as a prefetcher would see */
+static const char *c_mpd_xml =
+    "<?xml version=\"1.0\"?>"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" type=\"static\""
+    " mediaPresentationDuration=\"PT1H\" minBufferTime=\"PT2S\">"
+    "<BaseURL>https://cdn.example.com/channel/</BaseURL>"
+    "<Period id=\"p0\" start=\"PT0S\" duration=\"PT1H\">"
+    "<BaseURL>period0/</BaseURL>"
+    "<AdaptationSet contentType=\"video\" mimeType=\"video/mp4\">"
+    "<BaseURL>video/</BaseURL>"
+    "<SegmentTemplate timescale=\"1000\" duration=\"3840\" startNumber=\"1\""
+    " media=\"$RepresentationID$/$Bandwidth$/$Number%09d$.m4s\" initialization=\"$RepresentationID$/init.mp4\"/>"
+    "<Representation id=\"v1\" bandwidth=\"2000000\"/>"
+    "</AdaptationSet>"
+    "</Period>"
+    "</MPD>";
+
+int main(int argc, char *argv[])
+{
+    unsigned long batch = 50;
+    unsigned int iterations = 2000;
+    if (argc > 1) batch = strtoul(argv[1], nullptr, 10);
+    if (argc > 2) iterations = static_cast<unsigned int>(strtoul(argv[2], nullptr, 10));
+    if (batch == 0) batch = 1;
+    if (iterations == 0) iterations = 1;
+
+    std::string xml(c_mpd_xml);
+    MPD mpd(std::vector<char>(xml.begin(), xml.end()));
+    const Representation &rep = mpd.periods().front().adaptationSets().front().representations().front();
+    const auto segment_duration = std::chrono::milliseconds(3840);
+
+    std::cout << "Fetching " << batch << " segments, " << iterations << " times" << std::endl;
+
+    // One segmentAvailability() call per segment with synthetic query times
+    std::size_t url_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++) {
+        for (unsigned long seg = 0; seg < batch; seg++) {
+            auto avail = rep.segmentAvailability(Representation::time_type() + seg * segment_duration);
+            url_bytes += avail.segmentURL().str().size();
+        }
+    }
+    std::chrono::duration<double, std::nano> single = std::chrono::steady_clock::now() - start;
+
+    // One segmentAvailabilities() call for the whole range, starting at 1 as segmentAvailability() gives the next segment for
+    // a static MPD
+    start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < iterations; i++) {
+        for (const auto &avail : rep.segmentAvailabilities(1, batch)) {
+            url_bytes += avail.segmentURL().str().size();
+        }
+    }
+    std::chrono::duration<double, std::nano> ranged = std::chrono::steady_clock::now() - start;
+
+    double segments = static_cast<double>(batch) * iterations;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::left << std::setw(24) << "segmentAvailability()" << std::right << std::setw(10)
+              << (single.count() / segments) << " ns/segment" << std::endl
+              << std::left << std::setw(24) << "segmentAvailabilities()" << std::right << std::setw(10)
+              << (ranged.count() / segments) << " ns/segment" << std::endl
+              << "(" << url_bytes << " bytes of URLs generated)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: Example program to benchmark relative URL resolution
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <stdlib.h>
+
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "libmpd++/macros.hh"
+
+// Private library header, this benchmarks an internal class
+#include "DecomposedURL.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+// A cut down version of the std::list based URL resolution previously used by the library, kept here for comparison
+struct ListURL {
+    ListURL(const std::string &url) :scheme(), authority(), hasAuthority(false), path(), query(), fragment() {
+        std::string::size_type pos = url.find_first_of(":/?#");
+        std::string::size_type start = 0;
+        if (pos != std::string::npos && url[pos] == ':') {
+            scheme = url.substr(0, pos);
+            start = pos + 1;
+        }
+        if (url.compare(start, 2, "//") == 0) {
+            hasAuthority = true;
+            pos = url.find_first_of("/?#", start + 2);
+            authority = url.substr(start + 2, pos - start - 2);
+            start = pos;
+        }
+        if (start == std::string::npos) return;
+        pos = url.find_first_of("?#", start);
+        std::string path_str(url.substr(start, pos - start));
+        if (!path_str.empty()) {
+            std::string::size_type seg_start = 0, seg_end;
+            do {
+                seg_end = path_str.find('/', seg_start);
+                path.push_back(path_str.substr(seg_start, seg_end - seg_start));
+                seg_start = seg_end + 1;
+            } while (seg_end != std::string::npos);
+        }
+        if (pos != std::string::npos && url[pos] == '?') {
+            std::string::size_type query_end = url.find('#', pos);
+            query = url.substr(pos + 1, query_end - pos - 1);
+            pos = query_end;
+        }
+        if (pos != std::string::npos) fragment = url.substr(pos + 1);
+    };
+
+    static std::list<std::string> removeDotSegments(const std::list<std::string> &original) {
+        std::list<std::string> ret;
+        for (auto seg = original.begin(); seg != original.end(); ++seg) {
+            auto next = std::next(seg);
+            if (*seg == ".") continue;
+            if (seg->empty() && seg != original.begin() && next != original.end()) continue;
+            if (*seg == "..") {
+                if (!ret.empty() && !ret.back().empty()) ret.pop_back();
+                continue;
+            }
+            ret.push_back(*seg);
+        }
+        return ret;
+    };
+
+    ListURL &operator+=(const ListURL &other) {
+        if (!other.scheme.empty() || other.hasAuthority) {
+            if (!other.scheme.empty()) scheme = other.scheme;
+            authority = other.authority;
+            hasAuthority = other.hasAuthority;
+            path = removeDotSegments(other.path);
+            query = other.query;
+        } else if (other.path.empty()) {
+            if (!other.query.empty()) query = other.query;
+        } else if (other.path.front().empty()) {
+            path = removeDotSegments(other.path);
+            query = other.query;
+        } else {
+            std::list<std::string> merged(path);
+            if (!merged.empty()) merged.pop_back();
+            merged.insert(merged.end(), other.path.begin(), other.path.end());
+            path = removeDotSegments(merged);
+            query = other.query;
+        }
+        fragment = other.fragment;
+        return *this;
+    };
+
+    operator std::string() const {
+        std::string ret;
+        if (!scheme.empty()) ret += scheme + ":";
+        if (hasAuthority) ret += "//" + authority;
+        const char *sep = "";
+        for (const auto &seg : path) {
+            ret += sep;
+            ret += seg;
+            sep = "/";
+        }
+        if (!query.empty()) ret += "?" + query;
+        if (!fragment.empty()) ret += "#" + fragment;
+        return ret;
+    };
+
+    std::string scheme;
+    std::string authority;
+    bool hasAuthority;
+    std::list<std::string> path;
+    std::string query;
+    std::string fragment;
+};
+
+static double run_benchmark(const char *name, const std::vector<std::string> &refs, unsigned int resolutions,
+                            const std::function<std::size_t(const std::string&)> &fn)
+{
+    std::size_t total = 0;
+    for (const auto &ref : refs) total += fn(ref); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < resolutions; i++) {
+        total += fn(refs[i % refs.size()]);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double per_resolve = elapsed.count() / resolutions;
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << per_resolve << " ns/resolution (checksum " << total << ")" << std::endl;
+    return per_resolve;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int resolutions = 1000000;
+    if (argc > 1) resolutions = static_cast<unsigned int>(strtoul(argv[1], nullptr, 10));
+    if (resolutions == 0) resolutions = 1;
+
+    static const std::string base("https://cdn.example.com/dash/live/channel_1/manifest.mpd?token=0123456789abcdef");
+
+    // Segment URLs as they typically appear after SegmentTemplate substitution
+    std::vector<std::string> refs;
+    for (unsigned int i = 0; i < 100; i++) {
+        refs.push_back("video/avc1/1/segment_" + std::to_string(1234567 + i) + ".m4s");
+        refs.push_back("../channel_1/audio/mp4a/segment_" + std::to_string(1234567 + i) + ".m4s");
+    }
+
+    const DecomposedURL base_url(base);
+    for (const auto &ref : refs) {
+        std::string old_val(ListURL(base) += ListURL(ref));
+        std::string new_val(base_url.resolve(ref).str());
+        if (old_val != new_val) {
+            std::cerr << "Resolvers disagree on " << ref << ": " << old_val << " vs " << new_val << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Resolving " << resolutions << " references against " << base << std::endl;
+    auto list_time = run_benchmark("std::list", refs, resolutions, [](const std::string &ref) {
+        ListURL url(base);
+        url += ListURL(ref);
+        return std::string(url).size();
+    });
+    run_benchmark("DecomposedURL per call", refs, resolutions, [](const std::string &ref) {
+        return DecomposedURL(DecomposedURL(base), ref).str().size();
+    });
+    std::string out;
+    auto reuse_time = run_benchmark("pre-decomposed base", refs, resolutions, [&base_url, &out](const std::string &ref) {
+        base_url.resolve(ref, out);
+        return out.size();
+    });
+    std::cout << "Speedup: " << std::setprecision(1) << (list_time / reuse_time) << "x" << std::endl;
+
+    return 0;
+}
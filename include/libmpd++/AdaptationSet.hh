@@ -14,8 +14,10 @@
 #include <chrono>
 #include <list>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "macros.hh"
 #include "BaseURL.hh"
@@ -31,6 +33,7 @@
 #include "SegmentBase.hh"
 #include "SegmentList.hh"
 #include "SegmentTemplate.hh"
+#include "SharedValue.hh"
 #include "URI.hh"
 #include "XLink.hh"
 
@@ -984,7 +987,7 @@ public:
      *
      * @return The list of Initialization Set references.
      */
-    const std::list<unsigned int> &initializationSetRefs() const { return m_initializationSetRefs; };
+    std::span<const unsigned int> initializationSetRefs() const { return m_initializationSetRefs; };
 
     /**@{*/
     /**
@@ -992,8 +995,8 @@ public:
      *
      * @return An iterator pointing to the start of the Initialization Set references list.
      */
-    std::list<unsigned int>::const_iterator initializationSetRefsBegin() const { return m_initializationSetRefs.cbegin(); };
-    std::list<unsigned int>::iterator initializationSetRefsBegin() { return m_initializationSetRefs.begin(); };
+    std::span<const unsigned int>::iterator initializationSetRefsBegin() const { return initializationSetRefs().begin(); };
+    std::span<unsigned int>::iterator initializationSetRefsBegin() { return std::span<unsigned int>(m_initializationSetRefs).begin(); };
     /**@}*/
 
     /**@{*/
@@ -1002,8 +1005,8 @@ public:
      *
      * @return An iterator pointing to the start of the Initialization Set references list.
      */
-    std::list<unsigned int>::const_iterator initializationSetRefsEnd() const { return m_initializationSetRefs.cend(); };
-    std::list<unsigned int>::iterator initializationSetRefsEnd() { return m_initializationSetRefs.end(); };
+    std::span<const unsigned int>::iterator initializationSetRefsEnd() const { return initializationSetRefs().end(); };
+    std::span<unsigned int>::iterator initializationSetRefsEnd() { return std::span<unsigned int>(m_initializationSetRefs).end(); };
     /**@}*/
 
     /** Get the Initialization Set reference at the given list index
@@ -1012,12 +1015,10 @@ public:
      * @return The Initialization Set reference at the list index @p idx.
      * @throw std::out_of_range if @p idx is after the end of the Initialization Set reference list.
      */
-    unsigned int initializationSetRef(std::list<unsigned int>::size_type idx) const {
+    unsigned int initializationSetRef(std::vector<unsigned int>::size_type idx) const {
         if (idx >= m_initializationSetRefs.size())
             throw std::out_of_range("AdaptationSet Initialization Set Reference does not exist");
-        auto it = m_initializationSetRefs.cbegin();
-        while (idx > 0 && it != m_initializationSetRefs.cend()) {it++; idx--;}
-        return *it;
+        return m_initializationSetRefs[idx];
     };
 
     /**
@@ -1054,8 +1055,8 @@ public:
      * @see initializationSetRefsBegin()
      * @see initializationSetRefsEnd()
      */
-    AdaptationSet &initializationSetRefRemove(const std::list<unsigned int>::const_iterator &it) { m_initializationSetRefs.erase(it); return *this; };
-    AdaptationSet &initializationSetRefRemove(const std::list<unsigned int>::iterator &it) { m_initializationSetRefs.erase(it); return *this; };
+    AdaptationSet &initializationSetRefRemove(const std::span<const unsigned int>::iterator &it);
+    AdaptationSet &initializationSetRefRemove(const std::span<unsigned int>::iterator &it);
     /**@}*/
 
     /**
@@ -1068,7 +1069,7 @@ public:
      *                                references.
      * @return This AdaptationSet.
      */
-    AdaptationSet &initializationSetRefs(const std::list<unsigned int> &initialization_set_refs) { m_initializationSetRefs = initialization_set_refs; return *this;};
+    AdaptationSet &initializationSetRefs(const std::vector<unsigned int> &initialization_set_refs) { m_initializationSetRefs = initialization_set_refs; return *this;};
 
     /**
      * Set the list of Initialization Set references (move)
@@ -1079,7 +1080,7 @@ public:
      *                                references.
      * @return This AdaptationSet.
      */
-    AdaptationSet &initializationSetRefs(std::list<unsigned int> &&initialization_set_refs) { m_initializationSetRefs = std::move(initialization_set_refs); return *this;};
+    AdaptationSet &initializationSetRefs(std::vector<unsigned int> &&initialization_set_refs) { m_initializationSetRefs = std::move(initialization_set_refs); return *this;};
 
     // @initializationPrincipal
 
@@ -1546,7 +1547,7 @@ public:
      * @return An iterator pointing to the start of the %BaseURL elements list.
      */
     std::list<BaseURL>::const_iterator baseURLsBegin() const { return m_baseURLs.cbegin(); };
-    std::list<BaseURL>::iterator baseURLsBegin() { return m_baseURLs.begin(); };
+    std::list<BaseURL>::iterator baseURLsBegin() { invalidateBaseURLs(); return m_baseURLs.begin(); };
     /**@}*/
 
     /**@{*/
@@ -1556,7 +1557,7 @@ public:
      * @return An iterator pointing to the end of the %BaseURL elements list.
      */
     std::list<BaseURL>::const_iterator baseURLsEnd() const { return m_baseURLs.cend(); };
-    std::list<BaseURL>::iterator baseURLsEnd() { return m_baseURLs.end(); };
+    std::list<BaseURL>::iterator baseURLsEnd() { invalidateBaseURLs(); return m_baseURLs.end(); };
     /**@}*/
 
     /** Get an %BaseURL element
@@ -1610,10 +1611,13 @@ public:
     /**@}*/
 
     /** Get the list of BaseURL entries that apply for this AdaptationSet
+     *
+     * The resolved list is cached, the reference remains valid until the BaseURLs of this AdaptationSet or any of its parents are
+     * changed.
      *
      * @return A list of BaseURL entries from this AdaptationSet merged with entries from the Period and MPD.
      */ 
-    std::list<BaseURL> getBaseURLs() const;
+    const std::list<BaseURL> &getBaseURLs() const;
 
     // SegmentBase child
 
@@ -1635,7 +1639,7 @@ public:
      *
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentBase(const std::nullopt_t &) { m_segmentBase.reset(); return *this; };
+    AdaptationSet &segmentBase(const std::nullopt_t &) { m_segmentBase.reset(); invalidateAddressing(); return *this; };
 
     /** Set the SegmentBase
      *
@@ -1644,7 +1648,7 @@ public:
      * @param seg_base The SegmentBase to set on this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentBase(const SegmentBase &seg_base) { m_segmentBase = seg_base; return *this; };
+    AdaptationSet &segmentBase(const SegmentBase &seg_base) { m_segmentBase = seg_base; invalidateAddressing(); return *this; };
 
     /** Set the SegmentBase
      *
@@ -1653,7 +1657,7 @@ public:
      * @param seg_base The SegmentBase to set on this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentBase(SegmentBase &&seg_base) { m_segmentBase = std::move(seg_base); return *this; };
+    AdaptationSet &segmentBase(SegmentBase &&seg_base) { m_segmentBase = std::move(seg_base); invalidateAddressing(); return *this; };
 
     /**@{*/
     /** Set the SegmentBase
@@ -1663,8 +1667,8 @@ public:
      * @param seg_base The SegmentBase to set in this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentBase(const std::optional<SegmentBase> &seg_base) { m_segmentBase = seg_base; return *this; };
-    AdaptationSet &segmentBase(std::optional<SegmentBase> &&seg_base) { m_segmentBase = std::move(seg_base); return *this; };
+    AdaptationSet &segmentBase(const std::optional<SegmentBase> &seg_base) { m_segmentBase = seg_base; invalidateAddressing(); return *this; };
+    AdaptationSet &segmentBase(std::optional<SegmentBase> &&seg_base) { m_segmentBase = std::move(seg_base); invalidateAddressing(); return *this; };
     /**@}*/
 
     // SegmentList child
@@ -1687,7 +1691,7 @@ public:
      *
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentList(const std::nullopt_t &) { m_segmentList.reset(); return *this; };
+    AdaptationSet &segmentList(const std::nullopt_t &) { m_segmentList.reset(); invalidateAddressing(); return *this; };
 
     /** Set the SegmentList
      *
@@ -1696,7 +1700,7 @@ public:
      * @param seg_list The SegmentList to set on this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentList(const SegmentList &seg_list) { m_segmentList = seg_list; return *this; };
+    AdaptationSet &segmentList(const SegmentList &seg_list) { m_segmentList = seg_list; invalidateAddressing(); return *this; };
 
     /** Set the SegmentList
      *
@@ -1705,7 +1709,7 @@ public:
      * @param seg_list The SegmentList to set on this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentList(SegmentList &&seg_list) { m_segmentList = std::move(seg_list); return *this; };
+    AdaptationSet &segmentList(SegmentList &&seg_list) { m_segmentList = std::move(seg_list); invalidateAddressing(); return *this; };
 
     /**@{*/
     /** Set the SegmentList
@@ -1715,8 +1719,8 @@ public:
      * @param seg_list The SegmentList to set in this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentList(const std::optional<SegmentList> &seg_list) { m_segmentList = seg_list; return *this; };
-    AdaptationSet &segmentList(std::optional<SegmentList> &&seg_list) { m_segmentList = std::move(seg_list); return *this; };
+    AdaptationSet &segmentList(const std::optional<SegmentList> &seg_list) { m_segmentList = seg_list; invalidateAddressing(); return *this; };
+    AdaptationSet &segmentList(std::optional<SegmentList> &&seg_list) { m_segmentList = std::move(seg_list); invalidateAddressing(); return *this; };
     /**@}*/
 
     // SegmentTemplate child
@@ -1739,7 +1743,7 @@ public:
      *
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentTemplate(const std::nullopt_t &) { m_segmentTemplate.reset(); return *this; };
+    AdaptationSet &segmentTemplate(const std::nullopt_t &) { m_segmentTemplate.reset(); invalidateAddressing(); return *this; };
 
     /** Set the SegmentTemplate
      *
@@ -1748,7 +1752,7 @@ public:
      * @param seg_template The SegmentTemplate to set on this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentTemplate(const SegmentTemplate &seg_template) {m_segmentTemplate = seg_template; return *this; };
+    AdaptationSet &segmentTemplate(const SegmentTemplate &seg_template) {m_segmentTemplate = seg_template; invalidateAddressing(); return *this; };
 
     /** Set the SegmentTemplate
      *
@@ -1757,7 +1761,7 @@ public:
      * @param seg_template The SegmentTemplate to set on this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentTemplate(SegmentTemplate &&seg_template) {m_segmentTemplate = std::move(seg_template); return *this; };
+    AdaptationSet &segmentTemplate(SegmentTemplate &&seg_template) {m_segmentTemplate = std::move(seg_template); invalidateAddressing(); return *this; };
 
     /**@{*/
     /** Set the SegmentTemplate
@@ -1767,8 +1771,8 @@ public:
      * @param seg_template The SegmentTemplate to set in this AdaptationSet.
      * @return This AdaptationSet.
      */
-    AdaptationSet &segmentTemplate(const std::optional<SegmentTemplate> &seg_template) {m_segmentTemplate = seg_template; return *this; };
-    AdaptationSet &segmentTemplate(std::optional<SegmentTemplate> &&seg_template) {m_segmentTemplate = std::move(seg_template); return *this; };
+    AdaptationSet &segmentTemplate(const std::optional<SegmentTemplate> &seg_template) {m_segmentTemplate = seg_template; invalidateAddressing(); return *this; };
+    AdaptationSet &segmentTemplate(std::optional<SegmentTemplate> &&seg_template) {m_segmentTemplate = std::move(seg_template); invalidateAddressing(); return *this; };
     /**@}*/
 
     // Representation children
@@ -1979,6 +1983,9 @@ protected:
     friend class MPD;
     friend class Period;
     friend class Representation;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
 
     /**
      * XML constructor (internal use only)
@@ -2004,50 +2011,10 @@ protected:
      * @param period The Period to set as this AdaptationSet's parent object.
      * @return This AdaptationSet.
      */
-    AdaptationSet &setPeriod(Period *period) { m_period = period; return *this; };
-
-    /**
-     * Get a media segment URL
-     *
-     * Using the @p vars, get a media URL by applying a SegmentTemplate or SegmentList attached to this AdaptationSet.
-     *
-     * @param vars The segment variables to apply to any template or list index.
-     * @return The URL string for the media or an empty string if no template or list could be found.
-     */
-    std::string getMediaURL(const SegmentTemplate::Variables &vars) const;
-
-    /**
-     * Get an initialization segment URL
-     *
-     * Using the @p vars, get an initialization segment URL by applying a SegmentTemplate or SegmentList attached to this
-     * AdaptationSet.
-     *
-     * @param vars The segment variables to apply to any template or list index.
-     * @return The URL string for the initialization segment or an empty string if no template or list could be found.
-     */
-    std::string getInitializationURL(const SegmentTemplate::Variables &vars) const;
-
-    /**
-     * Get the media segment availability and URL
-     *
-     * Using the @p vars, get media segment metadata by applying a SegmentTemplate or SegmentList attached to this AdaptationSet.
-     *
-     * @param vars The segment variables to apply to any template or list index.
-     * @return The segment availability times and URL. The URL will be empty if no suitable segment could be found.
-     */
-    SegmentAvailability getMediaAvailability(const SegmentTemplate::Variables &vars) const;
-
-    /**
-     * Get the initialization segment availability and URL
-     *
-     * Using the @p vars, get initialization segment metadata by applying a SegmentTemplate or SegmentList attached to this
-     * AdaptationSet.
-     *
-     * @param vars The segment variables to apply to any template or list index.
-     * @return The initialization segment availability times and URL. The URL will be empty if no suitable initialization segment
-     *         could be found.
-     */
-    SegmentAvailability getInitialisationAvailability(const SegmentTemplate::Variables &vars) const;
+    AdaptationSet &setPeriod(Period *period) {
+        if (m_period != period) { m_period = period; invalidateBaseURLs(); invalidateAddressing(); }
+        return *this;
+    };
 
     /**
      * Get the start time for the parent Period
@@ -2064,19 +2031,12 @@ protected:
      */
     std::optional<duration_type> getPeriodDuration() const;
 
-    /**
-     * Get the MultipleSegmentBase appropriate for this AdaptationSet
-     *
-     * Returns the MultipleSegmentBase object for a SegmentTemplate or SegmentList associated with this AdaptationSet or, as a
-     * fallback the parent Period.
-     *
-     * @return The MultipleSegmentBase object found.
-     */
-    const MultipleSegmentBase &getMultiSegmentBase() const;
-
 ///@endcond PROTECTED
 
 private:
+    void invalidateBaseURLs() const;
+    void invalidateAddressing() const;
+
     Period *m_period;                                              ///< The Period object this adaptation set is a child of
     std::unordered_set<const Representation*> m_selectedRepresentations; ///< An index to the set of selected Representation entries
 
@@ -2084,7 +2044,7 @@ private:
     std::optional<XLink>               m_xlink;                    ///< The XLink settings for AdaptationSet HTTP referencing
     std::optional<unsigned int>        m_id;                       ///< The AdaptationSet @@id number
     std::optional<unsigned int>        m_group;                    ///< The AdaptationSet @@group number
-    std::optional<std::string>         m_lang;                     ///< The language identifier
+    SharedValue<std::optional<std::string> > m_lang;               ///< The language identifier
     std::optional<RFC6838ContentType>  m_contentType;              ///< The content type
     std::optional<Ratio>               m_par;                      ///< The picture aspect ratio
     std::optional<unsigned int>        m_minBandwidth;             ///< The minimum bandwidth requirement
@@ -2099,7 +2059,7 @@ private:
     bool                               m_subsegmentAlignment;      ///< The subsegment alignment flag (default: false)
     SAP                                m_subsegmentStartsWithSAP;  ///< The subsegment start with SAP value (default: 0)
     std::optional<bool>                m_bitstreamSwitching;       ///< The bitstream switching flag
-    std::list<unsigned int>            m_initializationSetRefs;    ///< The array of Initialization Set identifiers
+    std::vector<unsigned int>          m_initializationSetRefs;    ///< The array of Initialization Set identifiers
     std::optional<URI>                 m_initializationPrincipal;  ///< The Initialization Segment URL
 
     // Period child elements (ISO 23009-1:2022 Clause 5.3.3.3)
@@ -2109,6 +2069,7 @@ private:
     std::list<Descriptor>          m_viewpoints;                   ///< Viewpoint descriptors
     std::list<ContentComponent>    m_contentComponents;            ///< ContentComponent entries
     std::list<BaseURL>             m_baseURLs;                     ///< BaseURL entries
+    mutable BaseURLCache           m_baseURLCache;                 ///< Resolved BaseURLs from getBaseURLs()
     std::optional<SegmentBase>     m_segmentBase;                  ///< The SegmentBase entry
     std::optional<SegmentList>     m_segmentList;                  ///< The SegmentList entry
     std::optional<SegmentTemplate> m_segmentTemplate;              ///< The SegmentTemplate entry
@@ -10,7 +10,10 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <atomic>
 #include <chrono>
+#include <list>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -299,6 +302,8 @@ protected:
     friend class Period;
     friend class Representation;
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
 
     /** Constructor from libxml++ Node
      *
@@ -327,6 +332,83 @@ private:
     bool                         m_rangeAccess;              ///< The @@rangeAccess attribute value (default: false)
 };
 
+/**@cond PROTECTED
+ */
+/* Generation count for the caches of one MPD tree
+ *
+ * Anything which may change a cached value in an MPD tree calls invalidate() on the generation for that tree, and cached values from
+ * an earlier generation are rebuilt the next time they are used. Each MPD holds its own generations, so changes to one MPD leave the
+ * caches of other MPDs alone. Nodes which are not part of an MPD share the detached() generation.
+ *
+ * Every value is taken from a single process wide sequence, so no two generations ever have the same value. This means that a node
+ * moved to a different tree will not mistake the generation of its new tree for the one its cache was built for.
+ */
+class LIBMPDPP_PUBLIC_API CacheGeneration {
+public:
+    CacheGeneration() :m_value(next()) {};
+    CacheGeneration(const CacheGeneration&) :m_value(next()) {};
+    CacheGeneration &operator=(const CacheGeneration&) { invalidate(); return *this; };
+
+    unsigned long value() const { return m_value.load(std::memory_order_acquire); };
+
+    // Mark all values cached against this generation as out of date
+    void invalidate() { m_value.store(next(), std::memory_order_release); };
+
+    // Generation for nodes which are not in an MPD
+    static CacheGeneration &detached();
+
+private:
+    static unsigned long next() { return s_next.fetch_add(1, std::memory_order_acq_rel); };
+
+    static std::atomic<unsigned long> s_next; // starts at 1, a cache generation of 0 is an empty cache
+    std::atomic<unsigned long> m_value;
+};
+
+/* Cache of the resolved BaseURLs for an MPD, Period, AdaptationSet or Representation
+ *
+ * The resolved BaseURLs of a node depend on the BaseURLs of all its ancestors. Rather than tracking the descendants of every
+ * node, anything which may change the resolved BaseURLs in an MPD invalidates the BaseURL CacheGeneration of that MPD, and cached
+ * lists from an earlier generation are rebuilt the next time they are used. Copies of a cache start empty as the copied node may
+ * have a different parent.
+ *
+ * get() may be called from several threads at once. Rebuilds are serialised by a per-cache mutex, and the cached list is only
+ * replaced if the resolved BaseURLs have actually changed, so a change elsewhere in the MPD in another thread does not free a list
+ * still in use.
+ */
+class LIBMPDPP_PUBLIC_API BaseURLCache {
+public:
+    BaseURLCache() :m_generation(0), m_mutex(), m_baseURLs() {};
+    BaseURLCache(const BaseURLCache&) :m_generation(0), m_mutex(), m_baseURLs() {};
+    BaseURLCache &operator=(const BaseURLCache&) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation.store(0, std::memory_order_release);
+        m_baseURLs.reset();
+        return *this;
+    };
+
+    // Get the cached BaseURLs, calling resolve() to build the list if the cache is empty or older than tree_generation
+    template <typename Resolver>
+    const std::list<BaseURL> &get(const CacheGeneration &tree_generation, Resolver &&resolve) {
+        auto generation = tree_generation.value();
+        if (m_generation.load(std::memory_order_acquire) != generation) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_generation.load(std::memory_order_relaxed) != generation) {
+                std::list<BaseURL> resolved(resolve());
+                if (!m_baseURLs || m_baseURLs.value() != resolved) m_baseURLs = std::move(resolved);
+                m_generation.store(generation, std::memory_order_release);
+            }
+        }
+        return m_baseURLs.value();
+    };
+
+private:
+    std::atomic<unsigned long> m_generation;
+    std::mutex m_mutex;
+    std::optional<std::list<BaseURL> > m_baseURLs;
+};
+/**@endcond
+ */
+
 LIBMPDPP_NAMESPACE_END
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
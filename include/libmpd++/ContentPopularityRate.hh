@@ -227,6 +227,8 @@ public:
     ///@cond PROTECTED
     protected:
         friend class ContentPopularityRate;
+        friend class SnapshotReader;
+        friend class SnapshotWriter;
         PR(xmlpp::Node &node);
         void setXMLElement(xmlpp::Element &elem) const;
     ///@endcond PROTECTED
@@ -370,6 +372,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class RepresentationBase;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
 
     /**
      * XML constructor (internal use only)
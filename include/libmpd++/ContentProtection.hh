@@ -15,6 +15,7 @@
 
 #include "macros.hh"
 #include "Descriptor.hh"
+#include "SharedValue.hh"
 
 /**@cond
  */
@@ -131,6 +132,9 @@ protected:
     friend class MPD;
     friend class Period;
     friend class RepresentationBase;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
 
      /**
      * XML constructor (internal use only)
@@ -152,7 +156,7 @@ protected:
 ///@endcond PROTECTED
 
 private:
-    std::optional<std::string> m_robustness; // string with no whitespace
+    SharedValue<std::optional<std::string> > m_robustness; // string with no whitespace
     std::optional<std::string> m_refId;      // xs:ID type
     std::optional<std::string> m_ref;        // xs:IDREF type
 };
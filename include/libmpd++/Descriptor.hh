@@ -236,6 +236,9 @@ protected:
     friend class Period;
     friend class Representation;
     friend class RepresentationBase;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
 
     /**
      * XML constructor (internal use only)
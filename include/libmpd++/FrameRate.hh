@@ -179,6 +179,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     // Construct from an XML node; extracts the text content and converts.
     FrameRate(xmlpp::Node &node);
 
@@ -69,6 +69,8 @@ public:
 protected:
     friend class Period;
     friend class RepresentationBase;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     Label(xmlpp::Node &node);
     void setXMLElement(xmlpp::Element &elem) const;
 ///@endcond PROTECTED
@@ -10,10 +10,15 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -24,7 +29,9 @@
 #include "Descriptor.hh"
 #include "InitializationSet.hh"
 #include "LeapSecondInformation.hh"
+#include "MemoryResource.hh"
 #include "Metrics.hh"
+#include "ParseFilter.hh"
 #include "PatchLocation.hh"
 #include "Period.hh"
 #include "ProgramInformation.hh"
@@ -33,8 +40,26 @@
 #include "UIntVWithID.hh"
 #include "URI.hh"
 
+/**@cond
+ */
+// Forward declarations for types only used by pointer or reference
+namespace xmlpp {
+    class Document;
+    class Element;
+    class Node;
+}
+/**@endcond
+ */
+
 LIBMPDPP_NAMESPACE_BEGIN
 
+/**@cond
+ */
+class SnapshotReader;
+class StringPool;
+/**@endcond
+ */
+
 /** MPD class
  * @headerfile libmpd++/MPD.hh <libmpd++/MPD.hh>
  *
@@ -58,6 +83,184 @@ public:
         DYNAMIC  ///< Presentation is dynamic (can change during playback, e.g. live stream)
     };
 
+    /** XML parser backend selection
+     *
+     * Selects how the MPD XML is read when constructing an MPD from a stream, memory block or file. Both backends produce
+     * identical MPD objects, they only differ in how much of the XML document is held in memory at once.
+     */
+    enum ParserBackend {
+        PARSER_DOM,      ///< Parse the whole document into a DOM tree before extracting the MPD (default)
+        PARSER_STREAMING ///< Stream the document through an XML text reader, only expanding one MPD child element at a time
+    };
+
+    /** Options for parsing MPD XML
+     *
+     * Collects the settings that control how the MPD XML is parsed when using the parsing constructors which take a ParseOptions
+     * parameter. The default options give the same result as the other parsing constructors with their default parameters.
+     */
+    class ParseOptions {
+    public:
+        /** Default constructor
+         *
+         * Options are PARSER_DOM, serial Period parsing, Periods are parsed in full, no string pool is used, storage is
+         * allocated from the current MemoryResourceScope and all elements are parsed.
+         */
+        ParseOptions() :m_parserBackend(PARSER_DOM), m_periodParseThreads(1), m_lazyPeriods(false), m_stringPool()
+                       , m_memoryResource(nullptr), m_parseFilter() {};
+
+        /**@{*/
+        /** The XML parser backend
+         *
+         * @see MPD::ParserBackend
+         */
+        ParserBackend parserBackend() const { return m_parserBackend; };
+        ParseOptions &parserBackend(ParserBackend parser_backend) { m_parserBackend = parser_backend; return *this; };
+        /**@}*/
+
+        /**@{*/
+        /** The number of threads to use when parsing Period elements
+         *
+         * A value of 1 parses the Periods serially in the calling thread, 0 will use as many threads as there are hardware
+         * threads. This setting has no effect if lazyPeriods() is set.
+         */
+        unsigned int periodParseThreads() const { return m_periodParseThreads; };
+        ParseOptions &periodParseThreads(unsigned int threads) { m_periodParseThreads = threads; return *this; };
+        /**@}*/
+
+        /**@{*/
+        /** Lazy Period parsing
+         *
+         * When set, only the Period attributes (such as \@id, \@start and \@duration) are parsed when the MPD is constructed.
+         * The XML for the rest of each Period is kept and only parsed the first time its child elements are accessed, or a
+         * selection or query touches that Period. Any errors in the Period child elements are reported by throwing from the
+         * accessor that caused the parse.
+         *
+         * @see Period::isMaterialised()
+         */
+        bool lazyPeriods() const { return m_lazyPeriods; };
+        ParseOptions &lazyPeriods(bool lazy) { m_lazyPeriods = lazy; return *this; };
+        /**@}*/
+
+        /**@{*/
+        /** The string pool to intern parsed values in
+         *
+         * When set, the repeated attribute values of the parsed MPD are shared with any other MPD using the same StringPool. The
+         * pool is kept by the MPD and is also used for Periods materialised later and by MPD::refresh().
+         *
+         * @see StringPool
+         */
+        const std::shared_ptr<StringPool> &stringPool() const { return m_stringPool; };
+        ParseOptions &stringPool(const std::shared_ptr<StringPool> &pool) { m_stringPool = pool; return *this; };
+        /**@}*/
+
+        /**@{*/
+        /** The memory resource to allocate the MPD tree storage from
+         *
+         * When set, the SegmentTimeline S entries and the internal caches are allocated from this resource while parsing,
+         * including in the Period parsing threads, when materialising lazily parsed Periods, when refreshing the MPD and when
+         * applying an MPD Patch. This allows an arena, such as a `std::pmr::monotonic_buffer_resource`, to hold the bulk of a
+         * live MPD and be released in one operation after the MPD is destroyed. The other MPD tree objects, their container
+         * nodes and strings are still allocated from the global heap.
+         *
+         * The resource must outlive the MPD. If Periods are parsed using several threads, or Periods are materialised from more
+         * than one thread, then the resource must be thread-safe (for example a `std::pmr::synchronized_pool_resource`). Storage
+         * released by refresh() is returned to the resource, so a monotonic resource will grow with each refresh.
+         *
+         * If this is `nullptr` then the resource from the MemoryResourceScope in effect when parsing is used.
+         *
+         * @see MemoryResourceScope
+         */
+        std::pmr::memory_resource *memoryResource() const { return m_memoryResource; };
+        ParseOptions &memoryResource(std::pmr::memory_resource *resource) { m_memoryResource = resource; return *this; };
+        /**@}*/
+
+        /**@{*/
+        /** The filter for elements to skip while parsing
+         *
+         * When set, the elements and AdaptationSets selected by the filter are skipped without creating any objects for them.
+         * The filter is kept by the MPD and is also used for Periods materialised later and by MPD::refresh(). Setting the
+         * filter from a ParseFilter value takes a copy of it.
+         *
+         * @see ParseFilter
+         */
+        const std::shared_ptr<const ParseFilter> &parseFilter() const { return m_parseFilter; };
+        ParseOptions &parseFilter(const std::shared_ptr<const ParseFilter> &filter) { m_parseFilter = filter; return *this; };
+        ParseOptions &parseFilter(const ParseFilter &filter) {
+            m_parseFilter = std::make_shared<const ParseFilter>(filter); return *this;
+        };
+        /**@}*/
+
+    private:
+        ParserBackend m_parserBackend;
+        unsigned int m_periodParseThreads;
+        bool m_lazyPeriods;
+        std::shared_ptr<StringPool> m_stringPool;
+        std::pmr::memory_resource *m_memoryResource;
+        std::shared_ptr<const ParseFilter> m_parseFilter;
+    };
+
+    /** A change made by MPD::refresh()
+     *
+     * Identifies an element that was added, removed or updated when an MPD was refreshed from a newer version of the same
+     * presentation.
+     */
+    class RefreshChange {
+    public:
+        /** The kind of change
+         */
+        enum ChangeType {
+            ADDED,   ///< The element is new in the refreshed MPD
+            REMOVED, ///< The element is no longer in the refreshed MPD
+            UPDATED  ///< The element attributes or child elements (other than the child elements tracked separately) changed
+        };
+
+        /** The element that changed
+         */
+        enum ElementType {
+            MPD_ELEMENT,            ///< The MPD attributes or child elements other than Period
+            PERIOD_ELEMENT,         ///< A Period, excluding its AdaptationSet and EmptyAdaptationSet children
+            ADAPTATION_SET_ELEMENT, ///< An AdaptationSet or EmptyAdaptationSet, excluding its Representation children
+            REPRESENTATION_ELEMENT  ///< A Representation
+        };
+
+        /** Constructor
+         *
+         * @param change_type The kind of change.
+         * @param element_type The element type that changed.
+         * @param period_id The \@id of the Period the change is in, if any.
+         * @param adaptation_set_id The \@id of the AdaptationSet the change is in, if any.
+         * @param representation_id The \@id of the Representation that changed, if any.
+         */
+        RefreshChange(ChangeType change_type, ElementType element_type,
+                      const std::optional<std::string> &period_id = std::nullopt,
+                      const std::optional<unsigned int> &adaptation_set_id = std::nullopt,
+                      const std::optional<std::string> &representation_id = std::nullopt)
+            :m_changeType(change_type)
+            ,m_elementType(element_type)
+            ,m_periodId(period_id)
+            ,m_adaptationSetId(adaptation_set_id)
+            ,m_representationId(representation_id)
+        {};
+
+        bool operator==(const RefreshChange &other) const {
+            return m_changeType == other.m_changeType && m_elementType == other.m_elementType && m_periodId == other.m_periodId &&
+                   m_adaptationSetId == other.m_adaptationSetId && m_representationId == other.m_representationId;
+        };
+
+        ChangeType changeType() const { return m_changeType; };
+        ElementType elementType() const { return m_elementType; };
+        const std::optional<std::string> &periodId() const { return m_periodId; };
+        const std::optional<unsigned int> &adaptationSetId() const { return m_adaptationSetId; };
+        const std::optional<std::string> &representationId() const { return m_representationId; };
+
+    private:
+        ChangeType m_changeType;
+        ElementType m_elementType;
+        std::optional<std::string> m_periodId;
+        std::optional<unsigned int> m_adaptationSetId;
+        std::optional<std::string> m_representationId;
+    };
+
     /** Default constructor
      * 
      * This is removed to force mandatory parameters in the MPD to be filled in.
@@ -83,25 +286,77 @@ public:
      *
      * @param input_stream The stream to parse the MPD XML from.
      * @param mpd_location The URL the MPD was obtained from.
+     * @param parser_backend The XML parser backend to use, defaults to MPD::PARSER_DOM.
+     * @param period_parse_threads The number of threads to use when parsing Period elements. The default of 1 parses the Periods
+     *                             serially in the calling thread, 0 will use as many threads as there are hardware threads.
+     */
+    MPD(std::istream &input_stream, const std::optional<URI> &mpd_location = std::nullopt,
+        ParserBackend parser_backend = PARSER_DOM, unsigned int period_parse_threads = 1);
+
+    /** Construct from an input stream with parsing options
+     *
+     * @param input_stream The stream to parse the MPD XML from.
+     * @param mpd_location The URL the MPD was obtained from.
+     * @param options The options to use while parsing.
      */
-    MPD(std::istream &input_stream, const std::optional<URI> &mpd_location = std::nullopt);
+    MPD(std::istream &input_stream, const std::optional<URI> &mpd_location, const ParseOptions &options);
 
     /**@{*/
     /** Construct from MPD XML in memory
      *
      * @param mpd_xml The vector containing the MPD XML.
      * @param mpd_location The URL the MPD was obtained from.
+     * @param parser_backend The XML parser backend to use, defaults to MPD::PARSER_DOM.
+     * @param period_parse_threads The number of threads to use when parsing Period elements. The default of 1 parses the Periods
+     *                             serially in the calling thread, 0 will use as many threads as there are hardware threads.
      */
-    MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_location = std::nullopt);
-    MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mpd_location = std::nullopt);
+    MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_location = std::nullopt,
+        ParserBackend parser_backend = PARSER_DOM, unsigned int period_parse_threads = 1);
+    MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mpd_location = std::nullopt,
+        ParserBackend parser_backend = PARSER_DOM, unsigned int period_parse_threads = 1);
+    /**@}*/
+
+    /**@{*/
+    /** Construct from MPD XML in memory with parsing options
+     *
+     * @param mpd_xml The vector containing the MPD XML.
+     * @param mpd_location The URL the MPD was obtained from.
+     * @param options The options to use while parsing.
+     */
+    MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_location, const ParseOptions &options);
+    MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mpd_location, const ParseOptions &options);
     /**@}*/
 
     /** Construct from an MPD XML file
+     *
+     * Where the platform supports it, regular files are memory mapped and handed to libxml2 as an in-memory document, which
+     * avoids reading the file into a growing read buffer. Depending on the libxml2 version, libxml2 may still copy the mapped
+     * contents into its own input buffer. Other files, such as named pipes or character devices, are read through the normal
+     * file reading path.
+     *
+     * A mapped file must not be modified in place while it is being parsed. Truncating it can terminate the process with
+     * SIGBUS, and a change to its size or modification time during parsing causes a ParseError to be thrown. To update a
+     * manifest that may be parsed at the same time, write the new version to a temporary file and rename it over the old one.
+     *
+     * @param filename The file path of the MPD XML file.
+     * @param mpd_location The URL the MPD was obtained from.
+     * @param parser_backend The XML parser backend to use, defaults to MPD::PARSER_DOM.
+     * @param period_parse_threads The number of threads to use when parsing Period elements. The default of 1 parses the Periods
+     *                             serially in the calling thread, 0 will use as many threads as there are hardware threads.
+     */
+    MPD(const std::string &filename, const std::optional<URI> &mpd_location = std::nullopt,
+        ParserBackend parser_backend = PARSER_DOM, unsigned int period_parse_threads = 1);
+
+    /** Construct from an MPD XML file with parsing options
+     *
+     * Regular files are memory mapped in the same way as for MPD(const std::string&, const std::optional<URI>&, ParserBackend,
+     * unsigned int) and the same restrictions on modifying the file while it is being parsed apply.
      *
      * @param filename The file path of the MPD XML file.
      * @param mpd_location The URL the MPD was obtained from.
+     * @param options The options to use while parsing.
      */
-    MPD(const std::string &filename, const std::optional<URI> &mpd_location = std::nullopt);
+    MPD(const std::string &filename, const std::optional<URI> &mpd_location, const ParseOptions &options);
 
     /** Copy constructor
      * 
@@ -153,10 +408,14 @@ public:
      * an MPD::MPD() constructor.
      *
      * @return `true` if a source URL has been set, otherwise `false`.
-     * @see MPD::MPD(std::istream&, const std::optional<URI>&)
-     * @see MPD::MPD(const std::vector<char>&, const std::optional<URI>&)
-     * @see MPD::MPD(const std::vector<unsigned char>&, const std::optional<URI>&)
-     * @see MPD::MPD(const std::string&, const std::optional<URI>&)
+     * @see MPD::MPD(std::istream&, const std::optional<URI>&, ParserBackend, unsigned int)
+     * @see MPD::MPD(const std::vector<char>&, const std::optional<URI>&, ParserBackend, unsigned int)
+     * @see MPD::MPD(const std::vector<unsigned char>&, const std::optional<URI>&, ParserBackend, unsigned int)
+     * @see MPD::MPD(const std::string&, const std::optional<URI>&, ParserBackend, unsigned int)
+     * @see MPD::MPD(std::istream&, const std::optional<URI>&, const ParseOptions&)
+     * @see MPD::MPD(const std::vector<char>&, const std::optional<URI>&, const ParseOptions&)
+     * @see MPD::MPD(const std::vector<unsigned char>&, const std::optional<URI>&, const ParseOptions&)
+     * @see MPD::MPD(const std::string&, const std::optional<URI>&, const ParseOptions&)
      * @see MPD::sourceURL(const std::nullopt_t&)
      * @see MPD::sourceURL(const URI&)
      * @see MPD::sourceURL(URI&&)
@@ -177,19 +436,50 @@ public:
      *
      * @return This MPD.
      */
-    MPD &sourceURL(const std::nullopt_t &) { m_mpdURL.reset(); return *this; };
+    MPD &sourceURL(const std::nullopt_t &) { m_mpdURL.reset(); invalidateBaseURLs(); return *this; };
 
     /**@{*/
     /** Set the source URL
      *
      * @param url The URL to set as the source URL for this MPD.
      */
-    MPD &sourceURL(const URI &url) { m_mpdURL = url; return *this; };
-    MPD &sourceURL(URI &&url) { m_mpdURL = std::move(url); return *this; };
-    MPD &sourceURL(const std::optional<URI> &url) { m_mpdURL = url; return *this; };
-    MPD &sourceURL(std::optional<URI> &&url) { m_mpdURL = std::move(url); return *this; };
+    MPD &sourceURL(const URI &url) { m_mpdURL = url; invalidateBaseURLs(); return *this; };
+    MPD &sourceURL(URI &&url) { m_mpdURL = std::move(url); invalidateBaseURLs(); return *this; };
+    MPD &sourceURL(const std::optional<URI> &url) { m_mpdURL = url; invalidateBaseURLs(); return *this; };
+    MPD &sourceURL(std::optional<URI> &&url) { m_mpdURL = std::move(url); invalidateBaseURLs(); return *this; };
     /**@}*/
 
+    /** Get the string pool
+     *
+     * @return The StringPool used to intern the values of this MPD, or an empty pointer if no pool is used.
+     * @see ParseOptions::stringPool()
+     */
+    const std::shared_ptr<StringPool> &stringPool() const { return m_stringPool; };
+
+    /** Set the string pool
+     *
+     * Interns the current values of this MPD in @p pool and uses @p pool for any Periods materialised later or for refreshing
+     * this MPD.
+     *
+     * @param pool The StringPool to use, or an empty pointer to stop using a pool.
+     * @return This MPD.
+     */
+    MPD &stringPool(const std::shared_ptr<StringPool> &pool);
+
+    /** Get the memory resource
+     *
+     * @return The memory resource given in the ParseOptions used to parse this MPD, or `nullptr` if none was given.
+     * @see ParseOptions::memoryResource()
+     */
+    std::pmr::memory_resource *memoryResource() const { return m_memoryResource; };
+
+    /** Get the parse filter
+     *
+     * @return The ParseFilter given in the ParseOptions used to parse this MPD, or an empty pointer if the MPD was not filtered.
+     * @see ParseOptions::parseFilter()
+     */
+    const std::shared_ptr<const ParseFilter> &parseFilter() const { return m_parseFilter; };
+
     /** Check if this is a live MPD
      *
      * Check if this is a live or on-demand MPD by checking the @@presentationType and @@profiles attributes.
@@ -245,28 +535,27 @@ public:
     MPD &id(std::string &&val) { m_id = std::move(val); return *this; };
     MPD &id(const std::nullopt_t&) { m_id.reset(); return *this; };
 
-    const std::list<URI> &profiles() const { return m_profiles; };
-    std::list<URI>::const_iterator profilesBegin() const { return m_profiles.cbegin(); };
-    std::list<URI>::const_iterator profilesEnd() const { return m_profiles.cend(); };
-    std::list<URI>::iterator profilesBegin() { return m_profiles.begin(); };
-    std::list<URI>::iterator profilesEnd() { return m_profiles.end(); };
-    const URI &profile(std::list<URI>::size_type idx) const {
+    std::span<const URI> profiles() const { return m_profiles; };
+    std::span<const URI>::iterator profilesBegin() const { return profiles().begin(); };
+    std::span<const URI>::iterator profilesEnd() const { return profiles().end(); };
+    std::span<URI>::iterator profilesBegin() { return std::span<URI>(m_profiles).begin(); };
+    std::span<URI>::iterator profilesEnd() { return std::span<URI>(m_profiles).end(); };
+    const URI &profile(std::vector<URI>::size_type idx) const {
         if (idx >= m_profiles.size())
             throw std::out_of_range("MPD profile does not exist");
-        auto it = m_profiles.cbegin();
-        while (idx > 0 && it != m_profiles.cend()) {it++; idx--;}
-        return *it;
+        return m_profiles[idx];
     };
     bool profilesContain(const URI &uri) const;
     MPD &profileAdd(const URI &uri);
     MPD &profileAdd(URI &&uri);
-    MPD &profileRemove(const std::list<URI>::const_iterator &it);
+    MPD &profileRemove(const std::span<const URI>::iterator &it);
+    MPD &profileRemove(const std::span<URI>::iterator &it);
     MPD &profileRemove(const URI &uri);
 
     bool isStaticPresentation() const { return m_type == STATIC; };
     bool isDynamicPresentation() const { return m_type == DYNAMIC; };
     PresentationType presentationType() const { return m_type; };
-    MPD &presentationType(PresentationType pres_type) { m_type = pres_type; return *this; };
+    MPD &presentationType(PresentationType pres_type) { m_type = pres_type; cachePeriodTimesClear(); return *this; };
 
     bool hasAvailabilityStartTime() const { return m_availabilityStartTime.has_value(); };
     const time_type &availabilityStartTime(const time_type &default_val) const;
@@ -292,9 +581,9 @@ public:
     bool hasMediaPresentationDuration() const { return m_mediaPresentationDuration.has_value(); };
     const duration_type &mediaPresentationDuration(const duration_type &default_val) const;
     const std::optional<duration_type> &mediaPresentationDuration() const { return m_mediaPresentationDuration; };
-    MPD &mediaPresentationDuration(const duration_type &val) { m_mediaPresentationDuration = val; return *this; };
-    MPD &mediaPresentationDuration(duration_type &&val) { m_mediaPresentationDuration = std::move(val); return *this; };
-    MPD &mediaPresentationDuration(const std::nullopt_t&) { m_mediaPresentationDuration.reset(); return *this; };
+    MPD &mediaPresentationDuration(const duration_type &val) { m_mediaPresentationDuration = val; cachePeriodTimesClear(); return *this; };
+    MPD &mediaPresentationDuration(duration_type &&val) { m_mediaPresentationDuration = std::move(val); cachePeriodTimesClear(); return *this; };
+    MPD &mediaPresentationDuration(const std::nullopt_t&) { m_mediaPresentationDuration.reset(); cachePeriodTimesClear(); return *this; };
 
     bool hasMinimumUpdatePeriod() const { return m_minimumUpdatePeriod.has_value(); };
     const duration_type &minimumUpdatePeriod(const duration_type &default_val) const;
@@ -349,8 +638,8 @@ public:
     const std::list<BaseURL> &baseURLs() const { return m_baseURLs; };
     std::list<BaseURL>::const_iterator baseURLsBegin() const { return m_baseURLs.cbegin(); };
     std::list<BaseURL>::const_iterator baseURLsEnd() const { return m_baseURLs.cend(); };
-    std::list<BaseURL>::iterator baseURLsBegin() { return m_baseURLs.begin(); };
-    std::list<BaseURL>::iterator baseURLsEnd() { return m_baseURLs.end(); };
+    std::list<BaseURL>::iterator baseURLsBegin() { invalidateBaseURLs(); return m_baseURLs.begin(); };
+    std::list<BaseURL>::iterator baseURLsEnd() { invalidateBaseURLs(); return m_baseURLs.end(); };
     MPD &baseURLAdd(const BaseURL &base_url);
     MPD &baseURLAdd(BaseURL &&base_url);
     MPD &baseURLRemove(const BaseURL &base_url);
@@ -366,9 +655,11 @@ public:
      * If there are no BaseURLs set, then the return value is copied from the source %URL. If a source URL has been set then a
      * single entry is returned with the source %URL in it, otherwise an empty list is returned.
      *
+     * The resolved list is cached, the reference remains valid until the BaseURLs or source %URL of this MPD are changed.
+     *
      * @return The list of BaseURL values applicable at the MPD level.
      */
-    std::list<BaseURL> getBaseURLs() const;
+    const std::list<BaseURL> &getBaseURLs() const;
 
     const std::list<URI> &locations() const { return m_locations; };
     std::list<URI>::const_iterator locationsBegin() const { return m_locations.cbegin(); };
@@ -449,6 +740,18 @@ public:
 
     const std::list<Period> &periods() const { return m_periods; };
     std::list<Period>::const_iterator period(const std::string &id) const;
+
+    /** Find the Period for a presentation time
+     *
+     * The Period start times and durations are calculated for all Periods once and kept in a sorted index, so this is a binary
+     * search over the Periods rather than a scan.
+     *
+     * @param pres_time The presentation time to find the Period for. This is relative to the availabilityStartTime or, for
+     *                  an MPD without an availabilityStartTime, relative to the epoch.
+     * @return The Period which contains @p pres_time, or periodsEnd() if @p pres_time is not within a Period.
+     */
+    std::list<Period>::const_iterator period(const time_type &pres_time) const;
+
     std::list<Period>::const_iterator periodsBegin() const {return m_periods.cbegin(); };
     std::list<Period>::const_iterator periodsEnd() const {return m_periods.cend(); };
     std::list<Period>::iterator period(const std::string &id);
@@ -524,6 +827,93 @@ public:
      */
     void deselectAllRepresentations();
 
+    /**@{*/
+    /** Refresh this MPD from a newer version of the MPD
+     *
+     * The updated MPD is matched against this MPD using Period\@id, AdaptationSet\@id and Representation\@id (Periods and
+     * AdaptationSets without an \@id are matched by their position amongst the others without an \@id). Objects which have not
+     * changed are left untouched, so any references to them, their selection state and their cached values remain valid.
+     * Changed objects are updated in place, new objects are added and objects no longer present are removed. The Periods,
+     * AdaptationSets and Representations end up in the order they appear in the updated MPD.
+     *
+     * The source URL of this MPD is kept and is used as the location of the updated MPD XML.
+     *
+     * @param updated_mpd The newer version of this MPD. This will be left in a valid but unspecified state.
+     * @param mpd_xml The XML for the newer version of this MPD.
+     * @param input_stream The stream to read the XML for the newer version of this MPD from.
+     * @param options The options to use when parsing the updated MPD XML.
+     * @return The list of changes made to this MPD, an empty list means nothing changed.
+     * @throw ParseError If the updated MPD XML cannot be parsed, this MPD is left unchanged.
+     */
+    std::list<RefreshChange> refresh(MPD &&updated_mpd);
+    std::list<RefreshChange> refresh(const std::vector<char> &mpd_xml, const ParseOptions &options = ParseOptions());
+    std::list<RefreshChange> refresh(const std::vector<unsigned char> &mpd_xml, const ParseOptions &options = ParseOptions());
+    std::list<RefreshChange> refresh(std::istream &input_stream, const ParseOptions &options = ParseOptions());
+    /**@}*/
+
+    /**@{*/
+    /** Apply an MPD Patch to this MPD
+     *
+     * Applies the operations in an MPD Patch document (ISO 23009-1:2022 Clause 5.15), as fetched from a PatchLocation, directly
+     * to this MPD. The Patch\@mpdId must match the MPD\@id, the Patch\@originalPublishTime must match the MPD\@publishTime and
+     * the Patch\@publishTime must be later than the Patch\@originalPublishTime. Once applied the MPD\@publishTime is set to the
+     * Patch\@publishTime.
+     *
+     * The selectors in the patch operations are resolved against the Period, AdaptationSet and Representation objects of this MPD
+     * so that adding, replacing or removing these elements only affects those objects, and objects not targetted by the patch
+     * remain untouched and keep their selection state. Period, AdaptationSet and Representation elements can be selected by
+     * \@id or position in selectors. Operations on other elements and attributes only regenerate the nearest enclosing MPD,
+     * Period, AdaptationSet or Representation attributes and child elements, excluding any Periods, AdaptationSets and
+     * Representations it contains.
+     *
+     * The mpdId and publish times are checked before any changes are made. If a later operation cannot be applied then a
+     * PatchError is thrown and this MPD may have been partially patched, in which case the full MPD should be fetched again.
+     *
+     * @param patch_xml The MPD Patch XML document.
+     * @param input_stream The stream to read the MPD Patch XML document from.
+     * @return This MPD.
+     * @throw ParseError If the MPD Patch document is malformed or uses selectors that are not supported.
+     * @throw PatchError If the MPD Patch does not apply to this MPD.
+     * @see patchLocations()
+     */
+    MPD &applyPatch(const std::vector<char> &patch_xml);
+    MPD &applyPatch(const std::vector<unsigned char> &patch_xml);
+    MPD &applyPatch(std::istream &input_stream);
+    /**@}*/
+
+    /**@{*/
+    /** Save a binary snapshot of this MPD
+     *
+     * Writes this MPD, including all Periods, AdaptationSets and Representations and the current Representation selections, in a
+     * compact versioned binary format which can be loaded again with loadSnapshot() much faster than the MPD XML can be parsed.
+     * This is intended for caching an MPD between runs of an application, the snapshot format may change between library
+     * versions so snapshots should not be used for long term storage or interchange, use the MPD XML for that.
+     *
+     * Any lazily parsed Periods will be parsed in order to write the snapshot.
+     *
+     * @param output_stream The stream to write the snapshot to.
+     * @return The snapshot data.
+     * @see loadSnapshot()
+     */
+    void saveSnapshot(std::ostream &output_stream) const;
+    std::vector<unsigned char> saveSnapshot() const;
+    /**@}*/
+
+    /**@{*/
+    /** Load an MPD from a binary snapshot
+     *
+     * Recreates an MPD saved using saveSnapshot(). No XML parsing is done, the objects are read directly from the snapshot.
+     *
+     * @param snapshot The snapshot data.
+     * @param input_stream The stream to read the snapshot data from.
+     * @return The MPD recreated from the snapshot.
+     * @throw ParseError If the snapshot is corrupt, truncated or was written using an incompatible snapshot format version.
+     * @see saveSnapshot()
+     */
+    static MPD loadSnapshot(const std::vector<unsigned char> &snapshot);
+    static MPD loadSnapshot(std::istream &input_stream);
+    /**@}*/
+
     /** Get the list of all selected Representation objects
      * 
      * @return The list of all currently selected @ref Representation "Representations" across all @ref Period "Periods".
@@ -559,19 +949,47 @@ protected:
     friend class Period;
     friend class AdaptationSet;
     friend class Representation;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
     time_type systemTimeToPresentationTime(const time_type &system_time) const; // Returns presentation time
     time_type presentationTimeToSystemTime(const time_type &pres_time) const; // Returns system wallclock time
+    static CacheGeneration &baseURLGeneration(const MPD *mpd); // BaseURL cache generation for a node in mpd, or a detached node
+    static CacheGeneration &addressingGeneration(const MPD *mpd); // Segment addressing generation for a node in mpd, or a detached node
 /** @endcond PROTECTED
  */
 
 private:
-    void extractMPD(void *doc);
+    class Patcher;
+
+    MPD(SnapshotReader &reader);
+
+    void extractMPD(void *doc, const ParseOptions &options);
+    void extractMPDStreaming(void *reader, const ParseOptions &options);
+    void extractMPDAttributes(xmlpp::Element &mpd_root);
+    void extractMPDChild(xmlpp::Element &child, std::vector<xmlpp::Node*> *deferred_periods = nullptr);
+    void extractMPDPeriods(const std::vector<xmlpp::Node*> &period_nodes, unsigned int threads);
+    void extractMPDLazyPeriods(const std::vector<std::shared_ptr<UnparsedElement> > &unparsed_periods);
+    void extractMPDFinish();
+    void setXMLElement(xmlpp::Element &elem) const;
+    void relinkPeriods(bool clear_calculated_times = true);
+    ParseOptions refreshParseOptions(const ParseOptions &options) const;
+    bool refreshPeriod(Period &period, Period &updated, std::list<RefreshChange> &changes);
+    void refreshAdaptationSets(Period &period, std::list<AdaptationSet> &adapt_sets, std::list<AdaptationSet> &&updated,
+                               std::list<RefreshChange> &changes);
+    void refreshAdaptationSet(AdaptationSet &adapt_set, AdaptationSet &updated, const std::optional<std::string> &period_id,
+                              std::list<RefreshChange> &changes);
     std::list<Period>::const_iterator getPeriodFor(const time_type &pres_time) const;
+    void cachePeriodTimes() const;
+    void cachePeriodTimesClear() const;
+    void cachePeriodTimesAppended() const;
+    bool cachePeriodTimesRemove(std::list<Period>::const_iterator period_it) const;
+    void invalidateBaseURLs() const { m_cache->baseURLGeneration.invalidate(); };
 
     // Derived from ISO 23009-1_2022
     // MPD attributes
     std::optional<std::string> m_id;
-    std::list<URI> m_profiles; // Must contain at least 1 entry
+    std::vector<URI> m_profiles; // Must contain at least 1 entry
     PresentationType m_type;
     std::optional<time_type> m_availabilityStartTime;
     std::optional<time_type> m_availabilityEndTime;
@@ -586,6 +1004,7 @@ private:
     // MPD elements
     std::list<ProgramInformation> m_programInformations;
     std::list<BaseURL> m_baseURLs;
+    mutable BaseURLCache m_baseURLCache; // Resolved BaseURLs from getBaseURLs()
     std::list<URI> m_locations;
     std::list<PatchLocation> m_patchLocations;
     std::list<ServiceDescription> m_serviceDescriptions;
@@ -603,11 +1022,30 @@ private:
     // MPD original location (if known)
     std::optional<URI> m_mpdURL;   ///< original location URL as given in the constructor or using the sourceURL() methods
 
+    // Pool used to intern values, from the ParseOptions or stringPool()
+    std::shared_ptr<StringPool> m_stringPool;
+
+    // Resource to allocate from when materialising Periods or refreshing, from the ParseOptions
+    std::pmr::memory_resource *m_memoryResource;
+
+    // Filter for elements to skip when materialising Periods or refreshing, from the ParseOptions
+    std::shared_ptr<const ParseFilter> m_parseFilter;
+
     // Cache values (can change, even in const object, hence the pointer)
-    struct Cache {
+    struct Cache : public TreeAllocated {
         Cache();
-        bool haveUtcTimingOffsetFromSystemClock;      // Indicate if we've fetched UTCTimings before now
-        duration_type utcTimingOffsetFromSystemClock; // Offset derived from UTCTiming or a default of 0s.
+        std::atomic<bool> haveUtcTimingOffsetFromSystemClock;      // Indicate if we've fetched UTCTimings before now
+        std::atomic<duration_type> utcTimingOffsetFromSystemClock; // Offset derived from UTCTiming or a default of 0s.
+        struct PeriodTimes {
+            duration_type start;                      // Calculated start of the Period
+            std::optional<duration_type> end;         // Calculated end of the Period or std::nullopt if open ended
+            std::list<Period>::const_iterator period;
+        };
+        std::mutex periodTimesMutex;                  // Held while calculating the Period times
+        std::atomic<bool> periodTimesValid;           // The Period calculated times and periodIndex are up to date
+        std::vector<PeriodTimes> periodIndex;         // Periods with a known start, sorted by start
+        CacheGeneration baseURLGeneration;            // Generation of the BaseURL caches in this MPD tree
+        CacheGeneration addressingGeneration;         // Generation of the Representation segment addressing in this MPD tree
     } *m_cache;
 };
 
@@ -0,0 +1,101 @@
+#ifndef _BBC_PARSE_DASH_MPD_MEMORY_RESOURCE_HH_
+#define _BBC_PARSE_DASH_MPD_MEMORY_RESOURCE_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: MemoryResourceScope class
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <cstddef>
+#include <memory_resource>
+
+#include "macros.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/** Memory resource scope
+ * @headerfile libmpd++/MemoryResource.hh <libmpd++/MemoryResource.hh>
+ *
+ * Selects the `std::pmr::memory_resource` that MPD tree storage is allocated from in the current thread for the lifetime of the
+ * scope object. Scopes can be nested, the previous resource is restored when a scope ends.
+ *
+ * Only the SegmentTimeline S entries and the internal MPD and Period caches are allocated from the resource. The Period,
+ * AdaptationSet and Representation objects, the nodes of the `std::list` containers holding them and the `std::string` values
+ * use the global heap, as these are part of the public API. The largest part of a live MPD is usually its SegmentTimelines.
+ *
+ * The scope only applies to the thread which created it. The MPD keeps the resource given by MPD::ParseOptions::memoryResource()
+ * and sets a scope for it whenever the library adds to the tree: while parsing (including in the Period parsing threads), when
+ * materialising lazily parsed Periods, in MPD::refresh() and in MPD::applyPatch(). Applications only need to create a scope to
+ * build or modify an MPD tree in a resource through the other setters, anything created outside of a scope uses the default
+ * resource.
+ *
+ * Storage allocated from a resource is returned to the same resource when the object is destroyed, so the resource must outlive
+ * all objects created while it was in scope. Copies of those objects made outside of the scope do not use the resource.
+ */
+class LIBMPDPP_PUBLIC_API MemoryResourceScope {
+public:
+    /** Constructor
+     *
+     * @param resource The memory resource to use in this thread until the scope ends. If this is `nullptr` then the current
+     *                 resource is left unchanged.
+     */
+    explicit MemoryResourceScope(std::pmr::memory_resource *resource);
+
+    MemoryResourceScope(const MemoryResourceScope&) = delete;
+    MemoryResourceScope &operator=(const MemoryResourceScope&) = delete;
+
+    /** Destructor
+     *
+     * Restores the memory resource that was in use when this scope was created.
+     */
+    ~MemoryResourceScope();
+
+    /** Get the current memory resource
+     *
+     * @return The memory resource for the innermost scope in this thread, or `std::pmr::get_default_resource()` if there is no
+     *         scope.
+     */
+    static std::pmr::memory_resource *current();
+
+private:
+    std::pmr::memory_resource *m_previous;
+};
+
+/**@cond
+ */
+/* Allocator for containers in the MPD tree
+ *
+ * Uses the resource from the MemoryResourceScope in effect when the container is constructed. Container copies take the resource
+ * in effect when the copy is made rather than the resource of the original.
+ */
+template <class T>
+class TreeAllocator : public std::pmr::polymorphic_allocator<T> {
+public:
+    TreeAllocator() noexcept :std::pmr::polymorphic_allocator<T>(MemoryResourceScope::current()) {};
+    TreeAllocator(std::pmr::memory_resource *resource) noexcept :std::pmr::polymorphic_allocator<T>(resource) {};
+    template <class U>
+    TreeAllocator(const TreeAllocator<U> &other) noexcept :std::pmr::polymorphic_allocator<T>(other.resource()) {};
+
+    TreeAllocator select_on_container_copy_construction() const { return TreeAllocator(); };
+};
+
+/* Base class for objects allocated with new, such as the Cache structures
+ *
+ * Allocates from the current MemoryResourceScope and remembers the resource so that delete returns the storage to it.
+ */
+struct LIBMPDPP_PUBLIC_API TreeAllocated {
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size);
+};
+/**@endcond
+ */
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_MEMORY_RESOURCE_HH_*/
@@ -84,9 +84,18 @@ public:
     MultipleSegmentBase &bitstreamSwitching(const URL &val) { m_bitstreamSwitching = val; return *this; };
     MultipleSegmentBase &bitstreamSwitching(URL &&val) { m_bitstreamSwitching = std::move(val); return *this; };
 
+    /* Segment addressing
+     *
+     * Segment numbers count from 0 for the first segment in the Period, i.e. the segment with the @startNumber. These use the
+     * SegmentTimeline if there is one, otherwise @duration, and take @presentationTimeOffset into account.
+     */
+
     // Get time offset of a segment from Period start in the current timescale
     unsigned long segmentNumberToTime(unsigned long segment_number) const;
 
+    // Get the media time of a segment in the current timescale, i.e. the offset from Period start plus @presentationTimeOffset
+    unsigned long segmentNumberToMediaTime(unsigned long segment_number) const;
+
     // Get wallclock duration of a segment from Period start
     duration_type segmentNumberToDurationType(unsigned long segment_number) const;
 
@@ -96,10 +105,19 @@ public:
     // Get segment number that contains the wallclock duration since Period start
     unsigned long durationTypeToSegmentNumber(const duration_type &offset) const;
 
+    // Get the number of segments in a Period of period_duration, std::nullopt if the number of segments is unbounded
+    std::optional<unsigned long> segmentCount(const std::optional<duration_type> &period_duration = std::nullopt) const;
+
+    // Get the wallclock duration of a segment
+    duration_type segmentDurationAsDurationType(unsigned long segment_number) const;
+
 ///@cond PROTECTED
 protected:
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     MultipleSegmentBase(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
+    void inheritFrom(const MultipleSegmentBase &parent);
 ///@endcond PROTECTED
 
 private:
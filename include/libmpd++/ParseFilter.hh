@@ -0,0 +1,173 @@
+#ifndef _BBC_PARSE_DASH_MPD_PARSE_FILTER_HH_
+#define _BBC_PARSE_DASH_MPD_PARSE_FILTER_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: ParseFilter class
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "macros.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/** Parse-time element filter
+ * @headerfile libmpd++/ParseFilter.hh <libmpd++/ParseFilter.hh>
+ *
+ * Describes parts of the MPD XML that an application does not need, so that the parser can skip them without building any objects
+ * for them. A filter is given to the MPD parser using MPD::ParseOptions::parseFilter().
+ *
+ * Two kinds of filtering are available:
+ * - Elements in the MPD namespace can be skipped by name wherever they appear, for example "ProgramInformation", "Metrics",
+ *   "ContentProtection", "Label" or "Viewpoint".
+ * - AdaptationSet (and EmptyAdaptationSet) elements can be skipped using predicates which are given an AdaptationSetInfo for the
+ *   unparsed element, for example to drop all text tracks or all tracks protected by an unsupported scheme.
+ *
+ * When using MPD::PARSER_STREAMING, elements skipped by name are stepped over by the XML reader at any depth and are never built as
+ * XML nodes. AdaptationSets skipped by a predicate are still read, as the predicate looks at their content. With MPD::PARSER_DOM
+ * the skipped subtrees are left in the XML document and discarded with it.
+ *
+ * The filtered MPD is a smaller MPD, the skipped elements are not kept anywhere, so writing the MPD out again will not reproduce
+ * them. Skipping mandatory elements, such as "Period" or "Representation", will produce an MPD which is not valid. Content added
+ * to the MPD by MPD::applyPatch() is not filtered.
+ *
+ * A filter must not be changed while an MPD is being parsed with it. The predicates may be called from the Period parsing threads
+ * (see MPD::ParseOptions::periodParseThreads()) and must be thread-safe in that case.
+ */
+class LIBMPDPP_PUBLIC_API ParseFilter {
+public:
+    /** Information about an unparsed AdaptationSet
+     * @headerfile libmpd++/ParseFilter.hh <libmpd++/ParseFilter.hh>
+     *
+     * Gives access to the values of an AdaptationSet element that are useful when deciding whether to skip it, without parsing
+     * the element. The values are read directly from the XML and are only valid for the duration of the predicate call.
+     */
+    class LIBMPDPP_PUBLIC_API AdaptationSetInfo {
+    public:
+        /**@cond PROTECTED
+         */
+        explicit AdaptationSetInfo(const void *xml_node) :m_node(xml_node) {};
+        /**@endcond
+         */
+
+        /** Get the element name
+         *
+         * @return "AdaptationSet" or "EmptyAdaptationSet".
+         */
+        std::string_view elementName() const;
+
+        /** Get the content type
+         *
+         * @return The \@contentType attribute value. If there is no \@contentType attribute then the type part of mimeType()
+         *         (e.g. "video" for "video/mp4") is returned. An empty string is returned if neither value is available.
+         */
+        std::string_view contentType() const;
+
+        /** Get the MIME type
+         *
+         * @return The \@mimeType attribute value, or the \@mimeType of the first Representation if the AdaptationSet does not
+         *         have one. An empty string is returned if no \@mimeType is found.
+         */
+        std::string_view mimeType() const;
+
+        /** Check for an EssentialProperty scheme
+         *
+         * @param scheme_id_uri The \@schemeIdUri to look for.
+         * @return `true` if the AdaptationSet has an EssentialProperty child element with the \@schemeIdUri @p scheme_id_uri.
+         */
+        bool hasEssentialProperty(std::string_view scheme_id_uri) const;
+
+    private:
+        const void *m_node;
+    };
+
+    /** Type for AdaptationSet predicates
+     *
+     * The predicate returns `true` if the AdaptationSet should be skipped.
+     */
+    using adaptation_set_predicate_type = std::function<bool(const AdaptationSetInfo&)>;
+
+    /** Default constructor
+     *
+     * Creates a filter which does not skip anything.
+     */
+    ParseFilter();
+
+    /** Check if the filter skips anything
+     *
+     * @return `true` if no elements or AdaptationSets will be skipped by this filter.
+     */
+    bool empty() const { return m_skipElements.empty() && m_adaptationSetPredicates.empty(); };
+
+    /** Skip elements by name
+     *
+     * @param element_name The local name of the element in the MPD namespace to skip wherever it appears in the MPD.
+     * @return This ParseFilter.
+     */
+    ParseFilter &skipElement(const std::string &element_name);
+
+    /** Check if an element name is skipped
+     *
+     * @param element_name The local name of an element in the MPD namespace.
+     * @return `true` if elements called @p element_name are skipped.
+     */
+    bool skipsElement(std::string_view element_name) const;
+
+    /** Skip AdaptationSets using a predicate
+     *
+     * An AdaptationSet is skipped if any of the predicates added to the filter return `true` for it.
+     *
+     * @param predicate The predicate to add.
+     * @return This ParseFilter.
+     */
+    ParseFilter &skipAdaptationSets(const adaptation_set_predicate_type &predicate);
+
+    /** Skip AdaptationSets with a content type
+     *
+     * @param content_type The content type to skip, e.g. "text".
+     * @return This ParseFilter.
+     * @see AdaptationSetInfo::contentType()
+     */
+    ParseFilter &skipAdaptationSetContentType(const std::string &content_type);
+
+    /** Skip AdaptationSets with a MIME type
+     *
+     * @param mime_type The MIME type to skip, e.g. "application/ttml+xml".
+     * @return This ParseFilter.
+     * @see AdaptationSetInfo::mimeType()
+     */
+    ParseFilter &skipAdaptationSetMimeType(const std::string &mime_type);
+
+    /** Skip AdaptationSets with an EssentialProperty scheme
+     *
+     * @param scheme_id_uri The EssentialProperty \@schemeIdUri to skip.
+     * @return This ParseFilter.
+     * @see AdaptationSetInfo::hasEssentialProperty()
+     */
+    ParseFilter &skipAdaptationSetEssentialProperty(const std::string &scheme_id_uri);
+
+    /** Check if an AdaptationSet is skipped
+     *
+     * @param info The AdaptationSet to check.
+     * @return `true` if any of the AdaptationSet predicates return `true` for @p info.
+     */
+    bool skipsAdaptationSet(const AdaptationSetInfo &info) const;
+
+private:
+    std::vector<std::string> m_skipElements;
+    std::vector<adaptation_set_predicate_type> m_adaptationSetPredicates;
+};
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_PARSE_FILTER_HH_*/
@@ -10,6 +10,7 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <memory>
@@ -24,6 +25,7 @@
 #include "Descriptor.hh"
 #include "EventStream.hh"
 #include "Label.hh"
+#include "MemoryResource.hh"
 #include "Preselection.hh"
 #include "SegmentAvailability.hh"
 #include "SegmentBase.hh"
@@ -40,11 +42,18 @@ namespace xmlpp {
     class Element;
     class Node;
 }
+struct _xmlNode;
 /**@endcond
  */
 
 LIBMPDPP_NAMESPACE_BEGIN
 
+/**@cond
+ */
+class UnparsedElement;
+/**@endcond
+ */
+
 /** Period element class
  * @headerfile libmpd++/Period.hh <libmpd++/Period.hh>
  *
@@ -129,25 +138,25 @@ public:
 
     bool hasStart() const { return m_start.has_value(); };
     const std::optional<duration_type> &start() const { return m_start; };
-    Period &start(const std::nullopt_t &) { m_start.reset(); return *this; };
-    Period &start(const duration_type &start) { m_start = start; return *this; };
-    Period &start(const std::optional<duration_type> &start) { m_start = start; return *this; };
+    Period &start(const std::nullopt_t &) { m_start.reset(); cacheCalcClear(); return *this; };
+    Period &start(const duration_type &start) { m_start = start; cacheCalcClear(); return *this; };
+    Period &start(const std::optional<duration_type> &start) { m_start = start; cacheCalcClear(); return *this; };
 
     bool hasDuration() const { return m_duration.has_value(); };
     const std::optional<duration_type> &duration() const { return m_duration; };
-    Period &duration(const std::nullopt_t &) { m_duration.reset(); return *this; };
-    Period &duration(const duration_type &durn) { m_duration = durn; return *this; };
-    Period &duration(const std::optional<duration_type> &durn) { m_duration = durn; return *this; };
+    Period &duration(const std::nullopt_t &) { m_duration.reset(); cacheCalcClear(); return *this; };
+    Period &duration(const duration_type &durn) { m_duration = durn; cacheCalcClear(); return *this; };
+    Period &duration(const std::optional<duration_type> &durn) { m_duration = durn; cacheCalcClear(); return *this; };
 
     bool bitstreamSwitching() const { return m_bitstreamSwitching; };
     Period &bitstreamSwitching(bool bitstream_switching) { m_bitstreamSwitching = bitstream_switching; return *this; };
 
     //std::list<BaseURL>             m_baseURLs;
-    const std::list<BaseURL> &baseURLs() const { return m_baseURLs; };
-    std::list<BaseURL>::const_iterator baseURLsBegin() const { return m_baseURLs.cbegin(); };
-    std::list<BaseURL>::const_iterator baseURLsEnd() const { return m_baseURLs.cend(); };
-    std::list<BaseURL>::iterator baseURLsBegin() { return m_baseURLs.begin(); };
-    std::list<BaseURL>::iterator baseURLsEnd() { return m_baseURLs.end(); };
+    const std::list<BaseURL> &baseURLs() const { materialise(); return m_baseURLs; };
+    std::list<BaseURL>::const_iterator baseURLsBegin() const { materialise(); return m_baseURLs.cbegin(); };
+    std::list<BaseURL>::const_iterator baseURLsEnd() const { materialise(); return m_baseURLs.cend(); };
+    std::list<BaseURL>::iterator baseURLsBegin() { materialise(); invalidateBaseURLs(); return m_baseURLs.begin(); };
+    std::list<BaseURL>::iterator baseURLsEnd() { materialise(); invalidateBaseURLs(); return m_baseURLs.end(); };
     Period &baseURLAdd(const BaseURL &base_url);
     Period &baseURLAdd(BaseURL &&base_url);
     Period &baseURLRemove(const BaseURL &base_url);
@@ -163,52 +172,54 @@ public:
      * If there are no BaseURLs set, then the return value is equivalent to getMPD()->getBaseURLs(). If the Period has not been
      * added to an MPD then an empty list will be returned.
      *
+     * The resolved list is cached, the reference remains valid until the BaseURLs of this Period or the MPD are changed.
+     *
      * @return The list of resolved BaseURL values applicable at this Period level.
      */
-    std::list<BaseURL> getBaseURLs() const;
+    const std::list<BaseURL> &getBaseURLs() const;
 
     //std::optional<SegmentBase>     m_segmentBase;
-    bool hasSegmentBase() const { return m_segmentBase.has_value(); };
-    const std::optional<SegmentBase> &segmentBase() const { return m_segmentBase; };
-    Period &segmentBase(const std::nullopt_t &) { m_segmentBase.reset(); return *this; };
-    Period &segmentBase(const SegmentBase &seg_base) { m_segmentBase = seg_base; return *this; };
-    Period &segmentBase(SegmentBase &&seg_base) { m_segmentBase = std::move(seg_base); return *this; };
-    Period &segmentBase(const std::optional<SegmentBase> &seg_base) { m_segmentBase = seg_base; return *this; };
-    Period &segmentBase(std::optional<SegmentBase> &&seg_base) { m_segmentBase = std::move(seg_base); return *this; };
+    bool hasSegmentBase() const { materialise(); return m_segmentBase.has_value(); };
+    const std::optional<SegmentBase> &segmentBase() const { materialise(); return m_segmentBase; };
+    Period &segmentBase(const std::nullopt_t &) { materialise(); m_segmentBase.reset(); invalidateAddressing(); return *this; };
+    Period &segmentBase(const SegmentBase &seg_base) { materialise(); m_segmentBase = seg_base; invalidateAddressing(); return *this; };
+    Period &segmentBase(SegmentBase &&seg_base) { materialise(); m_segmentBase = std::move(seg_base); invalidateAddressing(); return *this; };
+    Period &segmentBase(const std::optional<SegmentBase> &seg_base) { materialise(); m_segmentBase = seg_base; invalidateAddressing(); return *this; };
+    Period &segmentBase(std::optional<SegmentBase> &&seg_base) { materialise(); m_segmentBase = std::move(seg_base); invalidateAddressing(); return *this; };
 
     //std::optional<SegmentList>     m_segmentList;
-    bool hasSegmentList() const { return m_segmentList.has_value(); };
-    const std::optional<SegmentList> &segmentList() const { return m_segmentList; };
-    Period &segmentList(const std::nullopt_t &) { m_segmentList.reset(); return *this; };
-    Period &segmentList(const SegmentList &seg_list) { m_segmentList = seg_list; return *this; };
-    Period &segmentList(SegmentList &&seg_list) { m_segmentList = std::move(seg_list); return *this; };
-    Period &segmentList(const std::optional<SegmentList> &seg_list) { m_segmentList = seg_list; return *this; };
-    Period &segmentList(std::optional<SegmentList> &&seg_list) { m_segmentList = std::move(seg_list); return *this; };
+    bool hasSegmentList() const { materialise(); return m_segmentList.has_value(); };
+    const std::optional<SegmentList> &segmentList() const { materialise(); return m_segmentList; };
+    Period &segmentList(const std::nullopt_t &) { materialise(); m_segmentList.reset(); invalidateAddressing(); return *this; };
+    Period &segmentList(const SegmentList &seg_list) { materialise(); m_segmentList = seg_list; invalidateAddressing(); return *this; };
+    Period &segmentList(SegmentList &&seg_list) { materialise(); m_segmentList = std::move(seg_list); invalidateAddressing(); return *this; };
+    Period &segmentList(const std::optional<SegmentList> &seg_list) { materialise(); m_segmentList = seg_list; invalidateAddressing(); return *this; };
+    Period &segmentList(std::optional<SegmentList> &&seg_list) { materialise(); m_segmentList = std::move(seg_list); invalidateAddressing(); return *this; };
 
     //std::optional<SegmentTemplate> m_segmentTemplate;
-    bool hasSegmentTemplate() const { return m_segmentTemplate.has_value(); };
-    const std::optional<SegmentTemplate> &segmentTemplate() const { return m_segmentTemplate; };
-    Period &segmentTemplate(const std::nullopt_t &) { m_segmentTemplate.reset(); return *this; };
-    Period &segmentTemplate(const SegmentTemplate &seg_template) {m_segmentTemplate = seg_template; return *this; };
-    Period &segmentTemplate(SegmentTemplate &&seg_template) {m_segmentTemplate = std::move(seg_template); return *this; };
-    Period &segmentTemplate(const std::optional<SegmentTemplate> &seg_template) {m_segmentTemplate = seg_template; return *this; };
-    Period &segmentTemplate(std::optional<SegmentTemplate> &&seg_template) {m_segmentTemplate = std::move(seg_template); return *this; };
+    bool hasSegmentTemplate() const { materialise(); return m_segmentTemplate.has_value(); };
+    const std::optional<SegmentTemplate> &segmentTemplate() const { materialise(); return m_segmentTemplate; };
+    Period &segmentTemplate(const std::nullopt_t &) { materialise(); m_segmentTemplate.reset(); invalidateAddressing(); return *this; };
+    Period &segmentTemplate(const SegmentTemplate &seg_template) { materialise(); m_segmentTemplate = seg_template; invalidateAddressing(); return *this; };
+    Period &segmentTemplate(SegmentTemplate &&seg_template) { materialise(); m_segmentTemplate = std::move(seg_template); invalidateAddressing(); return *this; };
+    Period &segmentTemplate(const std::optional<SegmentTemplate> &seg_template) { materialise(); m_segmentTemplate = seg_template; invalidateAddressing(); return *this; };
+    Period &segmentTemplate(std::optional<SegmentTemplate> &&seg_template) { materialise(); m_segmentTemplate = std::move(seg_template); invalidateAddressing(); return *this; };
 
     //std::optional<Descriptor>      m_assetIdentifier;
-    bool hasAssetIdentifier() const { return m_assetIdentifier.has_value(); };
-    const std::optional<Descriptor> &assetIdentifier() const { return m_assetIdentifier; };
-    Period &assetIdentifier(const std::nullopt_t &) { m_assetIdentifier.reset(); return *this; };
-    Period &assetIdentifier(const Descriptor &asset_id) { m_assetIdentifier = asset_id; return *this; };
-    Period &assetIdentifier(Descriptor &&asset_id) { m_assetIdentifier = std::move(asset_id); return *this; };
-    Period &assetIdentifier(const std::optional<Descriptor> &asset_id) { m_assetIdentifier = asset_id; return *this; };
-    Period &assetIdentifier(std::optional<Descriptor> &&asset_id) { m_assetIdentifier = std::move(asset_id); return *this; };
+    bool hasAssetIdentifier() const { materialise(); return m_assetIdentifier.has_value(); };
+    const std::optional<Descriptor> &assetIdentifier() const { materialise(); return m_assetIdentifier; };
+    Period &assetIdentifier(const std::nullopt_t &) { materialise(); m_assetIdentifier.reset(); return *this; };
+    Period &assetIdentifier(const Descriptor &asset_id) { materialise(); m_assetIdentifier = asset_id; return *this; };
+    Period &assetIdentifier(Descriptor &&asset_id) { materialise(); m_assetIdentifier = std::move(asset_id); return *this; };
+    Period &assetIdentifier(const std::optional<Descriptor> &asset_id) { materialise(); m_assetIdentifier = asset_id; return *this; };
+    Period &assetIdentifier(std::optional<Descriptor> &&asset_id) { materialise(); m_assetIdentifier = std::move(asset_id); return *this; };
 
     //std::list<EventStream>         m_eventStreams;
-    const std::list<EventStream> &eventStreams() const { return m_eventStreams; };
-    std::list<EventStream>::const_iterator eventStreamsBegin() const { return m_eventStreams.cbegin(); };
-    std::list<EventStream>::const_iterator eventStreamsEnd() const { return m_eventStreams.cend(); };
-    std::list<EventStream>::iterator eventStreamsBegin() { return m_eventStreams.begin(); };
-    std::list<EventStream>::iterator eventStreamsEnd() { return m_eventStreams.end(); };
+    const std::list<EventStream> &eventStreams() const { materialise(); return m_eventStreams; };
+    std::list<EventStream>::const_iterator eventStreamsBegin() const { materialise(); return m_eventStreams.cbegin(); };
+    std::list<EventStream>::const_iterator eventStreamsEnd() const { materialise(); return m_eventStreams.cend(); };
+    std::list<EventStream>::iterator eventStreamsBegin() { materialise(); return m_eventStreams.begin(); };
+    std::list<EventStream>::iterator eventStreamsEnd() { materialise(); return m_eventStreams.end(); };
     Period &eventStreamAdd(const EventStream &event_stream);
     Period &eventStreamAdd(EventStream &&event_stream);
     Period &eventStreamRemove(const EventStream &event_stream);
@@ -216,11 +227,11 @@ public:
     Period &eventStreamRemove(const std::list<EventStream>::iterator &);
 
     //std::list<ServiceDescription>  m_serviceDescriptions;
-    const std::list<ServiceDescription> &serviceDescriptions() const { return m_serviceDescriptions; };
-    std::list<ServiceDescription>::const_iterator serviceDescriptionsBegin() const { return m_serviceDescriptions.cbegin(); };
-    std::list<ServiceDescription>::const_iterator serviceDescriptionsEnd() const { return m_serviceDescriptions.cend(); };
-    std::list<ServiceDescription>::iterator serviceDescriptionsBegin() { return m_serviceDescriptions.begin(); };
-    std::list<ServiceDescription>::iterator serviceDescriptionsEnd() { return m_serviceDescriptions.end(); };
+    const std::list<ServiceDescription> &serviceDescriptions() const { materialise(); return m_serviceDescriptions; };
+    std::list<ServiceDescription>::const_iterator serviceDescriptionsBegin() const { materialise(); return m_serviceDescriptions.cbegin(); };
+    std::list<ServiceDescription>::const_iterator serviceDescriptionsEnd() const { materialise(); return m_serviceDescriptions.cend(); };
+    std::list<ServiceDescription>::iterator serviceDescriptionsBegin() { materialise(); return m_serviceDescriptions.begin(); };
+    std::list<ServiceDescription>::iterator serviceDescriptionsEnd() { materialise(); return m_serviceDescriptions.end(); };
     Period &serviceDescriptionAdd(const ServiceDescription &service_desc);
     Period &serviceDescriptionAdd(ServiceDescription &&service_desc);
     Period &serviceDescriptionRemove(const ServiceDescription &service_desc);
@@ -228,11 +239,11 @@ public:
     Period &serviceDescriptionRemove(const std::list<ServiceDescription>::iterator &);
 
     //std::list<ContentProtection>   m_contentProtections;
-    const std::list<ContentProtection> &contentProtections() const { return m_contentProtections; };
-    std::list<ContentProtection>::const_iterator contentProtectionsBegin() const { return m_contentProtections.cbegin(); };
-    std::list<ContentProtection>::const_iterator contentProtectionsEnd() const { return m_contentProtections.cend(); };
-    std::list<ContentProtection>::iterator contentProtectionsBegin() { return m_contentProtections.begin(); };
-    std::list<ContentProtection>::iterator contentProtectionsEnd() { return m_contentProtections.end(); };
+    const std::list<ContentProtection> &contentProtections() const { materialise(); return m_contentProtections; };
+    std::list<ContentProtection>::const_iterator contentProtectionsBegin() const { materialise(); return m_contentProtections.cbegin(); };
+    std::list<ContentProtection>::const_iterator contentProtectionsEnd() const { materialise(); return m_contentProtections.cend(); };
+    std::list<ContentProtection>::iterator contentProtectionsBegin() { materialise(); return m_contentProtections.begin(); };
+    std::list<ContentProtection>::iterator contentProtectionsEnd() { materialise(); return m_contentProtections.end(); };
     Period &contentProtectionAdd(const ContentProtection &content_prot);
     Period &contentProtectionAdd(ContentProtection &&content_prot);
     Period &contentProtectionRemove(const ContentProtection &content_prot);
@@ -240,11 +251,11 @@ public:
     Period &contentProtectionRemove(const std::list<ContentProtection>::iterator &);
 
     //std::list<AdaptationSet>       m_adaptationSets;
-    const std::list<AdaptationSet> &adaptationSets() const { return m_adaptationSets; };
-    std::list<AdaptationSet>::const_iterator adaptationSetsBegin() const { return m_adaptationSets.cbegin(); };
-    std::list<AdaptationSet>::const_iterator adaptationSetsEnd() const { return m_adaptationSets.cend(); };
-    std::list<AdaptationSet>::iterator adaptationSetsBegin() { return m_adaptationSets.begin(); };
-    std::list<AdaptationSet>::iterator adaptationSetsEnd() { return m_adaptationSets.end(); };
+    const std::list<AdaptationSet> &adaptationSets() const { materialise(); return m_adaptationSets; };
+    std::list<AdaptationSet>::const_iterator adaptationSetsBegin() const { materialise(); return m_adaptationSets.cbegin(); };
+    std::list<AdaptationSet>::const_iterator adaptationSetsEnd() const { materialise(); return m_adaptationSets.cend(); };
+    std::list<AdaptationSet>::iterator adaptationSetsBegin() { materialise(); return m_adaptationSets.begin(); };
+    std::list<AdaptationSet>::iterator adaptationSetsEnd() { materialise(); return m_adaptationSets.end(); };
     Period &adaptationSetAdd(const AdaptationSet &adapt_set);
     Period &adaptationSetAdd(AdaptationSet &&adapt_set);
     Period &adaptationSetRemove(const AdaptationSet &adapt_set);
@@ -252,11 +263,11 @@ public:
     Period &adaptationSetRemove(const std::list<AdaptationSet>::iterator &);
 
     //std::list<Subset>              m_subsets;
-    const std::list<Subset> &subsets() const { return m_subsets; };
-    std::list<Subset>::const_iterator subsetsBegin() const { return m_subsets.cbegin(); };
-    std::list<Subset>::const_iterator subsetsEnd() const { return m_subsets.cend(); };
-    std::list<Subset>::iterator subsetsBegin() { return m_subsets.begin(); };
-    std::list<Subset>::iterator subsetsEnd() { return m_subsets.end(); };
+    const std::list<Subset> &subsets() const { materialise(); return m_subsets; };
+    std::list<Subset>::const_iterator subsetsBegin() const { materialise(); return m_subsets.cbegin(); };
+    std::list<Subset>::const_iterator subsetsEnd() const { materialise(); return m_subsets.cend(); };
+    std::list<Subset>::iterator subsetsBegin() { materialise(); return m_subsets.begin(); };
+    std::list<Subset>::iterator subsetsEnd() { materialise(); return m_subsets.end(); };
     Period &subsetAdd(const Subset &subset);
     Period &subsetAdd(Subset &&subset);
     Period &subsetRemove(const Subset &subset);
@@ -264,11 +275,11 @@ public:
     Period &subsetRemove(const std::list<Subset>::iterator &);
 
     //std::list<Descriptor>          m_supplementalProperties;
-    const std::list<Descriptor> &supplementalProperties() const { return m_supplementalProperties; };
-    std::list<Descriptor>::const_iterator supplementalPropertiesBegin() const { return m_supplementalProperties.cbegin(); };
-    std::list<Descriptor>::const_iterator supplementalPropertiesEnd() const { return m_supplementalProperties.cend(); };
-    std::list<Descriptor>::iterator supplementalPropertiesBegin() { return m_supplementalProperties.begin(); };
-    std::list<Descriptor>::iterator supplementalPropertiesEnd() { return m_supplementalProperties.end(); };
+    const std::list<Descriptor> &supplementalProperties() const { materialise(); return m_supplementalProperties; };
+    std::list<Descriptor>::const_iterator supplementalPropertiesBegin() const { materialise(); return m_supplementalProperties.cbegin(); };
+    std::list<Descriptor>::const_iterator supplementalPropertiesEnd() const { materialise(); return m_supplementalProperties.cend(); };
+    std::list<Descriptor>::iterator supplementalPropertiesBegin() { materialise(); return m_supplementalProperties.begin(); };
+    std::list<Descriptor>::iterator supplementalPropertiesEnd() { materialise(); return m_supplementalProperties.end(); };
     Period &supplementalPropertyAdd(const Descriptor &supp_prop);
     Period &supplementalPropertyAdd(Descriptor &&supp_prop);
     Period &supplementalPropertyRemove(const Descriptor &supp_prop);
@@ -276,11 +287,11 @@ public:
     Period &supplementalPropertyRemove(const std::list<Descriptor>::iterator &);
 
     //std::list<AdaptationSet>       m_emptyAdaptationSets;
-    const std::list<AdaptationSet> &emptyAdaptationSets() const { return m_emptyAdaptationSets; };
-    std::list<AdaptationSet>::const_iterator emptyAdaptationSetsBegin() const { return m_emptyAdaptationSets.cbegin(); };
-    std::list<AdaptationSet>::const_iterator emptyAdaptationSetsEnd() const { return m_emptyAdaptationSets.cend(); };
-    std::list<AdaptationSet>::iterator emptyAdaptationSetsBegin() { return m_emptyAdaptationSets.begin(); };
-    std::list<AdaptationSet>::iterator emptyAdaptationSetsEnd() { return m_emptyAdaptationSets.end(); };
+    const std::list<AdaptationSet> &emptyAdaptationSets() const { materialise(); return m_emptyAdaptationSets; };
+    std::list<AdaptationSet>::const_iterator emptyAdaptationSetsBegin() const { materialise(); return m_emptyAdaptationSets.cbegin(); };
+    std::list<AdaptationSet>::const_iterator emptyAdaptationSetsEnd() const { materialise(); return m_emptyAdaptationSets.cend(); };
+    std::list<AdaptationSet>::iterator emptyAdaptationSetsBegin() { materialise(); return m_emptyAdaptationSets.begin(); };
+    std::list<AdaptationSet>::iterator emptyAdaptationSetsEnd() { materialise(); return m_emptyAdaptationSets.end(); };
     Period &emptyAdaptationSetAdd(const AdaptationSet &adapt_set);
     Period &emptyAdaptationSetAdd(AdaptationSet &&adapt_set);
     Period &emptyAdaptationSetRemove(const AdaptationSet &adapt_set);
@@ -288,11 +299,11 @@ public:
     Period &emptyAdaptationSetRemove(const std::list<AdaptationSet>::iterator &);
 
     //std::list<Label>               m_groupLabels;
-    const std::list<Label> &groupLabels() const { return m_groupLabels; };
-    std::list<Label>::const_iterator groupLabelsBegin() const { return m_groupLabels.cbegin(); };
-    std::list<Label>::const_iterator groupLabelsEnd() const { return m_groupLabels.cend(); };
-    std::list<Label>::iterator groupLabelsBegin() { return m_groupLabels.begin(); };
-    std::list<Label>::iterator groupLabelsEnd() { return m_groupLabels.end(); };
+    const std::list<Label> &groupLabels() const { materialise(); return m_groupLabels; };
+    std::list<Label>::const_iterator groupLabelsBegin() const { materialise(); return m_groupLabels.cbegin(); };
+    std::list<Label>::const_iterator groupLabelsEnd() const { materialise(); return m_groupLabels.cend(); };
+    std::list<Label>::iterator groupLabelsBegin() { materialise(); return m_groupLabels.begin(); };
+    std::list<Label>::iterator groupLabelsEnd() { materialise(); return m_groupLabels.end(); };
     Period &groupLabelAdd(const Label &label);
     Period &groupLabelAdd(Label &&label);
     Period &groupLabelRemove(const Label &label);
@@ -300,11 +311,11 @@ public:
     Period &groupLabelRemove(const std::list<Label>::iterator &);
 
     //std::list<Preselection>        m_preselections;
-    const std::list<Preselection> &preselections() const { return m_preselections; };
-    std::list<Preselection>::const_iterator preselectionsBegin() const { return m_preselections.cbegin(); };
-    std::list<Preselection>::const_iterator preselectionsEnd() const { return m_preselections.cend(); };
-    std::list<Preselection>::iterator preselectionsBegin() { return m_preselections.begin(); };
-    std::list<Preselection>::iterator preselectionsEnd() { return m_preselections.end(); };
+    const std::list<Preselection> &preselections() const { materialise(); return m_preselections; };
+    std::list<Preselection>::const_iterator preselectionsBegin() const { materialise(); return m_preselections.cbegin(); };
+    std::list<Preselection>::const_iterator preselectionsEnd() const { materialise(); return m_preselections.cend(); };
+    std::list<Preselection>::iterator preselectionsBegin() { materialise(); return m_preselections.begin(); };
+    std::list<Preselection>::iterator preselectionsEnd() { materialise(); return m_preselections.end(); };
     Period &preselectionAdd(const Preselection &preselection);
     Period &preselectionAdd(Preselection &&preselection);
     Period &preselectionRemove(const Preselection &preselection);
@@ -356,13 +367,26 @@ public:
      *
      * @param mpd The MPD pointer to attach this Period to. Use `nullptr` to detach the Period from the MPD.
      */
-    Period &setMPD(MPD *mpd) { m_mpd = mpd; return *this; };
+    Period &setMPD(MPD *mpd) { if (m_mpd != mpd) { m_mpd = mpd; invalidateBaseURLs(); invalidateAddressing(); } return *this; };
+
+    /** Check if the child elements of this Period have been parsed
+     *
+     * When an MPD is parsed with MPD::ParseOptions::lazyPeriods() set, only the Period attributes are parsed up front. The child
+     * elements are parsed the first time any of them are accessed, or when a selection or query touches this Period. Periods
+     * created in any other way always return `true`.
+     *
+     * @return `true` if the child elements of this Period are available, `false` if they will be parsed on next access.
+     */
+    bool isMaterialised() const { return !m_cache->haveUnparsedChildren.load(std::memory_order_acquire); };
 
     /** Calculate the start time of this Period
      *
      * If the @@start attribute is set then the calculated start time will be the same as @@start. If not set then Periods of the
      * same MPD from before and after this Period are checked to see if the start time of this period can be derived from their
-     * calculated start times and calculated durations.
+     * calculated start times and calculated durations. The first Period of an MPD starts at 0 if it has no @@start.
+     *
+     * The times of all Periods in an MPD are calculated together, in a single pass over the Periods, and are kept until the
+     * Periods or their timing attributes change.
      *
      * If the start time cannot be assertained then a std::nullopt will be returned.
      *
@@ -374,7 +398,8 @@ public:
      *
      * If the @@duration attribute is set then the calculated duration time will be the same as @@duration. If not set then Periods
      * of the same MPD from before and after this Period are checked to see if the duration of this period can be derived from
-     * their calculated start times and calculated durations.
+     * their calculated start times and calculated durations. The last Period of an MPD with a @@mediaPresentationDuration lasts
+     * until the end of the presentation.
      *
      * If the duration cannot be assertained then a std::nullopt will be returned.
      *
@@ -386,22 +411,27 @@ public:
 protected:
     friend class MPD;
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
     Period(xmlpp::Node&);
+    Period(const std::shared_ptr<UnparsedElement> &unparsed_element);
     void setXMLElement(xmlpp::Element&) const;
-    std::string getMediaURL(const SegmentTemplate::Variables&) const;
-    std::string getInitializationURL(const SegmentTemplate::Variables&) const;
-    SegmentAvailability getMediaAvailability(const SegmentTemplate::Variables&) const;
-    SegmentAvailability getInitialisationAvailability(const SegmentTemplate::Variables &vars) const;
-    Period &setPreviousSibling(Period *sibling) { m_previousSibling = sibling; cacheCalcClear(); sibling->cacheCalcClear(); return *this; };
-    Period &setNextSibling(Period *sibling) { m_nextSibling = sibling; cacheCalcClear(); sibling->cacheCalcClear(); return *this; };
+    Period &setPreviousSibling(Period *sibling) { m_previousSibling = sibling; cacheCalcClear(); if (sibling) sibling->cacheCalcClear(); return *this; };
+    Period &setNextSibling(Period *sibling) { m_nextSibling = sibling; cacheCalcClear(); if (sibling) sibling->cacheCalcClear(); return *this; };
     time_type getPeriodStartTime() const;
     std::optional<duration_type> getPeriodDuration() const;
-    const MultipleSegmentBase &getMultiSegmentBase() const;
 ///@endcond PROTECTED
 
 private:
-    void cacheCalcTimes() const;
+    void extractXMLAttributes(const _xmlNode *node);
+    void extractXMLChildren(xmlpp::Node &node);
+    void materialise() const { if (m_cache->haveUnparsedChildren.load(std::memory_order_acquire)) materialiseChildren(); };
+    void materialiseChildren() const;
+    bool cacheCalcTimes() const;
     void cacheCalcClear() const;
+    void invalidateBaseURLs() const;
+    void invalidateAddressing() const;
 
     MPD                           *m_mpd;             ///< The MPD this Period is attached to or `nullptr`
     Period                        *m_previousSibling; ///< The previous Period in the MPD or `nullptr`
@@ -416,6 +446,7 @@ private:
 
     // Period child elements (ISO 23009-1:2022 Table 4)
     std::list<BaseURL>             m_baseURLs;
+    mutable BaseURLCache           m_baseURLCache; ///< Resolved BaseURLs from getBaseURLs()
     std::optional<SegmentBase>     m_segmentBase;
     std::optional<SegmentList>     m_segmentList;
     std::optional<SegmentTemplate> m_segmentTemplate;
@@ -430,16 +461,19 @@ private:
     std::list<Label>               m_groupLabels;
     std::list<Preselection>        m_preselections;
 
-    struct Cache {
-        Cache() :calcStart(), calcDuration() {};
-        Cache(const Cache &other) :calcStart(other.calcStart), calcDuration(other.calcDuration) {};
-        Cache(Cache &&other) :calcStart(std::move(other.calcStart)), calcDuration(std::move(other.calcDuration)) {};
-        Cache &operator=(const Cache &other) { calcStart = other.calcStart; calcDuration = other.calcDuration; return *this; };
-        Cache &operator=(Cache &&other) { calcStart = std::move(other.calcStart); calcDuration = std::move(other.calcDuration); return *this; };
+    struct Cache : public TreeAllocated {
+        Cache() :calcTimesValid(false), calcStart(), calcDuration(), haveUnparsedChildren(false), unparsedChildren() {};
+        Cache(const Cache &other) :calcTimesValid(other.calcTimesValid), calcStart(other.calcStart), calcDuration(other.calcDuration), haveUnparsedChildren(other.haveUnparsedChildren.load()), unparsedChildren(other.unparsedChildren.load()) {};
+        Cache(Cache &&other) :calcTimesValid(other.calcTimesValid), calcStart(std::move(other.calcStart)), calcDuration(std::move(other.calcDuration)), haveUnparsedChildren(other.haveUnparsedChildren.exchange(false)), unparsedChildren(other.unparsedChildren.exchange(nullptr)) {};
+        Cache &operator=(const Cache &other) { calcTimesValid = other.calcTimesValid; calcStart = other.calcStart; calcDuration = other.calcDuration; unparsedChildren = other.unparsedChildren.load(); haveUnparsedChildren = other.haveUnparsedChildren.load(); return *this; };
+        Cache &operator=(Cache &&other) { calcTimesValid = other.calcTimesValid; calcStart = std::move(other.calcStart); calcDuration = std::move(other.calcDuration); unparsedChildren = other.unparsedChildren.exchange(nullptr); haveUnparsedChildren = other.haveUnparsedChildren.exchange(false); return *this; };
         ~Cache() {};
+        bool calcTimesValid; ///< calcStart and calcDuration have been calculated by the MPD
         std::optional<Period::duration_type> calcStart;
         std::optional<Period::duration_type> calcDuration;
-    } *m_cache; ///< Cache to hold the calculated start offset and duration of this Period (can be updated in a const Period, hence the pointer)
+        std::atomic<bool> haveUnparsedChildren; ///< unparsedChildren is set, checked without loading the pointer
+        std::atomic<std::shared_ptr<UnparsedElement> > unparsedChildren; ///< XML for child elements not yet parsed (lazy parsing)
+    } *m_cache; ///< Cache to hold the calculated start offset and duration of this Period and any unparsed child elements (can be updated in a const Period, hence the pointer)
 };
 
 LIBMPDPP_NAMESPACE_END
@@ -92,6 +92,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class MPD;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     ProgramInformation(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
@@ -44,6 +44,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     RFC6838ContentType(xmlpp::Node &node);
     void setXMLElement(xmlpp::Element &elem) const;
 ///@endcond PROTECTED
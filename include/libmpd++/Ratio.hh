@@ -63,6 +63,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     Ratio(xmlpp::Node &node);
     void setXMLElement(xmlpp::Element &elem) const;
 ///@endcond PROTECTED
@@ -10,9 +10,11 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -203,9 +205,12 @@ public:
      *
      * Get the list of relevant BaseURLs, resolved to absolute URLs when possible.
      *
+     * The resolved list is cached, the reference remains valid until the BaseURLs of this Representation or any of its parents are
+     * changed.
+     *
      * @return A list of resolves BaseURLs that apply at for this Representation.
      */
-    std::list<BaseURL> getBaseURLs() const;
+    const std::list<BaseURL> &getBaseURLs() const;
 
     /** Is this Representation selected by its AdaptationSet?
      *
@@ -225,6 +230,35 @@ public:
      */
     SegmentAvailability segmentAvailability(const time_type &query_time) const;
 
+    /** Get the segment availability information for a range of segments
+     *
+     * This returns the full segment availability information for @p count segments starting at @p first_segment, where segment
+     * numbers count from 0 for the first segment in the Period (see MultipleSegmentBase). The inherited segment information and
+     * BaseURLs are resolved once for the whole range, so this is much cheaper than calling segmentAvailability() for each
+     * segment, e.g. when filling a prefetch queue.
+     *
+     * The range is truncated at the end of the Period or the last segment described.
+     *
+     * @param first_segment The number of the first segment to return.
+     * @param count The maximum number of segments to return.
+     *
+     * @return The SegmentAvailability for each segment in the range, in segment order.
+     */
+    std::list<SegmentAvailability> segmentAvailabilities(unsigned long first_segment, unsigned long count) const;
+
+    /** Get the segment availability information for the segments in a time range
+     *
+     * This returns the full segment availability information for the segments which overlap the presentation times from
+     * @p start_time up to, but not including, @p end_time. This uses the same time base as getMediaURL(time_type).
+     *
+     * @param start_time The presentation time of the start of the range.
+     * @param end_time The presentation time of the end of the range.
+     *
+     * @return The SegmentAvailability for each segment in the range, in segment order.
+     * @see segmentAvailabilities(unsigned long, unsigned long) const
+     */
+    std::list<SegmentAvailability> segmentAvailabilities(const time_type &start_time, const time_type &end_time) const;
+
     /** Get the segment availability information of the initialisation segment
      *
      * This returns the full segment availability information for the initialisation segment. If no initialization segment is
@@ -238,18 +272,51 @@ public:
 ///@cond PROTECTED
 protected:
     friend class AdaptationSet;
+    friend class MPD;
+    friend class Period;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
     Representation(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
     void setAdaptationSet(AdaptationSet *);
 ///@endcond PROTECTED
 
 private:
+    /* Segment addressing for this Representation with the inheritance rules applied
+     *
+     * The SegmentTemplate, SegmentList or SegmentBase type is taken from the lowest level that has segment information, and any
+     * attributes or elements not set there are inherited from the same element type in the parent AdaptationSet and Period
+     * (ISO 23009-1:2022 Clause 5.3.9.1). When only one level has the element it is used in place, otherwise the merged element is
+     * held in the record.
+     *
+     * Records are built on first use and then only read, so queries don't walk up the MPD tree. Like the BaseURLCache, anything
+     * which may change the inherited values invalidates the addressing CacheGeneration of its MPD and records from an earlier
+     * generation are rebuilt the next time they are used. Queries hold a shared_ptr to the record so that a rebuild in
+     * another thread doesn't free it while in use.
+     */
+    struct Addressing {
+        Addressing() :generation(0), segmentTemplate(nullptr), segmentList(nullptr), multiSegmentBase(nullptr), mergedTemplate(), mergedList(), mergedBase() {};
+        unsigned long generation;                      ///< The addressing generation this record was built for
+        const SegmentTemplate *segmentTemplate;        ///< The SegmentTemplate for this Representation or `nullptr`
+        const SegmentList *segmentList;                ///< The SegmentList for this Representation or `nullptr`
+        const MultipleSegmentBase *multiSegmentBase;   ///< Segment timing, from segmentTemplate, segmentList or mergedBase
+        std::optional<SegmentTemplate> mergedTemplate; ///< SegmentTemplate merged from more than one level
+        std::optional<SegmentList> mergedList;         ///< SegmentList merged from more than one level
+        MultipleSegmentBase mergedBase;                ///< SegmentBase values, empty if there is no segment information
+    };
+
+    std::shared_ptr<const Addressing> getAddressing() const;
+    template <class T>
+    static const T *inheritSegmentInfo(const std::optional<T> *const (&levels)[3], std::optional<T> &merged);
+    std::list<SegmentAvailability> segmentAvailabilities(const Addressing &addressing, unsigned long first_segment,
+                                                         unsigned long count) const;
     SegmentTemplate::Variables getTemplateVars() const;
-    SegmentTemplate::Variables getTemplateVars(unsigned long segment_number) const;
-    SegmentTemplate::Variables getTemplateVars(const time_type &time) const;
+    SegmentTemplate::Variables getTemplateVars(const Addressing &addressing, unsigned long segment_number) const;
+    unsigned long getSegmentNumber(const Addressing &addressing, const time_type &time) const;
     time_type getPeriodStartTime() const;
     std::optional<duration_type> getPeriodDuration() const;
-    const MultipleSegmentBase &getMultiSegmentBase() const;
+    void invalidateBaseURLs() const;
 
     AdaptationSet                 *m_adaptationSet;       ///< The AdaptationSet this Representation is part of or `nullptr`
 
@@ -264,11 +331,15 @@ private:
 
     // Representation child elements (ISO 23009-1:2022 Table 9)
     std::list<BaseURL>             m_baseURLs;
+    mutable BaseURLCache           m_baseURLCache;        ///< Resolved BaseURLs from getBaseURLs()
     std::list<ExtendedBandwidth>   m_extendedBandwidths;
     std::list<SubRepresentation>   m_subRepresentations;
     std::optional<SegmentBase>     m_segmentBase;
     std::optional<SegmentList>     m_segmentList;
     std::optional<SegmentTemplate> m_segmentTemplate;
+
+    mutable std::atomic<std::shared_ptr<const Addressing> > m_addressing; ///< Segment addressing from getAddressing()
+    mutable std::mutex             m_addressingMutex;     ///< Serialises rebuilds of m_addressing
 };
 
 LIBMPDPP_NAMESPACE_END
@@ -14,7 +14,9 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "macros.hh"
 #include "Codecs.hh"
@@ -29,6 +31,7 @@
 #include "Ratio.hh"
 #include "Resync.hh"
 #include "SAP.hh"
+#include "SharedValue.hh"
 #include "Switching.hh"
 #include "URI.hh"
 
@@ -120,15 +123,15 @@ public:
      *
      * @return the list of profile URIs.
      */
-    const std::list<URI> &profiles() const { return m_profiles; };
+    std::span<const URI> profiles() const { return m_profiles; };
 
     /**@{*/
     /** Get an iterator for the start of the profiles list
      * 
      * @return An iterator for the start of the profiles list.
      */
-    std::list<URI>::const_iterator profilesBegin() const { return m_profiles.cbegin(); };
-    std::list<URI>::iterator profilesBegin() { return m_profiles.begin(); };
+    std::span<const URI>::iterator profilesBegin() const { return profiles().begin(); };
+    std::span<URI>::iterator profilesBegin() { return std::span<URI>(m_profiles).begin(); };
     /**@}*/
 
     /**@{*/
@@ -136,8 +139,8 @@ public:
      *
      * @return An iterator for the end of the profiles list.
      */
-    std::list<URI>::const_iterator profilesEnd() const { return m_profiles.cend(); };
-    std::list<URI>::iterator profilesEnd() { return m_profiles.end(); };
+    std::span<const URI>::iterator profilesEnd() const { return profiles().end(); };
+    std::span<URI>::iterator profilesEnd() { return std::span<URI>(m_profiles).end(); };
     /**@}*/
 
     /**@{*/
@@ -146,8 +149,8 @@ public:
      * @param _profiles The list of profiles to set the profiles list to.
      * @return This RepresentationBase.
      */
-    RepresentationBase &profiles(const std::list<URI> &_profiles) { m_profiles = _profiles; return *this; };
-    RepresentationBase &profiles(std::list<URI> &&_profiles) { m_profiles = std::move(_profiles); return *this; };
+    RepresentationBase &profiles(const std::vector<URI> &_profiles) { m_profiles = _profiles; return *this; };
+    RepresentationBase &profiles(std::vector<URI> &&_profiles) { m_profiles = std::move(_profiles); return *this; };
     /**@}*/
 
     /** Get an entry from the profiles list
@@ -156,7 +159,7 @@ public:
      * @return The profile URI at list index @p idx.
      * @throw std::out_of_range If the @p idx index references a URI outside the profiles list.
      */
-    const URI &profile(std::list<URI>::size_type idx) const;
+    const URI &profile(std::vector<URI>::size_type idx) const;
 
     /**@{*/
     /** Add a value to the profiles list
@@ -181,8 +184,8 @@ public:
      * @param it An iterator referencing the entry to remove from the @@profile attribute.
      * @return This RepresentationBase.
      */
-    RepresentationBase &profilesRemove(const std::list<URI>::const_iterator &it);
-    RepresentationBase &profilesRemove(const std::list<URI>::iterator &it);
+    RepresentationBase &profilesRemove(const std::span<const URI>::iterator &it);
+    RepresentationBase &profilesRemove(const std::span<URI>::iterator &it);
     /**@}*/
 
     // @width
@@ -328,15 +331,15 @@ public:
      *
      * @return The @@pudioSamplingRate attribute value list.
      */
-    const std::list<unsigned int> &audioSamplingRates() const { return m_audioSamplingRates; };
+    std::span<const unsigned int> audioSamplingRates() const { return m_audioSamplingRates; };
 
     /**@{*/
     /** Get an iterator for the start of the @@pudioSamplingRate attribute value list
      *
      * @return An iterator at the start of the @@pudioSamplingRate attribute value list.
      */
-    std::list<unsigned int>::const_iterator audioSamplingRatesBegin() const { return m_audioSamplingRates.cbegin(); };
-    std::list<unsigned int>::iterator audioSamplingRatesBegin() { return m_audioSamplingRates.begin(); };
+    std::span<const unsigned int>::iterator audioSamplingRatesBegin() const { return audioSamplingRates().begin(); };
+    std::span<unsigned int>::iterator audioSamplingRatesBegin() { return std::span<unsigned int>(m_audioSamplingRates).begin(); };
     /**@}*/
 
     /**@{*/
@@ -344,8 +347,8 @@ public:
      *
      * @return An iterator at the end of the @@pudioSamplingRate attribute value list.
      */
-    std::list<unsigned int>::const_iterator audioSamplingRatesEnd() const { return m_audioSamplingRates.cend(); };
-    std::list<unsigned int>::iterator audioSamplingRatesEnd() { return m_audioSamplingRates.end(); };
+    std::span<const unsigned int>::iterator audioSamplingRatesEnd() const { return audioSamplingRates().end(); };
+    std::span<unsigned int>::iterator audioSamplingRatesEnd() { return std::span<unsigned int>(m_audioSamplingRates).end(); };
     /**@}*/
 
     /**@{*/
@@ -354,8 +357,8 @@ public:
      * @param rates The list of audio sample rates to set the @@pudioSamplingRate attribute to.
      * @return This RepresentationBase.
      */
-    RepresentationBase &audioSamplingRates(const std::list<unsigned int> &rates) { m_audioSamplingRates = rates; return *this; };
-    RepresentationBase &audioSamplingRates(std::list<unsigned int> &&rates) { m_audioSamplingRates = std::move(rates); return *this; };
+    RepresentationBase &audioSamplingRates(const std::vector<unsigned int> &rates) { m_audioSamplingRates = rates; return *this; };
+    RepresentationBase &audioSamplingRates(std::vector<unsigned int> &&rates) { m_audioSamplingRates = std::move(rates); return *this; };
     /**@}*/
 
     /** Get an @@pudioSamplingRate attribute value from the list of @@pudioSamplingRate attribute values
@@ -364,7 +367,7 @@ public:
      * @return The audio sampling rate from index @p idx is the list of @@pudioSamplingRate attribute values.
      * @throw std::out_of_range If the @p idx index value lies outside the list of @@pudioSamplingRate attribute values.
      */
-    unsigned int audioSamplingRate(std::list<unsigned int>::size_type idx) const;
+    unsigned int audioSamplingRate(std::vector<unsigned int>::size_type idx) const;
 
     /** Add an @@pudioSamplingRate entry
      *
@@ -386,8 +389,8 @@ public:
      * @param it An iterator for an entry in the @@pudioSamplingRate values list.
      * @return This RepresentationBase.
      */
-    RepresentationBase &audioSamplingRatesRemove(const std::list<unsigned int>::const_iterator &it);
-    RepresentationBase &audioSamplingRatesRemove(const std::list<unsigned int>::iterator &it);
+    RepresentationBase &audioSamplingRatesRemove(const std::span<const unsigned int>::iterator &it);
+    RepresentationBase &audioSamplingRatesRemove(const std::span<unsigned int>::iterator &it);
     /**@}*/
 
     // @mimeType
@@ -1873,6 +1876,9 @@ public:
 
 ///@cond PROTECTED
 protected:
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
     /** Constructor from libxml++ %Node
      *
      * Extract the attributes, elements and values from the libxml++ %Element for a %RepresentationBaseType element.
@@ -1893,15 +1899,15 @@ protected:
 
 private:
     // RepresentationBase attributes (ISO 23009-1:2022 Clause 5.3.7.3)
-    std::list<URI>              m_profiles;
+    std::vector<URI>            m_profiles;
     std::optional<unsigned int> m_width;
     std::optional<unsigned int> m_height;
     std::optional<Ratio>        m_sar;
     std::optional<FrameRate>    m_frameRate;
-    std::list<unsigned int>     m_audioSamplingRates; // if present must contain 1 or 2 entries
-    std::optional<std::string>  m_mimeType;
+    std::vector<unsigned int>   m_audioSamplingRates; // if present must contain 1 or 2 entries
+    SharedValue<std::optional<std::string> > m_mimeType;
     std::list<std::string>      m_segmentProfiles;
-    std::optional<Codecs>       m_codecs;
+    SharedValue<std::optional<Codecs> > m_codecs;
     std::list<std::string>      m_containerProfiles;
     std::optional<double>       m_maximumSAPPeriod;
     std::optional<SAP>          m_startWithSAP;
@@ -59,6 +59,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     SAP(xmlpp::Node &node);
     void setXMLElement(xmlpp::Element &elem) const;
 ///@endcond PROTECTED
@@ -137,8 +137,12 @@ protected:
     friend class Period;
     friend class Representation;
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     SegmentBase(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
+    // Fill in attributes and elements not set here from the same element at a higher level (ISO 23009-1:2022 Clause 5.3.9.1)
+    void inheritFrom(const SegmentBase &parent);
 ///@endcond PROTECTED
 
 private:
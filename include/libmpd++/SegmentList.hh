@@ -11,6 +11,8 @@
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
 #include <optional>
+#include <span>
+#include <vector>
 
 #include "macros.hh"
 #include "MultipleSegmentBase.hh"
@@ -86,19 +88,22 @@ public:
     SegmentList &xLink(const XLink &val) { m_xLink = val; return *this; };
     SegmentList &xLink(XLink &&val) { m_xLink = std::move(val); return *this; };
 
-    const std::list<SegmentURL> &segmentURLs() const { return m_segmentURLs; };
-    std::list<SegmentURL>::const_iterator segmentURLsBegin() const { return m_segmentURLs.cbegin(); };
-    std::list<SegmentURL>::const_iterator segmentURLsEnd() const { return m_segmentURLs.cend(); };
-    std::list<SegmentURL>::iterator segmentURLsBegin() { return m_segmentURLs.begin(); };
-    std::list<SegmentURL>::iterator segmentURLsEnd() { return m_segmentURLs.end(); };
+    std::span<const SegmentURL> segmentURLs() const { return m_segmentURLs; };
+    std::span<const SegmentURL>::iterator segmentURLsBegin() const { return segmentURLs().begin(); };
+    std::span<const SegmentURL>::iterator segmentURLsEnd() const { return segmentURLs().end(); };
+    std::span<SegmentURL>::iterator segmentURLsBegin() { return std::span<SegmentURL>(m_segmentURLs).begin(); };
+    std::span<SegmentURL>::iterator segmentURLsEnd() { return std::span<SegmentURL>(m_segmentURLs).end(); };
     SegmentList &segmentURLAdd(const SegmentURL &val) { m_segmentURLs.push_back(val); return *this; };
     SegmentList &segmentURLAdd(SegmentURL &&val) { m_segmentURLs.push_back(std::move(val)); return *this; };
-    SegmentList &segmentURLRemove(const SegmentURL &val) { m_segmentURLs.remove(val); return *this; };
-    SegmentList &segmentURLRemove(const std::list<SegmentURL>::const_iterator &it) { m_segmentURLs.erase(it); return *this; };
-    SegmentList &segmentURLRemove(const std::list<SegmentURL>::iterator &it) { m_segmentURLs.erase(it); return *this; };
+    SegmentList &segmentURLRemove(const SegmentURL &val) { std::erase(m_segmentURLs, val); return *this; };
+    SegmentList &segmentURLRemove(const std::span<const SegmentURL>::iterator &it);
+    SegmentList &segmentURLRemove(const std::span<SegmentURL>::iterator &it);
 
+    // Get the SegmentURL@media for a segment number, counting from 0 for the first SegmentURL
     const std::string &getMediaURLForSegment(unsigned long segment_number) const;
+    // Get the SegmentURL@media for the segment containing a time offset from Period start, in the current timescale
     const std::string &getMediaURLForSegmentTime(unsigned long time) const;
+    // Get the SegmentURL@media for the segment containing a wallclock duration since Period start
     const std::string &getMediaURLForSegmentTime(const duration_type &time) const;
     const std::string &getInitializationURL() const;
 
@@ -107,8 +112,11 @@ protected:
     friend class Period;
     friend class Representation;
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     SegmentList(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
+    void inheritFrom(const SegmentList &parent);
 ///@endcond PROTECTED
 
 private:
@@ -116,7 +124,7 @@ private:
     // Attributes
     std::optional<XLink> m_xLink;
     // Elements
-    std::list<SegmentURL> m_segmentURLs;
+    std::vector<SegmentURL> m_segmentURLs;
 };
 
 LIBMPDPP_NAMESPACE_END
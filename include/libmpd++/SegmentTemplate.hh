@@ -11,11 +11,16 @@
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "macros.hh"
 #include "MultipleSegmentBase.hh"
+#include "SharedValue.hh"
 
 /**@cond
  */
@@ -149,52 +154,135 @@ public:
     std::string formatInitializationTemplate(const Variables &) const;
     std::string formatBitstreamSwitchingTemplate(const Variables &) const;
 
+    /**@{*/
+    /** Format a template into a buffer
+     *
+     * Formats the template in the same way as the methods returning a `std::string`, but writes the result into a buffer
+     * supplied by the caller. Templates are compiled when they are set, so formatting does not allocate or throw. Template
+     * variables which are not available in @p vars are left unsubstituted in the output.
+     *
+     * The output is not nul terminated. If the returned length is greater than `buffer.size()` then the output did not fit and
+     * the buffer only holds the first `buffer.size()` characters, the call can be repeated with a buffer of the returned length.
+     *
+     * @param vars The variables to substitute into the template.
+     * @param buffer The buffer to write the formatted template to.
+     * @return The length of the formatted template, or 0 if the template attribute is not set.
+     */
+    std::size_t formatMediaTemplate(const Variables &vars, std::span<char> buffer) const noexcept;
+    std::size_t formatIndexTemplate(const Variables &vars, std::span<char> buffer) const noexcept;
+    std::size_t formatInitializationTemplate(const Variables &vars, std::span<char> buffer) const noexcept;
+    std::size_t formatBitstreamSwitchingTemplate(const Variables &vars, std::span<char> buffer) const noexcept;
+    /**@}*/
+
     // @media
     bool hasMedia() const { return m_media.has_value(); };
     const std::optional<std::string> &media() const { return m_media; };
-    SegmentTemplate &media(const std::nullopt_t&) { m_media.reset(); return *this; };
-    SegmentTemplate &media(const std::string &val) { m_media = val; return *this; };
-    SegmentTemplate &media(std::string &&val) { m_media = std::move(val); return *this; };
+    SegmentTemplate &media(const std::nullopt_t&) { m_media.reset(); m_mediaProgram = Program(); return *this; };
+    SegmentTemplate &media(const std::string &val) { m_media = val; m_mediaProgram = Program(val); return *this; };
+    SegmentTemplate &media(std::string &&val) {
+        m_media = std::move(val); m_mediaProgram = Program(m_media.value()); return *this;
+    };
 
     // @index
     bool hasIndex() const { return m_index.has_value(); };
     const std::optional<std::string> &index() const { return m_index; };
-    SegmentTemplate &index(const std::nullopt_t&) { m_index.reset(); return *this; };
-    SegmentTemplate &index(const std::string &val) { m_index = val; return *this; };
-    SegmentTemplate &index(std::string &&val) { m_index = std::move(val); return *this; };
+    SegmentTemplate &index(const std::nullopt_t&) { m_index.reset(); m_indexProgram = Program(); return *this; };
+    SegmentTemplate &index(const std::string &val) { m_index = val; m_indexProgram = Program(val); return *this; };
+    SegmentTemplate &index(std::string &&val) {
+        m_index = std::move(val); m_indexProgram = Program(m_index.value()); return *this;
+    };
 
     // @initialization
     bool hasInitialization() const { return m_initialization.has_value(); };
     const std::optional<std::string> &initialization() const { return m_initialization; };
-    SegmentTemplate &initialization(const std::nullopt_t&) { m_initialization.reset(); return *this; };
-    SegmentTemplate &initialization(const std::string &val) { m_initialization = val; return *this; };
-    SegmentTemplate &initialization(std::string &&val) { m_initialization = std::move(val); return *this; };
+    SegmentTemplate &initialization(const std::nullopt_t&) {
+        m_initialization.reset(); m_initializationProgram = Program(); return *this;
+    };
+    SegmentTemplate &initialization(const std::string &val) {
+        m_initialization = val; m_initializationProgram = Program(val); return *this;
+    };
+    SegmentTemplate &initialization(std::string &&val) {
+        m_initialization = std::move(val); m_initializationProgram = Program(m_initialization.value()); return *this;
+    };
 
     // @bitstreamSwitching
     bool hasBitstreamSwitching() const { return m_bitstreamSwitching.has_value(); };
     const std::optional<std::string> &bitstreamSwitching() const { return m_bitstreamSwitching; };
-    SegmentTemplate &bitstreamSwitching(const std::nullopt_t&) { m_bitstreamSwitching.reset(); return *this; };
-    SegmentTemplate &bitstreamSwitching(const std::string &val) { m_bitstreamSwitching = val; return *this; };
-    SegmentTemplate &bitstreamSwitching(std::string &&val) { m_bitstreamSwitching = std::move(val); return *this; };
+    SegmentTemplate &bitstreamSwitching(const std::nullopt_t&) {
+        m_bitstreamSwitching.reset(); m_bitstreamSwitchingProgram = Program(); return *this;
+    };
+    SegmentTemplate &bitstreamSwitching(const std::string &val) {
+        m_bitstreamSwitching = val; m_bitstreamSwitchingProgram = Program(val); return *this;
+    };
+    SegmentTemplate &bitstreamSwitching(std::string &&val) {
+        m_bitstreamSwitching = std::move(val); m_bitstreamSwitchingProgram = Program(m_bitstreamSwitching.value()); return *this;
+    };
 
 ///@cond PROTECTED
 protected:
     friend class Period;
     friend class AdaptationSet;
     friend class Representation;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
     SegmentTemplate(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
+    void inheritFrom(const SegmentTemplate &parent);
 ///@endcond PROTECTED
 
 private:
-    std::string formatTemplate(const std::string &fmt, const Variables &vars) const;
+    /* A template compiled into a list of literal text and variable substitution tokens
+     *
+     * Tokens refer to the template text by offset, so the text is passed to format() rather than held by the Program. This lets
+     * the template text itself be shared by a StringPool.
+     */
+    class Program {
+    public:
+        Program() :m_tokens() {};
+        explicit Program(const std::string &fmt);
+
+        std::size_t format(const std::string &fmt, const Variables &vars, const std::optional<unsigned int> &start_number,
+                           std::span<char> buffer) const noexcept;
+
+    private:
+        enum TokenType : std::uint8_t {
+            LITERAL,
+            REPRESENTATION_ID,
+            NUMBER,
+            BANDWIDTH,
+            TIME,
+            SUB_NUMBER
+        };
+
+        // For variables the offset and length are of the whole "$...$" identifier, which is output if the variable is not set
+        struct Token {
+            TokenType type;
+            std::uint16_t width;
+            std::uint32_t offset;
+            std::uint32_t length;
+        };
+
+        std::vector<Token> m_tokens;
+    };
+
+    std::string formatTemplate(const std::optional<std::string> &fmt, const Program &program, const Variables &vars) const;
+    std::size_t formatTemplate(const std::optional<std::string> &fmt, const Program &program, const Variables &vars,
+                               std::span<char> buffer) const noexcept;
+    void compileTemplates();
 
     // SegmentTemplate derived from ISO 23009-1:2022 Clause 5.3.9.4.3
     // Attributes
-    std::optional<std::string> m_media;
-    std::optional<std::string> m_index;
-    std::optional<std::string> m_initialization;
-    std::optional<std::string> m_bitstreamSwitching;
+    SharedValue<std::optional<std::string> > m_media;
+    SharedValue<std::optional<std::string> > m_index;
+    SharedValue<std::optional<std::string> > m_initialization;
+    SharedValue<std::optional<std::string> > m_bitstreamSwitching;
+
+    // Compiled forms of the template attributes, kept in step with the attribute values
+    Program m_mediaProgram;
+    Program m_indexProgram;
+    Program m_initializationProgram;
+    Program m_bitstreamSwitchingProgram;
 };
 
 LIBMPDPP_NAMESPACE_END
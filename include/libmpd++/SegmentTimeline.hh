@@ -12,10 +12,12 @@
  */
 #include <chrono>
 #include <optional>
-#include <list>
+#include <span>
+#include <vector>
 
 #include "macros.hh"
 #include "FailoverContent.hh"
+#include "MemoryResource.hh"
 #include "SingleRFC7233Range.hh"
 #include "URL.hh"
 
@@ -57,9 +59,35 @@ public:
 
         bool operator==(const S&) const;
 
+        // @t
+        bool hasT() const { return m_t.has_value(); };
+        const std::optional<unsigned long> &t() const { return m_t; };
+        S &t(const std::nullopt_t&) { m_t.reset(); return *this; };
+        S &t(unsigned long val) { m_t = val; return *this; };
+
+        // @n
+        bool hasN() const { return m_n.has_value(); };
+        const std::optional<unsigned long> &n() const { return m_n; };
+        S &n(const std::nullopt_t&) { m_n.reset(); return *this; };
+        S &n(unsigned long val) { m_n = val; return *this; };
+
+        // @d
+        unsigned long d() const { return m_d; };
+        S &d(unsigned long val) { m_d = val; return *this; };
+
+        // @r
+        int r() const { return m_r; };
+        S &r(int val) { m_r = val; return *this; };
+
+        // @k
+        unsigned long k() const { return m_k; };
+        S &k(unsigned long val) { m_k = val; return *this; };
+
     ///@cond PROTECTED
     protected:
         friend class SegmentTimeline;
+        friend class SnapshotReader;
+        friend class SnapshotWriter;
         S(xmlpp::Node&);
         void setXMLElement(xmlpp::Element&) const;
     ///@endcond PROTECTED
@@ -73,27 +101,72 @@ public:
         unsigned long m_k;
     };
 
-    SegmentTimeline() :m_sLines() {};
-    SegmentTimeline(const SegmentTimeline &other) :m_sLines(other.m_sLines) {};
-    SegmentTimeline(SegmentTimeline &&other) :m_sLines(std::move(other.m_sLines)) {};
+    SegmentTimeline() :m_sLines(), m_runs() {};
+    SegmentTimeline(const SegmentTimeline &other) :m_sLines(other.m_sLines), m_runs(other.m_runs) {};
+    SegmentTimeline(SegmentTimeline &&other) :m_sLines(std::move(other.m_sLines)), m_runs(std::move(other.m_runs)) {};
 
     virtual ~SegmentTimeline() {};
 
-    SegmentTimeline &operator=(const SegmentTimeline &other) { m_sLines = other.m_sLines; return *this; };
-    SegmentTimeline &operator=(SegmentTimeline &&other) { m_sLines = std::move(other.m_sLines); return *this; };
+    SegmentTimeline &operator=(const SegmentTimeline &other) { m_sLines = other.m_sLines; m_runs = other.m_runs; return *this; };
+    SegmentTimeline &operator=(SegmentTimeline &&other) {
+        m_sLines = std::move(other.m_sLines); m_runs = std::move(other.m_runs); return *this;
+    };
 
     bool operator==(const SegmentTimeline &other) const { return m_sLines == other.m_sLines; };
 
+    // S children
+    std::span<const S> sLines() const { return m_sLines; };
+    SegmentTimeline &sLineAdd(const S &s);
+    SegmentTimeline &sLineAdd(S &&s);
+    SegmentTimeline &sLinesClear() { m_sLines.clear(); m_runs.clear(); return *this; };
+
+    /* Segment addressing
+     *
+     * Segments are indexed from 0 in timeline order and times are media times (including any @presentationTimeOffset) in the
+     * timescale of the parent MultipleSegmentBase. The lookups use an index of the S entries with prefix sums of the segment
+     * counts, so they take O(log n) time in the number of S entries rather than expanding each @r.
+     */
+
+    // Get the number of segments, an S with @r of -1 at the end of the timeline repeats until end_time, or indefinitely if
+    // end_time is not given in which case std::nullopt is returned
+    std::optional<unsigned long> segmentCount(const std::optional<unsigned long> &end_time = std::nullopt) const;
+
+    // Get the start time of a segment, times for segments past the end of the timeline continue using the last @d
+    unsigned long segmentStartTime(unsigned long segment_index) const;
+
+    // Get the duration of a segment, segments past the end of the timeline have the last @d
+    unsigned long segmentDuration(unsigned long segment_index) const;
+
+    // Get the index of the segment containing media_time. If media_time is in a gap in the timeline the index of the following
+    // segment is returned, 0 is returned for times before the timeline and the segment count for times after it.
+    unsigned long segmentIndexForTime(unsigned long media_time) const;
+
 ///@cond PROTECTED
 protected:
     friend class MultipleSegmentBase;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     SegmentTimeline(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
 
 private:
+    // Each S entry expands to a run of segments with the same duration
+    struct Run {
+        unsigned long startTime;  // media time of the first segment in the run
+        unsigned long duration;   // S@d
+        unsigned long firstIndex; // number of segments in all previous runs
+        unsigned long count;      // number of segments in the run, 0 if it repeats until the end of the Period
+    };
+
+    std::vector<Run, TreeAllocator<Run> >::const_iterator findRunForIndex(unsigned long segment_index) const;
+    void buildIndex();
+
     // SegmentTimeline element from ISO 23009-1:2022 Clause 5.3.9.6.3
-    std::list<S> m_sLines;
+    std::vector<S, TreeAllocator<S> > m_sLines; // allocated from the MemoryResourceScope in effect when constructed
+
+    // Segment index built from m_sLines whenever they change
+    std::vector<Run, TreeAllocator<Run> > m_runs;
 };
 
 LIBMPDPP_NAMESPACE_END
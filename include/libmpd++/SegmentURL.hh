@@ -78,6 +78,9 @@ public:
 ///@cond PROTECTED
 protected:
     friend class Period;
+    friend class SegmentList;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     SegmentURL(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
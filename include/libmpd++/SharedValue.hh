@@ -0,0 +1,112 @@
+#ifndef _BBC_PARSE_DASH_MPD_SHARED_VALUE_HH_
+#define _BBC_PARSE_DASH_MPD_SHARED_VALUE_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: SharedValue class
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "macros.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/**@cond
+ */
+template <class T>
+struct is_std_optional : std::false_type {};
+
+template <class T>
+struct is_std_optional<std::optional<T> > : std::true_type {};
+/**@endcond
+ */
+
+/** Shared immutable value
+ * @headerfile libmpd++/SharedValue.hh <libmpd++/SharedValue.hh>
+ *
+ * Holds a value which can be shared between objects, for example attribute values that a StringPool has interned so that
+ * identical values in different MPDs use the same storage. The value is never modified in place, setting a new value replaces
+ * the reference to the shared value, so changing one object never changes another.
+ *
+ * A SharedValue converts to a const reference of the held type, so accessors can continue to return `const T&`. When the held
+ * type is a `std::optional` an empty SharedValue is the same as `std::nullopt` and takes no extra storage.
+ *
+ * @tparam T The type of value held.
+ */
+template <class T>
+class SharedValue {
+public:
+    using value_type = T;
+
+    SharedValue() :m_value() {};
+    SharedValue(const T &val) :m_value() { assign(T(val)); };
+    SharedValue(T &&val) :m_value() { assign(std::move(val)); };
+    SharedValue(std::shared_ptr<const T> val) :m_value(std::move(val)) {};
+    SharedValue(const SharedValue &other) = default;
+    SharedValue(SharedValue &&other) = default;
+
+    SharedValue &operator=(const SharedValue &other) = default;
+    SharedValue &operator=(SharedValue &&other) = default;
+    SharedValue &operator=(const T &val) { assign(T(val)); return *this; };
+    SharedValue &operator=(T &&val) { assign(std::move(val)); return *this; };
+
+    /** Get the held value
+     *
+     * @return A const reference to the held value, or a default constructed value if nothing is held.
+     */
+    const T &get() const { return m_value?*m_value:c_default; };
+    operator const T&() const { return get(); };
+
+    bool operator==(const SharedValue &other) const { return m_value == other.m_value || get() == other.get(); };
+    bool operator!=(const SharedValue &other) const { return !(*this == other); };
+    bool operator==(const T &other) const { return get() == other; };
+    bool operator!=(const T &other) const { return !(get() == other); };
+
+    /** Remove the held value
+     */
+    void reset() { m_value.reset(); };
+
+    /** Get the shared pointer to the held value
+     *
+     * @return The shared pointer, which will be empty if no value is held.
+     */
+    const std::shared_ptr<const T> &shared() const { return m_value; };
+
+    /**@{*/
+    /** std::optional style access for SharedValue<std::optional<...>>
+     */
+    bool has_value() const requires is_std_optional<T>::value { return m_value && m_value->has_value(); };
+    explicit operator bool() const requires is_std_optional<T>::value { return has_value(); };
+    const auto &value() const requires is_std_optional<T>::value { return get().value(); };
+    const auto &operator*() const requires is_std_optional<T>::value { return *get(); };
+    const auto *operator->() const requires is_std_optional<T>::value { return &*get(); };
+    /**@}*/
+
+private:
+    void assign(T &&val) {
+        if constexpr (is_std_optional<T>::value) {
+            if (!val.has_value()) {
+                m_value.reset();
+                return;
+            }
+        }
+        m_value = std::make_shared<const T>(std::move(val));
+    };
+
+    static inline const T c_default{};
+    std::shared_ptr<const T> m_value;
+};
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_SHARED_VALUE_HH_*/
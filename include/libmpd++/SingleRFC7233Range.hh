@@ -63,6 +63,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class Period;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     SingleRFC7233Range(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
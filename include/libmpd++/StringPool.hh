@@ -0,0 +1,145 @@
+#ifndef _BBC_PARSE_DASH_MPD_STRING_POOL_HH_
+#define _BBC_PARSE_DASH_MPD_STRING_POOL_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: StringPool class
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "macros.hh"
+#include "Codecs.hh"
+#include "SharedValue.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+class AdaptationSet;
+class ContentProtection;
+class Descriptor;
+class MPD;
+class Period;
+class Representation;
+class RepresentationBase;
+class SegmentTemplate;
+class URI;
+
+/** String interning pool
+ * @headerfile libmpd++/StringPool.hh <libmpd++/StringPool.hh>
+ *
+ * Deduplicates attribute values which are repeated within and across MPDs so that only one copy of each distinct value is held
+ * in memory. This is useful when a large number of similar MPDs, for example the manifests for many channels from the same
+ * packager, are kept in memory at the same time.
+ *
+ * The values interned are:
+ * - %URI strings, which includes \@profiles, BaseURL and Descriptor \@schemeIdUri values,
+ * - RepresentationBase \@mimeType and \@codecs,
+ * - AdaptationSet \@lang,
+ * - ContentProtection \@robustness,
+ * - SegmentTemplate \@media, \@index, \@initialization and \@bitstreamSwitching.
+ *
+ * A pool is normally given to the MPD parser using MPD::ParseOptions::stringPool() and can be shared by any number of MPDs. The
+ * interned values are immutable, setting a value on one MPD never changes the value seen by another MPD using the same pool.
+ * Values stay in the pool until purge() is called after the MPDs using them have been destroyed.
+ *
+ * All methods are thread-safe, so MPDs sharing a pool can be parsed in different threads.
+ */
+class LIBMPDPP_PUBLIC_API StringPool {
+public:
+    /** Default constructor
+     *
+     * Creates an empty pool.
+     */
+    StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool &operator=(const StringPool&) = delete;
+
+    /** Destructor
+     *
+     * Values interned from this pool remain valid in the objects using them after the pool is destroyed.
+     */
+    virtual ~StringPool();
+
+    /** Intern all the values in an MPD
+     *
+     * The Periods of an MPD parsed using MPD::ParseOptions::lazyPeriods() are interned when they are materialised if the MPD was
+     * parsed using this pool, otherwise only the materialised Periods are interned.
+     *
+     * @param mpd The MPD to intern the values of.
+     */
+    void intern(MPD &mpd);
+
+    /** Intern all the values in a Period
+     *
+     * @param period The Period to intern the values of.
+     */
+    void intern(Period &period);
+
+    /** Intern a %URI
+     *
+     * @param uri The URI to intern the string of.
+     */
+    void intern(URI &uri);
+
+    /**@{*/
+    /** Intern a single value
+     *
+     * If an equal value is already in the pool then @p value will be changed to share the pooled value, otherwise the value is
+     * added to the pool.
+     *
+     * @param value The value to intern.
+     */
+    void intern(SharedValue<std::string> &value);
+    void intern(SharedValue<std::optional<std::string> > &value);
+    void intern(SharedValue<std::optional<Codecs> > &value);
+    /**@}*/
+
+    /** Get the number of distinct values in the pool
+     *
+     * @return The number of values held in the pool.
+     */
+    std::size_t size() const;
+
+    /** Remove unused values
+     *
+     * Removes the values which are not used by any object outside of the pool.
+     *
+     * @return The number of values removed from the pool.
+     */
+    std::size_t purge();
+
+private:
+    void intern(AdaptationSet &adapt_set);
+    void intern(Representation &rep);
+    void intern(RepresentationBase &rep_base);
+    void intern(Descriptor &descriptor);
+    void intern(ContentProtection &content_protection);
+    void intern(SegmentTemplate &seg_template);
+
+    // Find the pooled value for str, adding the value made by make_value if there is no pooled value yet
+    template <class F>
+    std::shared_ptr<const std::optional<std::string> > findOrAdd(std::string_view str, F make_value);
+
+    mutable std::shared_mutex m_mutex;
+    // Keys are views of the pooled strings
+    std::unordered_map<std::string_view, std::shared_ptr<const std::optional<std::string> > > m_strings;
+    // Keys are the @codecs attribute values
+    std::unordered_map<std::string, std::shared_ptr<const std::optional<Codecs> > > m_codecs;
+};
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_STRING_POOL_HH_*/
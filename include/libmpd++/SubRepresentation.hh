@@ -56,6 +56,8 @@ public:
 ///@cond PROTECTED
 protected:
     friend class Representation;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     SubRepresentation(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
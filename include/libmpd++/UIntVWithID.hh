@@ -11,7 +11,9 @@
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
 #include <iostream>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "macros.hh"
 
@@ -36,16 +38,16 @@ class LIBMPDPP_PUBLIC_API UIntVWithID : public std::list<unsigned int> {
 public:
     UIntVWithID() = delete;
     UIntVWithID(unsigned int id,
-                const std::list<URI> &profiles = std::list<URI>{},
+                const std::vector<URI> &profiles = std::vector<URI>{},
                 const std::optional<RFC6838ContentType> &content_type = std::nullopt);
     UIntVWithID(const std::list<unsigned int> &init, unsigned int id,
-                const std::list<URI> &profiles = std::list<URI>{},
+                const std::vector<URI> &profiles = std::vector<URI>{},
                 const std::optional<RFC6838ContentType> &content_type = std::nullopt);
     UIntVWithID(std::list<unsigned int> &&init, unsigned int id,
-                const std::list<URI> &profiles = std::list<URI>{},
+                const std::vector<URI> &profiles = std::vector<URI>{},
                 const std::optional<RFC6838ContentType> &content_type = std::nullopt);
     UIntVWithID(std::initializer_list<unsigned int> init, unsigned int id,
-                const std::list<URI> &profiles = std::list<URI>{},
+                const std::vector<URI> &profiles = std::vector<URI>{},
                 const std::optional<RFC6838ContentType> &content_type = std::nullopt);
     UIntVWithID(const UIntVWithID &to_copy);
     UIntVWithID(UIntVWithID &&to_move);
@@ -64,19 +66,19 @@ public:
     UIntVWithID &id(unsigned int val) { m_id = val; return *this; };
 
     // @profiles
-    const std::list<URI> &profiles() const { return m_profiles; };
-    std::list<URI>::const_iterator profilesBegin() const { return m_profiles.cbegin(); };
-    std::list<URI>::iterator profilesBegin() { return m_profiles.begin(); };
-    std::list<URI>::const_iterator profilesEnd() const { return m_profiles.cend(); };
-    std::list<URI>::iterator profilesEnd() { return m_profiles.end(); };
-    const URI &profile(std::list<URI>::size_type idx) const;
-    UIntVWithID &profiles(const std::list<URI> &val) { m_profiles = val; return *this; };
-    UIntVWithID &profiles(std::list<URI> &&val) { m_profiles = std::move(val); return *this; };
+    std::span<const URI> profiles() const { return m_profiles; };
+    std::span<const URI>::iterator profilesBegin() const { return profiles().begin(); };
+    std::span<URI>::iterator profilesBegin() { return std::span<URI>(m_profiles).begin(); };
+    std::span<const URI>::iterator profilesEnd() const { return profiles().end(); };
+    std::span<URI>::iterator profilesEnd() { return std::span<URI>(m_profiles).end(); };
+    const URI &profile(std::vector<URI>::size_type idx) const;
+    UIntVWithID &profiles(const std::vector<URI> &val) { m_profiles = val; return *this; };
+    UIntVWithID &profiles(std::vector<URI> &&val) { m_profiles = std::move(val); return *this; };
     UIntVWithID &profilesAdd(const URI &val) { m_profiles.push_back(val); return *this; };
     UIntVWithID &profilesAdd(URI &&val) { m_profiles.push_back(std::move(val)); return *this; };
     UIntVWithID &profilesRemove(const URI &val);
-    UIntVWithID &profilesRemove(const std::list<URI>::const_iterator &it);
-    UIntVWithID &profilesRemove(const std::list<URI>::iterator &it);
+    UIntVWithID &profilesRemove(const std::span<const URI>::iterator &it);
+    UIntVWithID &profilesRemove(const std::span<URI>::iterator &it);
 
     // @contentType
     bool hasContentType() const { return m_contentType.has_value(); };
@@ -90,13 +92,15 @@ public:
 ///@cond PROTECTED
 protected:
     friend class MPD;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     UIntVWithID(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
 
 private:
     unsigned int                      m_id;
-    std::list<URI>                    m_profiles;
+    std::vector<URI>                  m_profiles;
     std::optional<RFC6838ContentType> m_contentType;
 };
 
@@ -10,11 +10,13 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <cstdint>
 #include <iostream>
 #include <list>
 #include <string>
 
 #include "macros.hh"
+#include "SharedValue.hh"
 
 /**@cond
  */
@@ -39,24 +41,24 @@ class BaseURL;
  */
 class LIBMPDPP_PUBLIC_API URI {
 public:
-    URI() :m_uri() {};
-    URI(const char *uri) :m_uri(uri) {validate();};
-    URI(const std::string &uri) :m_uri(uri) {validate();};
-    URI(std::string &&uri) :m_uri(std::move(uri)) {validate();};
-    URI(const URI &other) :m_uri(other.m_uri) {};
-    URI(URI &&other) :m_uri(std::move(other.m_uri)) {};
+    URI() :m_uri(), m_components() {};
+    URI(const char *uri) :m_uri(uri), m_components() {validate();};
+    URI(const std::string &uri) :m_uri(uri), m_components() {validate();};
+    URI(std::string &&uri) :m_uri(std::move(uri)), m_components() {validate();};
+    URI(const URI &other) :m_uri(other.m_uri), m_components(other.m_components) {};
+    URI(URI &&other) :m_uri(std::move(other.m_uri)), m_components(other.m_components) {};
 
     virtual ~URI() {};
 
-    URI &operator=(const URI &other) { m_uri = other.m_uri; return *this; };
-    URI &operator=(URI &&other) { m_uri = std::move(other.m_uri); return *this; };
+    URI &operator=(const URI &other) { m_uri = other.m_uri; m_components = other.m_components; return *this; };
+    URI &operator=(URI &&other) { m_uri = std::move(other.m_uri); m_components = other.m_components; return *this; };
     URI &operator=(const std::string &val) { m_uri = val; validate(); return *this; };
     URI &operator=(std::string &&val) { m_uri = std::move(val); validate(); return *this; };
 
     bool operator==(const URI &other) const { return m_uri == other.m_uri; };
 
-    operator std::string() const { return m_uri; };
-    const std::string &str() const { return m_uri; };
+    operator std::string() const { return m_uri.get(); };
+    const std::string &str() const { return m_uri.get(); };
 
     URI resolveUsingBaseURLs(const std::list<BaseURL> &base_urls) const;
     bool isURL() const;
@@ -70,14 +72,32 @@ protected:
     friend class Representation;
     friend class BaseURL;
     friend class SegmentBase;
+    friend class DecomposedURL;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
+    friend class StringPool;
     URI(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
+
+    // Offsets of the RFC 3986 components in a URI string, also used by DecomposedURL
+    struct Components {
+        static constexpr std::uint32_t NONE = UINT32_MAX;
+        Components() :schemeLength(0), authorityStart(NONE), pathStart(0), queryStart(NONE), fragmentStart(NONE) {};
+        std::uint32_t schemeLength;   // Length of the scheme name or 0 if there is no scheme
+        std::uint32_t authorityStart; // Offset of the authority (after the "//") or NONE if there is no authority
+        std::uint32_t pathStart;      // Offset of the path, also the end of the authority
+        std::uint32_t queryStart;     // Offset of the '?' starting the query or NONE if there is no query
+        std::uint32_t fragmentStart;  // Offset of the '#' starting the fragment or NONE if there is no fragment
+    };
 ///@endcond PROTECTED
 
 private:
     void validate();
 
-    std::string m_uri;
+    SharedValue<std::string> m_uri;
+
+    // Offsets of the RFC 3986 components in m_uri, found by validate()
+    Components m_components;
 };
 
 LIBMPDPP_NAMESPACE_END
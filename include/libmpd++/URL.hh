@@ -70,6 +70,8 @@ protected:
     friend class BaseURL;
     friend class SegmentBase;
     friend class MultipleSegmentBase;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     URL(xmlpp::Node&);
     void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
@@ -107,6 +107,8 @@ public:
 protected:
     friend class Period;
     friend class AdaptationSet;
+    friend class SnapshotReader;
+    friend class SnapshotWriter;
     //XLink(xmlpp::Node&);
     //void setXMLElement(xmlpp::Element&) const;
 ///@endcond PROTECTED
@@ -11,6 +11,7 @@
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
 #include <exception>
+#include <stdexcept>
 
 #include "macros.hh"
 
@@ -56,6 +57,20 @@ public:
     virtual ~RangeError() = default;
 };
 
+/** PatchError exception class
+ * @headerfile libmpd++/exceptions.hh <libmpd++/exceptions.hh>
+ *
+ * This type is thrown when an MPD Patch cannot be applied to an %MPD, for example because it is for a different %MPD or a
+ * different version of the %MPD, or one of its selectors does not match the %MPD. The full %MPD should be fetched again.
+ */
+class LIBMPDPP_PUBLIC_API PatchError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+    using std::runtime_error::operator=;
+
+    virtual ~PatchError() = default;
+};
+
 LIBMPDPP_NAMESPACE_END
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
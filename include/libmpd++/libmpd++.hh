@@ -224,6 +224,24 @@
  * }
  * @endcode
  *
+ * To read a large MPD file without holding the whole XML document in memory at once:
+ * @code{.cpp}
+ * #include <string>
+ * #include <libmpd++/libmpd++.hh>
+ *
+ * LIBMPDPP_NAMESPACE_USING_ALL;
+ *
+ *   .
+ *   .
+ *   .
+ *
+ * {
+ *     const std::string filename("/path/to/manifest.mpd");
+ *     const std::string original_url("https://example.com/media/manifest.mpd");
+ *     MPD mpd(filename, original_url, MPD::PARSER_STREAMING);
+ * }
+ * @endcode
+ *
  * To create a new MPD:
  * @code{.cpp}
  * #include <chrono>
@@ -301,9 +319,11 @@
 #include "InitializationSet.hh"
 #include "Label.hh"
 #include "LeapSecondInformation.hh"
+#include "MemoryResource.hh"
 #include "Metrics.hh"
 #include "MPD.hh"
 #include "MultipleSegmentBase.hh"
+#include "ParseFilter.hh"
 #include "PatchLocation.hh"
 #include "Period.hh"
 #include "Preselection.hh"
@@ -323,7 +343,9 @@
 #include "SegmentTimeline.hh"
 #include "SegmentURL.hh"
 #include "ServiceDescription.hh"
+#include "SharedValue.hh"
 #include "SingleRFC7233Range.hh"
+#include "StringPool.hh"
 #include "SubRepresentation.hh"
 #include "Subset.hh"
 #include "Switching.hh"
@@ -13,8 +13,10 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <glibmm/ustring.h>
 #include <libxml++/libxml++.h>
 #include <libxml/tree.h>
@@ -30,6 +32,8 @@
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "parse_tables.hh"
+#include "span_iterators.hh"
 #include "stream_ops.hh"
 
 #include "libmpd++/AdaptationSet.hh"
@@ -66,6 +70,7 @@ AdaptationSet::AdaptationSet()
     ,m_viewpoints()
     ,m_contentComponents()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_segmentBase()
     ,m_segmentList()
     ,m_segmentTemplate()
@@ -103,6 +108,7 @@ AdaptationSet::AdaptationSet(const AdaptationSet &other)
     ,m_viewpoints(other.m_viewpoints)
     ,m_contentComponents(other.m_contentComponents)
     ,m_baseURLs(other.m_baseURLs)
+    ,m_baseURLCache()
     ,m_segmentBase(other.m_segmentBase)
     ,m_segmentList(other.m_segmentList)
     ,m_segmentTemplate(other.m_segmentTemplate)
@@ -150,6 +156,7 @@ AdaptationSet::AdaptationSet(AdaptationSet &&other)
     ,m_viewpoints(std::move(other.m_viewpoints))
     ,m_contentComponents(std::move(other.m_contentComponents))
     ,m_baseURLs(std::move(other.m_baseURLs))
+    ,m_baseURLCache()
     ,m_segmentBase(std::move(other.m_segmentBase))
     ,m_segmentList(std::move(other.m_segmentList))
     ,m_segmentTemplate(std::move(other.m_segmentTemplate))
@@ -198,9 +205,11 @@ AdaptationSet &AdaptationSet::operator=(const AdaptationSet &other)
     m_viewpoints = other.m_viewpoints;
     m_contentComponents = other.m_contentComponents;
     m_baseURLs = other.m_baseURLs;
+    invalidateBaseURLs();
     m_segmentBase = other.m_segmentBase;
     m_segmentList = other.m_segmentList;
     m_segmentTemplate = other.m_segmentTemplate;
+    invalidateAddressing();
     m_representations.clear();
     for (auto &rep : other.m_representations) {
         auto it = m_selectedRepresentations.find(&rep);
@@ -247,9 +256,11 @@ AdaptationSet &AdaptationSet::operator=(AdaptationSet &&other)
     m_viewpoints = std::move(other.m_viewpoints);
     m_contentComponents = std::move(other.m_contentComponents);
     m_baseURLs = std::move(other.m_baseURLs);
+    invalidateBaseURLs();
     m_segmentBase = std::move(other.m_segmentBase);
     m_segmentList = std::move(other.m_segmentList);
     m_segmentTemplate = std::move(other.m_segmentTemplate);
+    invalidateAddressing();
     m_representations.clear();
 
     for (auto &rep : other.m_representations) {
@@ -332,29 +343,21 @@ const MPD *AdaptationSet::getMPD() const
     return nullptr;
 }
 
-std::list<BaseURL> AdaptationSet::getBaseURLs() const
+const std::list<BaseURL> &AdaptationSet::getBaseURLs() const
 {
     if (m_baseURLs.size() == 0 && m_period) return m_period->getBaseURLs();
 
-    std::list<BaseURL> ret;
-    std::list<BaseURL> parent_urls_cache;
-    bool have_parent_urls = false;
-    for (const auto &base_url : m_baseURLs) {
-        if (base_url.url().isAbsoluteURL()) {
-            ret.push_back(base_url);
-        } else {
-            if (m_period) {
-                if (!have_parent_urls) {
-                    parent_urls_cache = m_period->getBaseURLs();
-                    have_parent_urls = true;
-                }
-                ret.push_back(base_url.resolveURL(parent_urls_cache));
-            } else {
+    return m_baseURLCache.get(MPD::baseURLGeneration(getMPD()), [this]() {
+        std::list<BaseURL> ret;
+        for (const auto &base_url : m_baseURLs) {
+            if (base_url.url().isAbsoluteURL() || !m_period) {
                 ret.push_back(base_url);
+            } else {
+                ret.push_back(base_url.resolveURL(m_period->getBaseURLs()));
             }
         }
-    }
-    return ret;
+        return ret;
+    });
 }
 
 /* protected: */
@@ -389,239 +392,97 @@ AdaptationSet::AdaptationSet(xmlpp::Node &node)
     ,m_viewpoints()
     ,m_contentComponents()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_segmentBase()
     ,m_segmentList()
     ,m_segmentTemplate()
     ,m_representations()
 {
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}, {"xlink", XLINK_NS}
-    };
-    xmlpp::Node::NodeSet node_set;
-
-    node_set = node.find("@xlink:href", ns_map);
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        std::string xlink_href = attr->get_value();
+    const xmlAttr *xlink_href_attr = xmlHasNsProp(node.cobj(), reinterpret_cast<const xmlChar*>("href"),
+                                                  reinterpret_cast<const xmlChar*>(XLINK_NS));
+    if (xlink_href_attr) {
+        std::string xlink_href = xml_attribute_value(xlink_href_attr);
         auto actuate = XLink::ACTUATE_ON_REQUEST;
-        node_set = node.find("@xlink:actuate", ns_map);
-        if (node_set.size() > 0) {
-            attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-            std::string xlink_actuate = attr->get_value();
+        const xmlAttr *xlink_actuate_attr = xmlHasNsProp(node.cobj(), reinterpret_cast<const xmlChar*>("actuate"),
+                                                         reinterpret_cast<const xmlChar*>(XLINK_NS));
+        if (xlink_actuate_attr) {
+            std::string xlink_actuate = xml_attribute_value(xlink_actuate_attr);
             if (xlink_actuate == "onLoad") actuate = XLink::ACTUATE_ON_LOAD;
             else if (xlink_actuate != "onRequest") throw ParseError("AdaptationSet/@xlink:actuate can only be either \"onLoad\" or \"onRequest\"");
         }
         m_xlink = XLink(xlink_href, actuate, XLink::TYPE_SIMPLE, XLink::SHOW_EMBED);
     }
 
-    node_set = node.find("@id");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_id =static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
-
-    node_set = node.find("@group");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_group =static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
-
-    node_set = node.find("@lang");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_lang = std::string(attr->get_value());
-    }
-
-    node_set = node.find("@contentType");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_contentType = RFC6838ContentType(std::string(attr->get_value()));
-    }
-
-    node_set = node.find("@par");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_par = Ratio(std::string(attr->get_value()));
-    }
-
-    node_set = node.find("@minBandwidth");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_minBandwidth = std::stod(attr->get_value());
-    }
-
-    node_set = node.find("@maxBandwidth");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_maxBandwidth = std::stod(attr->get_value());
-    }
-
-    node_set = node.find("@minWidth");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_minWidth =static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
-
-    node_set = node.find("@maxWidth");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_maxWidth =static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
-
-    node_set = node.find("@minHeight");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_minHeight =static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
-
-    node_set = node.find("@maxHeight");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_maxHeight =static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
-
-    node_set = node.find("@minFrameRate");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_minFrameRate = FrameRate(std::string(attr->get_value()));
-    }
-
-    node_set = node.find("@maxFrameRate");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_maxFrameRate = FrameRate(std::string(attr->get_value()));
-    }
-
-    node_set = node.find("@segmentAlignment");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        if (attr->get_value() == "true" || attr->get_value() == "1") {
-            m_segmentAlignment = true;
-        } else if (attr->get_value() == "false" || attr->get_value() == "0") {
-            m_segmentAlignment = false;
-        } else {
-            throw ParseError("AdaptationSet/@segmentAlignment can only be \"true\", \"1\", \"false\" or \"0\", if present");
-        }
-    }
-
-    node_set = node.find("@subsegmentAlignment");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        if (attr->get_value() == "true" || attr->get_value() == "1") {
-            m_subsegmentAlignment = true;
-        } else if (attr->get_value() == "false" || attr->get_value() == "0") {
-            m_subsegmentAlignment = false;
-        } else {
-            throw ParseError("AdaptationSet/@subsegmentAlignment can only be \"true\", \"1\", \"false\" or \"0\", if present");
-        }
-    }
-
-    node_set = node.find("@subsegmentStartsWithSAP");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_subsegmentStartsWithSAP = SAP(std::string(attr->get_value()));
-    }
-
-    node_set = node.find("@bitstreamSwitching");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        if (attr->get_value() == "true" || attr->get_value() == "1") {
-            m_bitstreamSwitching = true;
-        } else if (attr->get_value() == "false" || attr->get_value() == "0") {
-            m_bitstreamSwitching = false;
-        } else {
-            throw ParseError("AdaptationSet/@bitstreamSwitching can only be \"true\", \"1\", \"false\" or \"0\", if present");
-        }
-    }
-
-    node_set = node.find("@initializationSetRef", ns_map);
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        std::string::size_type start_pos = 0;
-        std::string attr_val = attr->get_value();
-        for (auto pos = attr_val.find_first_of(','); pos != std::string::npos; start_pos = pos+1, pos = attr_val.find_first_of(',')) {
-            auto val = attr_val.substr(start_pos, pos - start_pos);
-            if (!val.empty()) {
-                m_initializationSetRefs.push_back(static_cast<unsigned int>(std::stoul(val)));
-            }
-        }
-        auto val = attr_val.substr(start_pos);
-        if (!val.empty()) {
-            m_initializationSetRefs.push_back(static_cast<unsigned int>(std::stoul(val)));
-        }
-    }
-
-    node_set = node.find("@initializationPrincipal");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_initializationPrincipal = std::string(attr->get_value());
-    }
-
-    node_set = node.find("mpd:Accessibility", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_accessibilities.push_back(Descriptor(*node));
-        }
-    }
-
-    node_set = node.find("mpd:Role", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_roles.push_back(Descriptor(*node));
-        }
-    }
-
-    node_set = node.find("mpd:Rating", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_ratings.push_back(Descriptor(*node));
-        }
-    }
-
-    node_set = node.find("mpd:Viewpoint", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_viewpoints.push_back(Descriptor(*node));
-        }
-    }
-
-    node_set = node.find("mpd:ContentComponent", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_contentComponents.push_back(ContentComponent(*node));
-        }
-    }
-
-    node_set = node.find("mpd:BaseURL", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_baseURLs.push_back(BaseURL(*node));
-        }
-    }
-
-    node_set = node.find("mpd:SegmentBase", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentBase = SegmentBase(*node_set.front());
-    }
-
-    node_set = node.find("mpd:SegmentList", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentList = SegmentList(*node_set.front());
-    }
-
-    node_set = node.find("mpd:SegmentTemplate", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentTemplate = SegmentTemplate(*node_set.front());
-    }
-
-    node_set = node.find("mpd:Representation", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_representations.push_back(Representation(*node));
-            m_representations.back().setAdaptationSet(this);
-        }
-    }
+#define ATTR_FN(name, fn) {#name, [](AdaptationSet &as, const std::string &val) { as.m_ ## name = fn(val); }}
+#define ATTR_BOOL(name) {#name, [](AdaptationSet &as, const std::string &val) { \
+            if (val == "true" || val == "1") { \
+                as.m_ ## name = true; \
+            } else if (val == "false" || val == "0") { \
+                as.m_ ## name = false; \
+            } else { \
+                throw ParseError("AdaptationSet/@" #name " can only be \"true\", \"1\", \"false\" or \"0\", if present"); \
+            } \
+        }}
+#define CHILD_LIST(name, var, cls) {#name, [](AdaptationSet &as, xmlpp::Node &child) { as.var.push_back(cls(child)); }}
+#define CHILD_FIRST(name, var, cls) {#name, [](AdaptationSet &as, xmlpp::Node &child) { if (!as.var) as.var = cls(child); }}
+
+    static const AttributeTable<AdaptationSet> attribute_table("AdaptationSet", {
+        ATTR_FN(id, str_to_ui),
+        ATTR_FN(group, str_to_ui),
+        ATTR_FN(lang, std::string),
+        ATTR_FN(contentType, RFC6838ContentType),
+        ATTR_FN(par, Ratio),
+        ATTR_FN(minBandwidth, std::stod),
+        ATTR_FN(maxBandwidth, std::stod),
+        ATTR_FN(minWidth, str_to_ui),
+        ATTR_FN(maxWidth, str_to_ui),
+        ATTR_FN(minHeight, str_to_ui),
+        ATTR_FN(maxHeight, str_to_ui),
+        ATTR_FN(minFrameRate, FrameRate),
+        ATTR_FN(maxFrameRate, FrameRate),
+        ATTR_BOOL(segmentAlignment),
+        ATTR_BOOL(subsegmentAlignment),
+        ATTR_FN(subsegmentStartsWithSAP, SAP),
+        ATTR_BOOL(bitstreamSwitching),
+        {"initializationSetRef", [](AdaptationSet &as, const std::string &val) { as.m_initializationSetRefs = str_to_vector<unsigned int>(val); }},
+        ATTR_FN(initializationPrincipal, URI)
+    });
+
+    static const ElementTable<AdaptationSet> element_table({
+        CHILD_LIST(Accessibility, m_accessibilities, Descriptor),
+        CHILD_LIST(Role, m_roles, Descriptor),
+        CHILD_LIST(Rating, m_ratings, Descriptor),
+        CHILD_LIST(Viewpoint, m_viewpoints, Descriptor),
+        CHILD_LIST(ContentComponent, m_contentComponents, ContentComponent),
+        CHILD_LIST(BaseURL, m_baseURLs, BaseURL),
+        CHILD_FIRST(SegmentBase, m_segmentBase, SegmentBase),
+        CHILD_FIRST(SegmentList, m_segmentList, SegmentList),
+        CHILD_FIRST(SegmentTemplate, m_segmentTemplate, SegmentTemplate),
+        {"Representation", [](AdaptationSet &as, xmlpp::Node &child) {
+            as.m_representations.push_back(Representation(child));
+            as.m_representations.back().setAdaptationSet(&as);
+        }}
+    });
+
+#undef CHILD_FIRST
+#undef CHILD_LIST
+#undef ATTR_BOOL
+#undef ATTR_FN
+
+    attribute_table.apply(*this, node);
+    element_table.apply(*this, node);
+}
+
+AdaptationSet &AdaptationSet::initializationSetRefRemove(const std::span<const unsigned int>::iterator &it)
+{
+    m_initializationSetRefs.erase(vector_iterator(m_initializationSetRefs, it));
+    return *this;
+}
 
+AdaptationSet &AdaptationSet::initializationSetRefRemove(const std::span<unsigned int>::iterator &it)
+{
+    m_initializationSetRefs.erase(vector_iterator(m_initializationSetRefs, it));
+    return *this;
 }
 
 const Descriptor &AdaptationSet::accessibility(std::list<Descriptor>::size_type idx) const
@@ -867,30 +728,35 @@ bool AdaptationSet::baseURLsContains(const BaseURL &base_url) const
 AdaptationSet &AdaptationSet::baseURLsAdd(const BaseURL &base_url)
 {
     m_baseURLs.push_back(base_url);
+    invalidateBaseURLs();
     return *this;
 }
 
 AdaptationSet &AdaptationSet::baseURLsAdd(BaseURL &&base_url)
 {
     m_baseURLs.push_back(std::move(base_url));
+    invalidateBaseURLs();
     return *this;
 }
 
 AdaptationSet &AdaptationSet::baseURLsRemove(const BaseURL &base_url)
 {
     m_baseURLs.remove(base_url);
+    invalidateBaseURLs();
     return *this;
 }
 
 AdaptationSet &AdaptationSet::baseURLsRemove(const std::list<BaseURL>::const_iterator &it)
 {
     m_baseURLs.erase(it);
+    invalidateBaseURLs();
     return *this;
 }
 
 AdaptationSet &AdaptationSet::baseURLsRemove(const std::list<BaseURL>::iterator &it)
 {
     m_baseURLs.erase(it);
+    invalidateBaseURLs();
     return *this;
 }
 
@@ -1193,160 +1059,6 @@ void AdaptationSet::setXMLElement(xmlpp::Element &elem) const
     }
 }
 
-std::string AdaptationSet::getMediaURL(const SegmentTemplate::Variables &vars) const
-{
-    if (m_segmentTemplate.has_value()) {
-        return m_segmentTemplate.value().formatMediaTemplate(vars);
-    }
-    if (m_segmentList.has_value()) {
-        if (vars.number()) {
-            return m_segmentList.value().getMediaURLForSegment(vars.number().value());
-        } else if (vars.time()) {
-            return m_segmentList.value().getMediaURLForSegmentTime(vars.time().value());
-        }
-    }
-    if (m_period) {
-        return m_period->getMediaURL(vars);
-    }
-    return std::string();
-}
-
-std::string AdaptationSet::getInitializationURL(const SegmentTemplate::Variables &vars) const
-{
-    if (m_segmentTemplate.has_value()) {
-        return m_segmentTemplate.value().formatInitializationTemplate(vars);
-    }
-    if (m_segmentList.has_value()) {
-        return m_segmentList.value().getInitializationURL();
-    }
-    if (m_period) {
-        return m_period->getInitializationURL(vars);
-    }
-    return std::string();
-}
-
-SegmentAvailability AdaptationSet::getMediaAvailability(const SegmentTemplate::Variables &vars) const
-{
-    SegmentAvailability ret;
-    std::list<BaseURL> base_urls;
-    const MPD *mpd = getMPD();
-
-    if (m_segmentTemplate.has_value()) {
-        base_urls = getBaseURLs();
-        unsigned int ts = 1;
-        if (m_segmentTemplate.value().hasTimescale()) {
-            ts = m_segmentTemplate.value().timescale().value();
-        }
-        if (base_urls.empty()) {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->availabilityStartTime().value() + vars.timeAsDurationType(ts));
-            }
-        } else {
-            const BaseURL &base_url = base_urls.front();
-            if (base_url.hasAvailabilityTimeOffset()) {
-                if (mpd && mpd->hasAvailabilityStartTime()) {
-                    if (std::isnan(base_url.availabilityTimeOffset().value())) {
-                        // All segments available at the MPD@availabilityStartTime
-                        ret.availabilityStartTime(mpd->availabilityStartTime().value());
-                    } else {
-                        // available at MPD@availabilityStartTime - @availabilityTimeOffset + segment_time
-                        ret.availabilityStartTime(mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1>>(base_url.availabilityTimeOffset().value())) + vars.timeAsDurationType(ts));
-                    }
-                }
-            } else if (mpd && mpd->hasAvailabilityStartTime()) {
-                // available at MPD@availabilityStartTime + segment_time
-                ret.availabilityStartTime(mpd->availabilityStartTime().value() + vars.timeAsDurationType(ts));
-            }
-        }
-        if (mpd) {
-            if (mpd->hasAvailabilityEndTime()) {
-                ret.availabilityEndTime(mpd->presentationTimeToSystemTime(mpd->availabilityEndTime().value()));
-            }
-            ret.availabilityStartTime(mpd->presentationTimeToSystemTime(ret.availabilityStartTime()));
-        }
-        if (m_segmentTemplate.value().hasDuration()) {
-            ret.segmentDuration(m_segmentTemplate.value().durationAsDurationType());
-            if (mpd && mpd->isLive()) {
-                ret.availabilityStartTime(ret.availabilityStartTime() + std::chrono::duration_cast<time_type::duration>(ret.segmentDuration()));
-            }
-        }
-        ret.segmentURL(URI(m_segmentTemplate.value().formatMediaTemplate(vars)).resolveUsingBaseURLs(base_urls));
-    } else if (m_segmentList.has_value()) {
-        base_urls = getBaseURLs();
-        if (base_urls.empty()) {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->availabilityStartTime().value());
-            }
-        } else {
-            const BaseURL &base_url = base_urls.front();
-            if (base_url.hasAvailabilityTimeOffset() && !std::isnan(base_url.availabilityTimeOffset().value())) {
-                if (mpd && mpd->hasAvailabilityStartTime()) {
-                    ret.availabilityStartTime(mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1>>(base_url.availabilityTimeOffset().value())));
-                }
-            } else if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->availabilityStartTime().value());
-            }
-        }
-        ret.segmentDuration(m_segmentList.value().durationAsDurationType());
-        if (mpd) {
-            if (mpd->hasAvailabilityEndTime()) {
-                ret.availabilityEndTime(mpd->presentationTimeToSystemTime(mpd->availabilityEndTime().value()));
-            }
-            ret.availabilityStartTime(mpd->presentationTimeToSystemTime(ret.availabilityStartTime()));
-            if (mpd->isLive()) {
-                ret.availabilityStartTime(ret.availabilityStartTime() + std::chrono::duration_cast<time_type::duration>(ret.segmentDuration()));
-            }
-        }
-
-        if (vars.number()) {
-            ret.segmentURL(URI(m_segmentList.value().getMediaURLForSegment(vars.number().value())).resolveUsingBaseURLs(base_urls));
-        } else if (vars.time()) {
-            ret.segmentURL(URI(m_segmentList.value().getMediaURLForSegmentTime(vars.time().value())).resolveUsingBaseURLs(base_urls));
-        }
-    } else if (m_period) {
-        ret = m_period->getMediaAvailability(vars);
-    }
-
-    return ret;
-}
-
-SegmentAvailability AdaptationSet::getInitialisationAvailability(const SegmentTemplate::Variables &vars) const
-{
-    SegmentAvailability ret;
-    std::list<BaseURL> base_urls;
-
-    if (m_segmentTemplate.has_value()) {
-        base_urls = getBaseURLs();
-        ret.segmentURL(URI(m_segmentTemplate.value().formatInitializationTemplate(vars)).resolveUsingBaseURLs(base_urls));
-    } else if (m_segmentList.has_value()) {
-        base_urls = getBaseURLs();
-        ret.segmentURL(URI(m_segmentList.value().getInitializationURL()).resolveUsingBaseURLs(base_urls));
-    } else if (m_period) {
-        ret = m_period->getInitialisationAvailability(vars);
-        return ret;
-    }
-
-    if (!base_urls.empty()) {
-        const BaseURL &base_url = base_urls.front();
-        const MPD *mpd = getMPD();
-        if (base_url.hasAvailabilityTimeOffset()) {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->presentationTimeToSystemTime(mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1> >(base_url.availabilityTimeOffset().value()))));
-            }
-        } else {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->presentationTimeToSystemTime(mpd->availabilityStartTime().value()));
-            } else {
-                ret.availabilityStartTime(std::chrono::system_clock::now());
-            }
-        }
-    } else {
-        ret.availabilityStartTime(std::chrono::system_clock::now());
-    }
-
-    return ret;
-}
-
 AdaptationSet::time_type AdaptationSet::getPeriodStartTime() const
 {
     if (m_period) return m_period->getPeriodStartTime();
@@ -1354,24 +1066,21 @@ AdaptationSet::time_type AdaptationSet::getPeriodStartTime() const
 }
 
 std::optional<AdaptationSet::duration_type> AdaptationSet::getPeriodDuration() const
-{   
+{
     if (m_period) return m_period->getPeriodDuration();
     return std::optional<AdaptationSet::duration_type>(); // just return epoch if we can't find the period
 }
- 
-const MultipleSegmentBase &AdaptationSet::getMultiSegmentBase() const
+
+// private:
+
+void AdaptationSet::invalidateBaseURLs() const
 {
-    if (m_segmentTemplate) return m_segmentTemplate.value();
-    if (m_segmentList) return m_segmentTemplate.value();
-    if (m_segmentBase) {
-        static MultipleSegmentBase multi_no_duration;
-        static_cast<SegmentBase&>(multi_no_duration) = m_segmentBase.value(); // copy over SegmentBase values
-        return multi_no_duration;
-    }
-    if (m_period) return m_period->getMultiSegmentBase();
+    MPD::baseURLGeneration(getMPD()).invalidate();
+}
 
-    static const MultipleSegmentBase empty_multi;
-    return empty_multi;
+void AdaptationSet::invalidateAddressing() const
+{
+    MPD::addressingGeneration(getMPD()).invalidate();
 }
 
 LIBMPDPP_NAMESPACE_END
@@ -8,6 +8,7 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <atomic>
 #include <chrono>
 #include <optional>
 #include <string>
@@ -23,6 +24,14 @@
 
 LIBMPDPP_NAMESPACE_BEGIN
 
+std::atomic<unsigned long> CacheGeneration::s_next(1);
+
+CacheGeneration &CacheGeneration::detached()
+{
+    static CacheGeneration detached_generation;
+    return detached_generation;
+}
+
 BaseURL::BaseURL()
     :URI()
     ,m_serviceLocation()
@@ -19,14 +19,12 @@
 #include "libmpd++/exceptions.hh"
 
 #include "conversions.hh"
+#include "pct_encoding.hh"
 
 #include "libmpd++/Codecs.hh"
 
 LIBMPDPP_NAMESPACE_BEGIN
 
-static std::string pct_encode(const std::string &str);
-static std::string pct_decode(const std::string &pct_encoded_str);
-
 Codecs::Encoding::Encoding(const std::string &encoding)
 {
     auto pos = encoding.find_first_of('\'');
@@ -47,7 +45,7 @@ Codecs::Codecs(const std::string &attr_val)
     :m_encoding()
     ,m_codecs()
 {
-    static const std::regex encoding_re("^[-[:alpha:]]+'[[:alpha:]]{1,8}(?:-[[:alpha:]]{1,8})*'");
+    static const std::regex encoding_re("^[-[:alnum:]]+'[[:alpha:]]{1,8}(?:-[[:alpha:]]{1,8})*'");
     std::smatch result;
     if (std::regex_search(attr_val, result, encoding_re)) {
         m_encoding = Encoding(result.str());
@@ -110,13 +108,14 @@ Codecs::operator std::string() const
         oss << m_encoding.value();
         const char *sep = "";
         for (const auto &codec : m_codecs) {
-            oss << sep << pct_encode(codec);
+            oss << sep << pct_encode(codec, PCT_ATTR_CHAR);
             sep = ",";
         }
     } else {
         const char *sep = "";
         for (const auto &codec : m_codecs) {
             oss << sep << codec;
+            sep = ",";
         }
     }
 
@@ -155,39 +154,6 @@ Codecs &Codecs::codecsRemove(const std::list<std::string>::iterator &it)
     return *this;
 }
 
-static std::string pct_encode(const std::string &s)
-{
-    std::string ret(s);
-    static const char *subst_chars = "%";
-    for (auto pos=ret.find_first_of(subst_chars); pos != std::string::npos; pos = ret.find_first_of(subst_chars, pos+1)) {
-        std::ostringstream oss;
-        oss << std::setw(2) << std::setfill('0') << std::hex << static_cast<unsigned int>(ret[pos]);
-        ret.insert(pos+1, oss.str());
-        pos += 2;
-    }
-    return ret;
-}
-
-static unsigned int hex_to_val(char c)
-{
-    if (c >= '0' && c <= '9') return c-'0';
-    if (c >= 'a' && c <= 'f') return 10+c-'a';
-    if (c >= 'A' && c <= 'F') return 10+c-'A';
-    throw ParseError("Bad hex value");
-}
-
-static std::string pct_decode(const std::string &s)
-{
-    std::string ret(s);
-    static const char *subst_chars = "%";
-    for (auto pos=ret.find_first_of(subst_chars); pos != std::string::npos; pos = ret.find_first_of(subst_chars, pos+1)) {
-        if (pos+2 >= ret.size()) break;
-        auto charval = hex_to_val(ret[pos+1]) * 16 + hex_to_val(ret[pos+2]);
-        ret.replace(pos, 3, 1, static_cast<char>(charval));
-    }
-    return ret;
-}
-
 LIBMPDPP_NAMESPACE_END
 
 std::ostream &operator<<(std::ostream &os, const LIBMPDPP_NAMESPACE_CLASS(Codecs::Encoding) &enc)
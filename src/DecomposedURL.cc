@@ -8,17 +8,19 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
-#include <ctype.h>
 #include <stdint.h>
 
 #include <algorithm>
-#include <iterator>
-#include <list>
-#include <sstream>
+#include <cstring>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include "libmpd++/macros.hh"
 #include "libmpd++/exceptions.hh"
+#include "libmpd++/URI.hh"
+
+#include "pct_encoding.hh"
 
 #include "DecomposedURL.hh"
 
@@ -28,217 +30,112 @@ LIBMPDPP_NAMESPACE_BEGIN
  * helper functions
  **************************************************************************/
 
-#define _RESERVED_CHARS_GENERIC_DELIMITERS ":/?#[]@"
-#define _RESERVED_CHARS_SUBCOMPONENT_DELIMITERS "!$&'()*+,;="
-#define _RESERVED_CHARS_ALLOWED_IN_PATH_ELEMENT _RESERVED_CHARS_SUBCOMPONENT_DELIMITERS ":@"
-#define _RESERVED_CHARS_ALLOWED_IN_PATH _RESERVED_CHARS_ALLOWED_IN_PATH_ELEMENT "/"
-#define _RESERVED_CHARS_ALLOWED_IN_USERINFO _RESERVED_CHARS_SUBCOMPONENT_DELIMITERS ":"
-
-static std::string _uri_char_to_pct_encode(unsigned char c)
-{
-    const char hex_chars[] = "0123456789ABCDEF";
-    std::string ret("%");
-    ret += hex_chars[c>>4];
-    ret += hex_chars[c&0xF];
-    return ret;
-}
-
-static std::string _uri_escape_string(const std::string &unescaped, const std::string &allowed_chars)
+static bool _uri_is_alpha(char c)
 {
-    static const std::string reserved_chars(_RESERVED_CHARS_GENERIC_DELIMITERS _RESERVED_CHARS_SUBCOMPONENT_DELIMITERS);
-    std::string ret;
-
-    for (std::string::const_iterator c = unescaped.begin();
-         c != unescaped.end();
-         ++c) {
-        if (reserved_chars.find_first_of(*c) != std::string::npos &&
-            allowed_chars.find_first_of(*c) == std::string::npos) {
-            ret += _uri_char_to_pct_encode(*c);
-        }
-        else {
-            ret += *c;
-        }
-    }
-
-    return ret;
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
 }
 
-static std::string _uri_escape_userinfo(const std::string &unescaped)
+static bool _uri_is_digit(char c)
 {
-    return _uri_escape_string(unescaped, _RESERVED_CHARS_ALLOWED_IN_USERINFO);
+    return c >= '0' && c <= '9';
 }
 
-static std::string _uri_escape_host(const std::string &unescaped)
+static char _uri_lowercase(char c)
 {
-    return _uri_escape_string(unescaped, _RESERVED_CHARS_SUBCOMPONENT_DELIMITERS);
-}
-
-static std::string _uri_escape_host_colon(const std::string &unescaped)
-{
-    return _uri_escape_string(unescaped, _RESERVED_CHARS_SUBCOMPONENT_DELIMITERS ":");
-}
-
-static std::string _uri_escape_path_segment(const std::string &unescaped)
-{
-    return _uri_escape_string(unescaped, _RESERVED_CHARS_ALLOWED_IN_PATH_ELEMENT);
-}
-
-static std::string _uri_escape_query(const std::string &unescaped)
-{
-    std::string ret(_uri_escape_string(unescaped, "!$'()*,;:@/? =&"));
-    for (std::string::iterator c = ret.begin();
-         c != ret.end();
-         ++c) {
-        if (*c == ' ')
-            *c = '+';
-    }
-    return ret;
+    return (c >= 'A' && c <= 'Z')?(c - 'A' + 'a'):c;
 }
 
-static std::string _uri_escape_fragment(const std::string &unescaped)
+// Append escaped to out with percent-encoded unreserved characters decoded and other percent-encodings in upper case
+static void _uri_normalize_pct_append(std::string &out, std::string_view escaped, bool lowercase)
 {
-    return _uri_escape_string(unescaped, _RESERVED_CHARS_ALLOWED_IN_PATH "?");
-}
-
-static std::string _uri_unescape_string(const std::string &escaped)
-{
-    std::string ret;
-
-    for (std::string::size_type pos = 0; pos < escaped.size(); pos++) {
+    for (std::string_view::size_type pos = 0; pos < escaped.size(); pos++) {
+        int hi, lo;
         if (escaped[pos] == '%' && escaped.size() - pos >= 3 &&
-            isxdigit(escaped[pos+1]) && isxdigit(escaped[pos+2])) {
-            unsigned char a=0, b=0;
-            a = escaped[pos+1];
-            if (a >= '0' && a <= '9') {
-                a -= '0';
-            }
-            else if (a >= 'A' && a <= 'F') {
-                a -= ('A' - 10);
-            }
-            else {
-                a -= ('a' - 10);
-            }
-            b = escaped[pos+2];
-            if (b >= '0' && b <= '9') {
-                b -= '0';
-            }
-            else if (b >= 'A' && b <= 'F') {
-                b -= ('A' - 10);
-            }
-            else {
-                b -= ('a' - 10);
+            (hi = pct_hex_value(escaped[pos+1])) >= 0 && (lo = pct_hex_value(escaped[pos+2])) >= 0) {
+            char c = static_cast<char>(hi*16+lo);
+            if (pct_is_allowed(c, PCT_UNRESERVED)) {
+                out += lowercase?_uri_lowercase(c):c;
+            } else {
+                out += '%';
+                out += g_pct_hex_chars[hi];
+                out += g_pct_hex_chars[lo];
             }
-            ret += static_cast<char>(a*16+b);
             pos += 2;
+        } else {
+            out += lowercase?_uri_lowercase(escaped[pos]):escaped[pos];
         }
-        else {
-            ret += escaped[pos];
-        }
-    }
-
-    return ret;
-}
-
-static std::list<std::string> _uri_string_to_list(const std::string &path, unsigned char sep, bool convert, bool unescape)
-{
-    std::list<std::string> ret;
-
-    if (!path.empty()) {
-        std::string pct_sep;
-        if (convert && !unescape) {
-            pct_sep = _uri_char_to_pct_encode(sep);
-        }
-
-        std::string::size_type pos1 = 0, pos2;
-        do {
-            pos2 = path.find_first_of(static_cast<char>(sep), pos1);
-            std::string segment(path.substr(pos1, pos2 - pos1));
-            if (convert && !unescape) {
-                for (std::string::size_type pos(segment.find(pct_sep));
-                     pos != std::string::npos;
-                     pos = segment.find(pct_sep, pos + 1)) {
-                    segment.replace(pos, 3, 1, static_cast<char>(sep));
-                }
-            }
-            if (unescape) {
-                segment = _uri_unescape_string(segment);
-            }
-            ret.push_back(segment);
-            if (pos2 != std::string::npos)
-                pos1 = pos2 + 1;
-        } while (pos2 != std::string::npos);
     }
-
-    return ret;
 }
 
-static std::list<std::string> _uri_remove_dot_segments(const std::list<std::string> &original)
-{
-    std::list<std::string> ret;
-
-    for (auto seg = original.begin(); seg != original.end(); ++seg) {
-        auto next = seg;
-        ++next;
-        if (*seg == ".") {
-            // remove single dot segments
-        }
-        else if (seg->empty() && seg != original.begin() && next != original.end()) {
-            // remove empty segments that are not the first or last segment
-        }
-        else if (*seg == "..") {
-            // remove double dot plus previous segment (if it exists)
-            if (ret.size() > 0 && !ret.back().empty()) {
-                ret.pop_back();
-            }
+// Remove the "." and ".." segments from the path starting at offset start in buf (RFC 3986 section 5.2.4)
+static void _uri_remove_dot_segments(std::string &buf, std::string::size_type start)
+{
+    // The output never grows faster than the input is consumed, so this can be done in place
+    char *out_start = buf.data() + start;
+    char *out = out_start;
+    const char *in = out_start;
+    const char *end = buf.data() + buf.size();
+
+    auto pop_segment = [out_start, &out]() {
+        while (out != out_start && out[-1] != '/') out--;
+        if (out != out_start) out--;
+    };
+    auto move_segment = [end, &in, &out]() {
+        // move the first path segment, including any leading '/', to the output
+        const char *seg_end = in + 1;
+        while (seg_end != end && *seg_end != '/') seg_end++;
+        if (out != in) std::memmove(out, in, seg_end - in);
+        out += seg_end - in;
+        in = seg_end;
+    };
+
+    while (in != end) {
+        // quick check for segments which cannot be dot segments
+        if (in[0] != '.' && (in[0] != '/' || end - in < 2 || in[1] != '.')) {
+            move_segment();
+            continue;
         }
-        else {
-            // otherwise just copy the segment
-            ret.push_back(*seg);
+        std::string_view input(in, end - in);
+        if (input.starts_with("../")) {
+            in += 3;
+        } else if (input.starts_with("./") || input.starts_with("/./")) {
+            in += 2;
+        } else if (input == "/.") {
+            *out++ = '/';
+            in = end;
+        } else if (input.starts_with("/../")) {
+            in += 3;
+            pop_segment();
+        } else if (input == "/..") {
+            pop_segment();
+            *out++ = '/';
+            in = end;
+        } else if (input == "." || input == "..") {
+            in = end;
+        } else {
+            move_segment();
         }
     }
 
-    return ret;
-}
-
-static std::string _uri_normalize_lowercase(const std::string &original)
-{
-    std::string normalized;
-    transform(original.begin(), original.end(), back_inserter(normalized), tolower);
-    return normalized;
+    buf.resize(out - buf.data());
 }
 
-static std::string _uri_normalize_scheme(const std::string &original)
+static uint32_t _uri_path_end(const DecomposedURL::Components &components, std::string_view::size_type length)
 {
-    return _uri_normalize_lowercase(original);
+    if (components.queryStart != DecomposedURL::Components::NONE) return components.queryStart;
+    if (components.fragmentStart != DecomposedURL::Components::NONE) return components.fragmentStart;
+    return static_cast<uint32_t>(length);
 }
 
-static std::string _uri_normalize_hostname(const std::string &original)
+static uint32_t _uri_query_end(const DecomposedURL::Components &components, std::string_view::size_type length)
 {
-    return _uri_normalize_lowercase(original);
+    if (components.fragmentStart != DecomposedURL::Components::NONE) return components.fragmentStart;
+    return static_cast<uint32_t>(length);
 }
 
-static std::list<std::string> _uri_normalize_path(const std::list<std::string> &original)
+static void _uri_check_length(std::string::size_type length)
 {
-    return _uri_remove_dot_segments(original);
-}
-
-static std::list<std::string> _uri_merge(const std::list<std::string> &base, const std::list<std::string> &rel)
-{
-    std::list<std::string> ret(rel);
-    // If we don't have a base path or the rel DecomposedURL is absolute...
-    if (base.size() == 0) {
-        // ensure rel is absolute
-        if (ret.size() > 0 && !ret.front().empty()) {
-            ret.insert(ret.begin(), std::string());
-        }
-        // return the relative path
-        return ret;
-    }
-
-    ret = base;
-    ret.pop_back();
-    ret.insert(ret.end(), rel.begin(), rel.end());
-    return ret;
+    if (length >= DecomposedURL::Components::NONE) throw ParseError("URL is too long.");
 }
 
 /**************************************************************************
@@ -246,183 +143,86 @@ static std::list<std::string> _uri_merge(const std::list<std::string> &base, con
  **************************************************************************/
 
 DecomposedURL::DecomposedURL()
-    :m_pathSegments()
-    ,m_scheme()
-    ,m_userInfo()
-    ,m_host()
-    ,m_port(0)
-    ,m_portDefault(true)
-    ,m_query()
-    ,m_fragment()
+    :m_url()
+    ,m_components()
 {
 }
 
-DecomposedURL::DecomposedURL(const DecomposedURL &other)
-    :m_pathSegments(other.m_pathSegments)
-    ,m_scheme(other.m_scheme)
-    ,m_userInfo(other.m_userInfo)
-    ,m_host(other.m_host)
-    ,m_port(other.m_port)
-    ,m_portDefault(other.m_portDefault)
-    ,m_query(other.m_query)
-    ,m_fragment(other.m_fragment)
+DecomposedURL::DecomposedURL(const std::string &url)
+    :m_url(url)
+    ,m_components()
 {
+    parse();
 }
 
-DecomposedURL::DecomposedURL(const std::string &url)
-    :m_pathSegments()
-    ,m_scheme()
-    ,m_userInfo()
-    ,m_host()
-    ,m_port(0)
-    ,m_portDefault(true)
-    ,m_query()
-    ,m_fragment()
+DecomposedURL::DecomposedURL(std::string &&url)
+    :m_url(std::move(url))
+    ,m_components()
 {
-    if (url.empty()) return;
+    parse();
+}
 
-    // skip initial white space
-    std::string::size_type pos = 0;
-    while (pos < url.size() && isspace(url[pos])) pos++;
+DecomposedURL::DecomposedURL(const URI &uri)
+    :m_url(uri.m_uri.get())
+    ,m_components(uri.m_components) // URI has already found the component offsets while validating
+{
+}
 
-    // get working std::string starting with first non-space
-    std::string uri(url.substr(pos));
+DecomposedURL::DecomposedURL(const DecomposedURL &base, std::string_view reference)
+    :m_url()
+    ,m_components()
+{
+    base.resolve(reference, m_url);
+    _uri_check_length(m_url.size());
+    m_components = split(m_url);
+}
 
-    // Get scheme if available
-    if (!uri.empty() && isalpha(uri[0])) {
-        for (pos = 0; pos < uri.size() && (isalnum(uri[pos]) || uri[pos] == '+' || uri[pos] == '-' || uri[pos] == '.'); pos++);
-    }
-    if (pos > 0 && pos < uri.size() && uri[pos] == ':') {
-        m_scheme = uri.substr(0, pos);
-        uri.erase(0, pos + 1);
+DecomposedURL::DecomposedURL(const std::string &scheme, const std::string &userinfo, const std::string &host,
+         uint16_t port, const std::string &path, const std::string &query,
+         const std::string &fragment)
+    :m_url()
+    ,m_components()
+{
+    if (!scheme.empty()) {
+        m_url += scheme;
+        m_url += ':';
     }
 
-    // Get authority part
-    if (uri.size() >= 2 && uri[0] == '/' && uri[1] == '/') {
-        uri.erase(0, 2);
-        pos = uri.find_first_of("/?#");
-
-        std::string authority(uri.substr(0, pos));
-        uri.erase(0, authority.size());
-
-        pos = authority.find_first_of('@');
-        if (pos != std::string::npos) {
-            m_userInfo = _uri_unescape_string(authority.substr(0, pos));
-            authority.erase(0, pos+1);
+    bool has_authority = !userinfo.empty() || !host.empty() || port != 0;
+    if (has_authority) {
+        m_url += "//";
+        if (!userinfo.empty()) {
+            pct_encode_append(m_url, userinfo, PCT_USERINFO);
+            m_url += '@';
         }
-        if (authority.size() > 0 && authority[0] == '[') {
-            pos = authority.find_first_of(']', 1);
-            if (pos == std::string::npos) {
-                throw ParseError("Unable to parse the host part of the URL.");
-            }
-            m_host = _uri_unescape_string(authority.substr(1, pos - 1));
-            authority.erase(0, pos + 1);
+        if (host.find(':') != std::string::npos) {
+            m_url += '[';
+            pct_encode_append(m_url, host, PCT_IP_LITERAL);
+            m_url += ']';
         } else {
-            pos = authority.find_first_of(':');
-            m_host = _uri_unescape_string(authority.substr(0, pos));
-            authority.erase(0, pos);
+            pct_encode_append(m_url, host, PCT_HOST);
         }
-        if (!authority.empty()) {
-            if (authority[0] != ':' || authority.find_first_not_of("0123456789",1) != std::string::npos) {
-                throw ParseError("Unable to parse the port part of the URL.");
-            }
-            char *endptr;
-            m_port = strtol(authority.c_str()+1, &endptr, 10);
-            m_portDefault = false;
-        } else {
-            if (m_scheme.compare("http") == 0) {
-                m_port = 80;
-            } else if (m_scheme.compare("https") == 0) {
-                m_port = 443;
-            }
+        if (port != 0) {
+            m_url += ':';
+            m_url += std::to_string(port);
         }
+        if (!path.empty() && path[0] != '/') m_url += '/';
     }
 
-    // Get path part
-    if (!uri.empty()) {
-        pos = uri.find_first_of("?#");
-        m_pathSegments = _uri_string_to_list(uri.substr(0, pos), '/', false, true);
-        uri.erase(0, pos);
-    }
-
-    // Get query std::string
-    if (!uri.empty() && uri[0] == '?') {
-        pos = uri.find_first_of('#');
-        if (pos != std::string::npos) {
-            m_query = _uri_unescape_string(uri.substr(1, pos - 1));
-        } else {
-            m_query = _uri_unescape_string(uri.substr(1));
-        }
-        uri.erase(0, pos);
-    }
+    pct_encode_append(m_url, path, PCT_PATH);
 
-    // Get fragment std::string
-    if (!uri.empty() && uri[0] == '#') {
-        m_fragment = _uri_unescape_string(uri.substr(1));
-        uri.clear();
+    if (!query.empty()) {
+        m_url += '?';
+        pct_encode_append(m_url, query, PCT_QUERY);
     }
 
-    if (!uri.empty()) {
-        throw ParseError("URL parts left over after parse '" + uri + "'");
+    if (!fragment.empty()) {
+        m_url += '#';
+        pct_encode_append(m_url, fragment, PCT_QUERY);
     }
-}
 
-DecomposedURL::DecomposedURL(const DecomposedURL &base, const std::string &url)
-    :m_pathSegments(base.m_pathSegments)
-    ,m_scheme(base.m_scheme)
-    ,m_userInfo(base.m_userInfo)
-    ,m_host(base.m_host)
-    ,m_port(base.m_port)
-    ,m_portDefault(base.m_portDefault)
-    ,m_query(base.m_query)
-    ,m_fragment(base.m_fragment)
-{
-    DecomposedURL rel(url);
-    operator+=(rel);
-}
-
-DecomposedURL::DecomposedURL(const std::string &scheme, const std::string &userinfo, const std::string &host,
-         uint16_t port, const std::string &path, const std::string &query,
-         const std::string &fragment)
-    :m_pathSegments()
-    ,m_scheme(scheme)
-    ,m_userInfo(userinfo)
-    ,m_host(host)
-    ,m_port(port)
-    ,m_portDefault(false)
-    ,m_query(query)
-    ,m_fragment(fragment)
-{
-    m_pathSegments = _uri_string_to_list(path, '/', false, false);
-}
-
-DecomposedURL::DecomposedURL(const DecomposedURL& base, const std::string &scheme, const std::string &userinfo,
-         const std::string &host, uint16_t port, const std::string &path,
-         const std::string &query, const std::string &fragment)
-    :m_pathSegments(base.m_pathSegments)
-    ,m_scheme(base.m_scheme)
-    ,m_userInfo(base.m_userInfo)
-    ,m_host(base.m_host)
-    ,m_port(base.m_port)
-    ,m_portDefault(base.m_portDefault)
-    ,m_query(base.m_query)
-    ,m_fragment(base.m_fragment)
-{
-    DecomposedURL rel(scheme, userinfo, host, port, path, query, fragment);
-    operator+=(rel);
-}
-
-DecomposedURL &DecomposedURL::operator=(const DecomposedURL &other)
-{
-    m_scheme = other.m_scheme;
-    m_userInfo = other.m_userInfo;
-    m_host = other.m_host;
-    m_port = other.m_port;
-    m_portDefault = other.m_portDefault;
-    m_pathSegments = other.m_pathSegments;
-    m_query = other.m_query;
-    m_fragment = other.m_fragment;
-    return *this;
+    _uri_check_length(m_url.size());
+    m_components = split(m_url);
 }
 
 bool DecomposedURL::operator==(const DecomposedURL &other) const
@@ -430,214 +230,240 @@ bool DecomposedURL::operator==(const DecomposedURL &other) const
     // Check for same object
     if (this == &other) return true;
 
-    if (m_port != other.m_port) return false;
-    if (m_userInfo != other.m_userInfo) return false;
-    if (m_query != other.m_query) return false;
-    if (m_fragment != other.m_fragment) return false;
-
-    std::string first_cmp, second_cmp;
-
-    first_cmp = _uri_normalize_scheme(m_scheme);
-    second_cmp = _uri_normalize_scheme(other.m_scheme);
-    if (first_cmp != second_cmp) return false;
+    if (m_url == other.m_url) return true;
 
-    first_cmp = _uri_normalize_hostname(m_host);
-    second_cmp = _uri_normalize_hostname(other.m_host);
-    if (first_cmp != second_cmp) return false;
-
-    std::list<std::string> first_list(m_pathSegments);
-    std::list<std::string> second_list(other.m_pathSegments);
-    _uri_normalize_path(first_list);
-    _uri_normalize_path(second_list);
-
-    if (first_list != second_list) return false;
-
-    return true;
+    return DecomposedURL(*this).normalize().m_url == DecomposedURL(other).normalize().m_url;
 }
 
-DecomposedURL &DecomposedURL::operator+=(const DecomposedURL &other)
+void DecomposedURL::resolve(std::string_view reference, std::string &out) const
 {
+    // Nothing to resolve against, so the reference is the target
     if (isNull()) {
-        *this = other;
-            return *this;
+        out.assign(reference);
+        return;
+    }
+
+    const Components ref = split(reference);
+    const uint32_t ref_path_end = _uri_path_end(ref, reference.size());
+    const std::string_view ref_path(reference.substr(ref.pathStart, ref_path_end - ref.pathStart));
+    std::string_view ref_query;
+    if (ref.queryStart != Components::NONE) {
+        ref_query = reference.substr(ref.queryStart, _uri_query_end(ref, reference.size()) - ref.queryStart);
     }
 
-    if (other.isNull())
-        return *this;
-
-    if (!other.m_scheme.empty() && other.m_scheme != m_scheme) {
-        m_scheme = other.m_scheme;
-        m_userInfo = other.m_userInfo;
-        m_host = other.m_host;
-        m_port = other.m_port;
-        m_portDefault = other.m_portDefault;
-        m_pathSegments = _uri_remove_dot_segments(other.m_pathSegments);
-        m_query = other.m_query;
+    out.clear();
+    out.reserve(m_url.size() + reference.size());
+
+    if (ref.schemeLength != 0 || ref.authorityStart != Components::NONE) {
+        // reference has its own scheme or authority so only inherits the scheme from the base
+        if (ref.schemeLength == 0 && hasScheme()) out.append(m_url, 0, m_components.schemeLength + 1);
+        out.append(reference.substr(0, ref.pathStart));
+        auto path_start = out.size();
+        out.append(ref_path);
+        _uri_remove_dot_segments(out, path_start);
+        out.append(ref_query);
     } else {
-        if (!other.m_host.empty()) {
-            m_userInfo = other.m_userInfo;
-            m_host = other.m_host;
-            m_port = other.m_port;
-            m_portDefault = other.m_portDefault;
-            m_pathSegments = _uri_remove_dot_segments(other.m_pathSegments);
-            m_query = other.m_query;
-        }
-        else {
-            if (other.m_pathSegments.size() == 0) {
-                if (!other.m_query.empty()) {
-                    m_query = other.m_query;
-                }
+        // scheme and authority (including the "//") from the base
+        out.append(m_url, 0, m_components.pathStart);
+        if (ref_path.empty()) {
+            out.append(path());
+            if (ref.queryStart != Components::NONE) {
+                out.append(ref_query);
+            } else if (hasQuery()) {
+                out.append(m_url, m_components.queryStart, queryEnd() - m_components.queryStart);
             }
-            else {
-                if (other.m_pathSegments.size() > 0 &&
-                    other.m_pathSegments.front().empty()) {
-                    m_pathSegments = _uri_remove_dot_segments(other.m_pathSegments);
-                }
-                else {
-                    m_pathSegments = _uri_remove_dot_segments(
-                        _uri_merge(m_pathSegments, other.m_pathSegments));
+        } else {
+            auto path_start = out.size();
+            if (ref_path[0] != '/') {
+                // merge the reference path with the base path (RFC 3986 section 5.2.3)
+                auto base_path = path();
+                if (hasAuthority() && base_path.empty()) {
+                    out += '/';
+                } else {
+                    auto last_slash = base_path.rfind('/');
+                    if (last_slash != std::string_view::npos) out.append(base_path.substr(0, last_slash + 1));
                 }
-                m_query = other.m_query;
             }
+            out.append(ref_path);
+            _uri_remove_dot_segments(out, path_start);
+            out.append(ref_query);
         }
     }
-    m_fragment = other.m_fragment;
 
-    if ((m_port == 0) && (!m_scheme.empty())) {
-        if(m_scheme.compare("http") == 0) {
-                m_port = 80;
-            } else if (m_scheme.compare("https") == 0) {
-                m_port = 443;
-            }
-    }
-
-    return *this;
+    if (ref.fragmentStart != Components::NONE) out.append(reference.substr(ref.fragmentStart));
 }
 
-DecomposedURL DecomposedURL::operator+(const DecomposedURL &other)
+bool DecomposedURL::isNormalized() const
 {
-    DecomposedURL ret(*this);
-    ret += other;
-    return ret;
+    return DecomposedURL(*this).normalize().m_url == m_url;
 }
 
-DecomposedURL::operator std::string() const
+DecomposedURL &DecomposedURL::normalize()
 {
-    std::ostringstream ostr;
-
-    if (!m_scheme.empty())
-        ostr << m_scheme << ":";
-
-    if (!m_userInfo.empty() || !m_host.empty() || m_port != 0)
-        ostr << "//";
+    // Syntax-based normalization (RFC 3986 section 6.2.2)
+    std::string normalized;
+    normalized.reserve(m_url.size());
 
-    if (!m_userInfo.empty())
-        ostr << _uri_escape_userinfo(m_userInfo) << "@";
+    if (hasScheme()) {
+        for (char c : scheme()) normalized += _uri_lowercase(c);
+        normalized += ':';
+    }
 
-    if (!m_host.empty()) {
-        if (m_host.find_first_of(':') != std::string::npos) {
-            ostr << "[" << _uri_escape_host_colon(m_host) << "]";
-        }
-        else {
-            ostr << _uri_escape_host(m_host);
+    if (hasAuthority()) {
+        normalized += "//";
+        auto auth = authority();
+        auto at = auth.find('@');
+        if (at != std::string_view::npos) {
+            _uri_normalize_pct_append(normalized, auth.substr(0, at + 1), false);
+            auth.remove_prefix(at + 1);
         }
+        // host is case insensitive, the port is only digits so is not affected by lowercasing
+        _uri_normalize_pct_append(normalized, auth, true);
     }
 
-    if ((m_port != 0) && (!m_portDefault))
-        ostr << ":" << m_port;
-
-    if (m_pathSegments.size() > 0)
-        ostr << pathString();
+    auto path_start = normalized.size();
+    _uri_normalize_pct_append(normalized, path(), false);
+    // Only remove dot segments from absolute paths, a relative reference needs its dot segments to be resolved later
+    if (hasScheme() || hasAuthority() || path().starts_with("/")) _uri_remove_dot_segments(normalized, path_start);
 
-    if (!m_query.empty())
-        ostr << "?" << _uri_escape_query(m_query);
+    if (hasQuery()) {
+        normalized += '?';
+        _uri_normalize_pct_append(normalized, query(), false);
+    }
 
-    if (!m_fragment.empty())
-        ostr << "#" << _uri_escape_fragment(m_fragment);
+    if (hasFragment()) {
+        normalized += '#';
+        _uri_normalize_pct_append(normalized, fragment(), false);
+    }
 
-    return ostr.str();
+    m_url = std::move(normalized);
+    m_components = split(m_url);
+    return *this;
 }
 
-bool DecomposedURL::isNormalized() const
+std::string_view DecomposedURL::authority() const
 {
-    if (_uri_normalize_scheme(m_scheme) != m_scheme) return false;
-    if (_uri_normalize_hostname(m_host) != m_host) return false;
-    if (_uri_normalize_path(m_pathSegments) != m_pathSegments) return false;
+    if (!hasAuthority()) return std::string_view();
+    return component(m_components.authorityStart, m_components.pathStart);
+}
 
-    return true;
+std::string_view DecomposedURL::userinfo() const
+{
+    auto auth = authority();
+    auto at = auth.find('@');
+    if (at == std::string_view::npos) return std::string_view();
+    return auth.substr(0, at);
 }
 
-DecomposedURL &DecomposedURL::normalize()
+std::string_view DecomposedURL::host() const
 {
-    m_scheme = _uri_normalize_scheme(m_scheme);
-    m_host = _uri_normalize_hostname(m_host);
-    m_pathSegments = _uri_normalize_path(m_pathSegments);
-    return *this;
+    auto auth = authority();
+    auto at = auth.find('@');
+    if (at != std::string_view::npos) auth.remove_prefix(at + 1);
+    if (!auth.empty() && auth[0] == '[') return auth.substr(1, auth.find(']') - 1);
+    return auth.substr(0, auth.find(':'));
 }
 
-std::string DecomposedURL::path() const
+uint16_t DecomposedURL::port() const
 {
-    std::string ret;
-    const char *sep = "";
-
-    for (std::list<std::string>::const_iterator seg = m_pathSegments.begin();
-         seg != m_pathSegments.end();
-         ++seg) {
-        ret += sep;
-        ret += *seg;
-        sep = "/";
+    auto auth = authority();
+    auto at = auth.find('@');
+    if (at != std::string_view::npos) auth.remove_prefix(at + 1);
+    auto port_pos = auth.find(':', (!auth.empty() && auth[0] == '[')?auth.find(']'):0);
+    if (port_pos != std::string_view::npos && port_pos + 1 < auth.size()) {
+        uint32_t port_num = 0;
+        for (char c : auth.substr(port_pos + 1)) port_num = port_num * 10 + (c - '0');
+        return static_cast<uint16_t>(port_num);
     }
 
-    return ret;
+    // default ports for the schemes we know about
+    if (scheme() == "http") return 80;
+    if (scheme() == "https") return 443;
+    return 0;
 }
 
-DecomposedURL &DecomposedURL::path(const std::string &thepath)
+std::string_view DecomposedURL::query() const
 {
-    m_pathSegments = _uri_string_to_list(thepath, '/', false, false);
-    return *this;
+    if (!hasQuery()) return std::string_view();
+    return component(m_components.queryStart + 1, queryEnd());
 }
 
-std::string DecomposedURL::pathString() const
+std::string_view DecomposedURL::fragment() const
 {
-    std::string ret;
-    const char *sep = "";
-
-    for (std::list<std::string>::const_iterator seg = m_pathSegments.begin();
-         seg != m_pathSegments.end();
-         ++seg) {
-        ret += sep;
-        ret += _uri_escape_path_segment(*seg);
-        sep = "/";
+    if (!hasFragment()) return std::string_view();
+    return component(m_components.fragmentStart + 1, static_cast<uint32_t>(m_url.size()));
+}
+
+DecomposedURL::Components DecomposedURL::split(std::string_view url)
+{
+    Components components;
+    std::string_view::size_type pos = 0;
+
+    // scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." ) followed by ":"
+    if (!url.empty() && _uri_is_alpha(url[0])) {
+        std::string_view::size_type scheme_end = 1;
+        while (scheme_end < url.size() && (_uri_is_alpha(url[scheme_end]) || _uri_is_digit(url[scheme_end]) ||
+                                           url[scheme_end] == '+' || url[scheme_end] == '-' || url[scheme_end] == '.')) {
+            scheme_end++;
+        }
+        if (scheme_end < url.size() && url[scheme_end] == ':') {
+            components.schemeLength = static_cast<uint32_t>(scheme_end);
+            pos = scheme_end + 1;
+        }
+    }
+
+    // "//" authority
+    if (url.size() - pos >= 2 && url[pos] == '/' && url[pos+1] == '/') {
+        pos += 2;
+        components.authorityStart = static_cast<uint32_t>(pos);
+        while (pos < url.size() && url[pos] != '/' && url[pos] != '?' && url[pos] != '#') pos++;
+    }
+
+    components.pathStart = static_cast<uint32_t>(pos);
+
+    while (pos < url.size() && url[pos] != '?' && url[pos] != '#') pos++;
+    if (pos < url.size() && url[pos] == '?') {
+        components.queryStart = static_cast<uint32_t>(pos);
+        while (pos < url.size() && url[pos] != '#') pos++;
     }
+    if (pos < url.size()) components.fragmentStart = static_cast<uint32_t>(pos);
 
-    return ret;
+    return components;
 }
 
-DecomposedURL &DecomposedURL::pathString(const std::string &path_string)
+void DecomposedURL::parse()
 {
-    m_pathSegments = _uri_string_to_list(path_string, '/', false, true);
-    return *this;
+    _uri_check_length(m_url.size());
+    m_components = split(m_url);
+
+    // check the parts of the authority that are extracted by the accessors
+    if (hasAuthority()) {
+        auto auth = authority();
+        auto at = auth.find('@');
+        if (at != std::string_view::npos) auth.remove_prefix(at + 1);
+        std::string_view::size_type port_pos;
+        if (!auth.empty() && auth[0] == '[') {
+            auto close = auth.find(']');
+            if (close == std::string_view::npos) throw ParseError("Unable to parse the host part of the URL.");
+            port_pos = close + 1;
+        } else {
+            port_pos = auth.find(':');
+        }
+        if (port_pos < auth.size() && (auth[port_pos] != ':' ||
+                                       !std::all_of(auth.begin() + port_pos + 1, auth.end(), _uri_is_digit))) {
+            throw ParseError("Unable to parse the port part of the URL.");
+        }
+    }
 }
 
-DecomposedURL &DecomposedURL::appendPath(const std::string &relative_path)
+uint32_t DecomposedURL::pathEnd() const
 {
-    std::list<std::string> new_segs(_uri_string_to_list(relative_path, '/', false, false));
-    if (m_pathSegments.size() > 1 && m_pathSegments.back().empty())
-        m_pathSegments.pop_back();
-    if (new_segs.size() > 0 && new_segs.front().empty())
-        new_segs.erase(new_segs.begin());
-    m_pathSegments.insert(m_pathSegments.end(), new_segs.begin(), new_segs.end());
-    return *this;
+    return _uri_path_end(m_components, m_url.size());
 }
 
-DecomposedURL &DecomposedURL::appendPathSegment(const std::string &path_segment)
+uint32_t DecomposedURL::queryEnd() const
 {
-    if (!path_segment.empty()) {
-        if (m_pathSegments.size() > 1 && m_pathSegments.back().empty())
-            m_pathSegments.pop_back();
-        m_pathSegments.push_back(path_segment);
-    }
-    return *this;
+    return _uri_query_end(m_components, m_url.size());
 }
 
 LIBMPDPP_NAMESPACE_END
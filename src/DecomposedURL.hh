@@ -12,131 +12,89 @@
  */
 #include <stdint.h>
 
-#include <list>
+#include <iostream>
 #include <string>
+#include <string_view>
 
 #include "libmpd++/macros.hh"
+#include "libmpd++/URI.hh"
 
 LIBMPDPP_NAMESPACE_BEGIN
 
+/* A URL held as a single string with the offsets of its RFC 3986 components.
+ *
+ * The component accessors return views into the URL string and so are only valid while the DecomposedURL is unchanged. Relative
+ * references can be resolved against a DecomposedURL, as the base URL, without decomposing the base URL again and, using
+ * resolve(reference, out), without allocating once the output buffer is large enough.
+ */
 class DecomposedURL {
 public:
     DecomposedURL();
-    DecomposedURL(const DecomposedURL &other);
-    DecomposedURL(DecomposedURL &&other);
+    DecomposedURL(const DecomposedURL &other) = default;
+    DecomposedURL(DecomposedURL &&other) = default;
     DecomposedURL(const std::string &url);
-    DecomposedURL(const DecomposedURL &base, const std::string &url);
+    DecomposedURL(std::string &&url);
+    DecomposedURL(std::string_view url) :DecomposedURL(std::string(url)) {};
+    DecomposedURL(const char *url) :DecomposedURL(std::string(url)) {};
+    DecomposedURL(const URI &uri);
+    DecomposedURL(const DecomposedURL &base, std::string_view reference);
     DecomposedURL(const std::string &scheme, const std::string &userinfo, const std::string &host, uint16_t port,
                   const std::string &path, const std::string &query, const std::string &fragment);
-    DecomposedURL(const DecomposedURL &base, const std::string &scheme, const std::string &userinfo, const std::string &host,
-                  uint16_t port, const std::string &path, const std::string &query, const std::string &fragment);
 
-    DecomposedURL &operator=(const DecomposedURL&);
-    DecomposedURL &operator=(DecomposedURL&&);
+    DecomposedURL &operator=(const DecomposedURL&) = default;
+    DecomposedURL &operator=(DecomposedURL&&) = default;
     bool operator==(const DecomposedURL&) const;
     bool operator!=(const DecomposedURL &other) const { return !(*this == other); };
-    DecomposedURL &operator+=(const DecomposedURL&);
-    DecomposedURL operator+(const DecomposedURL&);
 
-    operator std::string() const;
+    operator std::string() const { return m_url; };
+    const std::string &str() const { return m_url; };
+
+    // Resolve a reference using this URL as the base (RFC 3986 section 5.2), the target URL replaces the contents of out
+    void resolve(std::string_view reference, std::string &out) const;
+    DecomposedURL resolve(std::string_view reference) const { return DecomposedURL(*this, reference); };
 
     bool isNormalized() const;
     DecomposedURL &normalize();
 
-    const std::string &scheme() const { return m_scheme; };
-    DecomposedURL &scheme(const std::string &scheme_name) {
-        m_scheme = scheme_name;
-        if (m_portDefault) {
-            if(scheme_name.compare("http") == 0) {
-                m_port = 80;
-            } else if (scheme_name.compare("https") == 0) {
-                m_port = 443;
-            }
-        }
-        return *this;
-    };
-
-    const std::string &userinfo() const { return m_userInfo; };
-    DecomposedURL &userinfo(const std::string &user_info) {
-        m_userInfo = user_info;
-        return *this;
-    };
-
-    const std::string &host() const { return m_host; };
-    DecomposedURL &host(const std::string &hostname) {
-        m_host = hostname;
-        return *this;
-    };
-
-    uint16_t port() const { return m_port; };
-    DecomposedURL &port(uint16_t portnum) {
-        m_port = portnum;
-        m_portDefault = false;
-        return *this;
-    };
+    bool hasScheme() const { return m_components.schemeLength != 0; };
+    bool hasAuthority() const { return m_components.authorityStart != Components::NONE; };
+    bool hasQuery() const { return m_components.queryStart != Components::NONE; };
+    bool hasFragment() const { return m_components.fragmentStart != Components::NONE; };
+    bool isAbsolute() const { return hasScheme(); };
+    bool isNull() const { return m_url.empty(); };
 
-    std::string authority() {
-        std::string out = m_host;
-        if (m_port > 0) {
-            out += ":";
-            out += std::to_string(m_port);
-        } /*else if (m_scheme == "https") {
-            out += ":443";
-        } else {
-            out += ":80";
-        }*/
-        return out;
-    };
-    std::string path() const;
-    DecomposedURL &path(const std::string &thepath);
-    std::string pathString() const;
-    DecomposedURL &pathString(const std::string &path_string);
-    const std::list<std::string> &pathSegments() const {
-        return m_pathSegments;
-    };
-    DecomposedURL &pathSegments(const std::list<std::string> &path_segments) {
-        m_pathSegments = path_segments;
-        return *this;
-    };
-    DecomposedURL &appendPath(const std::string &relative_path);
-    DecomposedURL &appendPathSegment(const std::string &path_segment);
+    std::string_view scheme() const { return component(0, m_components.schemeLength); };
+    std::string_view authority() const;
+    std::string_view userinfo() const;
+    std::string_view host() const;
+    uint16_t port() const;
+    std::string_view path() const { return component(m_components.pathStart, pathEnd()); };
+    std::string_view query() const;
+    std::string_view fragment() const;
 
-    const std::string &query() const { return m_query; };
-    DecomposedURL &query(const std::string &query_str) {
-        m_query = query_str;
-        return *this;
-    };
+    // Offsets of the components in a URL string, shared with URI so that the component offsets of a URI can be used directly
+    using Components = URI::Components;
 
-    const std::string &fragment() const { return m_fragment; };
-    DecomposedURL &fragment(const std::string &fragment_str) {
-        m_fragment = fragment_str;
-        return *this;
-    };
+    // Find the components of a URI reference without validating it
+    static Components split(std::string_view url);
 
-    bool isNull() const {
-        return m_port == 0 && m_scheme.empty() && m_userInfo.empty() &&
-               m_host.empty() && m_pathSegments.size() == 0 && m_query.empty() &&
-               m_fragment.empty();
+private:
+    void parse();
+    std::string_view component(uint32_t start, uint32_t end) const {
+        return std::string_view(m_url.data() + start, end - start);
     };
+    uint32_t pathEnd() const;
+    uint32_t queryEnd() const;
 
-protected:
-    std::list<std::string> m_pathSegments;
-
-private:
-    std::string m_scheme;
-    std::string m_userInfo;
-    std::string m_host;
-    uint16_t m_port;
-    bool m_portDefault;
-    std::string m_query;
-    std::string m_fragment;
+    std::string m_url;
+    Components m_components;
 };
 
 LIBMPDPP_NAMESPACE_END
 
 inline std::ostream &operator<<(std::ostream &os, const LIBMPDPP_NAMESPACE_CLASS(DecomposedURL) &url)
 {
-    os << std::string(url);
+    os << url.str();
     return os;
 }
 
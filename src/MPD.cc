@@ -10,13 +10,32 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <climits>
+#include <exception>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <regex>
 #include <sstream>
+#include <span>
 #include <string>
-
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <libxml/xmlreader.h>
 #include <libxml++/libxml++.h>
 #include <glibmm/ustring.h>
 
@@ -27,17 +46,24 @@
 #include "libmpd++/Descriptor.hh"
 #include "libmpd++/InitializationSet.hh"
 #include "libmpd++/LeapSecondInformation.hh"
+#include "libmpd++/MemoryResource.hh"
 #include "libmpd++/Metrics.hh"
+#include "libmpd++/ParseFilter.hh"
 #include "libmpd++/PatchLocation.hh"
 #include "libmpd++/Period.hh"
 #include "libmpd++/ProgramInformation.hh"
 #include "libmpd++/SegmentAvailability.hh"
 #include "libmpd++/ServiceDescription.hh"
+#include "libmpd++/StringPool.hh"
 #include "libmpd++/UIntVWithID.hh"
 #include "libmpd++/URI.hh"
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "parse_tables.hh"
+#include "Snapshot.hh"
+#include "span_iterators.hh"
+#include "UnparsedElement.hh"
 
 #include "libmpd++/MPD.hh"
 
@@ -46,10 +72,169 @@ static const int g_MPD_formatting_xindex = std::ios_base::xalloc();
 using namespace std::literals::chrono_literals;
 LIBMPDPP_NAMESPACE_BEGIN
 
-static MPD::time_type str_to_time_point(const std::string &str);
-static std::list<URI> str_to_uri_list(const std::string &str, char sep = ',');
+static std::vector<URI> str_to_uri_list(const std::string &str, char sep = ',');
+static int xml_reader_istream_read(void *context, char *buffer, int len);
 
 namespace {
+using XmlTextReaderPtr = std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)>;
+
+// Frees the libxml++ wrappers for a node when leaving a scope, so that nodes freed by the text reader have no dangling wrappers
+class NodeWrappersGuard {
+public:
+    NodeWrappersGuard(xmlNodePtr node) :m_node(node) {};
+    ~NodeWrappersGuard() { xmlpp::Node::free_wrappers(m_node); };
+
+private:
+    xmlNodePtr m_node;
+};
+
+// Check if the element at the reader's current position is skipped by the filter, without expanding it
+bool reader_skips_element(xmlTextReaderPtr reader, const ParseFilter &filter)
+{
+    const xmlChar *ns_uri = xmlTextReaderConstNamespaceUri(reader);
+    const xmlChar *name = xmlTextReaderConstLocalName(reader);
+    return ns_uri && name && xmlStrcmp(ns_uri, BAD_CAST MPD_NS) == 0 && filter.skipsElement(reinterpret_cast<const char*>(name));
+}
+
+// Copy an element without its children, as the reader only guarantees the element and its attributes at the start tag
+xmlNodePtr copy_reader_element(xmlDocPtr doc, xmlNodePtr parent, const xmlNode *node)
+{
+    xmlNodePtr copy = xmlNewDocNode(doc, nullptr, node->name, nullptr);
+    if (parent) xmlAddChild(parent, copy);
+    for (const xmlNs *ns = node->nsDef; ns; ns = ns->next) xmlNewNs(copy, ns->href, ns->prefix);
+    if (node->ns) {
+        xmlNsPtr ns = xmlSearchNsByHref(doc, copy, node->ns->href);
+        if (!ns) ns = xmlNewNs(copy, node->ns->href, node->ns->prefix);
+        xmlSetNs(copy, ns);
+    }
+    copy->properties = xmlCopyPropList(copy, node->properties);
+    return copy;
+}
+
+/* Read the element at the reader's current position into doc, leaving out any elements skipped by the filter
+ *
+ * Unlike xmlTextReaderExpand(), this steps over the skipped subtrees at any depth without building them. The reader is left on the
+ * end tag of the element, or on the element itself if it is empty, so that xmlTextReaderNext() moves on to the next sibling. The
+ * returned element is not linked into doc and must be freed by the caller, nullptr is returned if the reader fails.
+ */
+xmlNodePtr read_filtered_element(xmlTextReaderPtr reader, xmlDocPtr doc, const ParseFilter &filter)
+{
+    xmlNodePtr top = copy_reader_element(doc, nullptr, xmlTextReaderCurrentNode(reader));
+    if (xmlTextReaderIsEmptyElement(reader) == 1) return top;
+
+    xmlNodePtr parent = top;
+    int ret = xmlTextReaderRead(reader);
+    while (ret == 1) {
+        switch (xmlTextReaderNodeType(reader)) {
+        case XML_READER_TYPE_ELEMENT:
+            if (reader_skips_element(reader, filter)) {
+                ret = xmlTextReaderNext(reader);
+                continue;
+            }
+            {
+                xmlNodePtr elem = copy_reader_element(doc, parent, xmlTextReaderCurrentNode(reader));
+                if (xmlTextReaderIsEmptyElement(reader) != 1) parent = elem;
+            }
+            break;
+        case XML_READER_TYPE_END_ELEMENT:
+            if (parent == top) return top;
+            parent = parent->parent;
+            break;
+        case XML_READER_TYPE_TEXT:
+        case XML_READER_TYPE_WHITESPACE:
+        case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+            xmlAddChild(parent, xmlNewDocText(doc, xmlTextReaderConstValue(reader)));
+            break;
+        case XML_READER_TYPE_CDATA:
+            {
+                const xmlChar *value = xmlTextReaderConstValue(reader);
+                xmlAddChild(parent, xmlNewCDataBlock(doc, value, xmlStrlen(value)));
+            }
+            break;
+        default:
+            break;
+        }
+        ret = xmlTextReaderRead(reader);
+    }
+
+    xmlFreeNode(top);
+    return nullptr;
+}
+
+/* Read-only memory mapping of a regular file
+ *
+ * This allows the XML parsers to read the file from the page cache without read() calls into a growing read buffer. Depending on
+ * the libxml2 version, the parser may still copy the mapped bytes into its own input buffer, so the saving varies between
+ * libxml2 releases.
+ *
+ * If the file is not a regular file (e.g. a pipe or character device), is empty, is too large for the libxml2 memory APIs or
+ * cannot be mapped then isMapped() will return false and the caller should fall back to reading the file by name.
+ *
+ * The file must not be modified in place while mapped: if it is truncated, accessing the lost pages raises SIGBUS, and if it is
+ * rewritten the parser may see a mix of old and new contents. Replacing the file by renaming a new file over it is safe, as the
+ * mapping keeps the old file contents. The file descriptor is kept open so that unchanged() can detect in place rewrites that
+ * happened while parsing.
+ */
+class MappedFile {
+public:
+    MappedFile(const std::string &filename)
+        :m_data(nullptr)
+        ,m_size(0)
+        ,m_fd(-1)
+        ,m_mtime(0)
+    {
+#ifdef HAVE_MMAP
+        int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= INT_MAX) {
+            void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                m_data = addr;
+                m_size = static_cast<size_t>(st.st_size);
+                m_fd = fd;
+                m_mtime = st.st_mtime;
+#ifdef MADV_SEQUENTIAL
+                madvise(m_data, m_size, MADV_SEQUENTIAL);
+#endif
+            }
+        }
+        if (m_fd < 0) close(fd);
+#endif
+    };
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifdef HAVE_MMAP
+        if (m_data) munmap(m_data, m_size);
+        if (m_fd >= 0) close(m_fd);
+#endif
+    };
+
+    bool isMapped() const { return m_data != nullptr; };
+    const char *data() const { return static_cast<const char*>(m_data); };
+    size_t size() const { return m_size; };
+
+    // Check that the mapped file still has the size and modification time it had when it was mapped
+    bool unchanged() const {
+#ifdef HAVE_MMAP
+        struct stat st;
+        if (m_fd < 0 || fstat(m_fd, &st) != 0) return false;
+        return static_cast<size_t>(st.st_size) == m_size && st.st_mtime == m_mtime;
+#else
+        return false;
+#endif
+    };
+
+private:
+    void *m_data;
+    size_t m_size;
+    int m_fd;
+    time_t m_mtime;
+};
+
 class MPDFormattingOptions {
 public:
     MPDFormattingOptions() :m_compact(false) {};
@@ -84,6 +269,7 @@ MPD::MPD(const duration_type &minimum_buffer_time, const URI &profile, const Per
     ,m_maxSubsegmentDuration()
     ,m_programInformations()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_locations()
     ,m_patchLocations()
     ,m_serviceDescriptions()
@@ -98,8 +284,12 @@ MPD::MPD(const duration_type &minimum_buffer_time, const URI &profile, const Per
     ,m_utcTimings()
     ,m_leapSecondInformation()
     ,m_mpdURL()
+    ,m_stringPool()
+    ,m_memoryResource(nullptr)
+    ,m_parseFilter()
     ,m_cache(new Cache)
 {
+    m_periods.front().setMPD(this);
 }
 
 MPD::MPD(const duration_type &minimum_buffer_time, const URI &profile, Period &&period, PresentationType presentation_type)
@@ -118,6 +308,7 @@ MPD::MPD(const duration_type &minimum_buffer_time, const URI &profile, Period &&
     ,m_maxSubsegmentDuration()
     ,m_programInformations()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_locations()
     ,m_patchLocations()
     ,m_serviceDescriptions()
@@ -132,12 +323,22 @@ MPD::MPD(const duration_type &minimum_buffer_time, const URI &profile, Period &&
     ,m_utcTimings()
     ,m_leapSecondInformation()
     ,m_mpdURL()
+    ,m_stringPool()
+    ,m_memoryResource(nullptr)
+    ,m_parseFilter()
     ,m_cache(new Cache)
 {
     m_periods.push_back(std::move(period));
+    m_periods.front().setMPD(this);
+}
+
+MPD::MPD(std::istream &input_stream, const std::optional<URI> &mpd_location, MPD::ParserBackend parser_backend,
+         unsigned int period_parse_threads)
+    :MPD(input_stream, mpd_location, ParseOptions().parserBackend(parser_backend).periodParseThreads(period_parse_threads))
+{
 }
 
-MPD::MPD(std::istream &input_stream, const std::optional<URI> &mpd_location)
+MPD::MPD(std::istream &input_stream, const std::optional<URI> &mpd_location, const MPD::ParseOptions &options)
     :m_id()
     ,m_profiles()
     ,m_type(MPD::STATIC)
@@ -153,6 +354,7 @@ MPD::MPD(std::istream &input_stream, const std::optional<URI> &mpd_location)
     ,m_maxSubsegmentDuration()
     ,m_programInformations()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_locations()
     ,m_patchLocations()
     ,m_serviceDescriptions()
@@ -167,18 +369,38 @@ MPD::MPD(std::istream &input_stream, const std::optional<URI> &mpd_location)
     ,m_utcTimings()
     ,m_leapSecondInformation()
     ,m_mpdURL(mpd_location)
-    ,m_cache(new Cache)
-{
+    ,m_stringPool(options.stringPool())
+    ,m_memoryResource(options.memoryResource())
+    ,m_parseFilter(options.parseFilter())
+    ,m_cache(nullptr)
+{
+    MemoryResourceScope scope(m_memoryResource);
+    ParseFilterScope filter_scope(m_parseFilter.get());
+    m_cache = new Cache;
+
+    if (options.parserBackend() == PARSER_STREAMING) {
+        XmlTextReaderPtr reader(xmlReaderForIO(xml_reader_istream_read, nullptr, &input_stream, nullptr, nullptr, XML_PARSE_NOENT),
+                                xmlFreeTextReader);
+        extractMPDStreaming(reader.get(), options);
+        return;
+    }
+
     xmlpp::DomParser dom_parser;
     dom_parser.set_validate(false);
     dom_parser.set_substitute_entities(true);
     dom_parser.parse_stream(input_stream);
     if (dom_parser) {
-        extractMPD(dom_parser.get_document());
+        extractMPD(dom_parser.get_document(), options);
     }
 }
 
-MPD::MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_location)
+MPD::MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_location, MPD::ParserBackend parser_backend,
+         unsigned int period_parse_threads)
+    :MPD(mpd_xml, mpd_location, ParseOptions().parserBackend(parser_backend).periodParseThreads(period_parse_threads))
+{
+}
+
+MPD::MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_location, const MPD::ParseOptions &options)
     :m_id()
     ,m_profiles()
     ,m_type(MPD::STATIC)
@@ -194,6 +416,7 @@ MPD::MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_locatio
     ,m_maxSubsegmentDuration()
     ,m_programInformations()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_locations()
     ,m_patchLocations()
     ,m_serviceDescriptions()
@@ -208,18 +431,39 @@ MPD::MPD(const std::vector<char> &mpd_xml, const std::optional<URI> &mpd_locatio
     ,m_utcTimings()
     ,m_leapSecondInformation()
     ,m_mpdURL(mpd_location)
-    ,m_cache(new Cache)
-{
+    ,m_stringPool(options.stringPool())
+    ,m_memoryResource(options.memoryResource())
+    ,m_parseFilter(options.parseFilter())
+    ,m_cache(nullptr)
+{
+    MemoryResourceScope scope(m_memoryResource);
+    ParseFilterScope filter_scope(m_parseFilter.get());
+    m_cache = new Cache;
+
+    if (options.parserBackend() == PARSER_STREAMING) {
+        XmlTextReaderPtr reader(xmlReaderForMemory(mpd_xml.data(), static_cast<int>(mpd_xml.size()), nullptr, nullptr,
+                                                   XML_PARSE_NOENT),
+                                xmlFreeTextReader);
+        extractMPDStreaming(reader.get(), options);
+        return;
+    }
+
     xmlpp::DomParser dom_parser;
     dom_parser.set_validate(false);
     dom_parser.set_substitute_entities(true);
     dom_parser.parse_memory_raw(reinterpret_cast<const unsigned char*>(mpd_xml.data()), mpd_xml.size());
     if (dom_parser) {
-        extractMPD(dom_parser.get_document());
+        extractMPD(dom_parser.get_document(), options);
     }
 }
 
-MPD::MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mpd_location)
+MPD::MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mpd_location, MPD::ParserBackend parser_backend,
+         unsigned int period_parse_threads)
+    :MPD(mpd_xml, mpd_location, ParseOptions().parserBackend(parser_backend).periodParseThreads(period_parse_threads))
+{
+}
+
+MPD::MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mpd_location, const MPD::ParseOptions &options)
     :m_id()
     ,m_profiles()
     ,m_type(MPD::STATIC)
@@ -235,6 +479,7 @@ MPD::MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mp
     ,m_maxSubsegmentDuration()
     ,m_programInformations()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_locations()
     ,m_patchLocations()
     ,m_serviceDescriptions()
@@ -249,18 +494,39 @@ MPD::MPD(const std::vector<unsigned char> &mpd_xml, const std::optional<URI> &mp
     ,m_utcTimings()
     ,m_leapSecondInformation()
     ,m_mpdURL(mpd_location)
-    ,m_cache(new Cache)
-{
+    ,m_stringPool(options.stringPool())
+    ,m_memoryResource(options.memoryResource())
+    ,m_parseFilter(options.parseFilter())
+    ,m_cache(nullptr)
+{
+    MemoryResourceScope scope(m_memoryResource);
+    ParseFilterScope filter_scope(m_parseFilter.get());
+    m_cache = new Cache;
+
+    if (options.parserBackend() == PARSER_STREAMING) {
+        XmlTextReaderPtr reader(xmlReaderForMemory(reinterpret_cast<const char*>(mpd_xml.data()), static_cast<int>(mpd_xml.size()),
+                                                   nullptr, nullptr, XML_PARSE_NOENT),
+                                xmlFreeTextReader);
+        extractMPDStreaming(reader.get(), options);
+        return;
+    }
+
     xmlpp::DomParser dom_parser;
     dom_parser.set_validate(false);
     dom_parser.set_substitute_entities(true);
     dom_parser.parse_memory_raw(mpd_xml.data(), mpd_xml.size());
     if (dom_parser) {
-        extractMPD(dom_parser.get_document());
+        extractMPD(dom_parser.get_document(), options);
     }
 }
 
-MPD::MPD(const std::string &filename, const std::optional<URI> &mpd_location)
+MPD::MPD(const std::string &filename, const std::optional<URI> &mpd_location, MPD::ParserBackend parser_backend,
+         unsigned int period_parse_threads)
+    :MPD(filename, mpd_location, ParseOptions().parserBackend(parser_backend).periodParseThreads(period_parse_threads))
+{
+}
+
+MPD::MPD(const std::string &filename, const std::optional<URI> &mpd_location, const MPD::ParseOptions &options)
     :m_id()
     ,m_profiles()
     ,m_type(MPD::STATIC)
@@ -276,6 +542,7 @@ MPD::MPD(const std::string &filename, const std::optional<URI> &mpd_location)
     ,m_maxSubsegmentDuration()
     ,m_programInformations()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_locations()
     ,m_patchLocations()
     ,m_serviceDescriptions()
@@ -290,14 +557,43 @@ MPD::MPD(const std::string &filename, const std::optional<URI> &mpd_location)
     ,m_utcTimings()
     ,m_leapSecondInformation()
     ,m_mpdURL(mpd_location)
-    ,m_cache(new Cache)
-{
+    ,m_stringPool(options.stringPool())
+    ,m_memoryResource(options.memoryResource())
+    ,m_parseFilter(options.parseFilter())
+    ,m_cache(nullptr)
+{
+    MemoryResourceScope scope(m_memoryResource);
+    ParseFilterScope filter_scope(m_parseFilter.get());
+    m_cache = new Cache;
+
+    MappedFile mapped_file(filename);
+
+    if (options.parserBackend() == PARSER_STREAMING) {
+        XmlTextReaderPtr reader(mapped_file.isMapped()?
+                                xmlReaderForMemory(mapped_file.data(), static_cast<int>(mapped_file.size()), filename.c_str(),
+                                                   nullptr, XML_PARSE_NOENT):
+                                xmlReaderForFile(filename.c_str(), nullptr, XML_PARSE_NOENT),
+                                xmlFreeTextReader);
+        extractMPDStreaming(reader.get(), options);
+        if (mapped_file.isMapped() && !mapped_file.unchanged()) {
+            throw ParseError("MPD file \"" + filename + "\" was modified while it was being parsed");
+        }
+        return;
+    }
+
     xmlpp::DomParser dom_parser;
     dom_parser.set_validate(false);
     dom_parser.set_substitute_entities(true);
-    dom_parser.parse_file(filename);
+    if (mapped_file.isMapped()) {
+        dom_parser.parse_memory_raw(reinterpret_cast<const unsigned char*>(mapped_file.data()), mapped_file.size());
+        if (!mapped_file.unchanged()) {
+            throw ParseError("MPD file \"" + filename + "\" was modified while it was being parsed");
+        }
+    } else {
+        dom_parser.parse_file(filename);
+    }
     if (dom_parser) {
-        extractMPD(dom_parser.get_document());
+        extractMPD(dom_parser.get_document(), options);
     }
 }
 
@@ -317,6 +613,7 @@ MPD::MPD(const MPD &other)
     ,m_maxSubsegmentDuration(other.m_maxSubsegmentDuration)
     ,m_programInformations(other.m_programInformations)
     ,m_baseURLs(other.m_baseURLs)
+    ,m_baseURLCache()
     ,m_locations(other.m_locations)
     ,m_patchLocations(other.m_patchLocations)
     ,m_serviceDescriptions(other.m_serviceDescriptions)
@@ -331,12 +628,16 @@ MPD::MPD(const MPD &other)
     ,m_utcTimings(other.m_utcTimings)
     ,m_leapSecondInformation(other.m_leapSecondInformation)
     ,m_mpdURL(other.m_mpdURL)
+    ,m_stringPool(other.m_stringPool)
+    ,m_memoryResource(nullptr)
+    ,m_parseFilter(other.m_parseFilter)
     ,m_cache(new Cache)
 {
-    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock;
-    m_cache->utcTimingOffsetFromSystemClock = other.m_cache->utcTimingOffsetFromSystemClock;
+    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock.load();
+    m_cache->utcTimingOffsetFromSystemClock = other.m_cache->utcTimingOffsetFromSystemClock.load();
     Period *prev = nullptr;
     for (auto &period : m_periods) {
+        period.setMPD(this);
         if (prev) {
             period.setPreviousSibling(prev);
             prev->setNextSibling(&period);
@@ -361,6 +662,7 @@ MPD::MPD(MPD &&other)
     ,m_maxSubsegmentDuration(std::move(other.m_maxSubsegmentDuration))
     ,m_programInformations(std::move(other.m_programInformations))
     ,m_baseURLs(std::move(other.m_baseURLs))
+    ,m_baseURLCache()
     ,m_locations(std::move(other.m_locations))
     ,m_patchLocations(std::move(other.m_patchLocations))
     ,m_serviceDescriptions(std::move(other.m_serviceDescriptions))
@@ -375,12 +677,16 @@ MPD::MPD(MPD &&other)
     ,m_utcTimings(std::move(other.m_utcTimings))
     ,m_leapSecondInformation(std::move(other.m_leapSecondInformation))
     ,m_mpdURL(std::move(other.m_mpdURL))
+    ,m_stringPool(std::move(other.m_stringPool))
+    ,m_memoryResource(other.m_memoryResource)
+    ,m_parseFilter(std::move(other.m_parseFilter))
     ,m_cache(new Cache)
 {
-    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock;
-    m_cache->utcTimingOffsetFromSystemClock = std::move(other.m_cache->utcTimingOffsetFromSystemClock);
+    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock.load();
+    m_cache->utcTimingOffsetFromSystemClock = other.m_cache->utcTimingOffsetFromSystemClock.load();
     Period *prev = nullptr;
     for (auto &period : m_periods) {
+        period.setMPD(this);
         if (prev) {
             period.setPreviousSibling(prev);
             prev->setNextSibling(&period);
@@ -411,6 +717,7 @@ MPD &MPD::operator=(const MPD &other)
     m_maxSubsegmentDuration = other.m_maxSubsegmentDuration;
     m_programInformations = other.m_programInformations;
     m_baseURLs = other.m_baseURLs;
+    invalidateBaseURLs();
     m_locations = other.m_locations;
     m_patchLocations = other.m_patchLocations;
     m_serviceDescriptions = other.m_serviceDescriptions;
@@ -419,6 +726,7 @@ MPD &MPD::operator=(const MPD &other)
     m_initializationPresentations = other.m_initializationPresentations;
     m_contentProtections = other.m_contentProtections;
     m_periods = other.m_periods;
+    cachePeriodTimesClear();
     Period *prev = nullptr;
     for (auto &period : m_periods) {
         period.setMPD(this);
@@ -433,9 +741,12 @@ MPD &MPD::operator=(const MPD &other)
     m_supplementaryProperties = other.m_supplementaryProperties;
     m_utcTimings = other.m_utcTimings;
     m_leapSecondInformation = other.m_leapSecondInformation;
+    m_stringPool = other.m_stringPool;
+    m_memoryResource = other.m_memoryResource;
+    m_parseFilter = other.m_parseFilter;
 
-    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock;
-    m_cache->utcTimingOffsetFromSystemClock = other.m_cache->utcTimingOffsetFromSystemClock;
+    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock.load();
+    m_cache->utcTimingOffsetFromSystemClock = other.m_cache->utcTimingOffsetFromSystemClock.load();
 
     return *this;
 }
@@ -457,6 +768,7 @@ MPD &MPD::operator=(MPD &&other)
     m_maxSubsegmentDuration = std::move(other.m_maxSubsegmentDuration);
     m_programInformations = std::move(other.m_programInformations);
     m_baseURLs = std::move(other.m_baseURLs);
+    invalidateBaseURLs();
     m_locations = std::move(other.m_locations);
     m_patchLocations = std::move(other.m_patchLocations);
     m_serviceDescriptions = std::move(other.m_serviceDescriptions);
@@ -465,6 +777,7 @@ MPD &MPD::operator=(MPD &&other)
     m_initializationPresentations = std::move(other.m_initializationPresentations);
     m_contentProtections = std::move(other.m_contentProtections);
     m_periods = std::move(other.m_periods);
+    cachePeriodTimesClear();
     Period *prev = nullptr;
     for (auto &period : m_periods) {
         period.setMPD(this);
@@ -479,17 +792,21 @@ MPD &MPD::operator=(MPD &&other)
     m_supplementaryProperties = std::move(other.m_supplementaryProperties);
     m_utcTimings = std::move(other.m_utcTimings);
     m_leapSecondInformation = std::move(other.m_leapSecondInformation);
+    m_stringPool = std::move(other.m_stringPool);
+    m_memoryResource = other.m_memoryResource;
+    m_parseFilter = std::move(other.m_parseFilter);
 
-    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock;
-    m_cache->utcTimingOffsetFromSystemClock = std::move(other.m_cache->utcTimingOffsetFromSystemClock);
+    m_cache->haveUtcTimingOffsetFromSystemClock = other.m_cache->haveUtcTimingOffsetFromSystemClock.load();
+    m_cache->utcTimingOffsetFromSystemClock = other.m_cache->utcTimingOffsetFromSystemClock.load();
 
     return *this;
 }
 
 namespace {
-template <class T>
-bool any_order_list_equal(const std::list<T> &a, const std::list<T> &b)
+template <class Container>
+bool any_order_list_equal(const Container &a, const Container &b)
 {
+    using T = typename Container::value_type;
     if (a.size() != b.size()) return false;
 
     std::list<const T*> b_copy;
@@ -581,112 +898,7 @@ std::string MPD::asXML(bool compact_xml) const
 {
     xmlpp::Document doc;
     xmlpp::Element *docroot = doc.create_root_node("MPD", MPD_NS);
-
-    if (m_id) {
-        docroot->set_attribute("id", m_id.value());
-    }
-    {
-        std::ostringstream oss;
-        const char *sep = "";
-        for (const auto &u : m_profiles) {
-             oss << sep << u;
-             sep = ",";
-        }
-        docroot->set_attribute("profiles", oss.str());
-    }
-    if (m_type != MPD::STATIC) {
-        docroot->set_attribute("type", "dynamic");
-    }
-    if (m_availabilityStartTime) {
-        docroot->set_attribute("availabilityStartTime", std::format(ISO8601_DATE_TIME_FORMAT, std::chrono::round<std::chrono::milliseconds>(m_availabilityStartTime.value())));
-    }
-    if (m_availabilityEndTime) {
-        docroot->set_attribute("availabilityEndTime", std::format(ISO8601_DATE_TIME_FORMAT, std::chrono::round<std::chrono::milliseconds>(m_availabilityEndTime.value())));
-    }
-    if (m_publishTime) {
-        docroot->set_attribute("publishTime", std::format(ISO8601_DATE_TIME_FORMAT, std::chrono::round<std::chrono::milliseconds>(m_publishTime.value())));
-    }
-    if (m_mediaPresentationDuration) {
-        docroot->set_attribute("mediaPresentationDuration", format_duration(std::chrono::round<std::chrono::milliseconds>(m_mediaPresentationDuration.value())));
-    }
-    if (m_minimumUpdatePeriod) {
-        docroot->set_attribute("minimumUpdatePeriod", format_duration(std::chrono::round<std::chrono::milliseconds>(m_minimumUpdatePeriod.value())));
-    }
-    docroot->set_attribute("minBufferTime", format_duration(std::chrono::round<std::chrono::milliseconds>(m_minBufferTime)));
-    if (m_timeShiftBufferDepth) {
-        docroot->set_attribute("timeShiftBufferDepth", format_duration(std::chrono::round<std::chrono::milliseconds>(m_timeShiftBufferDepth.value())));
-    }
-    if (m_suggestedPresentationDelay) {
-        docroot->set_attribute("suggestedPresentationDelay", format_duration(std::chrono::round<std::chrono::milliseconds>(m_suggestedPresentationDelay.value())));
-    }
-    if (m_maxSegmentDuration) {
-        docroot->set_attribute("maxSegmentDuration", format_duration(std::chrono::round<std::chrono::milliseconds>(m_maxSegmentDuration.value())));
-    }
-    if (m_maxSubsegmentDuration) {
-        docroot->set_attribute("maxSubsegmentDuration", format_duration(std::chrono::round<std::chrono::milliseconds>(m_maxSubsegmentDuration.value())));
-    }
-
-    // Child elements
-    for (const auto &pi : m_programInformations) {
-        xmlpp::Element *elem = docroot->add_child_element("ProgramInformation");
-        pi.setXMLElement(*elem);
-    }
-    for (const auto &url : m_baseURLs) {
-        xmlpp::Element *elem = docroot->add_child_element("BaseURL");
-        url.setXMLElement(*elem);
-    }
-    for (const auto &url : m_locations) {
-        xmlpp::Element *elem = docroot->add_child_element("Location");
-        elem->add_child_text(std::string(url));
-    }
-    for (const auto &pl : m_patchLocations) {
-        xmlpp::Element *elem = docroot->add_child_element("PatchLocation");
-        pl.setXMLElement(*elem);
-    }
-    for (const auto &sd : m_serviceDescriptions) {
-        xmlpp::Element *elem = docroot->add_child_element("ServiceDescription");
-        sd.setXMLElement(*elem);
-    }
-    for (const auto &is : m_initializationSets) {
-        xmlpp::Element *elem = docroot->add_child_element("InitializationSet");
-        is.setXMLElement(*elem);
-    }
-    for (const auto &ig : m_initializationGroups) {
-        xmlpp::Element *elem = docroot->add_child_element("InitializationGroup");
-        ig.setXMLElement(*elem);
-    }
-    for (const auto &ip : m_initializationPresentations) {
-        xmlpp::Element *elem = docroot->add_child_element("InitializationPresentation");
-        ip.setXMLElement(*elem);
-    }
-    for (const auto &cp : m_contentProtections) {
-        xmlpp::Element *elem = docroot->add_child_element("ContentProtection");
-        cp.setXMLElement(*elem);
-    }
-    for (const auto &period : m_periods) {
-        xmlpp::Element *elem = docroot->add_child_element("Period");
-        period.setXMLElement(*elem);
-    }
-    for (const auto &metric : m_metrics) {
-        xmlpp::Element *elem = docroot->add_child_element("Metrics");
-        metric.setXMLElement(*elem);
-    }
-    for (const auto &ep : m_essentialProperties) {
-        xmlpp::Element *elem = docroot->add_child_element("EssentialProperty");
-        ep.setXMLElement(*elem);
-    }
-    for (const auto &sp : m_supplementaryProperties) {
-        xmlpp::Element *elem = docroot->add_child_element("SupplementaryProperty");
-        sp.setXMLElement(*elem);
-    }
-    for (const auto &timing : m_utcTimings) {
-        xmlpp::Element *elem = docroot->add_child_element("UTCTiming");
-        timing.setXMLElement(*elem);
-    }
-    if (m_leapSecondInformation.has_value()) {
-        xmlpp::Element *elem = docroot->add_child_element("LeapSecondInformation");
-        m_leapSecondInformation.value().setXMLElement(*elem);
-    }
+    setXMLElement(*docroot);
 
     std::ostringstream oss;
 
@@ -736,12 +948,21 @@ MPD &MPD::profileAdd(URI &&uri)
     return *this;
 }
 
-MPD &MPD::profileRemove(const std::list<URI>::const_iterator &it)
+MPD &MPD::profileRemove(const std::span<const URI>::iterator &it)
+{
+    if (m_profiles.size() == 1) {
+        throw InvalidMPD("Removing the last profile will make the MPD invalid");
+    }
+    m_profiles.erase(vector_iterator(m_profiles, it));
+    return *this;
+}
+
+MPD &MPD::profileRemove(const std::span<URI>::iterator &it)
 {
     if (m_profiles.size() == 1) {
         throw InvalidMPD("Removing the last profile will make the MPD invalid");
     }
-    m_profiles.erase(it);
+    m_profiles.erase(vector_iterator(m_profiles, it));
     return *this;
 }
 
@@ -844,55 +1065,62 @@ MPD &MPD::programInformationRemove(const std::list<ProgramInformation>::iterator
 MPD &MPD::baseURLAdd(const BaseURL &base_url)
 {
     m_baseURLs.push_back(base_url);
+    invalidateBaseURLs();
     return *this;
 }
 
 MPD &MPD::baseURLAdd(BaseURL &&base_url)
 {
     m_baseURLs.push_back(std::move(base_url));
+    invalidateBaseURLs();
     return *this;
 }
 
 MPD &MPD::baseURLRemove(const BaseURL &base_url)
 {
     m_baseURLs.remove(base_url);
+    invalidateBaseURLs();
     return *this;
 }
 
 MPD &MPD::baseURLRemove(const std::list<BaseURL>::const_iterator &it)
 {
     m_baseURLs.erase(it);
+    invalidateBaseURLs();
     return *this;
 }
 
 MPD &MPD::baseURLRemove(const std::list<BaseURL>::iterator &it)
 {
     m_baseURLs.erase(it);
+    invalidateBaseURLs();
     return *this;
 }
 
-std::list<BaseURL> MPD::getBaseURLs() const
+const std::list<BaseURL> &MPD::getBaseURLs() const
 {
-    std::list<BaseURL> ret;
-    std::list<BaseURL> acquisition_urls;
+    return m_baseURLCache.get(m_cache->baseURLGeneration, [this]() {
+        std::list<BaseURL> ret;
+        std::list<BaseURL> acquisition_urls;
 
-    if (m_mpdURL) {
-        acquisition_urls.push_back(BaseURL(m_mpdURL.value()));
-    }
+        if (m_mpdURL) {
+            acquisition_urls.push_back(BaseURL(m_mpdURL.value()));
+        }
 
-    if (m_baseURLs.size() == 0) {
-        // No BaseURL elements, just use the acquisition URL instead as a plain BaseURL
-        ret = std::move(acquisition_urls);
-    } else {
-        for (const auto &base_url : m_baseURLs) {
-            if (base_url.url().isAbsoluteURL()) {
-                ret.push_back(base_url);
-            } else {
-                ret.push_back(base_url.resolveURL(acquisition_urls));
+        if (m_baseURLs.size() == 0) {
+            // No BaseURL elements, just use the acquisition URL instead as a plain BaseURL
+            ret = std::move(acquisition_urls);
+        } else {
+            for (const auto &base_url : m_baseURLs) {
+                if (base_url.url().isAbsoluteURL()) {
+                    ret.push_back(base_url);
+                } else {
+                    ret.push_back(base_url.resolveURL(acquisition_urls));
+                }
             }
         }
-    }
-    return ret;
+        return ret;
+    });
 }
 
 MPD &MPD::locationAdd(const URI &location)
@@ -1110,6 +1338,11 @@ std::list<Period>::const_iterator MPD::period(const std::string &id) const
     return std::find_if(m_periods.cbegin(), m_periods.cend(), [id](const Period &period) -> bool { return period.hasId() && period.id().value() == id; });
 }
 
+std::list<Period>::const_iterator MPD::period(const time_type &pres_time) const
+{
+    return getPeriodFor(pres_time);
+}
+
 MPD &MPD::periodAdd(const Period &period)
 {
     return periodAdd(Period(period));
@@ -1120,80 +1353,48 @@ MPD &MPD::periodAdd(Period &&period)
     // Assign this MPD as the parent MPD of the period
     period.setMPD(this);
 
+    auto insert_at = m_periods.cend();
     if (period.hasStart()) {
-        // insert in start time order
-        auto start = period.start().value();
-        auto it = std::find_if(m_periods.begin(), m_periods.end(), [start](const Period &p) -> bool { auto calc_start = p.calcStart(); return calc_start && calc_start.value() < start; });
-        auto next = it;
-        if (it != m_periods.end()) {
-            period.setPreviousSibling(&(*it));
-            next++;
-        }
-        if (next != m_periods.end()) {
-            period.setNextSibling(&(*next));
-        }
-        auto inserted = m_periods.insert(it, std::move(period));
-        if (it != m_periods.end()) {
-            it->setNextSibling(&(*inserted));
-        }
-        if (next != m_periods.end()) {
-            next->setPreviousSibling(&(*inserted));
-        }
+        // insert in start time order, after any Periods with the same start
+        cachePeriodTimes();
+        const auto &index = m_cache->periodIndex;
+        auto next = std::upper_bound(index.begin(), index.end(), period.start().value(),
+                                     [](const duration_type &start, const Cache::PeriodTimes &times) { return start < times.start; });
+        if (next != index.end()) insert_at = next->period;
+    }
+
+    bool appended = (insert_at == m_periods.cend());
+    auto inserted = m_periods.insert(insert_at, std::move(period));
+    Period *prev = (inserted == m_periods.begin())?nullptr:&(*std::prev(inserted));
+    Period *next = appended?nullptr:&(*std::next(inserted));
+    inserted->m_previousSibling = prev;
+    inserted->m_nextSibling = next;
+    if (prev) prev->m_nextSibling = &(*inserted);
+    if (next) next->m_previousSibling = &(*inserted);
+
+    if (appended) {
+        cachePeriodTimesAppended();
     } else {
-        // no start so just stick at the end
-        auto it = m_periods.rbegin();
-        m_periods.push_back(std::move(period));
-        Period &inserted = m_periods.back();
-        if (it != m_periods.rend()) {
-            it->setNextSibling(&inserted);
-            inserted.setPreviousSibling(&(*it));
-        }
+        cachePeriodTimesClear();
     }
     return *this;
 }
 
 MPD &MPD::periodRemove(const Period &period)
 {
-    decltype(m_periods)::iterator it;
+    decltype(m_periods)::const_iterator it;
 
     if (period.hasId()) {
         // remove by id only
         auto id = period.id().value();
-        it = std::find_if(m_periods.begin(), m_periods.end(), [id](const Period &p) -> bool { return p.hasId() && p.id().value() == id; });
+        it = std::find_if(m_periods.cbegin(), m_periods.cend(), [id](const Period &p) -> bool { return p.hasId() && p.id().value() == id; });
     } else {
         // remove by value comparison
-        it = std::find(m_periods.begin(), m_periods.end(), period);
+        it = std::find(m_periods.cbegin(), m_periods.cend(), period);
     }
-    if (it != m_periods.end()) {
+    if (it != m_periods.cend()) {
         // We found a match, so remove it and adjust surrounding Period objects
-        if (m_periods.size() == 1) {
-            throw InvalidMPD("Removing the only Period will make the MPD invalid");
-        }
-        it = m_periods.erase(it);
-    }    
-    if (it !=  m_periods.end()) {
-        auto prev = it;
-        // was not the last one so reset surrounding siblings pointers
-        if (it != m_periods.begin()) {
-            // As long as we are not at the begining of the list we can decrement
-            prev--;
-        } else {
-            // Otherwise there is no previous value
-            prev = m_periods.end();
-        }
-        if (prev != m_periods.end()) {
-            it->setPreviousSibling(&(*prev));
-            prev->setNextSibling(&(*it));       
-        } else {
-            // we deleted the begining of the list, so just reset next
-            it->setPreviousSibling(nullptr);
-        }
-    } else {
-        // we erased the end of the list to just reset previous
-        auto prev = m_periods.rbegin();
-        if (prev != m_periods.rend()) {
-            prev->setNextSibling(nullptr);
-        }
+        periodRemove(it);
     }
     return *this;
 }
@@ -1204,66 +1405,23 @@ MPD &MPD::periodRemove(const std::list<Period>::const_iterator &period_it)
         throw InvalidMPD("Removing the only Period will make the MPD invalid");
     }
 
+    // The index entries refer to the Period, so update them before it goes
+    if (!cachePeriodTimesRemove(period_it)) cachePeriodTimesClear();
+
     auto it = m_periods.erase(period_it);
-    if (it !=  m_periods.end()) {
-        // was not the last one so reset surrounding siblings pointers
-        auto prev = it;
-        if (it != m_periods.begin()) {
-            // As long as we are not at the begining of the list we can decrement
-            prev--;
-        } else {
-            // Otherwise there is no previous value
-            prev = m_periods.end();
-        }
-        if (prev != m_periods.end()) {
-            it->setPreviousSibling(&(*prev));
-            prev->setNextSibling(&(*it));
-        } else {
-            // we deleted the begining of the list, so just reset next
-            it->setPreviousSibling(nullptr);
-        }
-    } else {
-        // we erased the end of the list to just reset previous
-        auto prev = m_periods.rbegin();
-        if (prev != m_periods.rend()) {
-            prev->setNextSibling(nullptr);
-        }
-    }
+
+    // reset surrounding siblings pointers
+    Period *prev = (it == m_periods.begin())?nullptr:&(*std::prev(it));
+    Period *next = (it == m_periods.end())?nullptr:&(*it);
+    if (prev) prev->m_nextSibling = next;
+    if (next) next->m_previousSibling = prev;
+
     return *this;
 }
 
 MPD &MPD::periodRemove(const std::list<Period>::iterator &period_it)
 {
-    if (m_periods.size() == 1) {
-        throw InvalidMPD("Removing the only Period will make the MPD invalid");
-    }
-
-    auto it = m_periods.erase(period_it);
-    if (it !=  m_periods.end()) {
-        // was not the last one so reset surrounding siblings pointers
-        auto prev = it;
-        if (it != m_periods.begin()) {
-            // As long as we are not at the begining of the list we can decrement
-            prev--;
-        } else {
-            // Otherwise there is no previous value
-            prev = m_periods.end();
-        }
-        if (prev != m_periods.end()) {
-            it->setPreviousSibling(&(*prev));
-            prev->setNextSibling(&(*it));
-        } else {
-            // we deleted the begining of the list, so just reset next
-            it->setPreviousSibling(nullptr);
-        }
-    } else {
-        // we erased the end of the list to just reset previous
-        auto prev = m_periods.rbegin();
-        if (prev != m_periods.rend()) {
-            prev->setNextSibling(nullptr);
-        }
-    }
-    return *this;
+    return periodRemove(std::list<Period>::const_iterator(period_it));
 }
 
 MPD &MPD::metricAdd(const Metrics &metrics)
@@ -1390,9 +1548,10 @@ void MPD::synchroniseWithUTCTiming() const
 {
     if (m_utcTimings.empty()) return;
 
-    // TODO: fetch one or more UTCTiming timestamp and store the (mean) offset from the system clock
-    //       m_cache->haveUtcTimingOffsetFromSystemClock = true;
-    //       m_cache->utcTimingOffsetFromSystemClock = duration to add to system_clock to make UTCTiming result.
+    // TODO: fetch one or more UTCTiming timestamp and store the (mean) offset from the system clock, storing the offset before
+    //       the flag so that concurrent queries never see the flag without the offset
+    //       m_cache->utcTimingOffsetFromSystemClock.store(duration to add to system_clock to make UTCTiming result);
+    //       m_cache->haveUtcTimingOffsetFromSystemClock.store(true, std::memory_order_release);
 }
 
 const LeapSecondInformation &MPD::leapSecondInformation(const LeapSecondInformation &default_val) const
@@ -1468,22 +1627,217 @@ std::list<SegmentAvailability> MPD::selectedInitializationSegments(const time_ty
     return ret;
 }
 
+std::list<MPD::RefreshChange> MPD::refresh(MPD &&updated)
+{
+    std::list<RefreshChange> changes;
+
+    // Compare and update the MPD attributes and child elements, other than the Periods
+    std::list<Period> periods(std::move(m_periods));
+    std::list<Period> updated_periods(std::move(updated.m_periods));
+    bool mpd_changed = !(*this == updated);
+    m_periods = std::move(periods);
+    if (mpd_changed) {
+        bool utc_timings_changed = !any_order_list_equal(m_utcTimings, updated.m_utcTimings);
+        m_id = std::move(updated.m_id);
+        m_profiles = std::move(updated.m_profiles);
+        m_type = updated.m_type;
+        m_availabilityStartTime = std::move(updated.m_availabilityStartTime);
+        m_availabilityEndTime = std::move(updated.m_availabilityEndTime);
+        m_publishTime = std::move(updated.m_publishTime);
+        m_mediaPresentationDuration = std::move(updated.m_mediaPresentationDuration);
+        m_minimumUpdatePeriod = std::move(updated.m_minimumUpdatePeriod);
+        m_minBufferTime = std::move(updated.m_minBufferTime);
+        m_timeShiftBufferDepth = std::move(updated.m_timeShiftBufferDepth);
+        m_suggestedPresentationDelay = std::move(updated.m_suggestedPresentationDelay);
+        m_maxSegmentDuration = std::move(updated.m_maxSegmentDuration);
+        m_maxSubsegmentDuration = std::move(updated.m_maxSubsegmentDuration);
+        m_programInformations = std::move(updated.m_programInformations);
+        m_baseURLs = std::move(updated.m_baseURLs);
+        invalidateBaseURLs();
+        m_locations = std::move(updated.m_locations);
+        m_patchLocations = std::move(updated.m_patchLocations);
+        m_serviceDescriptions = std::move(updated.m_serviceDescriptions);
+        m_initializationSets = std::move(updated.m_initializationSets);
+        m_initializationGroups = std::move(updated.m_initializationGroups);
+        m_initializationPresentations = std::move(updated.m_initializationPresentations);
+        m_contentProtections = std::move(updated.m_contentProtections);
+        m_metrics = std::move(updated.m_metrics);
+        m_essentialProperties = std::move(updated.m_essentialProperties);
+        m_supplementaryProperties = std::move(updated.m_supplementaryProperties);
+        m_utcTimings = std::move(updated.m_utcTimings);
+        m_leapSecondInformation = std::move(updated.m_leapSecondInformation);
+        if (utc_timings_changed) m_cache->haveUtcTimingOffsetFromSystemClock = false;
+        cachePeriodTimesClear();
+        changes.emplace_back(RefreshChange::UPDATED, RefreshChange::MPD_ELEMENT);
+    }
+
+    // Match up the Periods by @id, or by position for those without an @id
+    std::unordered_map<std::string, std::list<Period>::iterator> periods_by_id;
+    std::list<std::list<Period>::iterator> periods_without_id;
+    for (auto it = m_periods.begin(); it != m_periods.end(); it++) {
+        if (it->id()) {
+            periods_by_id.emplace(it->id().value(), it);
+        } else {
+            periods_without_id.push_back(it);
+        }
+    }
+
+    // Build the new Period list in the updated order, splicing keeps the existing Period objects where they are in memory
+    std::list<Period> new_periods;
+    bool periods_changed = false;
+    while (!updated_periods.empty()) {
+        auto updated_it = updated_periods.begin();
+        auto match = m_periods.end();
+        if (updated_it->id()) {
+            auto found = periods_by_id.find(updated_it->id().value());
+            if (found != periods_by_id.end()) {
+                match = found->second;
+                periods_by_id.erase(found);
+            }
+        } else if (!periods_without_id.empty()) {
+            match = periods_without_id.front();
+            periods_without_id.pop_front();
+        }
+        if (match != m_periods.end()) {
+            if (refreshPeriod(*match, *updated_it, changes)) periods_changed = true;
+            if (match != m_periods.begin()) periods_changed = true; // Period order has changed
+            new_periods.splice(new_periods.end(), m_periods, match);
+            updated_periods.erase(updated_it);
+        } else {
+            new_periods.splice(new_periods.end(), updated_periods, updated_it);
+            changes.emplace_back(RefreshChange::ADDED, RefreshChange::PERIOD_ELEMENT, new_periods.back().id());
+            periods_changed = true;
+        }
+    }
+    for (const auto &period : m_periods) {
+        changes.emplace_back(RefreshChange::REMOVED, RefreshChange::PERIOD_ELEMENT, period.id());
+        periods_changed = true;
+    }
+    m_periods = std::move(new_periods);
+
+    // The calculated Period times are only discarded if the Periods have changed
+    relinkPeriods(periods_changed);
+
+    return changes;
+}
+
+std::list<MPD::RefreshChange> MPD::refresh(const std::vector<char> &mpd_xml, const MPD::ParseOptions &options)
+{
+    return refresh(MPD(mpd_xml, m_mpdURL, refreshParseOptions(options)));
+}
+
+std::list<MPD::RefreshChange> MPD::refresh(const std::vector<unsigned char> &mpd_xml, const MPD::ParseOptions &options)
+{
+    return refresh(MPD(mpd_xml, m_mpdURL, refreshParseOptions(options)));
+}
+
+std::list<MPD::RefreshChange> MPD::refresh(std::istream &input_stream, const MPD::ParseOptions &options)
+{
+    return refresh(MPD(input_stream, m_mpdURL, refreshParseOptions(options)));
+}
+
+MPD &MPD::stringPool(const std::shared_ptr<StringPool> &pool)
+{
+    m_stringPool = pool;
+    if (m_stringPool) m_stringPool->intern(*this);
+    return *this;
+}
+
+void MPD::saveSnapshot(std::ostream &output_stream) const
+{
+    auto snapshot = saveSnapshot();
+    output_stream.write(reinterpret_cast<const char*>(snapshot.data()), snapshot.size());
+}
+
+std::vector<unsigned char> MPD::saveSnapshot() const
+{
+    std::vector<unsigned char> snapshot;
+    SnapshotWriter(snapshot).writeSnapshot(*this);
+    return snapshot;
+}
+
+MPD MPD::loadSnapshot(const std::vector<unsigned char> &snapshot)
+{
+    SnapshotReader reader(snapshot.data(), snapshot.size());
+    return MPD(reader);
+}
+
+MPD MPD::loadSnapshot(std::istream &input_stream)
+{
+    std::vector<unsigned char> snapshot{std::istreambuf_iterator<char>(input_stream), std::istreambuf_iterator<char>()};
+    return loadSnapshot(snapshot);
+}
+
 // protected:
 
 MPD::time_type MPD::systemTimeToPresentationTime(const MPD::time_type &system_time) const
 {
-    if (!m_cache->haveUtcTimingOffsetFromSystemClock) synchroniseWithUTCTiming();
-    return system_time + m_cache->utcTimingOffsetFromSystemClock;
+    if (!m_cache->haveUtcTimingOffsetFromSystemClock.load(std::memory_order_acquire)) synchroniseWithUTCTiming();
+    return system_time + m_cache->utcTimingOffsetFromSystemClock.load(std::memory_order_relaxed);
 }
 
 MPD::time_type MPD::presentationTimeToSystemTime(const MPD::time_type &pres_time) const
 {
-    if (!m_cache->haveUtcTimingOffsetFromSystemClock) synchroniseWithUTCTiming();
-    return pres_time - m_cache->utcTimingOffsetFromSystemClock;
+    if (!m_cache->haveUtcTimingOffsetFromSystemClock.load(std::memory_order_acquire)) synchroniseWithUTCTiming();
+    return pres_time - m_cache->utcTimingOffsetFromSystemClock.load(std::memory_order_relaxed);
+}
+
+CacheGeneration &MPD::baseURLGeneration(const MPD *mpd)
+{
+    return mpd?mpd->m_cache->baseURLGeneration:CacheGeneration::detached();
+}
+
+CacheGeneration &MPD::addressingGeneration(const MPD *mpd)
+{
+    return mpd?mpd->m_cache->addressingGeneration:CacheGeneration::detached();
 }
 
 // private:
 
+MPD::MPD(SnapshotReader &reader)
+    :m_id()
+    ,m_profiles()
+    ,m_type(STATIC)
+    ,m_availabilityStartTime()
+    ,m_availabilityEndTime()
+    ,m_publishTime()
+    ,m_mediaPresentationDuration()
+    ,m_minimumUpdatePeriod()
+    ,m_minBufferTime()
+    ,m_timeShiftBufferDepth()
+    ,m_suggestedPresentationDelay()
+    ,m_maxSegmentDuration()
+    ,m_maxSubsegmentDuration()
+    ,m_programInformations()
+    ,m_baseURLs()
+    ,m_baseURLCache()
+    ,m_locations()
+    ,m_patchLocations()
+    ,m_serviceDescriptions()
+    ,m_initializationSets()
+    ,m_initializationGroups()
+    ,m_initializationPresentations()
+    ,m_contentProtections()
+    ,m_periods()
+    ,m_metrics()
+    ,m_essentialProperties()
+    ,m_supplementaryProperties()
+    ,m_utcTimings()
+    ,m_leapSecondInformation()
+    ,m_mpdURL()
+    ,m_stringPool()
+    ,m_memoryResource(nullptr)
+    ,m_parseFilter()
+    ,m_cache(new Cache)
+{
+    try {
+        reader.readSnapshot(*this);
+    } catch (...) {
+        delete m_cache;
+        throw;
+    }
+}
+
 template <class T>
 concept has_setMPD = requires(T a)
 {
@@ -1504,116 +1858,282 @@ T &_setMPD(MPD *mpd, T &a)
     return a;
 }
 
-void MPD::extractMPD(void *doc)
+void MPD::extractMPD(void *doc, const ParseOptions &options)
 {
     if (!doc) return;
     xmlpp::Document *mpd_doc = reinterpret_cast<xmlpp::Document*>(doc);
     xmlpp::Element *mpd_root = mpd_doc->get_root_node();
-    if (mpd_root->get_namespace_uri() != MPD_NS) throw ParseError("MPD root node not in " MPD_NS " namespace");
-    if (mpd_root->get_name() != "MPD") throw ParseError("MPD root node is not <MPD>");
-
-#define CONCAT(a,b) a##b
-#define OPT_ATTR_FN(name,fn) do { \
-        node_set = mpd_root->find("@" #name); \
-        if (node_set.size() == 1) { \
-            xmlpp::Attribute *CONCAT(name,_attr) = dynamic_cast<xmlpp::Attribute*>(node_set.front()); \
-            CONCAT(m_,name) = fn(CONCAT(name,_attr)->get_value()); \
-        } else { \
-            CONCAT(m_,name).reset(); \
-        } \
-    } while (0)
+
+    extractMPDAttributes(*mpd_root);
+    std::vector<xmlpp::Node*> period_nodes;
+    std::vector<xmlpp::Node*> *deferred_periods = nullptr;
+    if (options.lazyPeriods() || options.periodParseThreads() != 1) deferred_periods = &period_nodes;
+    for (auto child : mpd_root->get_children()) {
+        xmlpp::Element *child_elem = dynamic_cast<xmlpp::Element*>(child);
+        if (child_elem) extractMPDChild(*child_elem, deferred_periods);
+    }
+    if (options.lazyPeriods()) {
+        // The DOM document is freed once parsing is done, so keep copies of the Period elements
+        auto period_doc = UnparsedDocument::create();
+        std::vector<std::shared_ptr<UnparsedElement> > unparsed_periods;
+        unparsed_periods.reserve(period_nodes.size());
+        for (auto node : period_nodes) {
+            unparsed_periods.push_back(period_doc->copyElement(node->cobj()));
+        }
+        extractMPDLazyPeriods(unparsed_periods);
+    } else if (deferred_periods) {
+        extractMPDPeriods(period_nodes, options.periodParseThreads());
+    }
+    extractMPDFinish();
+}
+
+void MPD::extractMPDStreaming(void *reader_ptr, const ParseOptions &options)
+{
+    if (!reader_ptr) throw ParseError("Unable to create an XML reader for the MPD");
+    xmlTextReaderPtr reader = reinterpret_cast<xmlTextReaderPtr>(reader_ptr);
+
+    // Find the root element
+    int ret;
+    for (ret = xmlTextReaderRead(reader); ret == 1 && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT;
+         ret = xmlTextReaderRead(reader));
+    if (ret != 1) throw ParseError("MPD XML document has no root element");
+
+    // At the root start tag the element attributes are available, but none of the children have been read yet
+    xmlNodePtr root = xmlTextReaderCurrentNode(reader);
+    xmlpp::Node::create_wrapper(root);
+    NodeWrappersGuard root_guard(root);
+    extractMPDAttributes(*static_cast<xmlpp::Element*>(root->_private));
+
+    // When parsing Periods lazily or in parallel, the Period subtrees are copied so that they survive the reader moving on
+    std::shared_ptr<UnparsedDocument> period_doc;
+    std::vector<std::shared_ptr<UnparsedElement> > unparsed_periods;
+    if (options.lazyPeriods() || options.periodParseThreads() != 1) period_doc = UnparsedDocument::create();
+
+    // Expand each child of the root element in turn, the reader frees each subtree once we move past it. With a filter, the
+    // children are read into filtered_doc instead so that filtered elements are stepped over, at any depth, without expanding them.
+    const ParseFilter *filter = ParseFilterScope::current();
+    std::unique_ptr<xmlDoc, decltype(&xmlFreeDoc)> filtered_doc(nullptr, &xmlFreeDoc);
+    if (filter && !filter->empty()) filtered_doc.reset(xmlNewDoc(BAD_CAST "1.0"));
+    if (xmlTextReaderIsEmptyElement(reader) != 1) {
+        ret = xmlTextReaderRead(reader);
+        while (ret == 1 && xmlTextReaderDepth(reader) > 0) {
+            if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT) {
+                if (filtered_doc && reader_skips_element(reader, *filter)) {
+                    ret = xmlTextReaderNext(reader);
+                    continue;
+                }
+                xmlNodePtr child;
+                if (filtered_doc) {
+                    child = read_filtered_element(reader, filtered_doc.get(), *filter);
+                } else {
+                    child = xmlTextReaderExpand(reader);
+                }
+                if (!child) {
+                    ret = -1;
+                    break;
+                }
+                if (period_doc && child->ns && child->ns->href && xmlStrcmp(child->ns->href, BAD_CAST MPD_NS) == 0 &&
+                    xmlStrcmp(child->name, BAD_CAST "Period") == 0) {
+                    unparsed_periods.push_back(period_doc->copyElement(child));
+                } else {
+                    xmlpp::Node::create_wrapper(child);
+                    NodeWrappersGuard child_guard(child);
+                    extractMPDChild(*static_cast<xmlpp::Element*>(child->_private));
+                }
+                if (filtered_doc) xmlFreeNode(child);
+                ret = xmlTextReaderNext(reader);
+            } else {
+                ret = xmlTextReaderRead(reader);
+            }
+        }
+    }
+    if (ret < 0) throw ParseError("Error while parsing MPD XML");
+
+    if (options.lazyPeriods()) {
+        extractMPDLazyPeriods(unparsed_periods);
+    } else if (period_doc) {
+        // Wrappers created here are freed along with period_doc
+        std::vector<xmlpp::Node*> period_nodes;
+        period_nodes.reserve(unparsed_periods.size());
+        for (const auto &unparsed : unparsed_periods) {
+            xmlpp::Node::create_wrapper(unparsed->node());
+            period_nodes.push_back(static_cast<xmlpp::Node*>(unparsed->node()->_private));
+        }
+        extractMPDPeriods(period_nodes, options.periodParseThreads());
+    }
+    extractMPDFinish();
+}
+
+void MPD::extractMPDAttributes(xmlpp::Element &mpd_root)
+{
+    if (mpd_root.get_namespace_uri() != MPD_NS) throw ParseError("MPD root node not in " MPD_NS " namespace");
+    if (mpd_root.get_name() != "MPD") throw ParseError("MPD root node is not <MPD>");
+
+#define OPT_ATTR_FN(name,fn) {#name, [](MPD &mpd, const std::string &val) { mpd.m_ ## name = fn(val); }}
 #define OPT_ATTR_STRING(name) OPT_ATTR_FN(name, std::string)
 #define OPT_ATTR_TIME_POINT(name) OPT_ATTR_FN(name, str_to_time_point)
 #define OPT_ATTR_DURN(name) OPT_ATTR_FN(name, str_to_duration<MPD::duration_type>)
-#define MAND_ATTR_FN(name,fn) do { \
-        node_set = mpd_root->find("@" #name); \
-        if (node_set.size() == 1) { \
-            xmlpp::Attribute *CONCAT(name,_attr) = dynamic_cast<xmlpp::Attribute*>(node_set.front()); \
-            CONCAT(m_,name) = fn(CONCAT(name,_attr)->get_value()); \
-        } else { \
-            throw ParseError("MPD must have a \"" #name "\" attribute"); \
-        } \
-    } while (0)
+#define MAND_ATTR_FN(name,fn) {#name, [](MPD &mpd, const std::string &val) { mpd.m_ ## name = fn(val); }, true}
 #define MAND_ATTR_DURN(name) MAND_ATTR_FN(name, str_to_duration<MPD::duration_type>)
-#define OPT_ELEM_LIST_CLASS(var, element, cls) do { \
-        node_set = mpd_root->find("mpd:" #element, ns_map); \
-        var.clear(); \
-        for (auto node : node_set) { \
-             var.push_back(cls(*node)); \
-             _setMPD(this, var.back()); \
-        } \
-    } while (0)
-#define MAND_ELEM_LIST_CLASS(var, element, cls) do { \
-        node_set = mpd_root->find("mpd:" #element, ns_map); \
-        if (node_set.size() == 0) throw ParseError("MPD needs at least one " #element " element"); \
-        var.clear(); \
-        for (auto node : node_set) { \
-             var.push_back(cls(*node)); \
-             _setMPD(this, var.back()); \
-        } \
-    } while (0)
-#define OPT_ELEM_CLASS(var, element, cls) do { \
-        node_set = mpd_root->find("mpd:" #element, ns_map); \
-        if (node_set.size() == 0) { \
-            var.reset(); \
-        } else if (node_set.size() == 1) { \
-            var = cls(*node_set.front()); \
-            _setMPD(this, var); \
-        } else { \
-            throw ParseError("MPD has too many " #element " elements"); \
-        } \
-    } while (0)
-
-    xmlpp::Node::NodeSet node_set;
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}
-    };
 
+    static const AttributeTable<MPD> attribute_table("MPD", {
+        OPT_ATTR_STRING(id),
+        MAND_ATTR_FN(profiles, str_to_uri_list),
+        {"type", [](MPD &mpd, const std::string &val) {
+            if (val == "static") {
+                mpd.m_type = STATIC;
+            } else if (val == "dynamic") {
+                mpd.m_type = DYNAMIC;
+            } else {
+                throw ParseError("Can only handle \"static\" or \"dynamic\" MPD types");
+            }
+        }},
+        OPT_ATTR_TIME_POINT(availabilityStartTime),
+        OPT_ATTR_TIME_POINT(availabilityEndTime),
+        OPT_ATTR_TIME_POINT(publishTime),
+        OPT_ATTR_DURN(mediaPresentationDuration),
+        OPT_ATTR_DURN(minimumUpdatePeriod),
+        MAND_ATTR_DURN(minBufferTime),
+        OPT_ATTR_DURN(timeShiftBufferDepth),
+        OPT_ATTR_DURN(suggestedPresentationDelay),
+        OPT_ATTR_DURN(maxSegmentDuration),
+        OPT_ATTR_DURN(maxSubsegmentDuration)
+    });
+
+#undef MAND_ATTR_DURN
+#undef MAND_ATTR_FN
+#undef OPT_ATTR_DURN
+#undef OPT_ATTR_TIME_POINT
+#undef OPT_ATTR_STRING
+#undef OPT_ATTR_FN
+
+    // Attributes not present in the XML take their default values
+    m_id.reset();
+    m_type = STATIC;
+    m_availabilityStartTime.reset();
+    m_availabilityEndTime.reset();
+    m_publishTime.reset();
+    m_mediaPresentationDuration.reset();
+    m_minimumUpdatePeriod.reset();
+    m_timeShiftBufferDepth.reset();
+    m_suggestedPresentationDelay.reset();
+    m_maxSegmentDuration.reset();
+    m_maxSubsegmentDuration.reset();
+
+    attribute_table.apply(*this, mpd_root);
+
+    // Child elements are added by extractMPDChild(), so start with empty lists
+    m_programInformations.clear();
+    m_baseURLs.clear();
+    invalidateBaseURLs();
+    m_locations.clear();
+    m_patchLocations.clear();
+    m_serviceDescriptions.clear();
+    m_initializationSets.clear();
+    m_initializationGroups.clear();
+    m_initializationPresentations.clear();
+    m_contentProtections.clear();
+    m_periods.clear();
+    m_metrics.clear();
+    m_essentialProperties.clear();
+    m_supplementaryProperties.clear();
+    m_utcTimings.clear();
+    m_leapSecondInformation.reset();
+}
+
+void MPD::extractMPDChild(xmlpp::Element &child, std::vector<xmlpp::Node*> *deferred_periods)
+{
+#define ELEM_LIST_CLASS(var, element, cls) {#element, [](MPD &mpd, xmlpp::Node &node) { \
+            mpd.var.push_back(cls(node)); \
+            _setMPD(&mpd, mpd.var.back()); \
+        }}
+#define OPT_ELEM_CLASS(var, element, cls) {#element, [](MPD &mpd, xmlpp::Node &node) { \
+            if (mpd.var) throw ParseError("MPD has too many " #element " elements"); \
+            mpd.var = cls(node); \
+            _setMPD(&mpd, mpd.var.value()); \
+        }}
+
+    static const ElementTable<MPD> element_table({
+        ELEM_LIST_CLASS(m_programInformations, ProgramInformation, ProgramInformation),
+        ELEM_LIST_CLASS(m_baseURLs, BaseURL, BaseURL),
+        ELEM_LIST_CLASS(m_locations, Location, URI),
+        ELEM_LIST_CLASS(m_patchLocations, PatchLocation, PatchLocation),
+        ELEM_LIST_CLASS(m_serviceDescriptions, ServiceDescription, ServiceDescription),
+        ELEM_LIST_CLASS(m_initializationSets, InitializationSet, InitializationSet),
+        ELEM_LIST_CLASS(m_initializationGroups, InitializationGroup, UIntVWithID),
+        ELEM_LIST_CLASS(m_initializationPresentations, InitializationPresentation, UIntVWithID),
+        ELEM_LIST_CLASS(m_contentProtections, ContentProtection, ContentProtection),
+        ELEM_LIST_CLASS(m_periods, Period, Period),
+        ELEM_LIST_CLASS(m_metrics, Metrics, Metrics),
+        ELEM_LIST_CLASS(m_essentialProperties, EssentialProperty, Descriptor),
+        ELEM_LIST_CLASS(m_supplementaryProperties, SupplementaryProperty, Descriptor),
+        ELEM_LIST_CLASS(m_utcTimings, UTCTiming, Descriptor),
+        OPT_ELEM_CLASS(m_leapSecondInformation, LeapSecondInformation, LeapSecondInformation)
+    });
+
+#undef OPT_ELEM_CLASS
+#undef ELEM_LIST_CLASS
+
+    if (deferred_periods && child.get_name() == "Period" && child.get_namespace_uri() == MPD_NS &&
+        !ParseFilterScope::skips(child.cobj())) {
+        deferred_periods->push_back(&child);
+        return;
+    }
+
+    element_table.applyChild(*this, child);
+}
+
+void MPD::extractMPDPeriods(const std::vector<xmlpp::Node*> &period_nodes, unsigned int threads)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    if (threads > period_nodes.size()) threads = static_cast<unsigned int>(period_nodes.size());
 
-    OPT_ATTR_STRING(id);
-    MAND_ATTR_FN(profiles, str_to_uri_list);
+    // Each Period is built in its own list so that the results can be spliced into m_periods in document order without copying
+    std::vector<std::list<Period> > parsed_periods(period_nodes.size());
+    std::vector<std::exception_ptr> errors(period_nodes.size());
+    std::atomic<std::vector<xmlpp::Node*>::size_type> next_index(0);
 
-    node_set = mpd_root->find("@type");
-    if (node_set.size() == 1) {
-        xmlpp::Attribute *type_attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        auto type_val = type_attr->get_value();
-        if (type_val == "static") {
-            m_type = STATIC;
-        } else if (type_val == "dynamic") {
-            m_type = DYNAMIC;
-        } else {
-            throw ParseError("Can only handle \"static\" or \"dynamic\" MPD types");
+    auto worker = [&]() {
+        MemoryResourceScope scope(m_memoryResource);
+        ParseFilterScope filter_scope(m_parseFilter.get());
+        for (auto i = next_index++; i < period_nodes.size(); i = next_index++) {
+            try {
+                parsed_periods[i].push_back(Period(*period_nodes[i]));
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
         }
-    } else {
-        m_type = STATIC;
-    }
-
-    OPT_ATTR_TIME_POINT(availabilityStartTime);
-    OPT_ATTR_TIME_POINT(availabilityEndTime);
-    OPT_ATTR_TIME_POINT(publishTime);
-    OPT_ATTR_DURN(mediaPresentationDuration);
-    OPT_ATTR_DURN(minimumUpdatePeriod);
-    MAND_ATTR_DURN(minBufferTime);
-    OPT_ATTR_DURN(timeShiftBufferDepth);
-    OPT_ATTR_DURN(suggestedPresentationDelay);
-    OPT_ATTR_DURN(maxSegmentDuration);
-    OPT_ATTR_DURN(maxSubsegmentDuration);
-
-    OPT_ELEM_LIST_CLASS(m_programInformations, ProgramInformation, ProgramInformation);
-    OPT_ELEM_LIST_CLASS(m_baseURLs, BaseURL, BaseURL);
-    OPT_ELEM_LIST_CLASS(m_locations, Location, URI);
-    OPT_ELEM_LIST_CLASS(m_patchLocations, PatchLocation, PatchLocation);
-    OPT_ELEM_LIST_CLASS(m_serviceDescriptions, ServiceDescription, ServiceDescription);
-    OPT_ELEM_LIST_CLASS(m_initializationSets, InitializationSet, InitializationSet);
-    OPT_ELEM_LIST_CLASS(m_initializationGroups, InitializationGroup, UIntVWithID);
-    OPT_ELEM_LIST_CLASS(m_initializationPresentations, InitializationPresentation, UIntVWithID);
-    OPT_ELEM_LIST_CLASS(m_contentProtections, ContentProtection, ContentProtection);
-    MAND_ELEM_LIST_CLASS(m_periods, Period, Period);
-    OPT_ELEM_LIST_CLASS(m_metrics, Metrics, Metrics);
-    OPT_ELEM_LIST_CLASS(m_essentialProperties, EssentialProperty, Descriptor);
-    OPT_ELEM_LIST_CLASS(m_supplementaryProperties, SupplementaryProperty, Descriptor);
-    OPT_ELEM_LIST_CLASS(m_utcTimings, UTCTiming, Descriptor);
-    OPT_ELEM_CLASS(m_leapSecondInformation, LeapSecondInformation, LeapSecondInformation);
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; i++) {
+        try {
+            pool.emplace_back(worker);
+        } catch (const std::system_error&) {
+            break; // couldn't start another thread, carry on with the ones we have
+        }
+    }
+    worker();
+    for (auto &thread : pool) thread.join();
+
+    // Report the same error a serial parse would have, i.e. the first in document order
+    for (std::vector<xmlpp::Node*>::size_type i = 0; i < period_nodes.size(); i++) {
+        if (errors[i]) std::rethrow_exception(errors[i]);
+        m_periods.splice(m_periods.end(), parsed_periods[i]);
+    }
+}
+
+void MPD::extractMPDLazyPeriods(const std::vector<std::shared_ptr<UnparsedElement> > &unparsed_periods)
+{
+    for (const auto &unparsed : unparsed_periods) {
+        m_periods.push_back(Period(unparsed));
+    }
+}
+
+void MPD::extractMPDFinish()
+{
+    if (m_periods.empty()) throw ParseError("MPD needs at least one Period element");
 
     Period *prev = nullptr;
     for (auto &period : m_periods) {
@@ -1624,33 +2144,460 @@ void MPD::extractMPD(void *doc)
         }
         prev = &period;
     }
+
+    // Calculate the Period times in one pass now, rather than on the first query
+    cachePeriodTimes();
+
+    if (m_stringPool) m_stringPool->intern(*this);
+}
+
+void MPD::setXMLElement(xmlpp::Element &docroot) const
+{
+    if (m_id) {
+        docroot.set_attribute("id", m_id.value());
+    }
+    {
+        std::ostringstream oss;
+        const char *sep = "";
+        for (const auto &u : m_profiles) {
+             oss << sep << u;
+             sep = ",";
+        }
+        docroot.set_attribute("profiles", oss.str());
+    }
+    if (m_type != MPD::STATIC) {
+        docroot.set_attribute("type", "dynamic");
+    }
+    if (m_availabilityStartTime) {
+        docroot.set_attribute("availabilityStartTime", std::format(ISO8601_DATE_TIME_FORMAT, std::chrono::round<std::chrono::milliseconds>(m_availabilityStartTime.value())));
+    }
+    if (m_availabilityEndTime) {
+        docroot.set_attribute("availabilityEndTime", std::format(ISO8601_DATE_TIME_FORMAT, std::chrono::round<std::chrono::milliseconds>(m_availabilityEndTime.value())));
+    }
+    if (m_publishTime) {
+        docroot.set_attribute("publishTime", std::format(ISO8601_DATE_TIME_FORMAT, std::chrono::round<std::chrono::milliseconds>(m_publishTime.value())));
+    }
+    if (m_mediaPresentationDuration) {
+        docroot.set_attribute("mediaPresentationDuration", format_duration(std::chrono::round<std::chrono::milliseconds>(m_mediaPresentationDuration.value())));
+    }
+    if (m_minimumUpdatePeriod) {
+        docroot.set_attribute("minimumUpdatePeriod", format_duration(std::chrono::round<std::chrono::milliseconds>(m_minimumUpdatePeriod.value())));
+    }
+    docroot.set_attribute("minBufferTime", format_duration(std::chrono::round<std::chrono::milliseconds>(m_minBufferTime)));
+    if (m_timeShiftBufferDepth) {
+        docroot.set_attribute("timeShiftBufferDepth", format_duration(std::chrono::round<std::chrono::milliseconds>(m_timeShiftBufferDepth.value())));
+    }
+    if (m_suggestedPresentationDelay) {
+        docroot.set_attribute("suggestedPresentationDelay", format_duration(std::chrono::round<std::chrono::milliseconds>(m_suggestedPresentationDelay.value())));
+    }
+    if (m_maxSegmentDuration) {
+        docroot.set_attribute("maxSegmentDuration", format_duration(std::chrono::round<std::chrono::milliseconds>(m_maxSegmentDuration.value())));
+    }
+    if (m_maxSubsegmentDuration) {
+        docroot.set_attribute("maxSubsegmentDuration", format_duration(std::chrono::round<std::chrono::milliseconds>(m_maxSubsegmentDuration.value())));
+    }
+
+    // Child elements
+    for (const auto &pi : m_programInformations) {
+        xmlpp::Element *elem = docroot.add_child_element("ProgramInformation");
+        pi.setXMLElement(*elem);
+    }
+    for (const auto &url : m_baseURLs) {
+        xmlpp::Element *elem = docroot.add_child_element("BaseURL");
+        url.setXMLElement(*elem);
+    }
+    for (const auto &url : m_locations) {
+        xmlpp::Element *elem = docroot.add_child_element("Location");
+        elem->add_child_text(std::string(url));
+    }
+    for (const auto &pl : m_patchLocations) {
+        xmlpp::Element *elem = docroot.add_child_element("PatchLocation");
+        pl.setXMLElement(*elem);
+    }
+    for (const auto &sd : m_serviceDescriptions) {
+        xmlpp::Element *elem = docroot.add_child_element("ServiceDescription");
+        sd.setXMLElement(*elem);
+    }
+    for (const auto &is : m_initializationSets) {
+        xmlpp::Element *elem = docroot.add_child_element("InitializationSet");
+        is.setXMLElement(*elem);
+    }
+    for (const auto &ig : m_initializationGroups) {
+        xmlpp::Element *elem = docroot.add_child_element("InitializationGroup");
+        ig.setXMLElement(*elem);
+    }
+    for (const auto &ip : m_initializationPresentations) {
+        xmlpp::Element *elem = docroot.add_child_element("InitializationPresentation");
+        ip.setXMLElement(*elem);
+    }
+    for (const auto &cp : m_contentProtections) {
+        xmlpp::Element *elem = docroot.add_child_element("ContentProtection");
+        cp.setXMLElement(*elem);
+    }
+    for (const auto &period : m_periods) {
+        xmlpp::Element *elem = docroot.add_child_element("Period");
+        period.setXMLElement(*elem);
+    }
+    for (const auto &metric : m_metrics) {
+        xmlpp::Element *elem = docroot.add_child_element("Metrics");
+        metric.setXMLElement(*elem);
+    }
+    for (const auto &ep : m_essentialProperties) {
+        xmlpp::Element *elem = docroot.add_child_element("EssentialProperty");
+        ep.setXMLElement(*elem);
+    }
+    for (const auto &sp : m_supplementaryProperties) {
+        xmlpp::Element *elem = docroot.add_child_element("SupplementaryProperty");
+        sp.setXMLElement(*elem);
+    }
+    for (const auto &timing : m_utcTimings) {
+        xmlpp::Element *elem = docroot.add_child_element("UTCTiming");
+        timing.setXMLElement(*elem);
+    }
+    if (m_leapSecondInformation.has_value()) {
+        xmlpp::Element *elem = docroot.add_child_element("LeapSecondInformation");
+        m_leapSecondInformation.value().setXMLElement(*elem);
+    }
+}
+
+MPD::ParseOptions MPD::refreshParseOptions(const ParseOptions &options) const
+{
+    // Intern the refreshed values in our pool, allocate from our memory resource and filter the same elements if the caller did
+    // not give them
+    ParseOptions refresh_options(options);
+    if (!refresh_options.stringPool()) refresh_options.stringPool(m_stringPool);
+    if (!refresh_options.memoryResource()) refresh_options.memoryResource(m_memoryResource);
+    if (!refresh_options.parseFilter()) refresh_options.parseFilter(m_parseFilter);
+    return refresh_options;
+}
+
+void MPD::relinkPeriods(bool clear_calculated_times)
+{
+    Period *prev = nullptr;
+    for (auto &period : m_periods) {
+        period.setMPD(this);
+        period.m_previousSibling = prev;
+        period.m_nextSibling = nullptr;
+        if (prev) prev->m_nextSibling = &period;
+        if (clear_calculated_times) period.cacheCalcClear();
+        prev = &period;
+    }
+    // The index refers to the Periods by position in the list
+    if (clear_calculated_times) cachePeriodTimesClear();
+}
+
+bool MPD::refreshPeriod(Period &period, Period &updated, std::list<RefreshChange> &changes)
+{
+    period.materialise();
+    updated.materialise();
+
+    // Compare and update the Period without the AdaptationSets, these are matched up separately
+    std::list<AdaptationSet> adapt_sets(std::move(period.m_adaptationSets));
+    std::list<AdaptationSet> empty_adapt_sets(std::move(period.m_emptyAdaptationSets));
+    std::list<AdaptationSet> updated_adapt_sets(std::move(updated.m_adaptationSets));
+    std::list<AdaptationSet> updated_empty_adapt_sets(std::move(updated.m_emptyAdaptationSets));
+    bool changed = !(period == updated);
+    if (changed) {
+        MPD *mpd = period.m_mpd;
+        Period *prev = period.m_previousSibling;
+        Period *next = period.m_nextSibling;
+        period = std::move(updated);
+        period.m_mpd = mpd;
+        period.m_previousSibling = prev;
+        period.m_nextSibling = next;
+        // The assignment invalidated the tree of the parsed MPD, the BaseURLs and segment information of this MPD have changed
+        period.invalidateBaseURLs();
+        period.invalidateAddressing();
+        changes.emplace_back(RefreshChange::UPDATED, RefreshChange::PERIOD_ELEMENT, period.id());
+    }
+    period.m_adaptationSets = std::move(adapt_sets);
+    period.m_emptyAdaptationSets = std::move(empty_adapt_sets);
+
+    refreshAdaptationSets(period, period.m_adaptationSets, std::move(updated_adapt_sets), changes);
+    refreshAdaptationSets(period, period.m_emptyAdaptationSets, std::move(updated_empty_adapt_sets), changes);
+
+    return changed;
+}
+
+void MPD::refreshAdaptationSets(Period &period, std::list<AdaptationSet> &adapt_sets, std::list<AdaptationSet> &&updated,
+                                std::list<RefreshChange> &changes)
+{
+    // Match up the AdaptationSets by @id, or by position for those without an @id
+    std::unordered_map<unsigned int, std::list<AdaptationSet>::iterator> adapt_sets_by_id;
+    std::list<std::list<AdaptationSet>::iterator> adapt_sets_without_id;
+    for (auto it = adapt_sets.begin(); it != adapt_sets.end(); it++) {
+        if (it->id()) {
+            adapt_sets_by_id.emplace(it->id().value(), it);
+        } else {
+            adapt_sets_without_id.push_back(it);
+        }
+    }
+
+    std::list<AdaptationSet> new_adapt_sets;
+    while (!updated.empty()) {
+        auto updated_it = updated.begin();
+        auto match = adapt_sets.end();
+        if (updated_it->id()) {
+            auto found = adapt_sets_by_id.find(updated_it->id().value());
+            if (found != adapt_sets_by_id.end()) {
+                match = found->second;
+                adapt_sets_by_id.erase(found);
+            }
+        } else if (!adapt_sets_without_id.empty()) {
+            match = adapt_sets_without_id.front();
+            adapt_sets_without_id.pop_front();
+        }
+        if (match != adapt_sets.end()) {
+            refreshAdaptationSet(*match, *updated_it, period.id(), changes);
+            new_adapt_sets.splice(new_adapt_sets.end(), adapt_sets, match);
+            updated.erase(updated_it);
+        } else {
+            new_adapt_sets.splice(new_adapt_sets.end(), updated, updated_it);
+            new_adapt_sets.back().setPeriod(&period);
+            changes.emplace_back(RefreshChange::ADDED, RefreshChange::ADAPTATION_SET_ELEMENT, period.id(),
+                                 new_adapt_sets.back().id());
+        }
+    }
+    for (const auto &adapt_set : adapt_sets) {
+        changes.emplace_back(RefreshChange::REMOVED, RefreshChange::ADAPTATION_SET_ELEMENT, period.id(), adapt_set.id());
+    }
+    adapt_sets = std::move(new_adapt_sets);
+}
+
+void MPD::refreshAdaptationSet(AdaptationSet &adapt_set, AdaptationSet &updated, const std::optional<std::string> &period_id,
+                               std::list<RefreshChange> &changes)
+{
+    // Compare and update the AdaptationSet without the Representations, these are matched up separately
+    std::list<Representation> reps(std::move(adapt_set.m_representations));
+    std::unordered_set<const Representation*> selected_reps(std::move(adapt_set.m_selectedRepresentations));
+    std::list<Representation> updated_reps(std::move(updated.m_representations));
+    updated.m_selectedRepresentations.clear();
+    if (!(adapt_set == updated)) {
+        Period *period = adapt_set.m_period;
+        adapt_set = std::move(updated);
+        adapt_set.m_period = period;
+        adapt_set.invalidateBaseURLs();
+        adapt_set.invalidateAddressing();
+        changes.emplace_back(RefreshChange::UPDATED, RefreshChange::ADAPTATION_SET_ELEMENT, period_id, adapt_set.id());
+    }
+    adapt_set.m_representations = std::move(reps);
+    adapt_set.m_selectedRepresentations = std::move(selected_reps);
+
+    // Representation@id is mandatory, so match up Representations using that alone
+    std::unordered_map<std::string, std::list<Representation>::iterator> reps_by_id;
+    for (auto it = adapt_set.m_representations.begin(); it != adapt_set.m_representations.end(); it++) {
+        reps_by_id.emplace(it->id(), it);
+    }
+
+    std::list<Representation> new_reps;
+    while (!updated_reps.empty()) {
+        auto updated_it = updated_reps.begin();
+        auto found = reps_by_id.find(updated_it->id());
+        if (found != reps_by_id.end()) {
+            auto match = found->second;
+            reps_by_id.erase(found);
+            if (!(*match == *updated_it)) {
+                // Assign in place so that the selection of this Representation is kept
+                *match = std::move(*updated_it);
+                match->setAdaptationSet(&adapt_set);
+                changes.emplace_back(RefreshChange::UPDATED, RefreshChange::REPRESENTATION_ELEMENT, period_id, adapt_set.id(),
+                                     match->id());
+            }
+            new_reps.splice(new_reps.end(), adapt_set.m_representations, match);
+            updated_reps.erase(updated_it);
+        } else {
+            new_reps.splice(new_reps.end(), updated_reps, updated_it);
+            new_reps.back().setAdaptationSet(&adapt_set);
+            changes.emplace_back(RefreshChange::ADDED, RefreshChange::REPRESENTATION_ELEMENT, period_id, adapt_set.id(),
+                                 new_reps.back().id());
+        }
+    }
+    for (const auto &rep : adapt_set.m_representations) {
+        adapt_set.m_selectedRepresentations.erase(&rep);
+        changes.emplace_back(RefreshChange::REMOVED, RefreshChange::REPRESENTATION_ELEMENT, period_id, adapt_set.id(), rep.id());
+    }
+    adapt_set.m_representations = std::move(new_reps);
 }
 
 std::list<Period>::const_iterator MPD::getPeriodFor(const MPD::time_type &pres_time) const
 {
-    if (isLive()) {
-        for (auto it = m_periods.cbegin(); it != m_periods.cend(); it++) {
-            auto calc_start = it->calcStart();
-            auto period_start = (m_availabilityStartTime?m_availabilityStartTime.value():time_type()) +
-                                (calc_start?calc_start.value():0s);
-            if (pres_time < period_start) break;
-            if (pres_time >= period_start) {
-                auto calc_duration = it->calcDuration();
-                if (!calc_duration) return it;
-                auto period_end = period_start + calc_duration.value();
-                if (pres_time < period_end) return it;
+    cachePeriodTimes();
+
+    // Period times are relative to the availabilityStartTime, or to the epoch for on-demand MPDs without one
+    time_type origin = m_availabilityStartTime?m_availabilityStartTime.value():time_type();
+    const auto &index = m_cache->periodIndex;
+
+    // Find the last Period starting at or before pres_time
+    auto it = std::upper_bound(index.begin(), index.end(), pres_time,
+                               [&origin](const time_type &time, const Cache::PeriodTimes &times) { return time < origin + times.start; });
+    if (it == index.begin()) return m_periods.cend();
+    --it;
+    if (it->end && pres_time >= origin + it->end.value()) return m_periods.cend();
+
+    return it->period;
+}
+
+void MPD::cachePeriodTimes() const
+{
+    // Calculated once and then only read, so concurrent queries on a const MPD only need to check the flag
+    if (m_cache->periodTimesValid.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(m_cache->periodTimesMutex);
+    if (m_cache->periodTimesValid.load(std::memory_order_relaxed)) return;
+
+    // Forward pass: Period@start, the end of the previous Period or 0 for the first Period (as getPeriodStartTime() assumes for
+    // an early available Period of a dynamic MPD)
+    std::optional<duration_type> prev_end;
+    for (auto it = m_periods.cbegin(); it != m_periods.cend(); it++) {
+        auto &cache = *it->m_cache;
+        cache.calcStart = it->m_start;
+        cache.calcDuration = it->m_duration;
+        if (!cache.calcStart) {
+            if (prev_end) {
+                cache.calcStart = prev_end;
+            } else if (it == m_periods.cbegin()) {
+                cache.calcStart = duration_type(0);
             }
         }
-    } else {
-        // TODO: find period for wallclock time in VoD (need to know wallclock start time!)
+        prev_end.reset();
+        if (cache.calcStart && cache.calcDuration) prev_end = cache.calcStart.value() + cache.calcDuration.value();
+    }
+
+    // Backward pass: durations up to the start of the next Period, or the end of the presentation for the last Period, and any
+    // start times that can only be found from the start of the next Period
+    std::optional<duration_type> next_start;
+    for (auto it = m_periods.crbegin(); it != m_periods.crend(); it++) {
+        auto &cache = *it->m_cache;
+        if (!cache.calcStart && cache.calcDuration && next_start) {
+            cache.calcStart = next_start.value() - cache.calcDuration.value();
+        }
+        if (!cache.calcDuration && cache.calcStart) {
+            if (next_start) {
+                cache.calcDuration = next_start.value() - cache.calcStart.value();
+            } else if (it == m_periods.crbegin() && m_mediaPresentationDuration &&
+                       m_mediaPresentationDuration.value() >= cache.calcStart.value()) {
+                cache.calcDuration = m_mediaPresentationDuration.value() - cache.calcStart.value();
+            }
+        }
+        cache.calcTimesValid = true;
+        next_start = cache.calcStart;
     }
 
-    return m_periods.cend();
+    // Index the Periods with a known start
+    auto &index = m_cache->periodIndex;
+    index.clear();
+    for (auto it = m_periods.cbegin(); it != m_periods.cend(); it++) {
+        const auto &cache = *it->m_cache;
+        if (!cache.calcStart) continue;
+        std::optional<duration_type> end;
+        if (cache.calcDuration) end = cache.calcStart.value() + cache.calcDuration.value();
+        index.push_back({cache.calcStart.value(), end, it});
+    }
+    // Periods should already be in start order, but don't rely on it
+    auto by_start = [](const Cache::PeriodTimes &a, const Cache::PeriodTimes &b) { return a.start < b.start; };
+    if (!std::is_sorted(index.begin(), index.end(), by_start)) std::stable_sort(index.begin(), index.end(), by_start);
+
+    m_cache->periodTimesValid.store(true, std::memory_order_release);
+}
+
+void MPD::cachePeriodTimesClear() const
+{
+    m_cache->periodTimesValid.store(false, std::memory_order_release);
+}
+
+void MPD::cachePeriodTimesAppended() const
+{
+    // Nothing to update if the times will be recalculated anyway
+    if (!m_cache->periodTimesValid.load(std::memory_order_relaxed)) return;
+
+    auto &index = m_cache->periodIndex;
+    auto added_it = std::prev(m_periods.cend());
+    const Period &added = *added_it;
+    const Period *prev = added.m_previousSibling;
+
+    // A previous Period without a start could now get one from the new Period, which would need the backward pass
+    if (prev && (!prev->m_cache->calcStart || index.empty() || index.back().period != std::prev(added_it))) {
+        cachePeriodTimesClear();
+        return;
+    }
+
+    std::optional<duration_type> prev_end;
+    if (prev) {
+        // The previous Period is no longer the last, so its duration now comes from the start of the new Period
+        auto &prev_cache = *prev->m_cache;
+        if (!prev->m_duration) {
+            prev_cache.calcDuration.reset();
+            if (added.m_start) prev_cache.calcDuration = added.m_start.value() - prev_cache.calcStart.value();
+            index.back().end.reset();
+            if (prev_cache.calcDuration) index.back().end = prev_cache.calcStart.value() + prev_cache.calcDuration.value();
+        }
+        if (prev_cache.calcDuration) prev_end = prev_cache.calcStart.value() + prev_cache.calcDuration.value();
+    }
+
+    auto &cache = *added.m_cache;
+    cache.calcStart = added.m_start;
+    cache.calcDuration = added.m_duration;
+    if (!cache.calcStart) {
+        if (prev_end) {
+            cache.calcStart = prev_end;
+        } else if (!prev) {
+            cache.calcStart = duration_type(0);
+        }
+    }
+    if (!cache.calcDuration && cache.calcStart && m_mediaPresentationDuration &&
+        m_mediaPresentationDuration.value() >= cache.calcStart.value()) {
+        cache.calcDuration = m_mediaPresentationDuration.value() - cache.calcStart.value();
+    }
+    cache.calcTimesValid = true;
+
+    if (cache.calcStart) {
+        if (!index.empty() && cache.calcStart.value() < index.back().start) {
+            // Out of order Period, re-sort on next use
+            cachePeriodTimesClear();
+            return;
+        }
+        std::optional<duration_type> end;
+        if (cache.calcDuration) end = cache.calcStart.value() + cache.calcDuration.value();
+        index.push_back({cache.calcStart.value(), end, added_it});
+    }
+}
+
+bool MPD::cachePeriodTimesRemove(std::list<Period>::const_iterator period_it) const
+{
+    if (!m_cache->periodTimesValid.load(std::memory_order_relaxed)) return true;
+
+    auto &index = m_cache->periodIndex;
+    bool indexed = period_it->m_cache->calcStart.has_value();
+    if (period_it == m_periods.cbegin()) {
+        // Removing the first Period only leaves the other times alone if the next Period has its own start
+        const Period &next = *std::next(period_it);
+        if (!next.m_start) return false;
+        if (indexed) {
+            if (index.empty() || index.front().period != period_it) return false;
+            index.erase(index.begin());
+        }
+        return true;
+    }
+    if (std::next(period_it) == m_periods.cend()) {
+        // Removing the last Period only leaves the other times alone if the previous Period has its own start and duration
+        const Period &prev = *std::prev(period_it);
+        if (!prev.m_start || !prev.m_duration) return false;
+        if (indexed) {
+            if (index.empty() || index.back().period != period_it) return false;
+            index.pop_back();
+        }
+        return true;
+    }
+    return false;
 }
 
 MPD::Cache::Cache()
     :haveUtcTimingOffsetFromSystemClock(false)
     ,utcTimingOffsetFromSystemClock(0s)
+    ,periodTimesMutex()
+    ,periodTimesValid(false)
+    ,periodIndex()
+    ,baseURLGeneration()
+    ,addressingGeneration()
 {
 }
 
@@ -1669,17 +2616,9 @@ static MPDFormattingOptions &get_mpd_formatting(std::ios_base &ios)
     return *reinterpret_cast<MPDFormattingOptions*>(pword);
 }
 
-static MPD::time_type str_to_time_point(const std::string &str)
+static std::vector<URI> str_to_uri_list(const std::string &str, char sep)
 {
-    MPD::time_type ret;
-    std::istringstream is(str);
-    is >> std::chrono::parse("%FT%TZ", ret);
-    return ret;
-}
-
-static std::list<URI> str_to_uri_list(const std::string &str, char sep)
-{
-    std::list<URI> ret;
+    std::vector<URI> ret;
     std::string items(str);
 
     for (auto posn = items.find_first_of(sep); posn != std::string::npos; posn = items.find_first_of(sep)) {
@@ -1692,6 +2631,15 @@ static std::list<URI> str_to_uri_list(const std::string &str, char sep)
     return ret;
 }
 
+static int xml_reader_istream_read(void *context, char *buffer, int len)
+{
+    std::istream *is = reinterpret_cast<std::istream*>(context);
+    if (is->eof()) return 0;
+    is->read(buffer, len);
+    if (is->bad()) return -1;
+    return static_cast<int>(is->gcount());
+}
+
 LIBMPDPP_NAMESPACE_END
 
 std::ostream &operator<<(std::ostream &os, const LIBMPDPP_NAMESPACE_CLASS(MPD) &mpd)
@@ -0,0 +1,945 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: MPD Patch application
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <libxml/tree.h>
+#include <libxml++/libxml++.h>
+
+#include "libmpd++/macros.hh"
+#include "libmpd++/exceptions.hh"
+#include "libmpd++/AdaptationSet.hh"
+#include "libmpd++/BaseURL.hh"
+#include "libmpd++/MemoryResource.hh"
+#include "libmpd++/Period.hh"
+#include "libmpd++/Representation.hh"
+
+#include "constants.hh"
+#include "conversions.hh"
+
+#include "libmpd++/MPD.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+namespace {
+
+/* A predicate from a selector step, either [@attr='value'] or [position] */
+struct SelectorPredicate {
+    std::optional<std::string> attribute;
+    std::string value;
+    std::size_t position;
+};
+
+/* A single step of a selector, either an element name with optional predicates or a final @attribute */
+struct SelectorStep {
+    std::string name;
+    bool isAttribute;
+    std::vector<SelectorPredicate> predicates;
+};
+
+/* An RFC 5261 operation from the MPD Patch document */
+struct PatchOperation {
+    enum Type {
+        ADD,
+        REPLACE,
+        REMOVE
+    };
+
+    enum Position {
+        APPEND,
+        PREPEND,
+        BEFORE,
+        AFTER
+    };
+
+    Type type;
+    std::string sel;
+    std::vector<SelectorStep> steps;
+    Position pos;
+    std::optional<std::string> attributeType; // the attribute name for <add type="@name">
+    xmlNodePtr node;                          // the operation element in the patch document
+    std::vector<xmlNodePtr> content;          // element and non-blank text children of the operation element
+};
+
+/* Moves a list out of an object for the lifetime of the guard, used to generate the XML for an object without its children */
+template <class L>
+class ListGuard {
+public:
+    ListGuard(L &list) :m_list(list), m_saved(std::move(list)) { m_list.clear(); };
+    ~ListGuard() { m_list = std::move(m_saved); };
+
+private:
+    L &m_list;
+    L m_saved;
+};
+
+bool is_space(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c));
+}
+
+std::string trim(const std::string &str)
+{
+    std::string::size_type start = 0;
+    std::string::size_type end = str.size();
+    while (start < end && is_space(str[start])) start++;
+    while (end > start && is_space(str[end-1])) end--;
+    return str.substr(start, end - start);
+}
+
+/* Parse the limited XPath subset used by MPD Patch selectors
+ *
+ * Only absolute paths of child steps are supported, each step can have any number of [@attr='value'] or [position] predicates and
+ * the final step may be an @attribute.
+ */
+std::vector<SelectorStep> parse_selector(const std::string &sel)
+{
+    std::vector<SelectorStep> steps;
+    std::string::size_type i = 0;
+
+    auto unsupported = [&sel]() { return ParseError("Unsupported MPD Patch selector \"" + sel + "\""); };
+
+    if (sel.empty() || sel[0] != '/') throw unsupported();
+    while (i < sel.size()) {
+        if (sel[i] != '/') throw unsupported();
+        i++;
+        SelectorStep step{std::string(), false, {}};
+        auto name_end = sel.find_first_of("/[", i);
+        if (name_end == std::string::npos) name_end = sel.size();
+        step.name = sel.substr(i, name_end - i);
+        i = name_end;
+        if (step.name.empty()) throw unsupported();
+        if (step.name[0] == '@') {
+            step.isAttribute = true;
+            step.name.erase(0, 1);
+            if (step.name.empty() || i != sel.size() || step.name.find(':') != std::string::npos) throw unsupported();
+        } else {
+            if (step.name.find_first_of("()*") != std::string::npos) throw unsupported();
+            // Element names in selectors are in the MPD namespace whatever prefix is used
+            auto colon = step.name.find(':');
+            if (colon != std::string::npos) step.name.erase(0, colon + 1);
+        }
+        while (i < sel.size() && sel[i] == '[') {
+            if (step.isAttribute) throw unsupported();
+            // find the closing bracket, skipping over quoted strings
+            auto j = i + 1;
+            char quote = '\0';
+            for (; j < sel.size() && (quote || sel[j] != ']'); j++) {
+                if (quote) {
+                    if (sel[j] == quote) quote = '\0';
+                } else if (sel[j] == '\'' || sel[j] == '"') {
+                    quote = sel[j];
+                }
+            }
+            if (j >= sel.size()) throw unsupported();
+            std::string pred_str(trim(sel.substr(i + 1, j - i - 1)));
+            i = j + 1;
+
+            SelectorPredicate pred{std::nullopt, std::string(), 0};
+            if (!pred_str.empty() && pred_str.find_first_not_of("0123456789") == std::string::npos) {
+                pred.position = str_to_ui(pred_str);
+                if (pred.position == 0) throw unsupported();
+            } else if (!pred_str.empty() && pred_str[0] == '@') {
+                auto eq = pred_str.find('=');
+                if (eq == std::string::npos) throw unsupported();
+                pred.attribute = trim(pred_str.substr(1, eq - 1));
+                std::string val(trim(pred_str.substr(eq + 1)));
+                if (pred.attribute.value().empty() || val.size() < 2 || (val[0] != '\'' && val[0] != '"') ||
+                    val.back() != val[0]) {
+                    throw unsupported();
+                }
+                pred.value = val.substr(1, val.size() - 2);
+            } else {
+                throw unsupported();
+            }
+            step.predicates.push_back(std::move(pred));
+        }
+        steps.push_back(std::move(step));
+    }
+
+    return steps;
+}
+
+/* Apply the predicates of a selector step to a list of candidate matches
+ *
+ * @p attr_fn is called with a candidate and an attribute name and returns the attribute value or std::nullopt.
+ */
+template <class C, class AttrFn>
+void filter_candidates(std::vector<C> &candidates, const std::vector<SelectorPredicate> &predicates, AttrFn attr_fn)
+{
+    for (const auto &pred : predicates) {
+        if (pred.attribute) {
+            std::vector<C> matched;
+            for (const auto &candidate : candidates) {
+                auto val = attr_fn(candidate, pred.attribute.value());
+                if (val && val.value() == pred.value) matched.push_back(candidate);
+            }
+            candidates = std::move(matched);
+        } else if (pred.position > candidates.size()) {
+            candidates.clear();
+        } else {
+            C candidate = candidates[pred.position - 1];
+            candidates.assign(1, candidate);
+        }
+    }
+}
+
+PatchError no_match(const PatchOperation &op)
+{
+    return PatchError("MPD Patch selector \"" + op.sel + "\" does not match exactly one node in the MPD");
+}
+
+/* Select one of the Period, AdaptationSet or Representation objects in a list using a selector step
+ *
+ * Only the @id attribute can be used in predicates at these levels as the objects are not backed by an XML tree.
+ */
+template <class T, class IdFn>
+typename std::list<T>::iterator select_one(std::list<T> &items, const SelectorStep &step, const PatchOperation &op, IdFn id_fn)
+{
+    std::vector<typename std::list<T>::iterator> candidates;
+    for (auto it = items.begin(); it != items.end(); it++) {
+        candidates.push_back(it);
+    }
+    filter_candidates(candidates, step.predicates,
+                      [&op, &id_fn](const typename std::list<T>::iterator &it, const std::string &attr) -> std::optional<std::string> {
+        if (attr != "id") {
+            throw ParseError("MPD Patch selector \"" + op.sel + "\" can only select Period, AdaptationSet and Representation "
+                             "elements by @id or position");
+        }
+        return id_fn(*it);
+    });
+    if (candidates.size() != 1) throw no_match(op);
+    return candidates.front();
+}
+
+bool is_element(const xmlNode *node, const char *ns, const char *name)
+{
+    return node->type == XML_ELEMENT_NODE && node->ns && node->ns->href &&
+           std::strcmp(reinterpret_cast<const char*>(node->ns->href), ns) == 0 &&
+           (!name || std::strcmp(reinterpret_cast<const char*>(node->name), name) == 0);
+}
+
+std::optional<std::string> get_attribute(const xmlNode *node, const char *name)
+{
+    xmlChar *val = xmlGetNoNsProp(node, reinterpret_cast<const xmlChar*>(name));
+    if (!val) return std::nullopt;
+    std::string ret(reinterpret_cast<const char*>(val));
+    xmlFree(val);
+    return ret;
+}
+
+/* Puts a parsed value back after its object has been rebuilt from XML, unless the patch changed the attribute it came from
+ *
+ * Dates and durations are only written to XML with millisecond precision, so rebuilding an object from its own XML would
+ * otherwise round them.
+ */
+template <class T>
+class UnpatchedValue {
+public:
+    UnpatchedValue(T &value, const xmlNode *node, const char *name)
+        :m_value(value)
+        ,m_parsed(value)
+        ,m_node(node)
+        ,m_name(name)
+        ,m_xml(get_attribute(node, name))
+    {};
+
+    void restore() const { if (get_attribute(m_node, m_name) == m_xml) m_value = m_parsed; };
+
+private:
+    T &m_value;
+    T m_parsed;
+    const xmlNode *m_node;
+    const char *m_name;
+    std::optional<std::string> m_xml;
+};
+
+std::string get_text_content(const xmlNode *node)
+{
+    xmlChar *val = xmlNodeGetContent(node);
+    std::string ret(val?reinterpret_cast<const char*>(val):"");
+    if (val) xmlFree(val);
+    return ret;
+}
+
+/* Move elements copied from the patch document from the patch namespaces into the MPD namespace */
+void set_mpd_namespace(xmlNodePtr node, xmlNsPtr mpd_ns)
+{
+    if (node->type != XML_ELEMENT_NODE) return;
+    if (!node->ns || !node->ns->href || is_element(node, MPD_PATCH_NS, nullptr) || is_element(node, PATCH_OPS_NS, nullptr)) {
+        node->ns = mpd_ns;
+    }
+    for (xmlNodePtr child = node->children; child; child = child->next) {
+        set_mpd_namespace(child, mpd_ns);
+    }
+}
+
+/* Copy a content node from the patch document ready for inserting below @p parent */
+xmlNodePtr copy_content(const xmlNode *node, xmlNodePtr parent)
+{
+    xmlNodePtr copy = xmlDocCopyNode(const_cast<xmlNodePtr>(node), parent->doc, 1);
+    if (!copy) throw std::bad_alloc();
+    set_mpd_namespace(copy, xmlSearchNsByHref(parent->doc, parent, reinterpret_cast<const xmlChar*>(MPD_NS)));
+    return copy;
+}
+
+void free_node(xmlNodePtr node)
+{
+    xmlpp::Node::free_wrappers(node);
+    xmlUnlinkNode(node);
+    xmlFreeNode(node);
+}
+
+/* Apply an operation to the XML generated for an object
+ *
+ * The selector steps from @p first_step onwards are resolved starting from @p root, which is the element for the object.
+ */
+void apply_xml_operation(xmlNodePtr root, const PatchOperation &op, std::vector<SelectorStep>::size_type first_step)
+{
+    xmlNodePtr node = root;
+    const SelectorStep *attr_step = nullptr;
+    for (auto i = first_step; i < op.steps.size(); i++) {
+        const auto &step = op.steps[i];
+        if (step.isAttribute) {
+            attr_step = &step;
+            break;
+        }
+        std::vector<xmlNodePtr> candidates;
+        for (xmlNodePtr child = node->children; child; child = child->next) {
+            if (is_element(child, MPD_NS, step.name.c_str())) candidates.push_back(child);
+        }
+        filter_candidates(candidates, step.predicates, [](xmlNodePtr candidate, const std::string &attr) {
+            return get_attribute(candidate, attr.c_str());
+        });
+        if (candidates.size() != 1) throw no_match(op);
+        node = candidates.front();
+    }
+
+    xmlAttrPtr attr = nullptr;
+    if (attr_step) {
+        attr = xmlHasNsProp(node, reinterpret_cast<const xmlChar*>(attr_step->name.c_str()), nullptr);
+        if (!attr) throw no_match(op);
+    }
+
+    switch (op.type) {
+    case PatchOperation::ADD:
+        if (attr) throw PatchError("MPD Patch cannot add to the attribute selected by \"" + op.sel + "\"");
+        if (op.attributeType) {
+            if (xmlHasNsProp(node, reinterpret_cast<const xmlChar*>(op.attributeType.value().c_str()), nullptr)) {
+                throw PatchError("MPD Patch adds attribute \"" + op.attributeType.value() + "\" which already exists at \"" +
+                                 op.sel + "\"");
+            }
+            xmlSetProp(node, reinterpret_cast<const xmlChar*>(op.attributeType.value().c_str()),
+                       reinterpret_cast<const xmlChar*>(get_text_content(op.node).c_str()));
+        } else {
+            if (node == root && (op.pos == PatchOperation::BEFORE || op.pos == PatchOperation::AFTER)) throw no_match(op);
+            xmlNodePtr parent = (op.pos == PatchOperation::BEFORE || op.pos == PatchOperation::AFTER)?node->parent:node;
+            xmlNodePtr first_child = node->children;
+            xmlNodePtr last_added = nullptr;
+            for (auto content : op.content) {
+                xmlNodePtr copy = copy_content(content, parent);
+                switch (op.pos) {
+                case PatchOperation::APPEND:
+                    copy = xmlAddChild(node, copy);
+                    break;
+                case PatchOperation::PREPEND:
+                    copy = first_child?xmlAddPrevSibling(first_child, copy):xmlAddChild(node, copy);
+                    break;
+                case PatchOperation::BEFORE:
+                    copy = xmlAddPrevSibling(node, copy);
+                    break;
+                case PatchOperation::AFTER:
+                    copy = xmlAddNextSibling(last_added?last_added:node, copy);
+                    break;
+                }
+                last_added = copy;
+            }
+        }
+        break;
+    case PatchOperation::REPLACE:
+        if (attr) {
+            xmlSetProp(node, attr->name, reinterpret_cast<const xmlChar*>(get_text_content(op.node).c_str()));
+        } else {
+            if (node == root || op.content.size() != 1 || op.content.front()->type != XML_ELEMENT_NODE) {
+                throw PatchError("MPD Patch replace of \"" + op.sel + "\" must have a single element as its content");
+            }
+            xmlNodePtr copy = copy_content(op.content.front(), node->parent);
+            xmlReplaceNode(node, copy);
+            free_node(node);
+        }
+        break;
+    case PatchOperation::REMOVE:
+        if (attr) {
+            if (attr->_private) {
+                delete static_cast<xmlpp::Node*>(attr->_private);
+                attr->_private = nullptr;
+            }
+            xmlRemoveProp(attr);
+        } else {
+            if (node == root) throw no_match(op);
+            free_node(node);
+        }
+        break;
+    }
+}
+
+} // namespace
+
+/* Applies the operations in an MPD Patch document to an MPD
+ *
+ * This is a nested class of MPD so that it can work with the private members of MPD, Period, AdaptationSet and Representation
+ * in the same way the MPD class can.
+ */
+class MPD::Patcher {
+public:
+    Patcher(MPD &mpd) :m_mpd(mpd) {};
+
+    void apply(xmlpp::Document &patch_doc);
+
+private:
+    enum Level {
+        MPD_LEVEL,
+        PERIOD_LEVEL,
+        ADAPTATION_SET_LEVEL,
+        REPRESENTATION_LEVEL
+    };
+
+    // The object model location a selector resolves to
+    struct Target {
+        Level level;
+        std::list<Period>::iterator period;
+        std::list<AdaptationSet> *adaptationSetList;
+        std::list<AdaptationSet>::iterator adaptationSet;
+        std::list<Representation>::iterator representation;
+        std::vector<SelectorStep>::size_type nextStep; // the first selector step below the object
+    };
+
+    static PatchOperation parseOperation(xmlNodePtr node);
+    Target resolve(const PatchOperation &op);
+    void applyOperation(const PatchOperation &op);
+    void removeTarget(const Target &target, const PatchOperation &op);
+    void replaceTarget(const Target &target, const PatchOperation &op);
+    void addSiblings(const Target &target, const PatchOperation &op);
+    void addChildren(const Target &target, const PatchOperation &op);
+    void patchXML(const Target &target, const PatchOperation &op);
+    void updateRepresentation(const Target &target, Representation &&updated, const PatchOperation &op);
+    xmlpp::Node &importContent(xmlpp::Document &doc, const xmlNode *content, const char *expected_name, const PatchOperation &op);
+
+    MPD &m_mpd;
+};
+
+void MPD::Patcher::apply(xmlpp::Document &patch_doc)
+{
+    xmlNodePtr root = xmlDocGetRootElement(patch_doc.cobj());
+    if (!root || !is_element(root, MPD_PATCH_NS, "Patch")) {
+        throw ParseError("MPD Patch root node is not <Patch> in the " MPD_PATCH_NS " namespace");
+    }
+
+    auto mpd_id = get_attribute(root, "mpdId");
+    auto original_publish_time = get_attribute(root, "originalPublishTime");
+    auto publish_time = get_attribute(root, "publishTime");
+    if (!mpd_id) throw ParseError("Patch must have a \"mpdId\" attribute");
+    if (!original_publish_time) throw ParseError("Patch must have a \"originalPublishTime\" attribute");
+    if (!publish_time) throw ParseError("Patch must have a \"publishTime\" attribute");
+    auto original = str_to_time_point(original_publish_time.value());
+    auto published = str_to_time_point(publish_time.value());
+
+    // Check the patch applies to this version of the MPD before making any changes
+    if (!m_mpd.m_id || m_mpd.m_id.value() != mpd_id.value()) {
+        throw PatchError("MPD Patch is for MPD \"" + mpd_id.value() + "\" which does not match the MPD@id");
+    }
+    if (!m_mpd.m_publishTime || m_mpd.m_publishTime.value() != original) {
+        throw PatchError("MPD Patch originalPublishTime does not match the MPD@publishTime");
+    }
+    if (published <= original) throw PatchError("MPD Patch publishTime is not later than its originalPublishTime");
+
+    // Parse all the operations first so that a malformed patch leaves the MPD untouched
+    std::vector<PatchOperation> operations;
+    for (xmlNodePtr child = root->children; child; child = child->next) {
+        if (is_element(child, MPD_PATCH_NS, nullptr) || is_element(child, PATCH_OPS_NS, nullptr)) {
+            operations.push_back(parseOperation(child));
+        }
+    }
+
+    // New tree storage comes from the resource the MPD was parsed with, whichever thread applies the patch
+    MemoryResourceScope scope(m_mpd.m_memoryResource);
+    for (const auto &op : operations) {
+        applyOperation(op);
+    }
+
+    m_mpd.m_publishTime = published;
+}
+
+PatchOperation MPD::Patcher::parseOperation(xmlNodePtr node)
+{
+    PatchOperation op{PatchOperation::ADD, std::string(), {}, PatchOperation::APPEND, std::nullopt, node, {}};
+    std::string name(reinterpret_cast<const char*>(node->name));
+
+    if (name == "add") {
+        op.type = PatchOperation::ADD;
+    } else if (name == "replace") {
+        op.type = PatchOperation::REPLACE;
+    } else if (name == "remove") {
+        op.type = PatchOperation::REMOVE;
+    } else {
+        throw ParseError("Unknown MPD Patch operation <" + name + ">");
+    }
+
+    auto sel = get_attribute(node, "sel");
+    if (!sel) throw ParseError(name + " must have a \"sel\" attribute");
+    op.sel = sel.value();
+    op.steps = parse_selector(op.sel);
+
+    if (op.type == PatchOperation::ADD) {
+        auto pos = get_attribute(node, "pos");
+        if (pos) {
+            if (pos.value() == "prepend") {
+                op.pos = PatchOperation::PREPEND;
+            } else if (pos.value() == "before") {
+                op.pos = PatchOperation::BEFORE;
+            } else if (pos.value() == "after") {
+                op.pos = PatchOperation::AFTER;
+            } else {
+                throw ParseError("Bad MPD Patch add@pos value \"" + pos.value() + "\"");
+            }
+        }
+        auto type = get_attribute(node, "type");
+        if (type) {
+            if (type.value().size() < 2 || type.value()[0] != '@' || type.value().find(':') != std::string::npos) {
+                throw ParseError("Unsupported MPD Patch add@type value \"" + type.value() + "\"");
+            }
+            op.attributeType = type.value().substr(1);
+        }
+    }
+
+    for (xmlNodePtr child = node->children; child; child = child->next) {
+        if (child->type == XML_ELEMENT_NODE || (child->type == XML_TEXT_NODE && !xmlIsBlankNode(child))) {
+            op.content.push_back(child);
+        }
+    }
+
+    return op;
+}
+
+MPD::Patcher::Target MPD::Patcher::resolve(const PatchOperation &op)
+{
+    const auto &steps = op.steps;
+    Target target{MPD_LEVEL, m_mpd.m_periods.end(), nullptr, {}, {}, 1};
+
+    if (steps[0].isAttribute || steps[0].name != "MPD") throw no_match(op);
+    for (const auto &pred : steps[0].predicates) {
+        if (pred.attribute?(pred.attribute.value() != "id" || m_mpd.m_id != pred.value):(pred.position != 1)) throw no_match(op);
+    }
+
+    // Walk down through the Periods, AdaptationSets and Representations held by the object model
+    auto i = target.nextStep;
+    if (i < steps.size() && !steps[i].isAttribute && steps[i].name == "Period") {
+        target.level = PERIOD_LEVEL;
+        target.period = select_one(m_mpd.m_periods, steps[i], op, [](const Period &period) { return period.id(); });
+        target.period->materialise();
+        i++;
+        if (i < steps.size() && !steps[i].isAttribute &&
+            (steps[i].name == "AdaptationSet" || steps[i].name == "EmptyAdaptationSet")) {
+            target.level = ADAPTATION_SET_LEVEL;
+            target.adaptationSetList = (steps[i].name == "AdaptationSet")?&target.period->m_adaptationSets:
+                                                                          &target.period->m_emptyAdaptationSets;
+            target.adaptationSet = select_one(*target.adaptationSetList, steps[i], op,
+                                              [](const AdaptationSet &adapt_set) -> std::optional<std::string> {
+                if (!adapt_set.id()) return std::nullopt;
+                return std::to_string(adapt_set.id().value());
+            });
+            i++;
+            if (i < steps.size() && !steps[i].isAttribute && steps[i].name == "Representation") {
+                target.level = REPRESENTATION_LEVEL;
+                target.representation = select_one(target.adaptationSet->m_representations, steps[i], op,
+                                                   [](const Representation &rep) -> std::optional<std::string> {
+                    return rep.id();
+                });
+                i++;
+            }
+        }
+    }
+    target.nextStep = i;
+
+    return target;
+}
+
+void MPD::Patcher::applyOperation(const PatchOperation &op)
+{
+    auto target = resolve(op);
+
+    if (target.nextStep < op.steps.size()) {
+        // Selector goes below the object model, so patch the XML for the nearest object
+        patchXML(target, op);
+    } else if (op.type == PatchOperation::REMOVE) {
+        removeTarget(target, op);
+    } else if (op.type == PatchOperation::REPLACE) {
+        replaceTarget(target, op);
+    } else if (op.attributeType) {
+        patchXML(target, op);
+    } else if (op.pos == PatchOperation::BEFORE || op.pos == PatchOperation::AFTER) {
+        addSiblings(target, op);
+    } else {
+        addChildren(target, op);
+    }
+}
+
+void MPD::Patcher::removeTarget(const Target &target, const PatchOperation &op)
+{
+    switch (target.level) {
+    case MPD_LEVEL:
+        throw PatchError("MPD Patch cannot remove the MPD element");
+    case PERIOD_LEVEL:
+        m_mpd.m_periods.erase(target.period);
+        m_mpd.relinkPeriods();
+        break;
+    case ADAPTATION_SET_LEVEL:
+        target.adaptationSetList->erase(target.adaptationSet);
+        break;
+    case REPRESENTATION_LEVEL:
+        target.adaptationSet->m_selectedRepresentations.erase(&(*target.representation));
+        target.adaptationSet->m_representations.erase(target.representation);
+        break;
+    }
+}
+
+void MPD::Patcher::replaceTarget(const Target &target, const PatchOperation &op)
+{
+    if (op.content.size() != 1) {
+        throw PatchError("MPD Patch replace of \"" + op.sel + "\" must have a single element as its content");
+    }
+
+    // Replacements are merged into the existing objects so that unchanged children keep their identity and selection state
+    xmlpp::Document doc;
+    doc.create_root_node("MPD", MPD_NS);
+    std::list<RefreshChange> changes;
+    switch (target.level) {
+    case MPD_LEVEL:
+        throw PatchError("MPD Patch cannot replace the MPD element");
+    case PERIOD_LEVEL:
+        {
+            Period updated(importContent(doc, op.content.front(), "Period", op));
+            m_mpd.refreshPeriod(*target.period, updated, changes);
+            m_mpd.relinkPeriods();
+        }
+        break;
+    case ADAPTATION_SET_LEVEL:
+        {
+            const char *name = (target.adaptationSetList == &target.period->m_adaptationSets)?"AdaptationSet":"EmptyAdaptationSet";
+            AdaptationSet updated(importContent(doc, op.content.front(), name, op));
+            m_mpd.refreshAdaptationSet(*target.adaptationSet, updated, target.period->id(), changes);
+        }
+        break;
+    case REPRESENTATION_LEVEL:
+        updateRepresentation(target, Representation(importContent(doc, op.content.front(), "Representation", op)), op);
+        break;
+    }
+}
+
+void MPD::Patcher::addSiblings(const Target &target, const PatchOperation &op)
+{
+    xmlpp::Document doc;
+    doc.create_root_node("MPD", MPD_NS);
+    switch (target.level) {
+    case MPD_LEVEL:
+        throw PatchError("MPD Patch cannot add siblings to the MPD element");
+    case PERIOD_LEVEL:
+        {
+            auto insert_at = (op.pos == PatchOperation::BEFORE)?target.period:std::next(target.period);
+            for (auto content : op.content) {
+                m_mpd.m_periods.insert(insert_at, Period(importContent(doc, content, "Period", op)));
+            }
+            m_mpd.relinkPeriods();
+        }
+        break;
+    case ADAPTATION_SET_LEVEL:
+        {
+            const char *name = (target.adaptationSetList == &target.period->m_adaptationSets)?"AdaptationSet":"EmptyAdaptationSet";
+            auto insert_at = (op.pos == PatchOperation::BEFORE)?target.adaptationSet:std::next(target.adaptationSet);
+            for (auto content : op.content) {
+                auto it = target.adaptationSetList->insert(insert_at, AdaptationSet(importContent(doc, content, name, op)));
+                it->setPeriod(&(*target.period));
+            }
+        }
+        break;
+    case REPRESENTATION_LEVEL:
+        {
+            auto &reps = target.adaptationSet->m_representations;
+            auto insert_at = (op.pos == PatchOperation::BEFORE)?target.representation:std::next(target.representation);
+            for (auto content : op.content) {
+                auto it = reps.insert(insert_at, Representation(importContent(doc, content, "Representation", op)));
+                it->setAdaptationSet(&(*target.adaptationSet));
+            }
+        }
+        break;
+    }
+}
+
+void MPD::Patcher::addChildren(const Target &target, const PatchOperation &op)
+{
+    // Children held as objects are added directly, anything else is added via the XML for the target
+    PatchOperation other_op(op);
+    other_op.content.clear();
+    xmlpp::Document doc;
+    doc.create_root_node("MPD", MPD_NS);
+    bool prepend = (op.pos == PatchOperation::PREPEND);
+    bool periods_added = false;
+
+    Period *period = (target.level == MPD_LEVEL)?nullptr:&(*target.period);
+    auto period_insert_at = prepend?m_mpd.m_periods.begin():m_mpd.m_periods.end();
+    std::list<AdaptationSet>::iterator adapt_set_insert_at, empty_adapt_set_insert_at;
+    std::list<Representation>::iterator rep_insert_at;
+    if (target.level == PERIOD_LEVEL) {
+        adapt_set_insert_at = prepend?period->m_adaptationSets.begin():period->m_adaptationSets.end();
+        empty_adapt_set_insert_at = prepend?period->m_emptyAdaptationSets.begin():period->m_emptyAdaptationSets.end();
+    } else if (target.level == ADAPTATION_SET_LEVEL) {
+        auto &reps = target.adaptationSet->m_representations;
+        rep_insert_at = prepend?reps.begin():reps.end();
+    }
+
+    for (auto content : op.content) {
+        // Content elements may be in the patch namespace, so only the names are compared
+        std::string name(content->type == XML_ELEMENT_NODE?reinterpret_cast<const char*>(content->name):"");
+        if (target.level == MPD_LEVEL && name == "Period") {
+            m_mpd.m_periods.insert(period_insert_at, Period(importContent(doc, content, "Period", op)));
+            periods_added = true;
+        } else if (target.level == PERIOD_LEVEL && name == "AdaptationSet") {
+            auto it = period->m_adaptationSets.insert(adapt_set_insert_at, AdaptationSet(importContent(doc, content, "AdaptationSet", op)));
+            it->setPeriod(period);
+        } else if (target.level == PERIOD_LEVEL && name == "EmptyAdaptationSet") {
+            auto it = period->m_emptyAdaptationSets.insert(empty_adapt_set_insert_at,
+                                                           AdaptationSet(importContent(doc, content, "EmptyAdaptationSet", op)));
+            it->setPeriod(period);
+        } else if (target.level == ADAPTATION_SET_LEVEL && name == "Representation") {
+            auto it = target.adaptationSet->m_representations.insert(rep_insert_at,
+                                                                     Representation(importContent(doc, content, "Representation", op)));
+            it->setAdaptationSet(&(*target.adaptationSet));
+        } else {
+            other_op.content.push_back(content);
+        }
+    }
+    if (periods_added) m_mpd.relinkPeriods();
+
+    if (!other_op.content.empty()) patchXML(target, other_op);
+}
+
+void MPD::Patcher::patchXML(const Target &target, const PatchOperation &op)
+{
+    xmlpp::Document doc;
+
+    switch (target.level) {
+    case MPD_LEVEL:
+        {
+            MPD &mpd = m_mpd;
+            xmlpp::Element *root = doc.create_root_node("MPD", MPD_NS);
+            ListGuard<std::list<Period> > periods(mpd.m_periods);
+            mpd.setXMLElement(*root);
+            auto unpatched = std::make_tuple(UnpatchedValue(mpd.m_availabilityStartTime, root->cobj(), "availabilityStartTime"),
+                                             UnpatchedValue(mpd.m_availabilityEndTime, root->cobj(), "availabilityEndTime"),
+                                             UnpatchedValue(mpd.m_publishTime, root->cobj(), "publishTime"),
+                                             UnpatchedValue(mpd.m_mediaPresentationDuration, root->cobj(), "mediaPresentationDuration"),
+                                             UnpatchedValue(mpd.m_minimumUpdatePeriod, root->cobj(), "minimumUpdatePeriod"),
+                                             UnpatchedValue(mpd.m_minBufferTime, root->cobj(), "minBufferTime"),
+                                             UnpatchedValue(mpd.m_timeShiftBufferDepth, root->cobj(), "timeShiftBufferDepth"),
+                                             UnpatchedValue(mpd.m_suggestedPresentationDelay, root->cobj(), "suggestedPresentationDelay"),
+                                             UnpatchedValue(mpd.m_maxSegmentDuration, root->cobj(), "maxSegmentDuration"),
+                                             UnpatchedValue(mpd.m_maxSubsegmentDuration, root->cobj(), "maxSubsegmentDuration"));
+            apply_xml_operation(root->cobj(), op, target.nextStep);
+
+            // Rebuild the MPD attributes and children, other than the Periods, from the patched XML
+            std::list<Descriptor> utc_timings(std::move(mpd.m_utcTimings));
+            mpd.m_id.reset();
+            mpd.m_profiles.clear();
+            mpd.m_type = STATIC;
+            mpd.m_availabilityStartTime.reset();
+            mpd.m_availabilityEndTime.reset();
+            mpd.m_publishTime.reset();
+            mpd.m_mediaPresentationDuration.reset();
+            mpd.m_minimumUpdatePeriod.reset();
+            mpd.m_timeShiftBufferDepth.reset();
+            mpd.m_suggestedPresentationDelay.reset();
+            mpd.m_maxSegmentDuration.reset();
+            mpd.m_maxSubsegmentDuration.reset();
+            mpd.m_programInformations.clear();
+            mpd.m_baseURLs.clear();
+            mpd.m_locations.clear();
+            mpd.m_patchLocations.clear();
+            mpd.m_serviceDescriptions.clear();
+            mpd.m_initializationSets.clear();
+            mpd.m_initializationGroups.clear();
+            mpd.m_initializationPresentations.clear();
+            mpd.m_contentProtections.clear();
+            mpd.m_metrics.clear();
+            mpd.m_essentialProperties.clear();
+            mpd.m_supplementaryProperties.clear();
+            mpd.m_utcTimings.clear();
+            mpd.m_leapSecondInformation.reset();
+
+            mpd.extractMPDAttributes(*root);
+            std::apply([](const auto &...value) { (value.restore(), ...); }, unpatched);
+            std::vector<xmlpp::Node*> added_periods;
+            for (auto child : root->get_children()) {
+                xmlpp::Element *child_elem = dynamic_cast<xmlpp::Element*>(child);
+                if (child_elem) mpd.extractMPDChild(*child_elem, &added_periods);
+            }
+            if (!added_periods.empty()) {
+                throw PatchError("MPD Patch selector \"" + op.sel + "\" adds Periods outside of the MPD element");
+            }
+            if (mpd.m_utcTimings != utc_timings) mpd.m_cache->haveUtcTimingOffsetFromSystemClock = false;
+            mpd.invalidateBaseURLs();
+        }
+        // MPD attributes such as the type can change how the Period times are calculated
+        m_mpd.relinkPeriods();
+        break;
+    case PERIOD_LEVEL:
+        {
+            Period &period = *target.period;
+            xmlpp::Element *root = doc.create_root_node("Period", MPD_NS);
+            {
+                ListGuard<std::list<AdaptationSet> > adapt_sets(period.m_adaptationSets);
+                ListGuard<std::list<AdaptationSet> > empty_adapt_sets(period.m_emptyAdaptationSets);
+                period.setXMLElement(*root);
+            }
+            auto unpatched = std::make_tuple(UnpatchedValue(period.m_start, root->cobj(), "start"),
+                                             UnpatchedValue(period.m_duration, root->cobj(), "duration"));
+            apply_xml_operation(root->cobj(), op, target.nextStep);
+            Period updated(*root);
+
+            // Keep the existing AdaptationSets and links, any AdaptationSets added via the XML are appended
+            std::list<AdaptationSet> adapt_sets(std::move(period.m_adaptationSets));
+            std::list<AdaptationSet> empty_adapt_sets(std::move(period.m_emptyAdaptationSets));
+            std::list<AdaptationSet> added_adapt_sets(std::move(updated.m_adaptationSets));
+            std::list<AdaptationSet> added_empty_adapt_sets(std::move(updated.m_emptyAdaptationSets));
+            MPD *mpd = period.m_mpd;
+            period = std::move(updated);
+            period.m_mpd = mpd;
+            // The assignment invalidated the detached tree of the parsed Period, the BaseURLs and segment information of this MPD have changed
+            period.invalidateBaseURLs();
+            period.invalidateAddressing();
+            period.m_adaptationSets = std::move(adapt_sets);
+            period.m_emptyAdaptationSets = std::move(empty_adapt_sets);
+            for (auto &adapt_set : added_adapt_sets) adapt_set.setPeriod(&period);
+            for (auto &adapt_set : added_empty_adapt_sets) adapt_set.setPeriod(&period);
+            period.m_adaptationSets.splice(period.m_adaptationSets.end(), added_adapt_sets);
+            period.m_emptyAdaptationSets.splice(period.m_emptyAdaptationSets.end(), added_empty_adapt_sets);
+            std::apply([](const auto &...value) { (value.restore(), ...); }, unpatched);
+        }
+        m_mpd.relinkPeriods();
+        break;
+    case ADAPTATION_SET_LEVEL:
+        {
+            AdaptationSet &adapt_set = *target.adaptationSet;
+            const char *name = (target.adaptationSetList == &target.period->m_adaptationSets)?"AdaptationSet":"EmptyAdaptationSet";
+            xmlpp::Element *root = doc.create_root_node(name, MPD_NS);
+            {
+                ListGuard<std::list<Representation> > reps(adapt_set.m_representations);
+                adapt_set.setXMLElement(*root);
+            }
+            apply_xml_operation(root->cobj(), op, target.nextStep);
+            AdaptationSet updated(*root);
+
+            // Keep the existing Representations and their selection, any Representations added via the XML are appended
+            std::list<Representation> reps(std::move(adapt_set.m_representations));
+            std::unordered_set<const Representation*> selected_reps(std::move(adapt_set.m_selectedRepresentations));
+            std::list<Representation> added_reps(std::move(updated.m_representations));
+            updated.m_selectedRepresentations.clear();
+            Period *period = adapt_set.m_period;
+            adapt_set = std::move(updated);
+            adapt_set.m_period = period;
+            adapt_set.invalidateBaseURLs();
+            adapt_set.invalidateAddressing();
+            adapt_set.m_representations = std::move(reps);
+            adapt_set.m_selectedRepresentations = std::move(selected_reps);
+            for (auto &rep : added_reps) rep.setAdaptationSet(&adapt_set);
+            adapt_set.m_representations.splice(adapt_set.m_representations.end(), added_reps);
+        }
+        break;
+    case REPRESENTATION_LEVEL:
+        {
+            xmlpp::Element *root = doc.create_root_node("Representation", MPD_NS);
+            target.representation->setXMLElement(*root);
+            apply_xml_operation(root->cobj(), op, target.nextStep);
+            updateRepresentation(target, Representation(*root), op);
+        }
+        break;
+    }
+}
+
+void MPD::Patcher::updateRepresentation(const Target &target, Representation &&updated, const PatchOperation &op)
+{
+    // Representations are matched up by @id when refreshing, so the @id cannot be changed by a patch
+    if (updated.id() != target.representation->id()) {
+        throw PatchError("MPD Patch operation on \"" + op.sel + "\" cannot change the Representation@id from \"" +
+                         target.representation->id() + "\" to \"" + updated.id() + "\"");
+    }
+
+    // Assign in place so that the selection of this Representation is kept
+    *target.representation = std::move(updated);
+    target.representation->setAdaptationSet(&(*target.adaptationSet));
+}
+
+xmlpp::Node &MPD::Patcher::importContent(xmlpp::Document &doc, const xmlNode *content, const char *expected_name,
+                                         const PatchOperation &op)
+{
+    if (content->type != XML_ELEMENT_NODE || std::strcmp(reinterpret_cast<const char*>(content->name), expected_name) != 0) {
+        throw PatchError("MPD Patch operation on \"" + op.sel + "\" can only have " + expected_name + " elements as content");
+    }
+
+    // Copy into the scratch document in the MPD namespace so that the element can be parsed like any other MPD element
+    xmlNodePtr root = xmlDocGetRootElement(doc.cobj());
+    xmlNodePtr copy = xmlAddChild(root, copy_content(content, root));
+    xmlpp::Node::create_wrapper(copy);
+    return *static_cast<xmlpp::Node*>(copy->_private);
+}
+
+MPD &MPD::applyPatch(const std::vector<char> &patch_xml)
+{
+    xmlpp::DomParser parser;
+    parser.set_substitute_entities(true);
+    parser.parse_memory_raw(reinterpret_cast<const unsigned char*>(patch_xml.data()), patch_xml.size());
+    if (!parser) throw ParseError("Unable to parse MPD Patch XML");
+    Patcher(*this).apply(*parser.get_document());
+    return *this;
+}
+
+MPD &MPD::applyPatch(const std::vector<unsigned char> &patch_xml)
+{
+    xmlpp::DomParser parser;
+    parser.set_substitute_entities(true);
+    parser.parse_memory_raw(patch_xml.data(), patch_xml.size());
+    if (!parser) throw ParseError("Unable to parse MPD Patch XML");
+    Patcher(*this).apply(*parser.get_document());
+    return *this;
+}
+
+MPD &MPD::applyPatch(std::istream &input_stream)
+{
+    xmlpp::DomParser parser;
+    parser.set_substitute_entities(true);
+    parser.parse_stream(input_stream);
+    if (!parser) throw ParseError("Unable to parse MPD Patch XML");
+    Patcher(*this).apply(*parser.get_document());
+    return *this;
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,62 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: MemoryResourceScope class
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <cstddef>
+#include <memory_resource>
+
+#include "libmpd++/macros.hh"
+
+#include "libmpd++/MemoryResource.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+// Resource for the innermost MemoryResourceScope in this thread, or nullptr for the default resource
+static thread_local std::pmr::memory_resource *g_current_resource = nullptr;
+
+// TreeAllocated objects are preceded by a header holding the resource they were allocated from
+static constexpr std::size_t c_header_size = alignof(std::max_align_t);
+static_assert(c_header_size >= sizeof(std::pmr::memory_resource*));
+
+MemoryResourceScope::MemoryResourceScope(std::pmr::memory_resource *resource)
+    :m_previous(g_current_resource)
+{
+    if (resource) g_current_resource = resource;
+}
+
+MemoryResourceScope::~MemoryResourceScope()
+{
+    g_current_resource = m_previous;
+}
+
+std::pmr::memory_resource *MemoryResourceScope::current()
+{
+    return g_current_resource?g_current_resource:std::pmr::get_default_resource();
+}
+
+void *TreeAllocated::operator new(std::size_t size)
+{
+    std::pmr::memory_resource *resource = MemoryResourceScope::current();
+    auto *block = static_cast<unsigned char*>(resource->allocate(size + c_header_size, alignof(std::max_align_t)));
+    *reinterpret_cast<std::pmr::memory_resource**>(block) = resource;
+    return block + c_header_size;
+}
+
+void TreeAllocated::operator delete(void *ptr, std::size_t size)
+{
+    if (!ptr) return;
+    auto *block = static_cast<unsigned char*>(ptr) - c_header_size;
+    std::pmr::memory_resource *resource = *reinterpret_cast<std::pmr::memory_resource**>(block);
+    resource->deallocate(block, size + c_header_size, alignof(std::max_align_t));
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
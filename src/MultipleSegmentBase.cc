@@ -8,6 +8,7 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <chrono>
 #include <optional>
 
 #include <libxml++/libxml++.h>
@@ -20,11 +21,34 @@
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "parse_tables.hh"
 
 #include "libmpd++/MultipleSegmentBase.hh"
 
 LIBMPDPP_NAMESPACE_BEGIN
 
+namespace {
+
+// Integer conversions between timescale ticks and durations, split into whole seconds so that long Periods don't overflow
+
+MultipleSegmentBase::duration_type ticks_to_duration(unsigned long ticks, unsigned long timescale)
+{
+    using rep = MultipleSegmentBase::duration_type::rep;
+    constexpr rep per_second = MultipleSegmentBase::duration_type::period::den;
+    return MultipleSegmentBase::duration_type(static_cast<rep>(ticks / timescale) * per_second +
+                                              static_cast<rep>(ticks % timescale) * per_second / static_cast<rep>(timescale));
+}
+
+unsigned long duration_to_ticks(const MultipleSegmentBase::duration_type &durn, unsigned long timescale)
+{
+    constexpr unsigned long per_second = MultipleSegmentBase::duration_type::period::den;
+    if (durn.count() < 0) return 0;
+    unsigned long count = static_cast<unsigned long>(durn.count());
+    return (count / per_second) * timescale + (count % per_second) * timescale / per_second;
+}
+
+} // namespace
+
 MultipleSegmentBase::MultipleSegmentBase()
     :SegmentBase()
     ,m_duration()
@@ -103,33 +127,89 @@ MultipleSegmentBase::duration_type MultipleSegmentBase::durationAsDurationType()
 
 unsigned long MultipleSegmentBase::segmentNumberToTime(unsigned long segment_number) const
 {
+    if (m_segmentTimeline) {
+        // The timeline is in media time, so remove the @presentationTimeOffset to get the offset into the Period
+        auto media_time = m_segmentTimeline.value().segmentStartTime(segment_number);
+        auto pto = presentationTimeOffest().value_or(0);
+        if (media_time < pto) return 0;
+        return media_time - pto;
+    }
     // time = m_duration * segment_number since m_duration is already in the correct timescale
     if (m_duration) return m_duration.value() * segment_number;
     return 0; // no duration then there's only one segment starting at the period start
 }
 
+unsigned long MultipleSegmentBase::segmentNumberToMediaTime(unsigned long segment_number) const
+{
+    if (m_segmentTimeline) return m_segmentTimeline.value().segmentStartTime(segment_number);
+    return segmentNumberToTime(segment_number) + presentationTimeOffest().value_or(0);
+}
+
 // Get wallclock duration of a segment from Period start
 MultipleSegmentBase::duration_type MultipleSegmentBase::segmentNumberToDurationType(unsigned long segment_number) const
 {
-    // time = m_duration / m_timescale * segment_number, where m_timescale defaults to 1 if not given.
-    if (m_duration) return durationAsDurationType() * segment_number;
-    return duration_type(0); // no duration then there's only one segment starting at the period start
+    return ticks_to_duration(segmentNumberToTime(segment_number), timescale().value_or(1));
 }
 
 // Get segment number from offset from Period start in the current timescale
 unsigned long MultipleSegmentBase::timeOffsetToSegmentNumber(unsigned long time_offset) const
 {
-    // segment_number = floor(time_offset / m_duration)
-    if (m_duration) return (time_offset / m_duration.value());
-    return 0; // no duration then there's only one segment
+    unsigned long segment_number = 0; // no duration or timeline then there's only one segment
+    if (m_segmentTimeline) {
+        segment_number = m_segmentTimeline.value().segmentIndexForTime(time_offset + presentationTimeOffest().value_or(0));
+    } else if (m_duration && m_duration.value() > 0) {
+        // segment_number = floor(time_offset / m_duration)
+        segment_number = time_offset / m_duration.value();
+    }
+
+    // Don't go past the last segment
+    auto count = segmentCount();
+    if (count && count.value() > 0 && segment_number >= count.value()) segment_number = count.value() - 1;
+
+    return segment_number;
 }
 
 // Get segment number that contains the wallclock duration since Period start
 unsigned long MultipleSegmentBase::durationTypeToSegmentNumber(const MultipleSegmentBase::duration_type &offset) const
 {
     if (offset.count() < 0) return 0;
-    if (m_duration) return (offset / durationAsDurationType());
-    return 0; // no duration then there's only one segment
+    return timeOffsetToSegmentNumber(duration_to_ticks(offset, timescale().value_or(1)));
+}
+
+std::optional<unsigned long> MultipleSegmentBase::segmentCount(const std::optional<duration_type> &period_duration) const
+{
+    std::optional<unsigned long> ret;
+    unsigned long ts = timescale().value_or(1);
+
+    if (m_segmentTimeline) {
+        std::optional<unsigned long> end_time;
+        if (period_duration) end_time = duration_to_ticks(period_duration.value(), ts) + presentationTimeOffest().value_or(0);
+        ret = m_segmentTimeline.value().segmentCount(end_time);
+    } else if (m_duration && m_duration.value() > 0) {
+        if (period_duration) {
+            auto period_ticks = duration_to_ticks(period_duration.value(), ts);
+            ret = (period_ticks + m_duration.value() - 1) / m_duration.value();
+        }
+    } else {
+        ret = 1;
+    }
+
+    // @endNumber is the number of the last segment
+    if (m_endNumber) {
+        unsigned long start_number = m_startNumber.value_or(1);
+        unsigned long end_count = (m_endNumber.value() < start_number)?0:(m_endNumber.value() - start_number + 1);
+        if (!ret || end_count < ret.value()) ret = end_count;
+    }
+
+    return ret;
+}
+
+MultipleSegmentBase::duration_type MultipleSegmentBase::segmentDurationAsDurationType(unsigned long segment_number) const
+{
+    if (m_segmentTimeline) {
+        return ticks_to_duration(m_segmentTimeline.value().segmentDuration(segment_number), timescale().value_or(1));
+    }
+    return durationAsDurationType();
 }
 
 // protected
@@ -142,42 +222,28 @@ MultipleSegmentBase::MultipleSegmentBase(xmlpp::Node &node)
     ,m_segmentTimeline()
     ,m_bitstreamSwitching()
 {
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}
-    };
-    xmlpp::Node::NodeSet node_set;
-
-    node_set = node.find("@duration");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_duration = static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
+#define ATTR_UINT(name) {#name, [](MultipleSegmentBase &msb, const std::string &val) { msb.m_ ## name = str_to_ui(val); }}
+#define CHILD_ONCE(name, var, cls) {#name, [](MultipleSegmentBase &msb, xmlpp::Node &child) { \
+            if (msb.var) throw ParseError("There can be only one " #name " child of a MultipleSegmentBase type element"); \
+            msb.var = cls(child); \
+        }}
 
-    node_set = node.find("@startNumber");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_startNumber = static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
+    static const AttributeTable<MultipleSegmentBase> attribute_table("MultipleSegmentBase", {
+        ATTR_UINT(duration),
+        ATTR_UINT(startNumber),
+        ATTR_UINT(endNumber)
+    });
 
-    node_set = node.find("@endNumber");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_endNumber = static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
+    static const ElementTable<MultipleSegmentBase> element_table({
+        CHILD_ONCE(SegmentTimeline, m_segmentTimeline, SegmentTimeline),
+        CHILD_ONCE(BitstreamSwitching, m_bitstreamSwitching, URL)
+    });
 
-    node_set = node.find("mpd:SegmentTimeline", ns_map);
-    if (node_set.size() == 1) {
-        m_segmentTimeline = SegmentTimeline(*node_set.front());
-    } else if (node_set.size() > 1) {
-        throw ParseError("There can be only one SegmentTimeline child of a MultipleSegmentBase type element");
-    }
+#undef CHILD_ONCE
+#undef ATTR_UINT
 
-    node_set = node.find("mpd:BitstreamSwitching", ns_map);
-    if (node_set.size() == 1) {
-        m_bitstreamSwitching = URL(*node_set.front());
-    } else if (node_set.size() > 1) {
-        throw ParseError("There can be only one BitstreamSwitching child of a MultipleSegmentBase type element");
-    }
+    attribute_table.apply(*this, node);
+    element_table.apply(*this, node);
 }
 
 void MultipleSegmentBase::setXMLElement(xmlpp::Element &elem) const
@@ -206,6 +272,17 @@ void MultipleSegmentBase::setXMLElement(xmlpp::Element &elem) const
     }
 }
 
+void MultipleSegmentBase::inheritFrom(const MultipleSegmentBase &parent)
+{
+    SegmentBase::inheritFrom(parent);
+
+    if (!m_duration) m_duration = parent.m_duration;
+    if (!m_startNumber) m_startNumber = parent.m_startNumber;
+    if (!m_endNumber) m_endNumber = parent.m_endNumber;
+    if (!m_segmentTimeline) m_segmentTimeline = parent.m_segmentTimeline;
+    if (!m_bitstreamSwitching) m_bitstreamSwitching = parent.m_bitstreamSwitching;
+}
+
 LIBMPDPP_NAMESPACE_END
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
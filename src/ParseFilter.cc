@@ -0,0 +1,137 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: ParseFilter class
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <libxml/tree.h>
+
+#include "libmpd++/macros.hh"
+
+#include "constants.hh"
+
+#include "libmpd++/ParseFilter.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+namespace {
+
+/* These helpers read the XML tree in place so that checking an AdaptationSet allocates nothing */
+
+bool is_mpd_element(const xmlNode *node, const char *name)
+{
+    return node->type == XML_ELEMENT_NODE && node->ns && node->ns->href &&
+           std::strcmp(reinterpret_cast<const char*>(node->ns->href), MPD_NS) == 0 &&
+           std::strcmp(reinterpret_cast<const char*>(node->name), name) == 0;
+}
+
+// Attribute values are a single text node once entities have been substituted, anything else is treated as empty
+std::string_view attribute_view(const xmlNode *node, const char *name)
+{
+    for (const xmlAttr *attr = node->properties; attr; attr = attr->next) {
+        if (attr->ns || std::strcmp(reinterpret_cast<const char*>(attr->name), name) != 0) continue;
+        const xmlNode *text = attr->children;
+        if (text && !text->next && text->type == XML_TEXT_NODE && text->content) {
+            return std::string_view(reinterpret_cast<const char*>(text->content));
+        }
+        return std::string_view();
+    }
+    return std::string_view();
+}
+
+} // namespace
+
+std::string_view ParseFilter::AdaptationSetInfo::elementName() const
+{
+    return std::string_view(reinterpret_cast<const char*>(static_cast<const xmlNode*>(m_node)->name));
+}
+
+std::string_view ParseFilter::AdaptationSetInfo::contentType() const
+{
+    auto content_type = attribute_view(static_cast<const xmlNode*>(m_node), "contentType");
+    if (!content_type.empty()) return content_type;
+    auto mime_type = mimeType();
+    return mime_type.substr(0, mime_type.find('/'));
+}
+
+std::string_view ParseFilter::AdaptationSetInfo::mimeType() const
+{
+    const xmlNode *node = static_cast<const xmlNode*>(m_node);
+    auto mime_type = attribute_view(node, "mimeType");
+    if (!mime_type.empty()) return mime_type;
+    for (const xmlNode *child = node->children; child; child = child->next) {
+        if (is_mpd_element(child, "Representation")) return attribute_view(child, "mimeType");
+    }
+    return std::string_view();
+}
+
+bool ParseFilter::AdaptationSetInfo::hasEssentialProperty(std::string_view scheme_id_uri) const
+{
+    for (const xmlNode *child = static_cast<const xmlNode*>(m_node)->children; child; child = child->next) {
+        if (is_mpd_element(child, "EssentialProperty") && attribute_view(child, "schemeIdUri") == scheme_id_uri) return true;
+    }
+    return false;
+}
+
+ParseFilter::ParseFilter()
+    :m_skipElements()
+    ,m_adaptationSetPredicates()
+{
+}
+
+ParseFilter &ParseFilter::skipElement(const std::string &element_name)
+{
+    if (!skipsElement(element_name)) m_skipElements.push_back(element_name);
+    return *this;
+}
+
+bool ParseFilter::skipsElement(std::string_view element_name) const
+{
+    // Only a handful of names are expected, so a linear search is quicker than hashing the name
+    return std::find(m_skipElements.begin(), m_skipElements.end(), element_name) != m_skipElements.end();
+}
+
+ParseFilter &ParseFilter::skipAdaptationSets(const adaptation_set_predicate_type &predicate)
+{
+    m_adaptationSetPredicates.push_back(predicate);
+    return *this;
+}
+
+ParseFilter &ParseFilter::skipAdaptationSetContentType(const std::string &content_type)
+{
+    return skipAdaptationSets([content_type](const AdaptationSetInfo &info) { return info.contentType() == content_type; });
+}
+
+ParseFilter &ParseFilter::skipAdaptationSetMimeType(const std::string &mime_type)
+{
+    return skipAdaptationSets([mime_type](const AdaptationSetInfo &info) { return info.mimeType() == mime_type; });
+}
+
+ParseFilter &ParseFilter::skipAdaptationSetEssentialProperty(const std::string &scheme_id_uri)
+{
+    return skipAdaptationSets([scheme_id_uri](const AdaptationSetInfo &info) {
+        return info.hasEssentialProperty(scheme_id_uri);
+    });
+}
+
+bool ParseFilter::skipsAdaptationSet(const AdaptationSetInfo &info) const
+{
+    for (const auto &predicate : m_adaptationSetPredicates) {
+        if (predicate(info)) return true;
+    }
+    return false;
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -8,10 +8,12 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_set>
@@ -27,18 +29,23 @@
 #include "libmpd++/Descriptor.hh"
 #include "libmpd++/EventStream.hh"
 #include "libmpd++/Label.hh"
+#include "libmpd++/MemoryResource.hh"
 #include "libmpd++/MPD.hh"
+#include "libmpd++/ParseFilter.hh"
 #include "libmpd++/Preselection.hh"
 #include "libmpd++/SegmentAvailability.hh"
 #include "libmpd++/SegmentBase.hh"
 #include "libmpd++/SegmentTemplate.hh"
 #include "libmpd++/SegmentList.hh"
+#include "libmpd++/StringPool.hh"
 #include "libmpd++/XLink.hh"
 #include <glibmm/ustring.h>
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "parse_tables.hh"
 #include "stream_ops.hh"
+#include "UnparsedElement.hh"
 
 #include "libmpd++/Period.hh"
 
@@ -55,6 +62,7 @@ Period::Period()
     ,m_duration()
     ,m_bitstreamSwitching(false)
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_segmentBase()
     ,m_segmentList()
     ,m_segmentTemplate()
@@ -82,6 +90,7 @@ Period::Period(const Period &to_copy)
     ,m_duration(to_copy.m_duration)
     ,m_bitstreamSwitching(to_copy.m_bitstreamSwitching)
     ,m_baseURLs(to_copy.m_baseURLs)
+    ,m_baseURLCache()
     ,m_segmentBase(to_copy.m_segmentBase)
     ,m_segmentList(to_copy.m_segmentList)
     ,m_segmentTemplate(to_copy.m_segmentTemplate)
@@ -115,6 +124,7 @@ Period::Period(Period &&to_move)
     ,m_duration(std::move(to_move.m_duration))
     ,m_bitstreamSwitching(to_move.m_bitstreamSwitching)
     ,m_baseURLs(std::move(to_move.m_baseURLs))
+    ,m_baseURLCache()
     ,m_segmentBase(std::move(to_move.m_segmentBase))
     ,m_segmentList(std::move(to_move.m_segmentList))
     ,m_segmentTemplate(std::move(to_move.m_segmentTemplate))
@@ -154,9 +164,11 @@ Period &Period::operator=(const Period &to_copy)
     m_duration = to_copy.m_duration;
     m_bitstreamSwitching = to_copy.m_bitstreamSwitching;
     m_baseURLs = to_copy.m_baseURLs;
+    invalidateBaseURLs();
     m_segmentBase = to_copy.m_segmentBase;
     m_segmentList = to_copy.m_segmentList;
     m_segmentTemplate = to_copy.m_segmentTemplate;
+    invalidateAddressing();
     m_assetIdentifier = to_copy.m_assetIdentifier;
     m_eventStreams = to_copy.m_eventStreams;
     m_serviceDescriptions = to_copy.m_serviceDescriptions;
@@ -190,9 +202,11 @@ Period &Period::operator=(Period &&to_move)
     m_duration = std::move(to_move.m_duration);
     m_bitstreamSwitching = to_move.m_bitstreamSwitching;
     m_baseURLs = std::move(to_move.m_baseURLs);
+    invalidateBaseURLs();
     m_segmentBase = std::move(to_move.m_segmentBase);
     m_segmentList = std::move(to_move.m_segmentList);
     m_segmentTemplate = std::move(to_move.m_segmentTemplate);
+    invalidateAddressing();
     m_assetIdentifier = std::move(to_move.m_assetIdentifier);
     m_eventStreams = std::move(to_move.m_eventStreams);
     m_serviceDescriptions = std::move(to_move.m_serviceDescriptions);
@@ -217,6 +231,9 @@ Period &Period::operator=(Period &&to_move)
 
 bool Period::operator==(const Period &to_compare) const
 {
+    materialise();
+    to_compare.materialise();
+
 #define COMPARE_OPT_VALUES(var) if (var != to_compare.var) return false
 #define COMPARE_ANY_ORDER_LISTS(var) do { \
         if (var.size() != to_compare.var.size()) return false; \
@@ -259,82 +276,88 @@ bool Period::operator==(const Period &to_compare) const
 
 Period &Period::baseURLAdd(const BaseURL &base_url)
 {
+    materialise();
     m_baseURLs.push_back(base_url);
+    invalidateBaseURLs();
     return *this;
 }
 
 Period &Period::baseURLAdd(BaseURL &&base_url)
 {
+    materialise();
     m_baseURLs.push_back(std::move(base_url));
+    invalidateBaseURLs();
     return *this;
 }
 
 Period &Period::baseURLRemove(const BaseURL &base_url)
 {
+    materialise();
     auto it = std::find(m_baseURLs.begin(), m_baseURLs.end(), base_url);
     return baseURLRemove(it);
 }
 
 Period &Period::baseURLRemove(const std::list<BaseURL>::const_iterator &it)
 {
+    materialise();
     if (it != m_baseURLs.end()) {
         m_baseURLs.erase(it);
     }
+    invalidateBaseURLs();
     return *this;
 }
 
 Period &Period::baseURLRemove(const std::list<BaseURL>::iterator &it)
 {
+    materialise();
     if (it != m_baseURLs.end()) {
         m_baseURLs.erase(it);
     }
+    invalidateBaseURLs();
     return *this;
 }
 
-std::list<BaseURL> Period::getBaseURLs() const
+const std::list<BaseURL> &Period::getBaseURLs() const
 {
+    materialise();
     if (m_baseURLs.empty() && m_mpd) return m_mpd->getBaseURLs();
 
-    std::list<BaseURL> ret;
-    std::list<BaseURL> parent_urls_cache;
-    bool have_parent_urls = false;
-    for (const auto &base_url : m_baseURLs) {
-        if (base_url.url().isAbsoluteURL()) {
-            ret.push_back(base_url);
-        } else {
-            if (m_mpd) {
-                if (!have_parent_urls) {
-                    parent_urls_cache = m_mpd->getBaseURLs();
-                    have_parent_urls = true;
-                }
-                ret.push_back(base_url.resolveURL(parent_urls_cache));
-            } else {
+    return m_baseURLCache.get(MPD::baseURLGeneration(m_mpd), [this]() {
+        std::list<BaseURL> ret;
+        for (const auto &base_url : m_baseURLs) {
+            if (base_url.url().isAbsoluteURL() || !m_mpd) {
                 ret.push_back(base_url);
+            } else {
+                ret.push_back(base_url.resolveURL(m_mpd->getBaseURLs()));
             }
         }
-    }
-    return ret;
+        return ret;
+    });
 }
 
 Period &Period::eventStreamAdd(const EventStream &event_stream)
 {
+    materialise();
     m_eventStreams.push_back(event_stream);
     return *this;
 }
 
 Period &Period::eventStreamAdd(EventStream &&event_stream)
 {
+    materialise();
     m_eventStreams.push_back(std::move(event_stream));
     return *this;
 }
 
 Period &Period::eventStreamRemove(const EventStream &event_stream)
 {
+    materialise();
     return eventStreamRemove(std::find(m_eventStreams.begin(), m_eventStreams.end(), event_stream));
 }
 
 Period &Period::eventStreamRemove(const std::list<EventStream>::const_iterator &it)
 {
+    materialise();
     if (it != m_eventStreams.end()) {
         m_eventStreams.erase(it);
     }
@@ -343,6 +366,7 @@ Period &Period::eventStreamRemove(const std::list<EventStream>::const_iterator &
 
 Period &Period::eventStreamRemove(const std::list<EventStream>::iterator &it)
 {
+    materialise();
     if (it != m_eventStreams.end()) {
         m_eventStreams.erase(it);
     }
@@ -351,23 +375,27 @@ Period &Period::eventStreamRemove(const std::list<EventStream>::iterator &it)
 
 Period &Period::serviceDescriptionAdd(const ServiceDescription &service_desc)
 {
+    materialise();
     m_serviceDescriptions.push_back(service_desc);
     return *this;
 }
 
 Period &Period::serviceDescriptionAdd(ServiceDescription &&service_desc)
 {
+    materialise();
     m_serviceDescriptions.push_back(std::move(service_desc));
     return *this;
 }
 
 Period &Period::serviceDescriptionRemove(const ServiceDescription &service_desc)
 {
+    materialise();
     return serviceDescriptionRemove(std::find(m_serviceDescriptions.begin(), m_serviceDescriptions.end(), service_desc));
 }
 
 Period &Period::serviceDescriptionRemove(const std::list<ServiceDescription>::const_iterator &it)
 {
+    materialise();
     if (it != m_serviceDescriptions.end()) {
         m_serviceDescriptions.erase(it);
     }
@@ -376,6 +404,7 @@ Period &Period::serviceDescriptionRemove(const std::list<ServiceDescription>::co
 
 Period &Period::serviceDescriptionRemove(const std::list<ServiceDescription>::iterator &it)
 {
+    materialise();
     if (it != m_serviceDescriptions.end()) {
         m_serviceDescriptions.erase(it);
     }
@@ -384,23 +413,27 @@ Period &Period::serviceDescriptionRemove(const std::list<ServiceDescription>::it
 
 Period &Period::contentProtectionAdd(const ContentProtection &content_prot)
 {
+    materialise();
     m_contentProtections.push_back(content_prot);
     return *this;
 }
 
 Period &Period::contentProtectionAdd(ContentProtection &&content_prot)
 {
+    materialise();
     m_contentProtections.push_back(std::move(content_prot));
     return *this;
 }
 
 Period &Period::contentProtectionRemove(const ContentProtection &content_prot)
 {
+    materialise();
     return contentProtectionRemove(std::find(m_contentProtections.begin(), m_contentProtections.end(), content_prot));
 }
 
 Period &Period::contentProtectionRemove(const std::list<ContentProtection>::const_iterator &it)
 {
+    materialise();
     if (it != m_contentProtections.end()) {
         m_contentProtections.erase(it);
     }
@@ -409,6 +442,7 @@ Period &Period::contentProtectionRemove(const std::list<ContentProtection>::cons
 
 Period &Period::contentProtectionRemove(const std::list<ContentProtection>::iterator &it)
 {
+    materialise();
     if (it != m_contentProtections.end()) {
         m_contentProtections.erase(it);
     }
@@ -417,6 +451,7 @@ Period &Period::contentProtectionRemove(const std::list<ContentProtection>::iter
 
 Period &Period::adaptationSetAdd(const AdaptationSet &adapt_set)
 {
+    materialise();
     m_adaptationSets.push_back(adapt_set);
     m_adaptationSets.back().setPeriod(this);
     return *this;
@@ -424,6 +459,7 @@ Period &Period::adaptationSetAdd(const AdaptationSet &adapt_set)
 
 Period &Period::adaptationSetAdd(AdaptationSet &&adapt_set)
 {
+    materialise();
     m_adaptationSets.push_back(std::move(adapt_set));
     m_adaptationSets.back().setPeriod(this);
     return *this;
@@ -431,11 +467,13 @@ Period &Period::adaptationSetAdd(AdaptationSet &&adapt_set)
 
 Period &Period::adaptationSetRemove(const AdaptationSet &adapt_set)
 {
+    materialise();
     return adaptationSetRemove(std::find(m_adaptationSets.begin(), m_adaptationSets.end(), adapt_set));
 }
 
 Period &Period::adaptationSetRemove(const std::list<AdaptationSet>::const_iterator &it)
 {
+    materialise();
     if (it != m_adaptationSets.end()) {
         m_adaptationSets.erase(it);
     }
@@ -444,6 +482,7 @@ Period &Period::adaptationSetRemove(const std::list<AdaptationSet>::const_iterat
 
 Period &Period::adaptationSetRemove(const std::list<AdaptationSet>::iterator &it)
 {
+    materialise();
     if (it != m_adaptationSets.end()) {
         m_adaptationSets.erase(it);
     }
@@ -452,23 +491,27 @@ Period &Period::adaptationSetRemove(const std::list<AdaptationSet>::iterator &it
 
 Period &Period::subsetAdd(const Subset &subset)
 {
+    materialise();
     m_subsets.push_back(subset);
     return *this;
 }
 
 Period &Period::subsetAdd(Subset &&subset)
 {
+    materialise();
     m_subsets.push_back(std::move(subset));
     return *this;
 }
 
 Period &Period::subsetRemove(const Subset &subset)
 {
+    materialise();
     return subsetRemove(std::find(m_subsets.begin(), m_subsets.end(), subset));
 }
 
 Period &Period::subsetRemove(const std::list<Subset>::const_iterator &it)
 {
+    materialise();
     if (it != m_subsets.end()) {
         m_subsets.erase(it);
     }
@@ -477,6 +520,7 @@ Period &Period::subsetRemove(const std::list<Subset>::const_iterator &it)
 
 Period &Period::subsetRemove(const std::list<Subset>::iterator &it)
 {
+    materialise();
     if (it != m_subsets.end()) {
         m_subsets.erase(it);
     }
@@ -485,23 +529,27 @@ Period &Period::subsetRemove(const std::list<Subset>::iterator &it)
 
 Period &Period::supplementalPropertyAdd(const Descriptor &supp_prop)
 {
+    materialise();
     m_supplementalProperties.push_back(supp_prop);
     return *this;
 }
 
 Period &Period::supplementalPropertyAdd(Descriptor &&supp_prop)
 {
+    materialise();
     m_supplementalProperties.push_back(std::move(supp_prop));
     return *this;
 }
 
 Period &Period::supplementalPropertyRemove(const Descriptor &supp_prop)
 {
+    materialise();
     return supplementalPropertyRemove(std::find(m_supplementalProperties.begin(), m_supplementalProperties.end(), supp_prop));
 }
 
 Period &Period::supplementalPropertyRemove(const std::list<Descriptor>::const_iterator &it)
 {
+    materialise();
     if (it != m_supplementalProperties.end()) {
         m_supplementalProperties.erase(it);
     }
@@ -510,6 +558,7 @@ Period &Period::supplementalPropertyRemove(const std::list<Descriptor>::const_it
 
 Period &Period::supplementalPropertyRemove(const std::list<Descriptor>::iterator &it)
 {
+    materialise();
     if (it != m_supplementalProperties.end()) {
         m_supplementalProperties.erase(it);
     }
@@ -518,6 +567,7 @@ Period &Period::supplementalPropertyRemove(const std::list<Descriptor>::iterator
 
 Period &Period::emptyAdaptationSetAdd(const AdaptationSet &adapt_set)
 {
+    materialise();
     m_emptyAdaptationSets.push_back(adapt_set);
     m_emptyAdaptationSets.back().setPeriod(this);
     return *this;
@@ -525,6 +575,7 @@ Period &Period::emptyAdaptationSetAdd(const AdaptationSet &adapt_set)
 
 Period &Period::emptyAdaptationSetAdd(AdaptationSet &&adapt_set)
 {
+    materialise();
     m_emptyAdaptationSets.push_back(std::move(adapt_set));
     m_emptyAdaptationSets.back().setPeriod(this);
     return *this;
@@ -532,11 +583,13 @@ Period &Period::emptyAdaptationSetAdd(AdaptationSet &&adapt_set)
 
 Period &Period::emptyAdaptationSetRemove(const AdaptationSet &adapt_set)
 {
+    materialise();
     return emptyAdaptationSetRemove(std::find(m_emptyAdaptationSets.begin(), m_emptyAdaptationSets.end(), adapt_set));
 }
 
 Period &Period::emptyAdaptationSetRemove(const std::list<AdaptationSet>::const_iterator &it)
 {
+    materialise();
     if (it != m_emptyAdaptationSets.end()) {
         m_emptyAdaptationSets.erase(it);
     }
@@ -545,6 +598,7 @@ Period &Period::emptyAdaptationSetRemove(const std::list<AdaptationSet>::const_i
 
 Period &Period::emptyAdaptationSetRemove(const std::list<AdaptationSet>::iterator &it)
 {
+    materialise();
     if (it != m_emptyAdaptationSets.end()) {
         m_emptyAdaptationSets.erase(it);
     }
@@ -553,23 +607,27 @@ Period &Period::emptyAdaptationSetRemove(const std::list<AdaptationSet>::iterato
 
 Period &Period::groupLabelAdd(const Label &label)
 {
+    materialise();
     m_groupLabels.push_back(label);
     return *this;
 }
 
 Period &Period::groupLabelAdd(Label &&label)
 {
+    materialise();
     m_groupLabels.push_back(std::move(label));
     return *this;
 }
 
 Period &Period::groupLabelRemove(const Label &label)
 {
+    materialise();
     return groupLabelRemove(std::find(m_groupLabels.begin(), m_groupLabels.end(), label));
 }
 
 Period &Period::groupLabelRemove(const std::list<Label>::const_iterator &it)
 {
+    materialise();
     if (it != m_groupLabels.end()) {
         m_groupLabels.erase(it);
     }
@@ -578,6 +636,7 @@ Period &Period::groupLabelRemove(const std::list<Label>::const_iterator &it)
 
 Period &Period::groupLabelRemove(const std::list<Label>::iterator &it)
 {
+    materialise();
     if (it != m_groupLabels.end()) {
         m_groupLabels.erase(it);
     }
@@ -586,23 +645,27 @@ Period &Period::groupLabelRemove(const std::list<Label>::iterator &it)
 
 Period &Period::preselectionAdd(const Preselection &preselection)
 {
+    materialise();
     m_preselections.push_back(preselection);
     return *this;
 }
 
 Period &Period::preselectionAdd(Preselection &&preselection)
 {
+    materialise();
     m_preselections.push_back(std::move(preselection));
     return *this;
 }
 
 Period &Period::preselectionRemove(const Preselection &preselection)
 {
+    materialise();
     return preselectionRemove(std::find(m_preselections.begin(), m_preselections.end(), preselection));
 }
 
 Period &Period::preselectionRemove(const std::list<Preselection>::const_iterator &it)
 {
+    materialise();
     if (it != m_preselections.end()) {
         m_preselections.erase(it);
     }
@@ -611,6 +674,7 @@ Period &Period::preselectionRemove(const std::list<Preselection>::const_iterator
 
 Period &Period::preselectionRemove(const std::list<Preselection>::iterator &it)
 {
+    materialise();
     if (it != m_preselections.end()) {
         m_preselections.erase(it);
     }
@@ -619,6 +683,7 @@ Period &Period::preselectionRemove(const std::list<Preselection>::iterator &it)
 
 void Period::selectAllRepresentations()
 {
+    materialise();
     for (auto &adapt_set : m_adaptationSets) {
         adapt_set.selectAllRepresentations();
     }
@@ -626,6 +691,7 @@ void Period::selectAllRepresentations()
 
 void Period::deselectAllRepresentations()
 {
+    materialise();
     for (auto &adapt_set : m_adaptationSets) {
         adapt_set.deselectAllRepresentations();
     }
@@ -633,6 +699,7 @@ void Period::deselectAllRepresentations()
 
 std::unordered_set<const Representation*> Period::selectedRepresentations() const
 {
+    materialise();
     std::unordered_set<const Representation*> ret;
     for (auto &adapt_set : m_adaptationSets) {
         const auto &selected_reps = adapt_set.selectedRepresentations();
@@ -643,6 +710,7 @@ std::unordered_set<const Representation*> Period::selectedRepresentations() cons
 
 std::list<SegmentAvailability> Period::selectedSegmentAvailability(const time_type &query_time) const
 {
+    materialise();
     std::list<SegmentAvailability> ret;
 
     for (const auto &adapt_set : m_adaptationSets) {
@@ -655,6 +723,7 @@ std::list<SegmentAvailability> Period::selectedSegmentAvailability(const time_ty
 
 std::list<SegmentAvailability> Period::selectedInitializationSegments() const
 {
+    materialise();
     std::unordered_set<SegmentAvailability> ret;
 
     for (const auto &adapt_set : m_adaptationSets) {
@@ -667,17 +736,13 @@ std::list<SegmentAvailability> Period::selectedInitializationSegments() const
 
 const std::optional<Period::duration_type> &Period::calcStart() const
 {
-    if (!m_cache->calcStart) {
-        cacheCalcTimes();
-    }
+    if (!cacheCalcTimes()) return m_start;
     return m_cache->calcStart;
 }
 
 const std::optional<Period::duration_type> &Period::calcDuration() const
 {
-    if (!m_cache->calcDuration) {
-        cacheCalcTimes();
-    }
+    if (!cacheCalcTimes()) return m_duration;
     return m_cache->calcDuration;
 }
 
@@ -693,6 +758,7 @@ Period::Period(xmlpp::Node &node)
     ,m_duration()
     ,m_bitstreamSwitching(false)
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_segmentBase()
     ,m_segmentList()
     ,m_segmentTemplate()
@@ -708,145 +774,39 @@ Period::Period(xmlpp::Node &node)
     ,m_preselections()
     ,m_cache(new Period::Cache)
 {
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}, {"xlink", XLINK_NS}
-    };
-    xmlpp::Node::NodeSet node_set;
-
-    node_set = node.find("@xlink:href", ns_map);
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        std::string xlink_href = attr->get_value();
-        auto actuate = XLink::ACTUATE_ON_REQUEST;
-        node_set = node.find("@xlink:actuate", ns_map);
-        if (node_set.size() > 0) {
-            attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-            std::string xlink_actuate = attr->get_value();
-            if (xlink_actuate == "onLoad") actuate = XLink::ACTUATE_ON_LOAD;
-            else if (xlink_actuate != "onRequest") throw ParseError("Period/@xlink:actuate can only be either \"onLoad\" or \"onRequest\"");
-        }
-        m_xlink = XLink(xlink_href, actuate, XLink::TYPE_SIMPLE, XLink::SHOW_EMBED);
-    }
-
-    node_set = node.find("@id");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_id = std::string(attr->get_value());
-    }
-
-    node_set = node.find("@start");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_start = str_to_duration<Period::duration_type>(attr->get_value());
-    }
-
-    node_set = node.find("@duration");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_duration = str_to_duration<Period::duration_type>(attr->get_value());
-    }
-
-    node_set = node.find("@bitstreamSwitching");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        if (attr->get_value() == "true") {
-            m_bitstreamSwitching = true;
-        }
-    }
-
-    node_set = node.find("mpd:BaseURL", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_baseURLs.push_back(BaseURL(*node));
-        }
-    }
-
-    node_set = node.find("mpd:SegmentBase", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentBase = SegmentBase(*node_set.front());
-    }
-
-    node_set = node.find("mpd:SegmentList", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentList = SegmentList(*node_set.front());
-    }
-
-    node_set = node.find("mpd:SegmentTemplate", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentTemplate = SegmentTemplate(*node_set.front());
-    }
-
-    node_set = node.find("mpd:AssetIdentifier", ns_map);
-    if (node_set.size() > 0) {
-        m_assetIdentifier = Descriptor(*node_set.front());
-    }
-
-    node_set = node.find("mpd:EventStream", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_eventStreams.push_back(EventStream(*node));
-        }
-    }
-
-    node_set = node.find("mpd:ServiceDescription", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_serviceDescriptions.push_back(ServiceDescription(*node));
-        }
-    }
-
-    node_set = node.find("mpd:ContentProtection", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_contentProtections.push_back(ContentProtection(*node));
-        }
-    }
-
-    node_set = node.find("mpd:AdaptationSet", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            AdaptationSet adapt_set(*node);
-            adapt_set.setPeriod(this);
-            m_adaptationSets.push_back(std::move(adapt_set));
-        }
-    }
-
-    node_set = node.find("mpd:Subset", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_subsets.push_back(Subset(*node));
-        }
-    }
-
-    node_set = node.find("mpd:SupplementalProperty", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_supplementalProperties.push_back(Descriptor(*node));
-        }
-    }
-
-    node_set = node.find("mpd:EmptyAdaptationSet", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            AdaptationSet adapt_set(*node);
-            adapt_set.setPeriod(this);
-            m_emptyAdaptationSets.push_back(std::move(adapt_set));
-        }
-    }
-
-    node_set = node.find("mpd:GroupLabel", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_groupLabels.push_back(Label(*node));
-        }
-    }
+    extractXMLAttributes(node.cobj());
+    extractXMLChildren(node);
+}
 
-    node_set = node.find("mpd:Preselection", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_preselections.push_back(Preselection(*node));
-        }
-    }
+Period::Period(const std::shared_ptr<UnparsedElement> &unparsed_element)
+    :m_mpd(nullptr)
+    ,m_previousSibling(nullptr)
+    ,m_nextSibling(nullptr)
+    ,m_xlink()
+    ,m_id()
+    ,m_start()
+    ,m_duration()
+    ,m_bitstreamSwitching(false)
+    ,m_baseURLs()
+    ,m_baseURLCache()
+    ,m_segmentBase()
+    ,m_segmentList()
+    ,m_segmentTemplate()
+    ,m_assetIdentifier()
+    ,m_eventStreams()
+    ,m_serviceDescriptions()
+    ,m_contentProtections()
+    ,m_adaptationSets()
+    ,m_subsets()
+    ,m_supplementalProperties()
+    ,m_emptyAdaptationSets()
+    ,m_groupLabels()
+    ,m_preselections()
+    ,m_cache(new Period::Cache)
+{
+    extractXMLAttributes(unparsed_element->node());
+    m_cache->unparsedChildren.store(unparsed_element);
+    m_cache->haveUnparsedChildren.store(static_cast<bool>(unparsed_element), std::memory_order_release);
 }
 
 static Glib::ustring get_ns_prefix_for(xmlpp::Element &elem, const Glib::ustring &namespace_uri, const Glib::ustring &namespace_prefix)
@@ -861,6 +821,7 @@ static Glib::ustring get_ns_prefix_for(xmlpp::Element &elem, const Glib::ustring
 
 void Period::setXMLElement(xmlpp::Element &elem) const
 {
+    materialise();
     if (m_xlink.has_value()) {
         // Period is referenced from another document
         const Glib::ustring& xlink_prefix = get_ns_prefix_for(elem, XLINK_NS, "xlink");
@@ -942,159 +903,15 @@ void Period::setXMLElement(xmlpp::Element &elem) const
     }
 }
 
-std::string Period::getMediaURL(const SegmentTemplate::Variables &vars) const
-{
-    if (m_segmentTemplate.has_value()) {
-        return m_segmentTemplate.value().formatMediaTemplate(vars);
-    }
-    if (m_segmentList.has_value()) {
-        if (vars.number()) {
-            return m_segmentList.value().getMediaURLForSegment(vars.number().value());
-        } else if (vars.time()) {
-            return m_segmentList.value().getMediaURLForSegmentTime(vars.time().value());
-        }
-    }
-    return std::string();
-}
-
-std::string Period::getInitializationURL(const SegmentTemplate::Variables &vars) const
-{
-    if (m_segmentTemplate.has_value()) {
-        return m_segmentTemplate.value().formatInitializationTemplate(vars);
-    }
-    if (m_segmentList.has_value()) {
-        return m_segmentList.value().getInitializationURL();
-    }
-    return std::string();
-}
-
-SegmentAvailability Period::getMediaAvailability(const SegmentTemplate::Variables &vars) const
-{
-    SegmentAvailability ret;
-    std::list<BaseURL> base_urls;
-
-    if (m_segmentTemplate.has_value()) {
-        base_urls = getBaseURLs();
-        unsigned int ts = 1;
-        if (m_segmentTemplate.value().hasTimescale()) {
-            ts = m_segmentTemplate.value().timescale().value();
-        }
-        if (base_urls.empty()) {
-            if (m_mpd && m_mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(m_mpd->availabilityStartTime().value() + vars.timeAsDurationType(ts));
-            }
-        } else {
-            const BaseURL &base_url = base_urls.front();
-            if (base_url.hasAvailabilityTimeOffset()) {
-                if (m_mpd && m_mpd->hasAvailabilityStartTime()) {
-                    if (std::isnan(base_url.availabilityTimeOffset().value())) {
-                        // All segments available at the MPD@availabilityStartTime
-                        ret.availabilityStartTime(m_mpd->availabilityStartTime().value());
-                    } else {
-                        // available at MPD@availabilityStartTime - @availabilityTimeOffset + segment_time
-                        ret.availabilityStartTime(m_mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1>>(base_url.availabilityTimeOffset().value())) + vars.timeAsDurationType(ts));
-                    }
-                }
-            } else if (m_mpd && m_mpd->hasAvailabilityStartTime()) {
-                // available at MPD@availabilityStartTime + segment_time
-                ret.availabilityStartTime(m_mpd->availabilityStartTime().value() + vars.timeAsDurationType(ts));
-            }
-        }
-        if (m_mpd) {
-            if (m_mpd->hasAvailabilityEndTime()) {
-                ret.availabilityEndTime(m_mpd->presentationTimeToSystemTime(m_mpd->availabilityEndTime().value()));
-            }
-            ret.availabilityStartTime(m_mpd->presentationTimeToSystemTime(ret.availabilityStartTime()));
-        }
-        if (m_segmentTemplate.value().hasDuration()) {
-            ret.segmentDuration(m_segmentTemplate.value().durationAsDurationType());
-            if (m_mpd && m_mpd->isLive()) {
-                ret.availabilityStartTime(ret.availabilityStartTime() + std::chrono::duration_cast<time_type::duration>(ret.segmentDuration()));
-            }
-        }
-        ret.segmentURL(URI(m_segmentTemplate.value().formatMediaTemplate(vars)).resolveUsingBaseURLs(base_urls));
-    } else if (m_segmentList.has_value()) {
-        base_urls = getBaseURLs();
-        if (base_urls.empty()) {
-            if (m_mpd && m_mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(m_mpd->availabilityStartTime().value());
-            }
-        } else {
-            const BaseURL &base_url = base_urls.front();
-            if (base_url.hasAvailabilityTimeOffset() && !std::isnan(base_url.availabilityTimeOffset().value())) {
-                if (m_mpd && m_mpd->hasAvailabilityStartTime()) {
-                    ret.availabilityStartTime(m_mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1>>(base_url.availabilityTimeOffset().value())));
-                }
-            } else if (m_mpd && m_mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(m_mpd->availabilityStartTime().value());
-            }
-        }
-        ret.segmentDuration(m_segmentList.value().durationAsDurationType());
-        if (m_mpd) {
-            if (m_mpd->hasAvailabilityEndTime()) {
-                ret.availabilityEndTime(m_mpd->presentationTimeToSystemTime(m_mpd->availabilityEndTime().value()));
-            }
-            ret.availabilityStartTime(m_mpd->presentationTimeToSystemTime(ret.availabilityStartTime()));
-            if (m_mpd->isLive()) {
-                ret.availabilityStartTime(ret.availabilityStartTime() + std::chrono::duration_cast<time_type::duration>(ret.segmentDuration()));
-            }
-        }
-
-        if (vars.number()) {
-            ret.segmentURL(URI(m_segmentList.value().getMediaURLForSegment(vars.number().value())).resolveUsingBaseURLs(base_urls));
-        } else if (vars.time()) {
-            ret.segmentURL(URI(m_segmentList.value().getMediaURLForSegmentTime(vars.time().value())).resolveUsingBaseURLs(base_urls));
-        }
-    }
-
-    return ret;
-}
-
-SegmentAvailability Period::getInitialisationAvailability(const SegmentTemplate::Variables &vars) const
-{
-    SegmentAvailability ret;
-    std::list<BaseURL> base_urls;
-
-    if (m_segmentTemplate.has_value()) {
-        base_urls = getBaseURLs();
-        ret.segmentURL(URI(m_segmentTemplate.value().formatInitializationTemplate(vars)).resolveUsingBaseURLs(base_urls));
-    } else if (m_segmentList.has_value()) {
-        base_urls = getBaseURLs();
-        ret.segmentURL(URI(m_segmentList.value().getInitializationURL()).resolveUsingBaseURLs(base_urls));
-    }
-
-    if (!base_urls.empty()) {
-        const BaseURL &base_url = base_urls.front();
-        const MPD *mpd = getMPD();
-        if (base_url.hasAvailabilityTimeOffset()) {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->presentationTimeToSystemTime(mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1> >(base_url.availabilityTimeOffset().value()))));
-            }
-        } else {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->presentationTimeToSystemTime(mpd->availabilityStartTime().value()));
-            } else {
-                ret.availabilityStartTime(std::chrono::system_clock::now());
-            }
-        }
-    } else {
-        ret.availabilityStartTime(std::chrono::system_clock::now());
-    }
-
-    return ret;
-}
-
 Period::time_type Period::getPeriodStartTime() const
 {
     auto mpd = getMPD();
     if (!mpd) return time_type();
     if (!mpd->hasAvailabilityStartTime()) return time_type();
 
-    // cache calculated start time if we don't have it already
-    if (!m_cache->calcStart) cacheCalcTimes();
-
-    if (m_cache->calcStart) {
-        return mpd->availabilityStartTime().value() + m_cache->calcStart.value();
+    const auto &calc_start = calcStart();
+    if (calc_start) {
+        return mpd->availabilityStartTime().value() + calc_start.value();
     }
 
     return mpd->availabilityStartTime().value();
@@ -1102,138 +919,149 @@ Period::time_type Period::getPeriodStartTime() const
 
 std::optional<Period::duration_type> Period::getPeriodDuration() const
 {
-    // Try to cache calculated duration if we don't have one
-    if (!m_cache->calcDuration) cacheCalcTimes();
-
-    return m_cache->calcDuration;
-}
-
-const MultipleSegmentBase &Period::getMultiSegmentBase() const
-{
-    if (m_segmentTemplate) return m_segmentTemplate.value();
-    if (m_segmentList) return m_segmentTemplate.value();
-    if (m_segmentBase) {
-        static MultipleSegmentBase multi_no_duration;
-        SegmentBase &seg_base = multi_no_duration;
-        seg_base = m_segmentBase.value(); // copy over SegmentBase values to get timescale
-        return multi_no_duration;
-    }
-
-    static const MultipleSegmentBase empty_multi;
-    return empty_multi;
+    return calcDuration();
 }
 
 // private:
 
-void Period::cacheCalcTimes() const
+void Period::extractXMLAttributes(const xmlNode *node)
 {
-    bool changed = false;
-
-    // Set or reset our cache values for start and duration
-    if (m_start && m_cache->calcStart != m_start) {
-        m_cache->calcStart = m_start;
-        changed = true;
-    }
-    if (!m_start && m_cache->calcStart) {
-        m_cache->calcStart.reset();
-        changed = true;
-    }
-    if (m_duration && m_cache->calcDuration != m_duration) {
-        m_cache->calcDuration = m_duration;
-        changed = true;
-    }
-    if (!m_duration && m_cache->calcDuration) {
-        m_cache->calcDuration.reset();
-        changed = true;
-    }
-
-    // go backward through siblings setting cache to local values
-    for (Period *it = m_previousSibling; it; it = it->m_previousSibling) {
-        if (it->m_start && it->m_cache->calcStart != it->m_start) {
-            it->m_cache->calcStart = it->m_start;
-            changed = true;
-        }
-        if (!it->m_start && it->m_cache->calcStart) {
-            it->m_cache->calcStart.reset();
-            changed = true;
-        }
-        if (it->m_duration && it->m_cache->calcDuration != it->m_duration) {
-            it->m_cache->calcDuration = it->m_duration;
-            changed = true;
-        }
-        if (!it->m_duration && it->m_cache->calcDuration) {
-            it->m_cache->calcDuration.reset();
-            changed = true;
-        }
-    }
-
-    // go forward through siblings setting cache to local values
-    for (Period *it = m_nextSibling; it; it = it->m_nextSibling) {
-        if (it->m_start && it->m_cache->calcStart != it->m_start) {
-            it->m_cache->calcStart = it->m_start;
-            changed = true;
-        }
-        if (!it->m_start && it->m_cache->calcStart) {
-            it->m_cache->calcStart.reset();
-            changed = true;
-        }
-        if (it->m_duration && it->m_cache->calcDuration != it->m_duration) {
-            it->m_cache->calcDuration = it->m_duration;
-            changed = true;
-        }
-        if (!it->m_duration && it->m_cache->calcDuration) {
-            it->m_cache->calcDuration.reset();
-            changed = true;
+    const xmlAttr *xlink_href_attr = xmlHasNsProp(node, reinterpret_cast<const xmlChar*>("href"),
+                                                  reinterpret_cast<const xmlChar*>(XLINK_NS));
+    if (xlink_href_attr) {
+        std::string xlink_href = xml_attribute_value(xlink_href_attr);
+        auto actuate = XLink::ACTUATE_ON_REQUEST;
+        const xmlAttr *xlink_actuate_attr = xmlHasNsProp(node, reinterpret_cast<const xmlChar*>("actuate"),
+                                                         reinterpret_cast<const xmlChar*>(XLINK_NS));
+        if (xlink_actuate_attr) {
+            std::string xlink_actuate = xml_attribute_value(xlink_actuate_attr);
+            if (xlink_actuate == "onLoad") actuate = XLink::ACTUATE_ON_LOAD;
+            else if (xlink_actuate != "onRequest") throw ParseError("Period/@xlink:actuate can only be either \"onLoad\" or \"onRequest\"");
         }
+        m_xlink = XLink(xlink_href, actuate, XLink::TYPE_SIMPLE, XLink::SHOW_EMBED);
     }
 
-    while (changed) {
-        changed = false;
-
-        // go backward through siblings setting relative cache values
-        for (const Period *it = this; it; it = it->m_previousSibling) {
-            if (!it->m_cache->calcStart && it->m_previousSibling && it->m_previousSibling->m_cache->calcStart && it->m_previousSibling->m_cache->calcDuration) {
-                // this start = prev start + prev duration
-                it->m_cache->calcStart = it->m_previousSibling->m_cache->calcStart.value() + it->m_previousSibling->m_cache->calcDuration.value();
-                changed = true;
-            }
-            if (!it->m_cache->calcStart && it->m_cache->calcDuration && it->m_nextSibling  && it->m_nextSibling->m_cache->calcStart) {
-                // this start = next start - this duration
-                it->m_cache->calcStart = it->m_nextSibling->m_cache->calcStart.value() - it->m_cache->calcDuration.value();
-                changed = true;
-            }
-            if (!it->m_cache->calcDuration && it->m_cache->calcStart && it->m_nextSibling && it->m_nextSibling->m_cache->calcStart) {
-                // this duration = next start - this start
-                it->m_cache->calcDuration = it->m_nextSibling->m_cache->calcStart.value() - it->m_cache->calcStart.value();
-                changed = true;
-            }
-        }
-
-        // go forward through siblings setting relative cache values
-        for (Period *it = m_nextSibling; it; it = it->m_previousSibling) {
-            if (!it->m_cache->calcStart && it->m_previousSibling && it->m_previousSibling->m_cache->calcStart && it->m_previousSibling->m_cache->calcDuration) {
-                // this start = prev start + prev duration
-                it->m_cache->calcStart = it->m_previousSibling->m_cache->calcStart.value() + it->m_previousSibling->m_cache->calcDuration.value();
-                changed = true;
-            }
-            if (!it->m_cache->calcStart && it->m_cache->calcDuration && it->m_nextSibling  && it->m_nextSibling->m_cache->calcStart) {
-                // this start = next start - this duration
-                it->m_cache->calcStart = it->m_nextSibling->m_cache->calcStart.value() - it->m_cache->calcDuration.value();
-                changed = true;
-            }
-            if (!it->m_cache->calcDuration && it->m_cache->calcStart && it->m_nextSibling && it->m_nextSibling->m_cache->calcStart) {
-                // this duration = next start - this start
-                it->m_cache->calcDuration = it->m_nextSibling->m_cache->calcStart.value() - it->m_cache->calcStart.value();
-                changed = true;
-            }
-        }
-    }
+    static const AttributeTable<Period> attribute_table("Period", {
+        {"id", [](Period &period, const std::string &val) { period.m_id = val; }},
+        {"start", [](Period &period, const std::string &val) { period.m_start = str_to_duration<Period::duration_type>(val); }},
+        {"duration", [](Period &period, const std::string &val) { period.m_duration = str_to_duration<Period::duration_type>(val); }},
+        {"bitstreamSwitching", [](Period &period, const std::string &val) { if (val == "true") period.m_bitstreamSwitching = true; }}
+    });
+
+    attribute_table.apply(*this, node);
+}
+
+void Period::extractXMLChildren(xmlpp::Node &node)
+{
+#define CHILD_LIST(name, var, cls) {#name, [](Period &period, xmlpp::Node &child) { period.var.push_back(cls(child)); }}
+#define CHILD_FIRST(name, var, cls) {#name, [](Period &period, xmlpp::Node &child) { if (!period.var) period.var = cls(child); }}
+#define CHILD_ADAPTATION_SET(name, var) {#name, [](Period &period, xmlpp::Node &child) { \
+            if (ParseFilterScope::skipsAdaptationSet(child.cobj())) return; \
+            AdaptationSet adapt_set(child); \
+            adapt_set.setPeriod(&period); \
+            period.var.push_back(std::move(adapt_set)); \
+        }}
+
+    static const ElementTable<Period> element_table({
+        CHILD_LIST(BaseURL, m_baseURLs, BaseURL),
+        CHILD_FIRST(SegmentBase, m_segmentBase, SegmentBase),
+        CHILD_FIRST(SegmentList, m_segmentList, SegmentList),
+        CHILD_FIRST(SegmentTemplate, m_segmentTemplate, SegmentTemplate),
+        CHILD_FIRST(AssetIdentifier, m_assetIdentifier, Descriptor),
+        CHILD_LIST(EventStream, m_eventStreams, EventStream),
+        CHILD_LIST(ServiceDescription, m_serviceDescriptions, ServiceDescription),
+        CHILD_LIST(ContentProtection, m_contentProtections, ContentProtection),
+        CHILD_ADAPTATION_SET(AdaptationSet, m_adaptationSets),
+        CHILD_LIST(Subset, m_subsets, Subset),
+        CHILD_LIST(SupplementalProperty, m_supplementalProperties, Descriptor),
+        CHILD_ADAPTATION_SET(EmptyAdaptationSet, m_emptyAdaptationSets),
+        CHILD_LIST(GroupLabel, m_groupLabels, Label),
+        CHILD_LIST(Preselection, m_preselections, Preselection)
+    });
+
+#undef CHILD_ADAPTATION_SET
+#undef CHILD_FIRST
+#undef CHILD_LIST
+
+    element_table.apply(*this, node);
+}
+
+void Period::materialiseChildren() const
+{
+    std::shared_ptr<UnparsedElement> unparsed(m_cache->unparsedChildren.load());
+    if (!unparsed) return;
+    std::lock_guard<std::mutex> lock(unparsed->document().mutex());
+    if (!m_cache->haveUnparsedChildren.load(std::memory_order_acquire)) return;
+
+    // Parse into a temporary so that this Period is left untouched if the child elements fail to parse
+    MemoryResourceScope scope(m_mpd?m_mpd->m_memoryResource:nullptr);
+    ParseFilterScope filter_scope(m_mpd?m_mpd->m_parseFilter.get():nullptr);
+    Period parsed;
+    xmlNodePtr node = unparsed->node();
+    xmlpp::Node::create_wrapper(node);
+    try {
+        parsed.extractXMLChildren(*static_cast<xmlpp::Node*>(node->_private));
+    } catch (...) {
+        xmlpp::Node::free_wrappers(node);
+        throw;
+    }
+    xmlpp::Node::free_wrappers(node);
+    if (m_mpd && m_mpd->m_stringPool) m_mpd->m_stringPool->intern(parsed);
+
+    // Only the child elements were unparsed, so filling them in does not change the value of this Period
+    Period &self = const_cast<Period&>(*this);
+    self.m_baseURLs = std::move(parsed.m_baseURLs);
+    invalidateBaseURLs();
+    self.m_segmentBase = std::move(parsed.m_segmentBase);
+    self.m_segmentList = std::move(parsed.m_segmentList);
+    self.m_segmentTemplate = std::move(parsed.m_segmentTemplate);
+    self.m_assetIdentifier = std::move(parsed.m_assetIdentifier);
+    self.m_eventStreams = std::move(parsed.m_eventStreams);
+    self.m_serviceDescriptions = std::move(parsed.m_serviceDescriptions);
+    self.m_contentProtections = std::move(parsed.m_contentProtections);
+    self.m_adaptationSets = std::move(parsed.m_adaptationSets);
+    self.m_subsets = std::move(parsed.m_subsets);
+    self.m_supplementalProperties = std::move(parsed.m_supplementalProperties);
+    self.m_emptyAdaptationSets = std::move(parsed.m_emptyAdaptationSets);
+    self.m_groupLabels = std::move(parsed.m_groupLabels);
+    self.m_preselections = std::move(parsed.m_preselections);
+    for (auto &adapt_set : self.m_adaptationSets) {
+        adapt_set.setPeriod(&self);
+    }
+    for (auto &adapt_set : self.m_emptyAdaptationSets) {
+        adapt_set.setPeriod(&self);
+    }
+    m_cache->unparsedChildren.store(nullptr);
+    m_cache->haveUnparsedChildren.store(false, std::memory_order_release);
+}
+
+bool Period::cacheCalcTimes() const
+{
+    // The times for all Periods in an MPD are calculated together by the MPD
+    if (!m_mpd) return false;
+    m_mpd->cachePeriodTimes();
+
+    // A copy of a Period that is not in the MPD Period list may not have calculated times, in which case only the local values
+    // can be used. Nothing is written here so that this is safe to call from several threads.
+    return m_cache->calcTimesValid;
 }
 
 void Period::cacheCalcClear() const
 {
+    m_cache->calcTimesValid = false;
     m_cache->calcStart.reset();
     m_cache->calcDuration.reset();
+    if (m_mpd) m_mpd->cachePeriodTimesClear();
+}
+
+void Period::invalidateBaseURLs() const
+{
+    MPD::baseURLGeneration(m_mpd).invalidate();
+}
+
+void Period::invalidateAddressing() const
+{
+    MPD::addressingGeneration(m_mpd).invalidate();
 }
 
 LIBMPDPP_NAMESPACE_END
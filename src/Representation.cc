@@ -13,6 +13,7 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 
 #include <libxml++/libxml++.h>
@@ -36,6 +37,8 @@
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "DecomposedURL.hh"
+#include "parse_tables.hh"
 #include "stream_ops.hh"
 
 #include "libmpd++/Representation.hh"
@@ -53,11 +56,14 @@ Representation::Representation()
     ,m_associationTypes()
     ,m_mediaStreamStructureIds()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_extendedBandwidths()
     ,m_subRepresentations()
     ,m_segmentBase()
     ,m_segmentList()
     ,m_segmentTemplate()
+    ,m_addressing()
+    ,m_addressingMutex()
 {
 }
 
@@ -72,9 +78,12 @@ Representation::Representation(const Representation &to_copy)
     ,m_associationTypes(to_copy.m_associationTypes)
     ,m_mediaStreamStructureIds(to_copy.m_mediaStreamStructureIds)
     ,m_baseURLs(to_copy.m_baseURLs)
+    ,m_baseURLCache()
     ,m_segmentBase(to_copy.m_segmentBase)
     ,m_segmentList(to_copy.m_segmentList)
     ,m_segmentTemplate(to_copy.m_segmentTemplate)
+    ,m_addressing()
+    ,m_addressingMutex()
 {
 }
 
@@ -89,9 +98,12 @@ Representation::Representation(Representation &&to_move)
     ,m_associationTypes(to_move.m_associationTypes)
     ,m_mediaStreamStructureIds(to_move.m_mediaStreamStructureIds)
     ,m_baseURLs(std::move(to_move.m_baseURLs))
+    ,m_baseURLCache()
     ,m_segmentBase(std::move(to_move.m_segmentBase))
     ,m_segmentList(std::move(to_move.m_segmentList))
     ,m_segmentTemplate(std::move(to_move.m_segmentTemplate))
+    ,m_addressing()
+    ,m_addressingMutex()
 {
 }
 
@@ -107,9 +119,11 @@ Representation &Representation::operator=(const Representation &to_copy)
     m_associationTypes = to_copy.m_associationTypes;
     m_mediaStreamStructureIds = to_copy.m_mediaStreamStructureIds;
     m_baseURLs = to_copy.m_baseURLs;
+    invalidateBaseURLs();
     m_segmentBase = to_copy.m_segmentBase;
     m_segmentList = to_copy.m_segmentList;
     m_segmentTemplate = to_copy.m_segmentTemplate;
+    m_addressing.store(nullptr);
 
     return *this;
 }
@@ -126,11 +140,13 @@ Representation &Representation::operator=(Representation &&to_move)
     m_associationTypes = std::move(to_move.m_associationTypes);
     m_mediaStreamStructureIds = std::move(to_move.m_mediaStreamStructureIds);
     m_baseURLs = std::move(to_move.m_baseURLs);
+    invalidateBaseURLs();
     m_extendedBandwidths = std::move(to_move.m_extendedBandwidths);
     m_subRepresentations = std::move(to_move.m_subRepresentations);
     m_segmentBase = std::move(to_move.m_segmentBase);
     m_segmentList = std::move(to_move.m_segmentList);
     m_segmentTemplate = std::move(to_move.m_segmentTemplate);
+    m_addressing.store(nullptr);
 
     return *this;
 }
@@ -159,6 +175,12 @@ bool Representation::operator==(const Representation &to_compare) const
     COMPARE_ANY_ORDER_LISTS(m_associationIds);
     COMPARE_ANY_ORDER_LISTS(m_associationTypes);
     COMPARE_ANY_ORDER_LISTS(m_mediaStreamStructureIds);
+    COMPARE_OPT_VALUES(m_segmentBase);
+    COMPARE_OPT_VALUES(m_segmentList);
+    COMPARE_OPT_VALUES(m_segmentTemplate);
+    COMPARE_ANY_ORDER_LISTS(m_baseURLs);
+    COMPARE_ANY_ORDER_LISTS(m_extendedBandwidths);
+    COMPARE_ANY_ORDER_LISTS(m_subRepresentations);
 
     return RepresentationBase::operator==(to_compare);
 }
@@ -186,72 +208,62 @@ const Period *Representation::getPeriod() const
     return nullptr;
 }
 
+namespace {
+    // The availabilityTimeOffset for segments is the sum of the values from the segment information and the BaseURL
+    std::optional<double> availability_time_offset(const SegmentBase &seg_base, const std::list<BaseURL> &base_urls)
+    {
+        std::optional<double> ret(seg_base.availabilityTimeOffset());
+        if (!base_urls.empty() && base_urls.front().hasAvailabilityTimeOffset()) {
+            ret = ret.value_or(0.0) + base_urls.front().availabilityTimeOffset().value();
+        }
+        return ret;
+    }
+}
+
 URI Representation::getMediaURL(unsigned long segment_number) const
 {
-    if (m_segmentTemplate.has_value()) {
-        return URI(m_segmentTemplate.value().formatMediaTemplate(getTemplateVars(segment_number))).resolveUsingBaseURLs(getBaseURLs());
+    auto addressing = getAddressing();
+    if (addressing->segmentTemplate) {
+        return URI(addressing->segmentTemplate->formatMediaTemplate(getTemplateVars(*addressing, segment_number))).resolveUsingBaseURLs(getBaseURLs());
     }
-    if (m_segmentList.has_value()) {
-        return URI(m_segmentList.value().getMediaURLForSegment(segment_number)).resolveUsingBaseURLs(getBaseURLs());
-    }
-    if (m_adaptationSet) {
-        return URI(m_adaptationSet->getMediaURL(getTemplateVars(segment_number))).resolveUsingBaseURLs(m_adaptationSet->getBaseURLs());
+    if (addressing->segmentList) {
+        return URI(addressing->segmentList->getMediaURLForSegment(segment_number)).resolveUsingBaseURLs(getBaseURLs());
     }
     return URI();
 }
 
 URI Representation::getMediaURL(time_type segment_time) const
 {
-    if (m_segmentTemplate.has_value()) {
-        return URI(m_segmentTemplate.value().formatMediaTemplate(getTemplateVars(segment_time))).resolveUsingBaseURLs(getBaseURLs());
-    }
-    if (m_segmentList.has_value()) {
-        // TODO: convert @a segment_time to a time offset for this presentation in the time base provided
-        return URI(m_segmentList.value().getMediaURLForSegmentTime(0 /*segment_time*/)).resolveUsingBaseURLs(getBaseURLs());
-    }
-    if (m_adaptationSet) {
-        return URI(m_adaptationSet->getMediaURL(getTemplateVars(segment_time))).resolveUsingBaseURLs(m_adaptationSet->getBaseURLs());
-    }
-    return URI();
+    return getMediaURL(getSegmentNumber(*getAddressing(), segment_time));
 }
 
 URI Representation::getInitializationURL() const
 {
-    if (m_segmentTemplate.has_value()) {
-        return URI(m_segmentTemplate.value().formatInitializationTemplate(getTemplateVars())).resolveUsingBaseURLs(getBaseURLs());
+    auto addressing = getAddressing();
+    if (addressing->segmentTemplate) {
+        return URI(addressing->segmentTemplate->formatInitializationTemplate(getTemplateVars())).resolveUsingBaseURLs(getBaseURLs());
     }
-    if (m_segmentList.has_value()) {
-        return URI(m_segmentList.value().getInitializationURL()).resolveUsingBaseURLs(getBaseURLs());
-    }
-    if (m_adaptationSet) {
-        return URI(m_adaptationSet->getInitializationURL(getTemplateVars())).resolveUsingBaseURLs(m_adaptationSet->getBaseURLs());
+    if (addressing->segmentList) {
+        return URI(addressing->segmentList->getInitializationURL()).resolveUsingBaseURLs(getBaseURLs());
     }
     return URI();
 }
 
-std::list<BaseURL> Representation::getBaseURLs() const
+const std::list<BaseURL> &Representation::getBaseURLs() const
 {
     if (m_baseURLs.size() == 0 && m_adaptationSet) return m_adaptationSet->getBaseURLs();
 
-    std::list<BaseURL> ret;
-    std::list<BaseURL> parent_urls_cache;
-    bool have_parent_urls = false;
-    for (const auto &base_url : m_baseURLs) {
-        if (base_url.url().isAbsoluteURL()) {
-            ret.push_back(base_url);
-        } else {
-            if (m_adaptationSet) {
-                if (!have_parent_urls) {
-                    parent_urls_cache = m_adaptationSet->getBaseURLs();
-                    have_parent_urls = true;
-                }
-                ret.push_back(base_url.resolveURL(parent_urls_cache));
-            } else {
+    return m_baseURLCache.get(MPD::baseURLGeneration(getMPD()), [this]() {
+        std::list<BaseURL> ret;
+        for (const auto &base_url : m_baseURLs) {
+            if (base_url.url().isAbsoluteURL() || !m_adaptationSet) {
                 ret.push_back(base_url);
+            } else {
+                ret.push_back(base_url.resolveURL(m_adaptationSet->getBaseURLs()));
             }
         }
-    }
-    return ret;
+        return ret;
+    });
 }
 
 bool Representation::isSelected() const
@@ -262,137 +274,68 @@ bool Representation::isSelected() const
 
 SegmentAvailability Representation::segmentAvailability(const time_type &query_time) const
 {
-    SegmentAvailability ret;
-    std::list<BaseURL> base_urls;
+    auto addressing = getAddressing();
+    const MultipleSegmentBase &multi_base = *addressing->multiSegmentBase;
 
     time_type pres_time = query_time;
     const MPD *mpd = getMPD();
     if (mpd) {
         pres_time = mpd->systemTimeToPresentationTime(query_time);
-        const auto &multi_base = getMultiSegmentBase();
         if (!mpd->isLive() && multi_base.hasDuration()) {
             // we want the next available, not the current segment for non-live
             pres_time += std::chrono::duration_cast<time_type::duration>(multi_base.durationAsDurationType());
         }
     }
 
-    if (m_segmentTemplate) {
-        base_urls = getBaseURLs();
-        auto vars = getTemplateVars(pres_time);
-        unsigned int ts = 1;
-        if (m_segmentTemplate.value().hasTimescale()) {
-            ts = m_segmentTemplate.value().timescale().value();
-        }
-        if (base_urls.empty()) {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->availabilityStartTime().value() + vars.timeAsDurationType(ts));
-            }
-        } else {
-            const BaseURL &base_url = base_urls.front();
-            if (base_url.hasAvailabilityTimeOffset()) {
-                if (mpd && mpd->hasAvailabilityStartTime()) {
-                    if (std::isnan(base_url.availabilityTimeOffset().value())) {
-                        // All segments available at the MPD@availabilityStartTime
-                        ret.availabilityStartTime(mpd->availabilityStartTime().value());
-                    } else {
-                        // available at MPD@availabilityStartTime - @availabilityTimeOffset + segment_time
-                        ret.availabilityStartTime(mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1>>(base_url.availabilityTimeOffset().value())) + vars.timeAsDurationType(ts));
-                    }
-                }
-            } else if (mpd && mpd->hasAvailabilityStartTime()) {
-                // available at MPD@availabilityStartTime + segment_time
-                ret.availabilityStartTime(mpd->availabilityStartTime().value() + vars.timeAsDurationType(ts));
-            }
-        }
-        if (mpd) {
-            if (mpd->hasAvailabilityEndTime()) {
-                ret.availabilityEndTime(mpd->presentationTimeToSystemTime(mpd->availabilityEndTime().value()));
-            }
-            ret.availabilityStartTime(mpd->presentationTimeToSystemTime(ret.availabilityStartTime()));
-        }
-        if (m_segmentTemplate.value().hasDuration()) {
-            ret.segmentDuration(m_segmentTemplate.value().durationAsDurationType());
-            if (mpd && mpd->isLive()) {
-                // Availability is at the end of segments for live
-                ret.availabilityStartTime(ret.availabilityStartTime() + std::chrono::duration_cast<time_type::duration>(ret.segmentDuration()));
-            }
-        }
-        ret.segmentURL(URI(m_segmentTemplate.value().formatMediaTemplate(vars)).resolveUsingBaseURLs(base_urls));
-    } else if (m_segmentList.has_value()) {
-        const Period *period = getPeriod();
-        base_urls = getBaseURLs();
-        duration_type pres_offset;
-        if (!period) {
-            // Assume a period start of 0 and availabilityStartTime of 0 - best we can do without any other information
-            pres_offset = std::chrono::duration_cast<duration_type>(pres_time.time_since_epoch());
-        } else {
-            if (base_urls.empty()) {
-                if (mpd && mpd->hasAvailabilityStartTime()) {
-                    ret.availabilityStartTime(mpd->availabilityStartTime().value());
-                }
-            } else {
-                const BaseURL &base_url = base_urls.front();
-                if (base_url.hasAvailabilityTimeOffset() && !std::isnan(base_url.availabilityTimeOffset().value())) {
-                    if (mpd && mpd->hasAvailabilityStartTime()) {
-                        ret.availabilityStartTime(mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1>>(base_url.availabilityTimeOffset().value())));
-                    }
-                } else if (mpd && mpd->hasAvailabilityStartTime()) {
-                    ret.availabilityStartTime(mpd->availabilityStartTime().value());
-                }
-            }
-            if (mpd) {
-                ret.availabilityEndTime(mpd->availabilityEndTime());
-            }
-            pres_offset = std::chrono::duration_cast<duration_type>(pres_time - ret.availabilityStartTime()) - period->calcStart().value();
-        }
-        ret.segmentDuration(m_segmentList.value().durationAsDurationType());
-        if (mpd) {
-            if (ret.hasAvailabilityEndTime()) {
-                ret.availabilityEndTime(mpd->presentationTimeToSystemTime(ret.availabilityEndTime().value()));
-            }
-            ret.availabilityStartTime(mpd->presentationTimeToSystemTime(ret.availabilityStartTime()));
-            if (mpd->isLive()) {
-                ret.availabilityStartTime(ret.availabilityStartTime() + std::chrono::duration_cast<time_type::duration>(ret.segmentDuration()));
-            }
-        }
-        ret.segmentURL(URI(m_segmentList.value().getMediaURLForSegmentTime(pres_offset)).resolveUsingBaseURLs(base_urls));
-    } else if (m_adaptationSet) {
-        ret = m_adaptationSet->getMediaAvailability(getTemplateVars(pres_time));
+    auto segments = segmentAvailabilities(*addressing, getSegmentNumber(*addressing, pres_time), 1);
+    if (segments.empty()) return SegmentAvailability();
+    return std::move(segments.front());
+}
+
+std::list<SegmentAvailability> Representation::segmentAvailabilities(unsigned long first_segment, unsigned long count) const
+{
+    return segmentAvailabilities(*getAddressing(), first_segment, count);
+}
+
+std::list<SegmentAvailability> Representation::segmentAvailabilities(const time_type &start_time, const time_type &end_time) const
+{
+    auto addressing = getAddressing();
+    if ((!addressing->segmentTemplate && !addressing->segmentList) || end_time <= start_time) {
+        return std::list<SegmentAvailability>();
     }
 
-    return ret;
+    auto period_start = getPeriodStartTime();
+    if (end_time <= period_start) return std::list<SegmentAvailability>();
+    unsigned long first_segment = getSegmentNumber(*addressing, start_time);
+    // The last segment is the one containing the last microsecond before end_time
+    unsigned long last_segment = addressing->multiSegmentBase->durationTypeToSegmentNumber(
+                                        std::chrono::duration_cast<duration_type>(end_time - period_start) - duration_type(1));
+    if (last_segment < first_segment) return std::list<SegmentAvailability>();
+
+    return segmentAvailabilities(*addressing, first_segment, last_segment - first_segment + 1);
 }
 
 SegmentAvailability Representation::initialisationSegmentAvailability() const
 {
     SegmentAvailability ret;
-    std::list<BaseURL> base_urls;
+    auto addressing = getAddressing();
+    const std::list<BaseURL> &base_urls = getBaseURLs();
 
-    if (m_segmentTemplate.has_value()) {
-        base_urls = getBaseURLs();
-        ret.segmentURL(URI(m_segmentTemplate.value().formatInitializationTemplate(getTemplateVars())).resolveUsingBaseURLs(base_urls));
-    } else if (m_segmentList.has_value()) {
-        base_urls = getBaseURLs();
-        ret.segmentURL(URI(m_segmentList.value().getInitializationURL()).resolveUsingBaseURLs(base_urls));
-    } else if (m_adaptationSet) {
-        ret = m_adaptationSet->getInitialisationAvailability(getTemplateVars());
-        return ret;
+    if (addressing->segmentTemplate) {
+        ret.segmentURL(URI(addressing->segmentTemplate->formatInitializationTemplate(getTemplateVars())).resolveUsingBaseURLs(base_urls));
+    } else if (addressing->segmentList) {
+        ret.segmentURL(URI(addressing->segmentList->getInitializationURL()).resolveUsingBaseURLs(base_urls));
     }
 
-    if (!base_urls.empty()) {
-        const BaseURL &base_url = base_urls.front();
-        const MPD *mpd = getMPD();
-        if (base_url.hasAvailabilityTimeOffset()) {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->presentationTimeToSystemTime(mpd->availabilityStartTime().value() - std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1> >(base_url.availabilityTimeOffset().value()))));
-            }
-        } else {
-            if (mpd && mpd->hasAvailabilityStartTime()) {
-                ret.availabilityStartTime(mpd->presentationTimeToSystemTime(mpd->availabilityStartTime().value()));
-            } else {
-                ret.availabilityStartTime(std::chrono::system_clock::now());
-            }
+    const MPD *mpd = getMPD();
+    if (mpd && mpd->hasAvailabilityStartTime()) {
+        // available at the MPD@availabilityStartTime - @availabilityTimeOffset
+        time_type start_time = mpd->availabilityStartTime().value();
+        auto ato = availability_time_offset(*addressing->multiSegmentBase, base_urls);
+        if (ato && std::isfinite(ato.value())) {
+            start_time -= std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1> >(ato.value()));
         }
+        ret.availabilityStartTime(mpd->presentationTimeToSystemTime(start_time));
     } else {
         ret.availabilityStartTime(std::chrono::system_clock::now());
     }
@@ -428,103 +371,44 @@ Representation::Representation(xmlpp::Node &node)
     ,m_associationTypes()
     ,m_mediaStreamStructureIds()
     ,m_baseURLs()
+    ,m_baseURLCache()
     ,m_extendedBandwidths()
     ,m_subRepresentations()
     ,m_segmentBase()
     ,m_segmentList()
     ,m_segmentTemplate()
+    ,m_addressing()
+    ,m_addressingMutex()
 {
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}, {"xlink", XLINK_NS}
-    };
-    xmlpp::Node::NodeSet node_set;
-
-    node_set = node.find("@id");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_id = std::string(attr->get_value());
-    }
-
-    node_set = node.find("@bandwidth");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_bandwidth = std::stod(attr->get_value());
-    }
-
-    node_set = node.find("@qualityRanking");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_qualityRanking = std::stoi(attr->get_value());
-    }
-
-    node_set = node.find("@dependencyId");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_dependencyIds.push_back(std::string(attr->get_value()));
-    }
-
-    node_set = node.find("@id");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_id = std::string(attr->get_value());
-    }
-
-
-    node_set = node.find("@associationId");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_associationIds = split_attribute_str<std::string>(attr->get_value());
-    }
-
-    node_set = node.find("@associationType");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_associationTypes = split_attribute_str<std::string>(attr->get_value());
-
-    }
-
-    node_set = node.find("@mediaStreamStructureId");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_mediaStreamStructureIds = split_attribute_str<std::string>(attr->get_value());
-    }
-
-    node_set = node.find("mpd:BaseURL", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_baseURLs.push_back(BaseURL(*node));
-        }
-    }
-
-    node_set = node.find("mpd:ExtendedBandwidth", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_extendedBandwidths.push_back(ExtendedBandwidth(*node));
-        }
-    }
-
-    node_set = node.find("mpd:subRepresentation", ns_map);
-    if (node_set.size() > 0) {
-        for (auto node : node_set) {
-            m_subRepresentations.push_back(SubRepresentation(*node));
-        }
-    }
-
-    node_set = node.find("mpd:SegmentBase", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentBase = SegmentBase(*node_set.front());
-    }
-
-    node_set = node.find("mpd:SegmentList", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentList = SegmentList(*node_set.front());
-    }
-
-    node_set = node.find("mpd:SegmentTemplate", ns_map);
-    if (node_set.size() > 0) {
-        m_segmentTemplate = SegmentTemplate(*node_set.front());
-    }
-
+#define ATTR_FN(name, var, fn) {#name, [](Representation &rep, const std::string &val) { rep.var = fn(val); }}
+#define CHILD_LIST(name, var, cls) {#name, [](Representation &rep, xmlpp::Node &child) { rep.var.push_back(cls(child)); }}
+#define CHILD_FIRST(name, var, cls) {#name, [](Representation &rep, xmlpp::Node &child) { if (!rep.var) rep.var = cls(child); }}
+
+    static const AttributeTable<Representation> attribute_table("Representation", {
+        ATTR_FN(id, m_id, std::string),
+        ATTR_FN(bandwidth, m_bandwidth, std::stod),
+        ATTR_FN(qualityRanking, m_qualityRanking, std::stoi),
+        {"dependencyId", [](Representation &rep, const std::string &val) { rep.m_dependencyIds.push_back(val); }},
+        ATTR_FN(associationId, m_associationIds, split_attribute_str<std::string>),
+        ATTR_FN(associationType, m_associationTypes, split_attribute_str<std::string>),
+        ATTR_FN(mediaStreamStructureId, m_mediaStreamStructureIds, split_attribute_str<std::string>)
+    });
+
+    static const ElementTable<Representation> element_table({
+        CHILD_LIST(BaseURL, m_baseURLs, BaseURL),
+        CHILD_LIST(ExtendedBandwidth, m_extendedBandwidths, ExtendedBandwidth),
+        CHILD_LIST(SubRepresentation, m_subRepresentations, SubRepresentation),
+        CHILD_FIRST(SegmentBase, m_segmentBase, SegmentBase),
+        CHILD_FIRST(SegmentList, m_segmentList, SegmentList),
+        CHILD_FIRST(SegmentTemplate, m_segmentTemplate, SegmentTemplate)
+    });
+
+#undef CHILD_FIRST
+#undef CHILD_LIST
+#undef ATTR_FN
+
+    attribute_table.apply(*this, node);
+    element_table.apply(*this, node);
 }
 
 void Representation::setXMLElement(xmlpp::Element &elem) const
@@ -582,9 +466,9 @@ void Representation::setXMLElement(xmlpp::Element &elem) const
         m_segmentBase.value().setXMLElement(*child);
     }
 
-    if (m_segmentBase.has_value()) {
+    if (m_segmentList.has_value()) {
         xmlpp::Element *child = elem.add_child_element("SegmentList");
-        m_segmentBase.value().setXMLElement(*child);
+        m_segmentList.value().setXMLElement(*child);
     }
 
     if (m_segmentTemplate.has_value()) {
@@ -596,45 +480,191 @@ void Representation::setXMLElement(xmlpp::Element &elem) const
 
 void Representation::setAdaptationSet(AdaptationSet *adapt_set)
 {
+    if (m_adaptationSet == adapt_set) return;
     m_adaptationSet = adapt_set;
+    invalidateBaseURLs();
+    m_addressing.store(nullptr);
 }
 
 // private:
 
-SegmentTemplate::Variables Representation::getTemplateVars() const
+std::shared_ptr<const Representation::Addressing> Representation::getAddressing() const
 {
-    return SegmentTemplate::Variables(m_id, std::nullopt, m_bandwidth);
+    // Built once per generation and then only read, so concurrent queries on a const Representation only load the pointer
+    auto generation = MPD::addressingGeneration(getMPD()).value();
+    std::shared_ptr<const Addressing> addressing(m_addressing.load(std::memory_order_acquire));
+    if (addressing && addressing->generation == generation) return addressing;
+
+    std::lock_guard<std::mutex> lock(m_addressingMutex);
+    addressing = m_addressing.load(std::memory_order_relaxed);
+    if (addressing && addressing->generation == generation) return addressing;
+
+    // Segment information at the Representation, AdaptationSet and Period levels
+    const std::optional<SegmentTemplate> *seg_templates[3] = {&m_segmentTemplate, nullptr, nullptr};
+    const std::optional<SegmentList> *seg_lists[3] = {&m_segmentList, nullptr, nullptr};
+    const std::optional<SegmentBase> *seg_bases[3] = {&m_segmentBase, nullptr, nullptr};
+    if (m_adaptationSet) {
+        seg_templates[1] = &m_adaptationSet->segmentTemplate();
+        seg_lists[1] = &m_adaptationSet->segmentList();
+        seg_bases[1] = &m_adaptationSet->segmentBase();
+        const Period *period = m_adaptationSet->getPeriod();
+        if (period) {
+            seg_templates[2] = &period->segmentTemplate();
+            seg_lists[2] = &period->segmentList();
+            seg_bases[2] = &period->segmentBase();
+        }
+    }
+
+    auto rebuilt = std::make_shared<Addressing>();
+    rebuilt->generation = generation;
+    // The lowest level with any segment information decides which type of segment information applies
+    for (int level = 0; level < 3 && !rebuilt->multiSegmentBase; level++) {
+        if (seg_templates[level] && seg_templates[level]->has_value()) {
+            rebuilt->segmentTemplate = inheritSegmentInfo(seg_templates, rebuilt->mergedTemplate);
+            rebuilt->multiSegmentBase = rebuilt->segmentTemplate;
+        } else if (seg_lists[level] && seg_lists[level]->has_value()) {
+            rebuilt->segmentList = inheritSegmentInfo(seg_lists, rebuilt->mergedList);
+            rebuilt->multiSegmentBase = rebuilt->segmentList;
+        } else if (seg_bases[level] && seg_bases[level]->has_value()) {
+            std::optional<SegmentBase> merged_base;
+            static_cast<SegmentBase&>(rebuilt->mergedBase) = *inheritSegmentInfo(seg_bases, merged_base);
+            rebuilt->multiSegmentBase = &rebuilt->mergedBase;
+        }
+    }
+    if (!rebuilt->multiSegmentBase) rebuilt->multiSegmentBase = &rebuilt->mergedBase;
+
+    m_addressing.store(rebuilt, std::memory_order_release);
+    return rebuilt;
 }
 
-SegmentTemplate::Variables Representation::getTemplateVars(unsigned long segment_number) const
+template <class T>
+const T *Representation::inheritSegmentInfo(const std::optional<T> *const (&levels)[3], std::optional<T> &merged)
 {
-    SegmentTemplate::Variables ret(getTemplateVars());
+    // Levels are lowest first, values at a lower level override those inherited from a higher level
+    const T *ret = nullptr;
+    for (const auto *level : levels) {
+        if (!level || !level->has_value()) continue;
+        if (!ret) {
+            ret = &level->value();
+        } else {
+            if (!merged) merged = *ret;
+            merged.value().inheritFrom(level->value());
+            ret = &merged.value();
+        }
+    }
+    return ret;
+}
 
-    ret.number(segment_number);
+std::list<SegmentAvailability> Representation::segmentAvailabilities(const Addressing &addressing, unsigned long first_segment,
+                                                                     unsigned long count) const
+{
+    std::list<SegmentAvailability> ret;
 
-    auto &multi_seg_base = getMultiSegmentBase();
-    ret.time(multi_seg_base.segmentNumberToTime(segment_number));
+    const SegmentTemplate *seg_template = addressing.segmentTemplate;
+    const SegmentList *seg_list = addressing.segmentList;
+    const MultipleSegmentBase *multi_base = addressing.multiSegmentBase;
+    if (!seg_template && !seg_list) return ret;
+
+    // Don't go past the end of the Period or the list of segments
+    auto seg_count = multi_base->segmentCount(getPeriodDuration());
+    if (seg_list && (!seg_count || seg_list->segmentURLs().size() < seg_count.value())) seg_count = seg_list->segmentURLs().size();
+    if (seg_count) {
+        if (first_segment >= seg_count.value()) return ret;
+        if (count > seg_count.value() - first_segment) count = seg_count.value() - first_segment;
+    }
+
+    // Segment availability is relative to the Period start, less any @availabilityTimeOffset
+    const std::list<BaseURL> &base_urls = getBaseURLs();
+    const MPD *mpd = getMPD();
+    std::optional<time_type> availability_base;
+    bool all_available = false;
+    if (mpd && mpd->hasAvailabilityStartTime()) {
+        availability_base = getPeriodStartTime();
+        auto ato = availability_time_offset(*multi_base, base_urls);
+        if (ato) {
+            if (!std::isfinite(ato.value())) {
+                // All segments available at the MPD@availabilityStartTime
+                availability_base = mpd->availabilityStartTime().value();
+                all_available = true;
+            } else {
+                availability_base.value() -= std::chrono::duration_cast<duration_type>(std::chrono::duration<double, std::ratio<1>>(ato.value()));
+            }
+        }
+    }
+    std::optional<time_type> availability_end;
+    if (mpd && mpd->hasAvailabilityEndTime()) {
+        availability_end = mpd->presentationTimeToSystemTime(mpd->availabilityEndTime().value());
+    }
+    bool have_durations = multi_base->hasSegmentTimeline() || multi_base->hasDuration();
+    bool is_live = mpd && mpd->isLive();
+
+    // Decompose the BaseURL once and reuse the formatting buffers for each segment
+    std::optional<DecomposedURL> base_url;
+    if (!base_urls.empty()) base_url.emplace(base_urls.front());
+    SegmentTemplate::Variables vars(getTemplateVars());
+    std::string media(seg_template && seg_template->hasMedia()?seg_template->media().value().size() + 32:0, '\0');
+    std::string resolved;
+
+    for (unsigned long segment_number = first_segment; segment_number < first_segment + count; segment_number++) {
+        SegmentAvailability &avail = ret.emplace_back();
+
+        time_type start_time;
+        if (availability_base) {
+            start_time = availability_base.value();
+            if (!all_available) start_time += multi_base->segmentNumberToDurationType(segment_number);
+        }
+        if (mpd) start_time = mpd->presentationTimeToSystemTime(start_time);
+        if (have_durations) {
+            avail.segmentDuration(multi_base->segmentDurationAsDurationType(segment_number));
+            // Availability is at the end of segments for live
+            if (is_live) start_time += std::chrono::duration_cast<time_type::duration>(avail.segmentDuration());
+        }
+        avail.availabilityStartTime(start_time);
+        avail.availabilityEndTime(availability_end);
+
+        URI media_url;
+        if (seg_template) {
+            vars.number(segment_number);
+            vars.time(multi_base->segmentNumberToMediaTime(segment_number));
+            auto length = seg_template->formatMediaTemplate(vars, std::span<char>(media));
+            if (length > media.size()) {
+                media.resize(length);
+                seg_template->formatMediaTemplate(vars, std::span<char>(media));
+            }
+            media_url = URI(media.substr(0, length));
+        } else {
+            media_url = URI(seg_list->getMediaURLForSegment(segment_number));
+        }
+        if (base_url && media_url.isURL() && !media_url.isAbsoluteURL()) {
+            base_url.value().resolve(media_url.str(), resolved);
+            media_url = URI(resolved);
+        }
+        avail.segmentURL(std::move(media_url));
+    }
 
     return ret;
 }
 
-SegmentTemplate::Variables Representation::getTemplateVars(const Representation::time_type &time) const
+SegmentTemplate::Variables Representation::getTemplateVars() const
+{
+    return SegmentTemplate::Variables(m_id, std::nullopt, m_bandwidth);
+}
+
+SegmentTemplate::Variables Representation::getTemplateVars(const Addressing &addressing, unsigned long segment_number) const
 {
     SegmentTemplate::Variables ret(getTemplateVars());
 
-    auto &multi_seg_base = getMultiSegmentBase();
-    auto period_start = getPeriodStartTime();
-    auto period_duration = getPeriodDuration();
-    unsigned long seg_num = 0;
+    ret.number(segment_number);
+    ret.time(addressing.multiSegmentBase->segmentNumberToMediaTime(segment_number));
 
-    if (time > period_start) {
-        duration_type offset_into_period = std::chrono::duration_cast<duration_type>(time - period_start);
-        if (!period_duration || offset_into_period < period_duration.value()) {
-            seg_num = multi_seg_base.durationTypeToSegmentNumber(offset_into_period);
-        }
-    }
+    return ret;
+}
 
-    return getTemplateVars(seg_num);
+unsigned long Representation::getSegmentNumber(const Addressing &addressing, const time_type &time) const
+{
+    auto period_start = getPeriodStartTime();
+    if (time <= period_start) return 0;
+    return addressing.multiSegmentBase->durationTypeToSegmentNumber(std::chrono::duration_cast<duration_type>(time - period_start));
 }
 
 Representation::time_type Representation::getPeriodStartTime() const
@@ -649,19 +679,9 @@ std::optional<Representation::duration_type> Representation::getPeriodDuration()
     return std::optional<Representation::duration_type>(); // just return epoch if we can't find the adaptation set
 }
 
-const MultipleSegmentBase &Representation::getMultiSegmentBase() const
+void Representation::invalidateBaseURLs() const
 {
-    if (m_segmentTemplate) return m_segmentTemplate.value();
-    if (m_segmentList) return m_segmentTemplate.value();
-    if (m_segmentBase) {
-        static MultipleSegmentBase multi_no_duration;
-        static_cast<SegmentBase&>(multi_no_duration) = m_segmentBase.value(); // copy over SegmentBase values
-        return multi_no_duration;
-    }
-    if (m_adaptationSet) return m_adaptationSet->getMultiSegmentBase();
-
-    static const MultipleSegmentBase empty_multi;
-    return empty_multi;
+    MPD::baseURLGeneration(getMPD()).invalidate();
 }
 
 LIBMPDPP_NAMESPACE_END
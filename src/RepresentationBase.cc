@@ -13,7 +13,9 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include <libxml++/libxml++.h>
 
@@ -36,6 +38,8 @@
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "parse_tables.hh"
+#include "span_iterators.hh"
 
 #include "libmpd++/RepresentationBase.hh"
 
@@ -274,11 +278,6 @@ bool RepresentationBase::operator==(const RepresentationBase &to_compare) const
     return true;
 }
 
-static unsigned int str_to_ui(const std::string &s)
-{
-    return static_cast<unsigned int>(std::stoul(s));
-}
-
 static bool str_to_bool(const std::string &s)
 {
     if (s == "true" || s == "1") return true;
@@ -311,64 +310,72 @@ static std::string videoScan_to_str(RepresentationBase::VideoScan val)
     return "unknown";
 }
 
-const URI &RepresentationBase::profile(std::list<URI>::size_type idx) const
+const URI &RepresentationBase::profile(std::vector<URI>::size_type idx) const
 {
     if (idx >= m_profiles.size())
         throw std::out_of_range("profile in RepresentationBase does not exist");
-    
-    auto it = m_profiles.begin();
-    while (idx-- > 0) it++;
-    return *it;
+
+    return m_profiles[idx];
 }
 
 RepresentationBase &RepresentationBase::profilesRemove(const URI &val)
 {
-    return profilesRemove(std::find(m_profiles.begin(), m_profiles.end(), val));
+    auto it = std::find(m_profiles.begin(), m_profiles.end(), val);
+    if (it != m_profiles.end()) {
+        m_profiles.erase(it);
+    }
+    return *this;
 }
 
-RepresentationBase &RepresentationBase::profilesRemove(const std::list<URI>::const_iterator &it)
+RepresentationBase &RepresentationBase::profilesRemove(const std::span<const URI>::iterator &it)
 {
-    if (it != m_profiles.end()) {
-        m_profiles.erase(it);
+    auto vec_it = vector_iterator(m_profiles, it);
+    if (vec_it != m_profiles.end()) {
+        m_profiles.erase(vec_it);
     }
     return *this;
 }
 
-RepresentationBase &RepresentationBase::profilesRemove(const std::list<URI>::iterator &it)
+RepresentationBase &RepresentationBase::profilesRemove(const std::span<URI>::iterator &it)
 {
-    if (it != m_profiles.end()) {
-        m_profiles.erase(it);
+    auto vec_it = vector_iterator(m_profiles, it);
+    if (vec_it != m_profiles.end()) {
+        m_profiles.erase(vec_it);
     }
     return *this;
 }
 
-unsigned int RepresentationBase::audioSamplingRate(std::list<unsigned int>::size_type idx) const
+unsigned int RepresentationBase::audioSamplingRate(std::vector<unsigned int>::size_type idx) const
 {
     if (idx >= m_audioSamplingRates.size())
         throw std::out_of_range("@audioSamplingRates entry in RepresentationBase does not exist");
 
-    auto it = m_audioSamplingRates.begin();
-    while (idx-- > 0) it++;
-    return *it;
+    return m_audioSamplingRates[idx];
 }
 
 RepresentationBase &RepresentationBase::audioSamplingRatesRemove(unsigned int val)
 {
-    return audioSamplingRatesRemove(std::find(m_audioSamplingRates.begin(), m_audioSamplingRates.end(), val));
+    auto it = std::find(m_audioSamplingRates.begin(), m_audioSamplingRates.end(), val);
+    if (it != m_audioSamplingRates.end()) {
+        m_audioSamplingRates.erase(it);
+    }
+    return *this;
 }
 
-RepresentationBase &RepresentationBase::audioSamplingRatesRemove(const std::list<unsigned int>::const_iterator &it)
+RepresentationBase &RepresentationBase::audioSamplingRatesRemove(const std::span<const unsigned int>::iterator &it)
 {
-    if (it != m_audioSamplingRates.end()) {
-        m_audioSamplingRates.erase(it);
+    auto vec_it = vector_iterator(m_audioSamplingRates, it);
+    if (vec_it != m_audioSamplingRates.end()) {
+        m_audioSamplingRates.erase(vec_it);
     }
     return *this;
 }
 
-RepresentationBase &RepresentationBase::audioSamplingRatesRemove(const std::list<unsigned int>::iterator &it)
+RepresentationBase &RepresentationBase::audioSamplingRatesRemove(const std::span<unsigned int>::iterator &it)
 {
-    if (it != m_audioSamplingRates.end()) {
-        m_audioSamplingRates.erase(it);
+    auto vec_it = vector_iterator(m_audioSamplingRates, it);
+    if (vec_it != m_audioSamplingRates.end()) {
+        m_audioSamplingRates.erase(vec_it);
     }
     return *this;
 }
@@ -872,90 +879,62 @@ RepresentationBase::RepresentationBase(xmlpp::Node &node)
     ,m_contentPopularityRates()
     ,m_resyncs()
 {
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}
-    };
-    xmlpp::Node::NodeSet node_set;
+#define NODE_ATTR_LIST_CLASS(name, var, cls) {#name, [](RepresentationBase &rb, const std::string &val) { rb.var = str_to_list<cls, decltype(rb.var)>(val); }}
+#define NODE_ATTR_OPT_FN(name, fn) {#name, [](RepresentationBase &rb, const std::string &val) { rb.m_ ## name = fn(val); }}
+
+    static const AttributeTable<RepresentationBase> attribute_table("RepresentationBase", {
+        NODE_ATTR_LIST_CLASS(profiles, m_profiles, URI),
+        NODE_ATTR_OPT_FN(width, str_to_ui),
+        NODE_ATTR_OPT_FN(height, str_to_ui),
+        NODE_ATTR_OPT_FN(sar, Ratio),
+        NODE_ATTR_OPT_FN(frameRate, FrameRate),
+        NODE_ATTR_LIST_CLASS(audioSamplingRate, m_audioSamplingRates, unsigned int),
+        NODE_ATTR_OPT_FN(mimeType, std::string),
+        NODE_ATTR_LIST_CLASS(segmentProfiles, m_segmentProfiles, std::string),
+        NODE_ATTR_OPT_FN(codecs, Codecs),
+        NODE_ATTR_LIST_CLASS(containerProfiles, m_containerProfiles, std::string),
+        NODE_ATTR_OPT_FN(maximumSAPPeriod, std::stod),
+        NODE_ATTR_OPT_FN(startWithSAP, SAP),
+        NODE_ATTR_OPT_FN(maxPlayoutRate, std::stod),
+        NODE_ATTR_OPT_FN(codingDependency, str_to_bool),
+        NODE_ATTR_OPT_FN(scanType, str_to_VideoScan),
+        NODE_ATTR_OPT_FN(selectionPriority, str_to_ui),
+        NODE_ATTR_OPT_FN(tag, std::string)
+    });
 
-#define NODE_ATTR_LIST_CLASS(name, var, cls) do { \
-        node_set = node.find("@" #name); \
-        if (node_set.size() > 0) { \
-            xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front()); \
-            var = str_to_list<cls>(attr->get_value()); \
-        } \
-    } while (0)
-#define NODE_ATTR_OPT_FN(name, fn) do { \
-        node_set = node.find("@" #name); \
-        if (node_set.size() > 0) { \
-            xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front()); \
-            m_ ## name = fn(attr->get_value()); \
-        } \
-    } while (0)
-#define NODE_ATTR_OPT_FN_DEFAULT(name, fn, dflt) do { \
-        node_set = node.find("@" #name); \
-        if (node_set.size() > 0) { \
-            xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front()); \
-            m_ ## name = fn(attr->get_value()); \
-        } else { \
-            m_ ## name = dflt; \
-        } \
-    } while (0)
-
-    NODE_ATTR_LIST_CLASS(profiles, m_profiles, URI);
-    NODE_ATTR_OPT_FN(width, str_to_ui);
-    NODE_ATTR_OPT_FN(height, str_to_ui);
-    NODE_ATTR_OPT_FN(sar, Ratio);
-    NODE_ATTR_OPT_FN(frameRate, FrameRate);
-    NODE_ATTR_LIST_CLASS(audioSamplingRate, m_audioSamplingRates, unsigned int);
-    NODE_ATTR_OPT_FN(mimeType, std::string);
-    NODE_ATTR_LIST_CLASS(segmentProfiles, m_segmentProfiles, std::string);
-    NODE_ATTR_OPT_FN(codecs, Codecs);
-    NODE_ATTR_LIST_CLASS(containerProfiles, m_containerProfiles, std::string);
-    NODE_ATTR_OPT_FN(maximumSAPPeriod, std::stod);
-    NODE_ATTR_OPT_FN(startWithSAP, SAP);
-    NODE_ATTR_OPT_FN(maxPlayoutRate, std::stod);
-    NODE_ATTR_OPT_FN(codingDependency, str_to_bool);
-    NODE_ATTR_OPT_FN(scanType, str_to_VideoScan);
-    NODE_ATTR_OPT_FN_DEFAULT(selectionPriority, str_to_ui, 1);
-    NODE_ATTR_OPT_FN(tag, std::string);
-
-#undef NODE_ATTR_OPT_FN_DEFAULT
 #undef NODE_ATTR_OPT_FN
 #undef NODE_ATTR_LIST_CLASS
-#undef NODE_ATTR_LIST_TYPE
 
-#define NODE_CHILD_OPT_LIST(name, var, cls) do { \
-        node_set = node.find("mpd:" #name, ns_map); \
-        for (auto node : node_set) { \
-            var.push_back(cls(*node)); \
-        } \
-    } while (0)
-#define NODE_CHILD_OPT(name, var, cls) do { \
-        node_set = node.find("mpd:" #name, ns_map); \
-        if (node_set.size() > 1) { \
-            throw ParseError("<RepresentationBase>/" #name " can only be used once per <RepresentationBase>"); \
-        } else if (node_set.size() == 1) { \
-            var = cls(*node_set.front()); \
-        } \
-    } while (0)
-
-    NODE_CHILD_OPT_LIST(FramePacking, m_framePackings, Descriptor);
-    NODE_CHILD_OPT_LIST(AudioChannelConfiguration, m_audioChannelConfigurations, Descriptor);
-    NODE_CHILD_OPT_LIST(ContentProtection, m_contentProtections, ContentProtection);
-    NODE_CHILD_OPT(OutputProtection, m_outputProtection, Descriptor);
-    NODE_CHILD_OPT_LIST(EssentialProperty, m_essentialProperties, Descriptor);
-    NODE_CHILD_OPT_LIST(SupplementalProperty, m_supplementalProperties, Descriptor);
-    NODE_CHILD_OPT_LIST(InbandEventStream, m_inbandEventStreams, EventStream);
-    NODE_CHILD_OPT_LIST(Switching, m_switchings, Switching);
-    NODE_CHILD_OPT_LIST(RandomAccess, m_randomAccesses, RandomAccess);
-    NODE_CHILD_OPT_LIST(GroupLabel, m_groupLabels, Label);
-    NODE_CHILD_OPT_LIST(Label, m_labels, Label);
-    NODE_CHILD_OPT_LIST(ProducerReferenceTime, m_producerReferenceTimes, ProducerReferenceTime);
-    NODE_CHILD_OPT_LIST(ContentPopularityRate, m_contentPopularityRates, ContentPopularityRate);
-    NODE_CHILD_OPT_LIST(Resync, m_resyncs, Resync);
+#define NODE_CHILD_OPT_LIST(name, var, cls) {#name, [](RepresentationBase &rb, xmlpp::Node &child) { rb.var.push_back(cls(child)); }}
+#define NODE_CHILD_OPT(name, var, cls) {#name, [](RepresentationBase &rb, xmlpp::Node &child) { \
+            if (rb.var.has_value()) { \
+                throw ParseError("<RepresentationBase>/" #name " can only be used once per <RepresentationBase>"); \
+            } \
+            rb.var = cls(child); \
+        }}
+
+    static const ElementTable<RepresentationBase> element_table({
+        NODE_CHILD_OPT_LIST(FramePacking, m_framePackings, Descriptor),
+        NODE_CHILD_OPT_LIST(AudioChannelConfiguration, m_audioChannelConfigurations, Descriptor),
+        NODE_CHILD_OPT_LIST(ContentProtection, m_contentProtections, ContentProtection),
+        NODE_CHILD_OPT(OutputProtection, m_outputProtection, Descriptor),
+        NODE_CHILD_OPT_LIST(EssentialProperty, m_essentialProperties, Descriptor),
+        NODE_CHILD_OPT_LIST(SupplementalProperty, m_supplementalProperties, Descriptor),
+        NODE_CHILD_OPT_LIST(InbandEventStream, m_inbandEventStreams, EventStream),
+        NODE_CHILD_OPT_LIST(Switching, m_switchings, Switching),
+        NODE_CHILD_OPT_LIST(RandomAccess, m_randomAccesses, RandomAccess),
+        NODE_CHILD_OPT_LIST(GroupLabel, m_groupLabels, Label),
+        NODE_CHILD_OPT_LIST(Label, m_labels, Label),
+        NODE_CHILD_OPT_LIST(ProducerReferenceTime, m_producerReferenceTimes, ProducerReferenceTime),
+        NODE_CHILD_OPT_LIST(ContentPopularityRate, m_contentPopularityRates, ContentPopularityRate),
+        NODE_CHILD_OPT_LIST(Resync, m_resyncs, Resync)
+    });
 
 #undef NODE_CHILD_OPT_LIST
 #undef NODE_CHILD_OPT
+
+    attribute_table.apply(*this, node);
+    element_table.apply(*this, node);
 }
 
 void RepresentationBase::setXMLElement(xmlpp::Element &elem) const
@@ -20,6 +20,7 @@
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "parse_tables.hh"
 
 #include "libmpd++/SegmentBase.hh"
 
@@ -152,92 +153,37 @@ SegmentBase::SegmentBase(xmlpp::Node &node)
     ,m_representationIndex()
     ,m_failoverContent()
 {
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}
-    };
-    xmlpp::Node::NodeSet node_set;
-
-    node_set = node.find("@timescale");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_timescale = static_cast<unsigned int>(std::stoul(attr->get_value()));
-    }
-
-    node_set = node.find("@eptDelta");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_eptDelta = std::stoi(attr->get_value());
-    }
-
-    node_set = node.find("@pdDelta");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_pdDelta = std::stoi(attr->get_value());
-    }
-
-    node_set = node.find("@presentationTimeOffset");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_presentationTimeOffset = std::stoul(attr->get_value());
-    }
-
-    node_set = node.find("@presentationDuration");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_presentationDuration = std::stoul(attr->get_value());
-    }
-
-    node_set = node.find("@timeShiftBufferDepth");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_timeShiftBufferDepth = str_to_duration<duration_type>(std::string(attr->get_value()));
-    }
-
-    node_set = node.find("@indexRange");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_indexRange = SingleRFC7233Range(attr->get_value());
-    }
-
-    node_set = node.find("@indexRangeExact");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_indexRangeExact = (attr->get_value() == "true");
-    }
-
-    node_set = node.find("@availabilityTimeOffset");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_availabilityTimeOffset = std::stod(attr->get_value());
-    }
-
-    node_set = node.find("@availabilityTimeComplete");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_availabilityTimeComplete = !(attr->get_value() == "false");
-    }
+#define ATTR_FN(name, fn) {#name, [](SegmentBase &sb, const std::string &val) { sb.m_ ## name = fn(val); }}
+#define CHILD_ONCE(name, var, cls) {#name, [](SegmentBase &sb, xmlpp::Node &child) { \
+            if (sb.var) throw ParseError("A SegmentBase can only have one " #name " element"); \
+            sb.var = cls(child); \
+        }}
+
+    static const AttributeTable<SegmentBase> attribute_table("SegmentBase", {
+        ATTR_FN(timescale, str_to_ui),
+        ATTR_FN(eptDelta, std::stoi),
+        ATTR_FN(pdDelta, std::stoi),
+        ATTR_FN(presentationTimeOffset, std::stoul),
+        ATTR_FN(presentationDuration, std::stoul),
+        ATTR_FN(timeShiftBufferDepth, str_to_duration<duration_type>),
+        ATTR_FN(indexRange, SingleRFC7233Range),
+        {"indexRangeExact", [](SegmentBase &sb, const std::string &val) { sb.m_indexRangeExact = (val == "true"); }},
+        ATTR_FN(availabilityTimeOffset, std::stod),
+        {"availabilityTimeComplete", [](SegmentBase &sb, const std::string &val) { sb.m_availabilityTimeComplete = !(val == "false"); }}
+    });
 
     // Elements
-    node_set = node.find("mpd:Initialization", ns_map);
-    if (node_set.size() == 1) {
-        m_initialization = URL(*node_set.front());
-    } else if (node_set.size() > 1) {
-        throw ParseError("A SegmentBase can only have one Initialization element");
-    }
+    static const ElementTable<SegmentBase> element_table({
+        CHILD_ONCE(Initialization, m_initialization, URL),
+        CHILD_ONCE(RepresentationIndex, m_representationIndex, URL),
+        CHILD_ONCE(FailoverContent, m_failoverContent, FailoverContent)
+    });
 
-    node_set = node.find("mpd:RepresentationIndex", ns_map);
-    if (node_set.size() == 1) {
-        m_representationIndex = URL(*node_set.front());
-    } else if (node_set.size() > 1) {
-        throw ParseError("A SegmentBase can only have one RepresentationIndex element");
-    }
+#undef CHILD_ONCE
+#undef ATTR_FN
 
-    node_set = node.find("mpd:FailoverContent", ns_map);
-    if (node_set.size() == 1) {
-        m_failoverContent = FailoverContent(*node_set.front());
-    } else if (node_set.size() > 1) {
-        throw ParseError("A SegmentBase can only have one FailoverContent element");
-    }
+    attribute_table.apply(*this, node);
+    element_table.apply(*this, node);
 }
 
 void SegmentBase::setXMLElement(xmlpp::Element &elem) const
@@ -288,6 +234,29 @@ void SegmentBase::setXMLElement(xmlpp::Element &elem) const
     }
 }
 
+void SegmentBase::inheritFrom(const SegmentBase &parent)
+{
+#define INHERIT_OPT_VALUE(var) if (!var && parent.var) var = parent.var
+
+    INHERIT_OPT_VALUE(m_timescale);
+    INHERIT_OPT_VALUE(m_eptDelta);
+    INHERIT_OPT_VALUE(m_pdDelta);
+    INHERIT_OPT_VALUE(m_presentationTimeOffset);
+    INHERIT_OPT_VALUE(m_presentationDuration);
+    INHERIT_OPT_VALUE(m_timeShiftBufferDepth);
+    INHERIT_OPT_VALUE(m_indexRange);
+    INHERIT_OPT_VALUE(m_availabilityTimeOffset);
+    INHERIT_OPT_VALUE(m_initialization);
+    INHERIT_OPT_VALUE(m_representationIndex);
+    INHERIT_OPT_VALUE(m_failoverContent);
+
+#undef INHERIT_OPT_VALUE
+
+    // Flags left at their default values can't be told apart from unset, so only inherit a non-default value
+    if (!m_indexRangeExact) m_indexRangeExact = parent.m_indexRangeExact;
+    if (m_availabilityTimeComplete) m_availabilityTimeComplete = parent.m_availabilityTimeComplete;
+}
+
 LIBMPDPP_NAMESPACE_END
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
@@ -9,12 +9,23 @@
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
 #include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
+#include <glibmm/ustring.h>
 #include <libxml++/libxml++.h>
+#include <libxml/tree.h>
 
+#include "libmpd++/exceptions.hh"
 #include "libmpd++/macros.hh"
 #include "libmpd++/MultipleSegmentBase.hh"
-#include "libmpd++/Period.hh"
+#include "libmpd++/SegmentURL.hh"
+#include "libmpd++/XLink.hh"
+
+#include "constants.hh"
+#include "parse_tables.hh"
+#include "span_iterators.hh"
 
 #include "libmpd++/SegmentList.hh"
 
@@ -22,20 +33,32 @@ LIBMPDPP_NAMESPACE_BEGIN
 
 static const std::string g_empty_string;
 
+SegmentList &SegmentList::segmentURLRemove(const std::span<const SegmentURL>::iterator &it)
+{
+    m_segmentURLs.erase(vector_iterator(m_segmentURLs, it));
+    return *this;
+}
+
+SegmentList &SegmentList::segmentURLRemove(const std::span<SegmentURL>::iterator &it)
+{
+    m_segmentURLs.erase(vector_iterator(m_segmentURLs, it));
+    return *this;
+}
+
 const std::string &SegmentList::getMediaURLForSegment(unsigned long segment_number) const
 {
+    // SegmentURLs are held in a vector so this is a direct index into the list
     if (segment_number >= m_segmentURLs.size()) return g_empty_string;
-    auto it = m_segmentURLs.begin();
-    for (decltype(segment_number) i = 0; i < segment_number; i++) it++;
-    const auto &seg_url = *it;
+    const auto &seg_url = m_segmentURLs[segment_number];
     if (seg_url.hasMedia()) return seg_url.media().value().str();
     return g_empty_string;
 }
 
 const std::string &SegmentList::getMediaURLForSegmentTime(unsigned long time) const
 {
-    // TODO: iterate to the m_segmentURLs to find the one representing @a time.
-    return g_empty_string;
+    // Segment number from the SegmentTimeline (binary search) or @duration (division), then index the SegmentURLs
+    if (!hasSegmentTimeline() && !hasDuration() && m_segmentURLs.size() > 1) return g_empty_string; // can't tell segments apart
+    return getMediaURLForSegment(timeOffsetToSegmentNumber(time));
 }
 
 const std::string &SegmentList::getMediaURLForSegmentTime(const duration_type &time) const
@@ -62,12 +85,64 @@ const std::string &SegmentList::getInitializationURL() const
 /* protected: */
 SegmentList::SegmentList(xmlpp::Node &node)
     :MultipleSegmentBase(node)
+    ,m_xLink()
+    ,m_segmentURLs()
+{
+    const xmlAttr *xlink_href_attr = xmlHasNsProp(node.cobj(), reinterpret_cast<const xmlChar*>("href"),
+                                                  reinterpret_cast<const xmlChar*>(XLINK_NS));
+    if (xlink_href_attr) {
+        std::string xlink_href = xml_attribute_value(xlink_href_attr);
+        auto actuate = XLink::ACTUATE_ON_REQUEST;
+        const xmlAttr *xlink_actuate_attr = xmlHasNsProp(node.cobj(), reinterpret_cast<const xmlChar*>("actuate"),
+                                                         reinterpret_cast<const xmlChar*>(XLINK_NS));
+        if (xlink_actuate_attr) {
+            std::string xlink_actuate = xml_attribute_value(xlink_actuate_attr);
+            if (xlink_actuate == "onLoad") actuate = XLink::ACTUATE_ON_LOAD;
+            else if (xlink_actuate != "onRequest") throw ParseError("SegmentList/@xlink:actuate can only be either \"onLoad\" or \"onRequest\"");
+        }
+        m_xLink = XLink(xlink_href, actuate, XLink::TYPE_SIMPLE, XLink::SHOW_EMBED);
+    }
+
+    static const ElementTable<SegmentList> element_table({
+        {"SegmentURL", [](SegmentList &seg_list, xmlpp::Node &child) { seg_list.m_segmentURLs.push_back(SegmentURL(child)); }}
+    });
+
+    element_table.apply(*this, node);
+}
+
+static Glib::ustring get_ns_prefix_for(xmlpp::Element &elem, const Glib::ustring &namespace_uri, const Glib::ustring &namespace_prefix)
 {
+    auto ns_ptr = xmlSearchNsByHref(elem.cobj()->doc, elem.cobj(), reinterpret_cast<const xmlChar*>(namespace_uri.c_str()));
+    if (ns_ptr == nullptr) {
+        auto root_node = xmlDocGetRootElement(elem.cobj()->doc);
+        ns_ptr = xmlNewNs(root_node, reinterpret_cast<const xmlChar*>(namespace_uri.c_str()), reinterpret_cast<const xmlChar*>(namespace_prefix.c_str()));
+    }
+    return Glib::ustring(reinterpret_cast<const char*>(ns_ptr->prefix));
 }
 
 void SegmentList::setXMLElement(xmlpp::Element &elem) const
 {
     MultipleSegmentBase::setXMLElement(elem);
+
+    if (m_xLink) {
+        const Glib::ustring& xlink_prefix = get_ns_prefix_for(elem, XLINK_NS, "xlink");
+        elem.set_attribute("href", std::string(m_xLink.value().href()), xlink_prefix);
+        if (m_xLink.value().actuate() != XLink::ACTUATE_ON_REQUEST) {
+            elem.set_attribute("actuate", "onLoad", xlink_prefix);
+        }
+    }
+    for (const auto &seg_url : m_segmentURLs) {
+        xmlpp::Element *child = elem.add_child_element("SegmentURL");
+        seg_url.setXMLElement(*child);
+    }
+}
+
+void SegmentList::inheritFrom(const SegmentList &parent)
+{
+    MultipleSegmentBase::inheritFrom(parent);
+
+    if (!m_xLink) m_xLink = parent.m_xLink;
+    if (m_segmentURLs.empty()) m_segmentURLs = parent.m_segmentURLs;
 }
 
 LIBMPDPP_NAMESPACE_END
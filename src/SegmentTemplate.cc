@@ -8,14 +8,25 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
-#include <optional>
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 
 #include <libxml++/libxml++.h>
 
 #include "libmpd++/macros.hh"
 #include "libmpd++/Period.hh"
 
+#include "parse_tables.hh"
+
 #include "libmpd++/SegmentTemplate.hh"
 
 LIBMPDPP_NAMESPACE_BEGIN
@@ -75,6 +86,137 @@ std::string SegmentTemplate::Variables::format(const std::string &fmt, const std
     throw std::runtime_error("Substitute for \"" + fmt + "\" unrecognised");
 }
 
+/******** SegmentTemplate::Program ********/
+
+SegmentTemplate::Program::Program(const std::string &fmt)
+    :m_tokens()
+{
+    // Work out which variable, if any, an identifier (the text between a pair of '$') refers to
+    auto parse_identifier = [](std::string_view ident, TokenType &type, std::uint16_t &width) {
+        width = 1;
+        if (ident == "RepresentationID") {
+            type = REPRESENTATION_ID;
+            return true;
+        }
+        // All other identifiers can end with a format tag of "%0<width>d"
+        auto pct = ident.find('%');
+        if (pct != std::string_view::npos) {
+            auto tag = ident.substr(pct);
+            if (tag.size() < 4 || tag[1] != '0' || tag.back() != 'd') return false;
+            unsigned int tag_width;
+            auto [ptr, ec] = std::from_chars(tag.data() + 2, tag.data() + tag.size() - 1, tag_width);
+            if (ec != std::errc() || ptr != tag.data() + tag.size() - 1 || tag_width > std::numeric_limits<std::uint16_t>::max()) {
+                return false;
+            }
+            width = static_cast<std::uint16_t>(tag_width);
+            ident = ident.substr(0, pct);
+        }
+        if (ident == "Number") {
+            type = NUMBER;
+        } else if (ident == "Bandwidth") {
+            type = BANDWIDTH;
+        } else if (ident == "Time") {
+            type = TIME;
+        } else if (ident == "SubNumber") {
+            type = SUB_NUMBER;
+        } else {
+            return false;
+        }
+        return true;
+    };
+    auto add_literal = [this](std::string::size_type offset, std::string::size_type length) {
+        if (length > 0) {
+            m_tokens.push_back({LITERAL, 0, static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(length)});
+        }
+    };
+
+    std::string::size_type literal_start = 0;
+    for (auto pos = fmt.find('$'); pos != std::string::npos;) {
+        auto epos = fmt.find('$', pos+1);
+        if (epos == std::string::npos) break;
+        TokenType type;
+        std::uint16_t width;
+        if (epos == pos+1) {
+            // "$$" is an escaped '$', keep the first '$' as part of the literal text
+            add_literal(literal_start, pos + 1 - literal_start);
+            literal_start = epos + 1;
+            pos = fmt.find('$', literal_start);
+        } else if (parse_identifier(std::string_view(fmt).substr(pos+1, epos-pos-1), type, width)) {
+            add_literal(literal_start, pos - literal_start);
+            m_tokens.push_back({type, width, static_cast<std::uint32_t>(pos), static_cast<std::uint32_t>(epos - pos + 1)});
+            literal_start = epos + 1;
+            pos = fmt.find('$', literal_start);
+        } else {
+            // Unrecognised identifiers are left as they are, and the closing '$' may start the next identifier
+            pos = epos;
+        }
+    }
+    add_literal(literal_start, fmt.size() - literal_start);
+}
+
+std::size_t SegmentTemplate::Program::format(const std::string &fmt, const Variables &vars,
+                                             const std::optional<unsigned int> &start_number,
+                                             std::span<char> buffer) const noexcept
+{
+    std::size_t length = 0;
+    auto append = [&](const char *str, std::size_t len) {
+        if (length < buffer.size()) std::memcpy(buffer.data() + length, str, std::min(len, buffer.size() - length));
+        length += len;
+    };
+    auto append_number = [&](unsigned long value, std::uint16_t width) {
+        char digits[std::numeric_limits<unsigned long>::digits10 + 1];
+        auto num_digits = static_cast<std::size_t>(std::to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+        if (num_digits < width) {
+            std::size_t padding = width - num_digits;
+            if (length < buffer.size()) std::memset(buffer.data() + length, '0', std::min(padding, buffer.size() - length));
+            length += padding;
+        }
+        append(digits, num_digits);
+    };
+
+    for (const auto &token : m_tokens) {
+        switch (token.type) {
+        case LITERAL:
+            append(fmt.data() + token.offset, token.length);
+            continue;
+        case REPRESENTATION_ID:
+            if (vars.representationId()) {
+                append(vars.representationId().value().data(), vars.representationId().value().size());
+                continue;
+            }
+            break;
+        case NUMBER:
+            if (vars.number()) {
+                append_number(vars.number().value() + (start_number?start_number.value():1), token.width);
+                continue;
+            }
+            break;
+        case BANDWIDTH:
+            if (vars.bandwidth()) {
+                append_number(vars.bandwidth().value(), token.width);
+                continue;
+            }
+            break;
+        case TIME:
+            if (vars.time()) {
+                append_number(vars.time().value(), token.width);
+                continue;
+            }
+            break;
+        case SUB_NUMBER:
+            if (vars.subNumber()) {
+                append_number(vars.subNumber().value(), token.width);
+                continue;
+            }
+            break;
+        }
+        // The variable has no value, so leave the identifier in the output
+        append(fmt.data() + token.offset, token.length);
+    }
+
+    return length;
+}
+
 /******** SegmentTemplate ********/
 
 SegmentTemplate::SegmentTemplate()
@@ -83,6 +225,10 @@ SegmentTemplate::SegmentTemplate()
     ,m_index()
     ,m_initialization()
     ,m_bitstreamSwitching()
+    ,m_mediaProgram()
+    ,m_indexProgram()
+    ,m_initializationProgram()
+    ,m_bitstreamSwitchingProgram()
 {
 }
 
@@ -92,6 +238,10 @@ SegmentTemplate::SegmentTemplate(const SegmentTemplate &other)
     ,m_index(other.m_index)
     ,m_initialization(other.m_initialization)
     ,m_bitstreamSwitching(other.m_bitstreamSwitching)
+    ,m_mediaProgram(other.m_mediaProgram)
+    ,m_indexProgram(other.m_indexProgram)
+    ,m_initializationProgram(other.m_initializationProgram)
+    ,m_bitstreamSwitchingProgram(other.m_bitstreamSwitchingProgram)
 {
 }
 
@@ -101,6 +251,10 @@ SegmentTemplate::SegmentTemplate(SegmentTemplate &&other)
     ,m_index(std::move(other.m_index))
     ,m_initialization(std::move(other.m_initialization))
     ,m_bitstreamSwitching(std::move(other.m_bitstreamSwitching))
+    ,m_mediaProgram(std::move(other.m_mediaProgram))
+    ,m_indexProgram(std::move(other.m_indexProgram))
+    ,m_initializationProgram(std::move(other.m_initializationProgram))
+    ,m_bitstreamSwitchingProgram(std::move(other.m_bitstreamSwitchingProgram))
 {
 }
 
@@ -111,6 +265,10 @@ SegmentTemplate &SegmentTemplate::operator=(const SegmentTemplate &other)
     m_index = other.m_index;
     m_initialization = other.m_initialization;
     m_bitstreamSwitching = other.m_bitstreamSwitching;
+    m_mediaProgram = other.m_mediaProgram;
+    m_indexProgram = other.m_indexProgram;
+    m_initializationProgram = other.m_initializationProgram;
+    m_bitstreamSwitchingProgram = other.m_bitstreamSwitchingProgram;
     return *this;
 }
 
@@ -121,6 +279,10 @@ SegmentTemplate &SegmentTemplate::operator=(SegmentTemplate &&other)
     m_index = std::move(other.m_index);
     m_initialization = std::move(other.m_initialization);
     m_bitstreamSwitching = std::move(other.m_bitstreamSwitching);
+    m_mediaProgram = std::move(other.m_mediaProgram);
+    m_indexProgram = std::move(other.m_indexProgram);
+    m_initializationProgram = std::move(other.m_initializationProgram);
+    m_bitstreamSwitchingProgram = std::move(other.m_bitstreamSwitchingProgram);
     return *this;
 }
 
@@ -136,38 +298,44 @@ bool SegmentTemplate::operator==(const SegmentTemplate &other) const
 
 std::string SegmentTemplate::formatMediaTemplate(const SegmentTemplate::Variables &vars) const
 {
-    std::string ret;
-    if (m_media) {
-        ret = formatTemplate(m_media.value(), vars);
-    }
-    return ret;
+    return formatTemplate(m_media, m_mediaProgram, vars);
 }
 
 std::string SegmentTemplate::formatIndexTemplate(const SegmentTemplate::Variables &vars) const
 {
-    std::string ret;
-    if (m_index) {
-        ret = formatTemplate(m_index.value(), vars);
-    }
-    return ret;
+    return formatTemplate(m_index, m_indexProgram, vars);
 }
 
 std::string SegmentTemplate::formatInitializationTemplate(const SegmentTemplate::Variables &vars) const
 {
-    std::string ret;
-    if (m_initialization) {
-        ret = formatTemplate(m_initialization.value(), vars);
-    }
-    return ret;
+    return formatTemplate(m_initialization, m_initializationProgram, vars);
 }
 
 std::string SegmentTemplate::formatBitstreamSwitchingTemplate(const SegmentTemplate::Variables &vars) const
 {
-    std::string ret;
-    if (m_bitstreamSwitching) {
-        ret = formatTemplate(m_bitstreamSwitching.value(), vars);
-    }
-    return ret;
+    return formatTemplate(m_bitstreamSwitching, m_bitstreamSwitchingProgram, vars);
+}
+
+std::size_t SegmentTemplate::formatMediaTemplate(const SegmentTemplate::Variables &vars, std::span<char> buffer) const noexcept
+{
+    return formatTemplate(m_media, m_mediaProgram, vars, buffer);
+}
+
+std::size_t SegmentTemplate::formatIndexTemplate(const SegmentTemplate::Variables &vars, std::span<char> buffer) const noexcept
+{
+    return formatTemplate(m_index, m_indexProgram, vars, buffer);
+}
+
+std::size_t SegmentTemplate::formatInitializationTemplate(const SegmentTemplate::Variables &vars,
+                                                          std::span<char> buffer) const noexcept
+{
+    return formatTemplate(m_initialization, m_initializationProgram, vars, buffer);
+}
+
+std::size_t SegmentTemplate::formatBitstreamSwitchingTemplate(const SegmentTemplate::Variables &vars,
+                                                              std::span<char> buffer) const noexcept
+{
+    return formatTemplate(m_bitstreamSwitching, m_bitstreamSwitchingProgram, vars, buffer);
 }
 
 /* protected: */
@@ -178,31 +346,19 @@ SegmentTemplate::SegmentTemplate(xmlpp::Node &node)
     ,m_initialization()
     ,m_bitstreamSwitching()
 {
-    xmlpp::Node::NodeSet node_set;
+#define ATTR_STRING(name) {#name, [](SegmentTemplate &st, const std::string &val) { st.m_ ## name = val; }}
 
-    node_set = node.find("@media");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_media = std::string(attr->get_value());
-    }
-
-    node_set = node.find("@index");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_index = std::string(attr->get_value());
-    }
+    static const AttributeTable<SegmentTemplate> attribute_table("SegmentTemplate", {
+        ATTR_STRING(media),
+        ATTR_STRING(index),
+        ATTR_STRING(initialization),
+        ATTR_STRING(bitstreamSwitching)
+    });
 
-    node_set = node.find("@initialization");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_initialization = std::string(attr->get_value());
-    }
+#undef ATTR_STRING
 
-    node_set = node.find("@bitstreamSwitching");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_bitstreamSwitching = std::string(attr->get_value());
-    }
+    attribute_table.apply(*this, node);
+    compileTemplates();
 }
 
 void SegmentTemplate::setXMLElement(xmlpp::Element &elem) const
@@ -222,23 +378,63 @@ void SegmentTemplate::setXMLElement(xmlpp::Element &elem) const
     }
 }
 
+void SegmentTemplate::inheritFrom(const SegmentTemplate &parent)
+{
+    MultipleSegmentBase::inheritFrom(parent);
+
+    // Inherited templates are already compiled, so take the compiled form along with the template text
+    if (!m_media && parent.m_media) {
+        m_media = parent.m_media;
+        m_mediaProgram = parent.m_mediaProgram;
+    }
+    if (!m_index && parent.m_index) {
+        m_index = parent.m_index;
+        m_indexProgram = parent.m_indexProgram;
+    }
+    if (!m_initialization && parent.m_initialization) {
+        m_initialization = parent.m_initialization;
+        m_initializationProgram = parent.m_initializationProgram;
+    }
+    if (!m_bitstreamSwitching && parent.m_bitstreamSwitching) {
+        m_bitstreamSwitching = parent.m_bitstreamSwitching;
+        m_bitstreamSwitchingProgram = parent.m_bitstreamSwitchingProgram;
+    }
+}
+
 // private:
 
-std::string SegmentTemplate::formatTemplate(const std::string &fmt, const SegmentTemplate::Variables &vars) const
+std::string SegmentTemplate::formatTemplate(const std::optional<std::string> &fmt, const Program &program,
+                                            const SegmentTemplate::Variables &vars) const
 {
-    std::string ret(fmt);
-    const auto &start_number = startNumber();
-    for (auto pos = ret.find_first_of('$'); pos != std::string::npos; pos = ret.find_first_of('$', pos+1)) {
-        auto epos = ret.find_first_of('$', pos+1);
-        if (epos == std::string::npos) break;
-        try {
-            ret.replace(pos, epos-pos+1, vars.format(ret.substr(pos, epos-pos+1), start_number));
-        } catch (std::runtime_error &ex) {
-        }
+    std::string ret;
+    if (!fmt) return ret;
+
+    // Allow some room for the substituted values, if that is not enough then format again now the length is known
+    ret.resize(fmt.value().size() + 32);
+    auto length = program.format(fmt.value(), vars, startNumber(), std::span<char>(ret.data(), ret.size()));
+    if (length > ret.size()) {
+        ret.resize(length);
+        program.format(fmt.value(), vars, startNumber(), std::span<char>(ret.data(), ret.size()));
     }
+    ret.resize(length);
     return ret;
 }
 
+std::size_t SegmentTemplate::formatTemplate(const std::optional<std::string> &fmt, const Program &program,
+                                            const SegmentTemplate::Variables &vars, std::span<char> buffer) const noexcept
+{
+    if (!fmt) return 0;
+    return program.format(fmt.value(), vars, startNumber(), buffer);
+}
+
+void SegmentTemplate::compileTemplates()
+{
+    m_mediaProgram = m_media?Program(m_media.value()):Program();
+    m_indexProgram = m_index?Program(m_index.value()):Program();
+    m_initializationProgram = m_initialization?Program(m_initialization.value()):Program();
+    m_bitstreamSwitchingProgram = m_bitstreamSwitching?Program(m_bitstreamSwitching.value()):Program();
+}
+
 LIBMPDPP_NAMESPACE_END
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
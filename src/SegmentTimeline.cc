@@ -8,8 +8,10 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <algorithm>
 #include <chrono>
 #include <optional>
+#include <string>
 
 #include <libxml++/libxml++.h>
 
@@ -21,6 +23,7 @@
 
 #include "constants.hh"
 #include "conversions.hh"
+#include "parse_tables.hh"
 
 #include "libmpd++/SegmentTimeline.hh"
 
@@ -95,60 +98,91 @@ SegmentTimeline::S::S(xmlpp::Node &node)
     ,m_r(0)
     ,m_k(1)
 {
-    xmlpp::Node::NodeSet node_set;
+    static const AttributeTable<S> attribute_table("SegmentTimeline/S", {
+        {"t", [](S &s, const std::string &val) { s.m_t = std::stoul(val); }},
+        {"n", [](S &s, const std::string &val) { s.m_n = std::stoul(val); }},
+        {"d", [](S &s, const std::string &val) { s.m_d = std::stoul(val); }, true},
+        {"r", [](S &s, const std::string &val) { s.m_r = std::stoi(val); }},
+        {"k", [](S &s, const std::string &val) { s.m_k = std::stoul(val); }}
+    });
+
+    attribute_table.apply(*this, node);
+}
 
-    node_set = node.find("@t");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_t = std::stoul(std::string(attr->get_value()));
-    }
+void SegmentTimeline::S::setXMLElement(xmlpp::Element &elem) const
+{
+    if (m_t) elem.set_attribute("t", std::to_string(m_t.value()));
+    if (m_n) elem.set_attribute("n", std::to_string(m_n.value()));
+    elem.set_attribute("d", std::to_string(m_d));
+    if (m_r != 0) elem.set_attribute("r", std::to_string(m_r));
+    if (m_k != 1) elem.set_attribute("k", std::to_string(m_k));
+}
 
-    node_set = node.find("@n");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_n = std::stoul(std::string(attr->get_value()));
-    }
+/******** SegmentTimeline ********/
 
-    node_set = node.find("@d");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_d = std::stoul(std::string(attr->get_value()));
-    } else {
-        throw ParseError("SegmentTimeline/S must have a \"d\" attribute");
-    }
+SegmentTimeline &SegmentTimeline::sLineAdd(const S &s)
+{
+    m_sLines.push_back(s);
+    buildIndex();
+    return *this;
+}
 
-    node_set = node.find("@r");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_r = std::stoi(std::string(attr->get_value()));
-    }
+SegmentTimeline &SegmentTimeline::sLineAdd(S &&s)
+{
+    m_sLines.push_back(std::move(s));
+    buildIndex();
+    return *this;
+}
 
-    node_set = node.find("@k");
-    if (node_set.size() > 0) {
-        xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_k = std::stoul(std::string(attr->get_value()));
-    }
+std::optional<unsigned long> SegmentTimeline::segmentCount(const std::optional<unsigned long> &end_time) const
+{
+    if (m_runs.empty()) return 0;
+    const Run &last = m_runs.back();
+    if (last.count != 0) return last.firstIndex + last.count;
+    if (!end_time) return std::nullopt;
+    if (end_time.value() <= last.startTime || last.duration == 0) return last.firstIndex;
+    return last.firstIndex + (end_time.value() - last.startTime + last.duration - 1) / last.duration;
 }
 
-void SegmentTimeline::S::setXMLElement(xmlpp::Element &elem) const
+unsigned long SegmentTimeline::segmentStartTime(unsigned long segment_index) const
 {
+    if (m_runs.empty()) return 0;
+    auto it = findRunForIndex(segment_index);
+    return it->startTime + (segment_index - it->firstIndex) * it->duration;
 }
 
-/******** SegmentTimeline ********/
+unsigned long SegmentTimeline::segmentDuration(unsigned long segment_index) const
+{
+    if (m_runs.empty()) return 0;
+    return findRunForIndex(segment_index)->duration;
+}
+
+unsigned long SegmentTimeline::segmentIndexForTime(unsigned long media_time) const
+{
+    // Find the last run starting at or before media_time
+    auto it = std::upper_bound(m_runs.begin(), m_runs.end(), media_time, [](unsigned long time, const Run &run) {
+        return time < run.startTime;
+    });
+    if (it == m_runs.begin()) return 0;
+    --it;
+    if (it->duration == 0) return it->firstIndex;
+    auto offset = (media_time - it->startTime) / it->duration;
+    if (it->count != 0 && offset >= it->count) return it->firstIndex + it->count; // in a gap or after the end
+    return it->firstIndex + offset;
+}
 
 // protected:
 
 SegmentTimeline::SegmentTimeline(xmlpp::Node &node)
     :m_sLines()
+    ,m_runs()
 {
-    static const xmlpp::Node::PrefixNsMap ns_map = {
-        {"mpd", MPD_NS}
-    };
-    xmlpp::Node::NodeSet node_set = node.find("mpd:S", ns_map);
+    static const ElementTable<SegmentTimeline> element_table({
+        {"S", [](SegmentTimeline &timeline, xmlpp::Node &child) { timeline.m_sLines.push_back(S(child)); }}
+    });
 
-    for (auto node : node_set) {
-        m_sLines.push_back(S(*node));
-    }
+    element_table.apply(*this, node);
+    buildIndex();
 }
 
 void SegmentTimeline::setXMLElement(xmlpp::Element &elem) const
@@ -159,6 +193,44 @@ void SegmentTimeline::setXMLElement(xmlpp::Element &elem) const
     }
 }
 
+// private:
+
+std::vector<SegmentTimeline::Run, TreeAllocator<SegmentTimeline::Run> >::const_iterator
+SegmentTimeline::findRunForIndex(unsigned long segment_index) const
+{
+    // The first run always starts at index 0, so this finds the last run starting at or before segment_index
+    auto it = std::upper_bound(m_runs.begin(), m_runs.end(), segment_index, [](unsigned long index, const Run &run) {
+        return index < run.firstIndex;
+    });
+    return std::prev(it);
+}
+
+void SegmentTimeline::buildIndex()
+{
+    m_runs.clear();
+    m_runs.reserve(m_sLines.size());
+    unsigned long time = 0;
+    unsigned long index = 0;
+    for (decltype(m_sLines)::size_type i = 0; i < m_sLines.size(); i++) {
+        const S &s = m_sLines[i];
+        if (s.m_t) time = s.m_t.value();
+        unsigned long count = 1;
+        if (s.m_r > 0) {
+            count += static_cast<unsigned long>(s.m_r);
+        } else if (s.m_r < 0 && s.m_d > 0) {
+            // @r of -1 repeats until the next S@t, or until the end of the Period for the last S
+            if (i + 1 == m_sLines.size()) {
+                count = 0;
+            } else if (m_sLines[i + 1].m_t && m_sLines[i + 1].m_t.value() > time) {
+                count = (m_sLines[i + 1].m_t.value() - time + s.m_d - 1) / s.m_d;
+            }
+        }
+        m_runs.push_back(Run{time, s.m_d, index, count});
+        time += count * s.m_d;
+        index += count;
+    }
+}
+
 LIBMPDPP_NAMESPACE_END
 
 /* vim:ts=8:sts=4:sw=4:expandtab:
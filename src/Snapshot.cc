@@ -0,0 +1,1043 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: SnapshotReader and SnapshotWriter classes
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "libmpd++/macros.hh"
+#include "libmpd++/exceptions.hh"
+#include "libmpd++/AdaptationSet.hh"
+#include "libmpd++/BaseURL.hh"
+#include "libmpd++/Codecs.hh"
+#include "libmpd++/ContentComponent.hh"
+#include "libmpd++/ContentPopularityRate.hh"
+#include "libmpd++/ContentProtection.hh"
+#include "libmpd++/Descriptor.hh"
+#include "libmpd++/EventStream.hh"
+#include "libmpd++/ExtendedBandwidth.hh"
+#include "libmpd++/FailoverContent.hh"
+#include "libmpd++/FrameRate.hh"
+#include "libmpd++/InitializationSet.hh"
+#include "libmpd++/Label.hh"
+#include "libmpd++/LeapSecondInformation.hh"
+#include "libmpd++/Metrics.hh"
+#include "libmpd++/MPD.hh"
+#include "libmpd++/MultipleSegmentBase.hh"
+#include "libmpd++/PatchLocation.hh"
+#include "libmpd++/Period.hh"
+#include "libmpd++/Preselection.hh"
+#include "libmpd++/ProducerReferenceTime.hh"
+#include "libmpd++/ProgramInformation.hh"
+#include "libmpd++/RandomAccess.hh"
+#include "libmpd++/Ratio.hh"
+#include "libmpd++/Representation.hh"
+#include "libmpd++/RepresentationBase.hh"
+#include "libmpd++/Resync.hh"
+#include "libmpd++/RFC6838ContentType.hh"
+#include "libmpd++/SAP.hh"
+#include "libmpd++/SegmentBase.hh"
+#include "libmpd++/SegmentList.hh"
+#include "libmpd++/SegmentTemplate.hh"
+#include "libmpd++/SegmentTimeline.hh"
+#include "libmpd++/SegmentURL.hh"
+#include "libmpd++/ServiceDescription.hh"
+#include "libmpd++/SingleRFC7233Range.hh"
+#include "libmpd++/SubRepresentation.hh"
+#include "libmpd++/Subset.hh"
+#include "libmpd++/Switching.hh"
+#include "libmpd++/UIntVWithID.hh"
+#include "libmpd++/URI.hh"
+#include "libmpd++/URL.hh"
+#include "libmpd++/XLink.hh"
+
+#include "Snapshot.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/**************** SnapshotWriter ****************/
+
+void SnapshotWriter::writeSnapshot(const MPD &mpd)
+{
+    writeBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writeUnsigned(SNAPSHOT_VERSION);
+    write(mpd);
+}
+
+void SnapshotWriter::writeUnsigned(std::uint64_t val)
+{
+    while (val >= 0x80) {
+        m_buffer.push_back(static_cast<unsigned char>(val | 0x80));
+        val >>= 7;
+    }
+    m_buffer.push_back(static_cast<unsigned char>(val));
+}
+
+void SnapshotWriter::writeSigned(std::int64_t val)
+{
+    writeUnsigned((static_cast<std::uint64_t>(val) << 1) ^ static_cast<std::uint64_t>(val >> 63));
+}
+
+void SnapshotWriter::writeBytes(const void *data, std::size_t length)
+{
+    auto bytes = reinterpret_cast<const unsigned char*>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + length);
+}
+
+void SnapshotWriter::write(double val)
+{
+    auto bits = std::bit_cast<std::uint64_t>(val);
+    for (int i = 0; i < 8; i++, bits >>= 8) {
+        m_buffer.push_back(static_cast<unsigned char>(bits & 0xff));
+    }
+}
+
+void SnapshotWriter::write(const std::string &val)
+{
+    writeUnsigned(val.size());
+    writeBytes(val.data(), val.size());
+}
+
+void SnapshotWriter::write(const std::chrono::system_clock::time_point &val)
+{
+    writeSigned(std::chrono::duration_cast<std::chrono::nanoseconds>(val.time_since_epoch()).count());
+}
+
+void SnapshotWriter::write(const MPD &mpd)
+{
+    write(mpd.m_id);
+    write(mpd.m_profiles);
+    writeUnsigned(mpd.m_type);
+    write(mpd.m_availabilityStartTime);
+    write(mpd.m_availabilityEndTime);
+    write(mpd.m_publishTime);
+    write(mpd.m_mediaPresentationDuration);
+    write(mpd.m_minimumUpdatePeriod);
+    write(mpd.m_minBufferTime);
+    write(mpd.m_timeShiftBufferDepth);
+    write(mpd.m_suggestedPresentationDelay);
+    write(mpd.m_maxSegmentDuration);
+    write(mpd.m_maxSubsegmentDuration);
+    write(mpd.m_programInformations);
+    write(mpd.m_baseURLs);
+    write(mpd.m_locations);
+    write(mpd.m_patchLocations);
+    write(mpd.m_serviceDescriptions);
+    write(mpd.m_initializationSets);
+    write(mpd.m_initializationGroups);
+    write(mpd.m_initializationPresentations);
+    write(mpd.m_contentProtections);
+    write(mpd.m_periods);
+    write(mpd.m_metrics);
+    write(mpd.m_essentialProperties);
+    write(mpd.m_supplementaryProperties);
+    write(mpd.m_utcTimings);
+    write(mpd.m_leapSecondInformation);
+    write(mpd.m_mpdURL);
+}
+
+void SnapshotWriter::write(const Period &period)
+{
+    period.materialise();
+    write(period.m_xlink);
+    write(period.m_id);
+    write(period.m_start);
+    write(period.m_duration);
+    write(period.m_bitstreamSwitching);
+    write(period.m_baseURLs);
+    write(period.m_segmentBase);
+    write(period.m_segmentList);
+    write(period.m_segmentTemplate);
+    write(period.m_assetIdentifier);
+    write(period.m_eventStreams);
+    write(period.m_serviceDescriptions);
+    write(period.m_contentProtections);
+    write(period.m_adaptationSets);
+    write(period.m_subsets);
+    write(period.m_supplementalProperties);
+    write(period.m_emptyAdaptationSets);
+    write(period.m_groupLabels);
+    write(period.m_preselections);
+}
+
+void SnapshotWriter::write(const AdaptationSet &adapt_set)
+{
+    write(static_cast<const RepresentationBase&>(adapt_set));
+    write(adapt_set.m_xlink);
+    write(adapt_set.m_id);
+    write(adapt_set.m_group);
+    write(adapt_set.m_lang);
+    write(adapt_set.m_contentType);
+    write(adapt_set.m_par);
+    write(adapt_set.m_minBandwidth);
+    write(adapt_set.m_maxBandwidth);
+    write(adapt_set.m_minWidth);
+    write(adapt_set.m_maxWidth);
+    write(adapt_set.m_minHeight);
+    write(adapt_set.m_maxHeight);
+    write(adapt_set.m_minFrameRate);
+    write(adapt_set.m_maxFrameRate);
+    write(adapt_set.m_segmentAlignment);
+    write(adapt_set.m_subsegmentAlignment);
+    write(adapt_set.m_subsegmentStartsWithSAP);
+    write(adapt_set.m_bitstreamSwitching);
+    write(adapt_set.m_initializationSetRefs);
+    write(adapt_set.m_initializationPrincipal);
+    write(adapt_set.m_accessibilities);
+    write(adapt_set.m_roles);
+    write(adapt_set.m_ratings);
+    write(adapt_set.m_viewpoints);
+    write(adapt_set.m_contentComponents);
+    write(adapt_set.m_baseURLs);
+    write(adapt_set.m_segmentBase);
+    write(adapt_set.m_segmentList);
+    write(adapt_set.m_segmentTemplate);
+    write(adapt_set.m_representations);
+
+    // Selected Representations as indexes into m_representations
+    std::list<unsigned long> selected;
+    unsigned long idx = 0;
+    for (const auto &rep : adapt_set.m_representations) {
+        if (adapt_set.m_selectedRepresentations.contains(&rep)) selected.push_back(idx);
+        idx++;
+    }
+    write(selected);
+}
+
+void SnapshotWriter::write(const Representation &rep)
+{
+    write(static_cast<const RepresentationBase&>(rep));
+    write(rep.m_id);
+    write(rep.m_bandwidth);
+    write(rep.m_qualityRanking);
+    write(rep.m_dependencyIds);
+    write(rep.m_associationIds);
+    write(rep.m_associationTypes);
+    write(rep.m_mediaStreamStructureIds);
+    write(rep.m_baseURLs);
+    write(rep.m_extendedBandwidths);
+    write(rep.m_subRepresentations);
+    write(rep.m_segmentBase);
+    write(rep.m_segmentList);
+    write(rep.m_segmentTemplate);
+}
+
+void SnapshotWriter::write(const SubRepresentation &sub_rep)
+{
+    write(static_cast<const RepresentationBase&>(sub_rep));
+    write(sub_rep.m_level);
+    write(sub_rep.m_dependencyLevel);
+    write(sub_rep.m_bandwidth);
+    write(sub_rep.m_contentComponent);
+}
+
+void SnapshotWriter::write(const RepresentationBase &rep_base)
+{
+    write(rep_base.m_profiles);
+    write(rep_base.m_width);
+    write(rep_base.m_height);
+    write(rep_base.m_sar);
+    write(rep_base.m_frameRate);
+    write(rep_base.m_audioSamplingRates);
+    write(rep_base.m_mimeType);
+    write(rep_base.m_segmentProfiles);
+    write(rep_base.m_codecs);
+    write(rep_base.m_containerProfiles);
+    write(rep_base.m_maximumSAPPeriod);
+    write(rep_base.m_startWithSAP);
+    write(rep_base.m_maxPlayoutRate);
+    write(rep_base.m_codingDependency);
+    write(rep_base.m_scanType.has_value());
+    if (rep_base.m_scanType) writeUnsigned(rep_base.m_scanType.value());
+    write(rep_base.m_selectionPriority);
+    write(rep_base.m_tag);
+    write(rep_base.m_framePackings);
+    write(rep_base.m_audioChannelConfigurations);
+    write(rep_base.m_contentProtections);
+    write(rep_base.m_outputProtection);
+    write(rep_base.m_essentialProperties);
+    write(rep_base.m_supplementalProperties);
+    write(rep_base.m_inbandEventStreams);
+    write(rep_base.m_switchings);
+    write(rep_base.m_randomAccesses);
+    write(rep_base.m_groupLabels);
+    write(rep_base.m_labels);
+    write(rep_base.m_producerReferenceTimes);
+    write(rep_base.m_contentPopularityRates);
+    write(rep_base.m_resyncs);
+}
+
+void SnapshotWriter::write(const SegmentBase &seg_base)
+{
+    write(seg_base.m_timescale);
+    write(seg_base.m_eptDelta);
+    write(seg_base.m_pdDelta);
+    write(seg_base.m_presentationTimeOffset);
+    write(seg_base.m_presentationDuration);
+    write(seg_base.m_timeShiftBufferDepth);
+    write(seg_base.m_indexRange);
+    write(seg_base.m_indexRangeExact);
+    write(seg_base.m_availabilityTimeOffset);
+    write(seg_base.m_availabilityTimeComplete);
+    write(seg_base.m_initialization);
+    write(seg_base.m_representationIndex);
+    write(seg_base.m_failoverContent);
+}
+
+void SnapshotWriter::write(const MultipleSegmentBase &multi_seg_base)
+{
+    write(static_cast<const SegmentBase&>(multi_seg_base));
+    write(multi_seg_base.m_duration);
+    write(multi_seg_base.m_startNumber);
+    write(multi_seg_base.m_endNumber);
+    write(multi_seg_base.m_segmentTimeline);
+    write(multi_seg_base.m_bitstreamSwitching);
+}
+
+void SnapshotWriter::write(const SegmentTemplate &seg_template)
+{
+    write(static_cast<const MultipleSegmentBase&>(seg_template));
+    write(seg_template.m_media);
+    write(seg_template.m_index);
+    write(seg_template.m_initialization);
+    write(seg_template.m_bitstreamSwitching);
+}
+
+void SnapshotWriter::write(const SegmentList &seg_list)
+{
+    write(static_cast<const MultipleSegmentBase&>(seg_list));
+    write(seg_list.m_xLink);
+    write(seg_list.m_segmentURLs);
+}
+
+void SnapshotWriter::write(const SegmentTimeline &seg_timeline)
+{
+    write(seg_timeline.m_sLines);
+}
+
+void SnapshotWriter::write(const SegmentTimeline::S &s)
+{
+    write(s.m_t);
+    write(s.m_n);
+    write(s.m_d);
+    write(s.m_r);
+    write(s.m_k);
+}
+
+void SnapshotWriter::write(const SegmentURL &seg_url)
+{
+    write(seg_url.m_media);
+    write(seg_url.m_mediaRange);
+    write(seg_url.m_index);
+    write(seg_url.m_indexRange);
+}
+
+void SnapshotWriter::write(const URL &url)
+{
+    write(url.m_sourceURL);
+    write(url.m_range);
+}
+
+void SnapshotWriter::write(const BaseURL &base_url)
+{
+    write(static_cast<const URI&>(base_url));
+    write(base_url.m_serviceLocation);
+    write(base_url.m_byteRange);
+    write(base_url.m_availabilityTimeOffset);
+    write(base_url.m_availabilityTimeComplete);
+    write(base_url.m_timeShiftBufferDepth);
+    write(base_url.m_rangeAccess);
+}
+
+void SnapshotWriter::write(const URI &uri)
+{
+    write(uri.m_uri);
+}
+
+void SnapshotWriter::write(const PatchLocation &patch_location)
+{
+    write(static_cast<const URI&>(patch_location));
+}
+
+void SnapshotWriter::write(const Descriptor &descriptor)
+{
+    write(descriptor.m_schemeIdUri);
+    write(descriptor.m_value);
+    write(descriptor.m_id);
+}
+
+void SnapshotWriter::write(const ContentProtection &content_protection)
+{
+    write(static_cast<const Descriptor&>(content_protection));
+    write(content_protection.m_robustness);
+    write(content_protection.m_refId);
+    write(content_protection.m_ref);
+}
+
+void SnapshotWriter::write(const Codecs &codecs)
+{
+    write(codecs.encoding());
+    write(codecs.codecs());
+}
+
+void SnapshotWriter::write(const Codecs::Encoding &encoding)
+{
+    write(static_cast<std::string>(encoding));
+}
+
+void SnapshotWriter::write(const ContentPopularityRate &content_popularity_rate)
+{
+    write(content_popularity_rate.m_prs);
+}
+
+void SnapshotWriter::write(const ContentPopularityRate::PR &pr)
+{
+    write(pr.m_popularityRate);
+    write(pr.m_start);
+    write(pr.m_r);
+}
+
+void SnapshotWriter::write(const FrameRate &frame_rate)
+{
+    writeUnsigned(frame_rate.m_numerator);
+    writeUnsigned(frame_rate.m_denominator);
+}
+
+void SnapshotWriter::write(const Ratio &ratio)
+{
+    writeUnsigned(ratio.m_numerator);
+    writeUnsigned(ratio.m_denominator);
+}
+
+void SnapshotWriter::write(const SingleRFC7233Range &range)
+{
+    writeUnsigned(range.m_fromByte);
+    write(range.m_toByte.has_value());
+    if (range.m_toByte) writeUnsigned(range.m_toByte.value());
+}
+
+void SnapshotWriter::write(const XLink &xlink)
+{
+    write(xlink.m_href);
+    writeUnsigned(xlink.m_actuate);
+    writeUnsigned(xlink.m_type);
+    writeUnsigned(xlink.m_show);
+}
+
+void SnapshotWriter::write(const UIntVWithID &uints)
+{
+    write(static_cast<const std::list<unsigned int>&>(uints));
+    write(uints.m_id);
+    write(uints.m_profiles);
+    write(uints.m_contentType);
+}
+
+void SnapshotWriter::write(const Label &label)
+{
+    write(static_cast<const std::string&>(label));
+    write(label.m_id);
+    write(label.m_lang);
+    write(label.m_label);
+}
+
+void SnapshotWriter::write(const ProgramInformation &program_info)
+{
+    write(program_info.m_lang);
+    write(program_info.m_moreInformationURL);
+    write(program_info.m_title);
+    write(program_info.m_source);
+    write(program_info.m_copyright);
+}
+
+void SnapshotWriter::write(const SAP &sap)
+{
+    write(sap.m_value);
+}
+
+void SnapshotWriter::write(const RFC6838ContentType &content_type)
+{
+    write(content_type.m_value);
+}
+
+void SnapshotWriter::write(const InitializationSet &init_set)
+{
+    write(static_cast<const RepresentationBase&>(init_set));
+}
+
+void SnapshotWriter::write(const Preselection &preselection)
+{
+    write(static_cast<const RepresentationBase&>(preselection));
+}
+
+/**************** SnapshotReader ****************/
+
+void SnapshotReader::readSnapshot(MPD &mpd)
+{
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    readBytes(magic, sizeof(magic));
+    if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) throw ParseError("Data is not an MPD snapshot");
+    auto version = readUnsigned();
+    if (version != SNAPSHOT_VERSION) {
+        throw ParseError("MPD snapshot version " + std::to_string(version) + " is not supported, expected version " +
+                         std::to_string(SNAPSHOT_VERSION));
+    }
+    read(mpd);
+    if (m_pos != m_end) throw ParseError("Unexpected data at the end of the MPD snapshot");
+}
+
+std::uint64_t SnapshotReader::readUnsigned()
+{
+    std::uint64_t val = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (m_pos == m_end) throw ParseError("MPD snapshot is truncated");
+        auto byte = *m_pos++;
+        val |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return val;
+    }
+    throw ParseError("MPD snapshot contains an invalid integer value");
+}
+
+std::int64_t SnapshotReader::readSigned()
+{
+    auto val = readUnsigned();
+    return static_cast<std::int64_t>((val >> 1) ^ (~(val & 1) + 1));
+}
+
+void SnapshotReader::readBytes(void *data, std::size_t length)
+{
+    if (static_cast<std::size_t>(m_end - m_pos) < length) throw ParseError("MPD snapshot is truncated");
+    std::memcpy(data, m_pos, length);
+    m_pos += length;
+}
+
+std::size_t SnapshotReader::readCount()
+{
+    auto count = readUnsigned();
+    if (count > static_cast<std::uint64_t>(m_end - m_pos)) throw ParseError("MPD snapshot is truncated");
+    return static_cast<std::size_t>(count);
+}
+
+void SnapshotReader::read(bool &val)
+{
+    if (m_pos == m_end) throw ParseError("MPD snapshot is truncated");
+    auto byte = *m_pos++;
+    if (byte > 1) throw ParseError("MPD snapshot contains an invalid boolean value");
+    val = (byte != 0);
+}
+
+void SnapshotReader::read(int &val)
+{
+    auto sval = readSigned();
+    if (sval < std::numeric_limits<int>::min() || sval > std::numeric_limits<int>::max()) {
+        throw ParseError("MPD snapshot value out of range");
+    }
+    val = static_cast<int>(sval);
+}
+
+void SnapshotReader::read(double &val)
+{
+    unsigned char bytes[8];
+    readBytes(bytes, sizeof(bytes));
+    std::uint64_t bits = 0;
+    for (int i = 7; i >= 0; i--) {
+        bits = (bits << 8) | bytes[i];
+    }
+    val = std::bit_cast<double>(bits);
+}
+
+void SnapshotReader::read(std::string &val)
+{
+    auto length = readCount();
+    val.assign(reinterpret_cast<const char*>(m_pos), length);
+    m_pos += length;
+}
+
+void SnapshotReader::read(std::chrono::system_clock::time_point &val)
+{
+    std::chrono::nanoseconds since_epoch(readSigned());
+    val = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(since_epoch));
+}
+
+void SnapshotReader::readPlaceholder()
+{
+    if (readUnsigned() != 0) throw ParseError("MPD snapshot contains data for an unsupported element");
+}
+
+void SnapshotReader::read(std::list<Period> &periods)
+{
+    periods.clear();
+    for (auto count = readCount(); count > 0; count--) {
+        read(periods.emplace_back());
+    }
+}
+
+void SnapshotReader::read(std::list<AdaptationSet> &adapt_sets)
+{
+    adapt_sets.clear();
+    for (auto count = readCount(); count > 0; count--) {
+        read(adapt_sets.emplace_back());
+    }
+}
+
+void SnapshotReader::read(std::list<Representation> &reps)
+{
+    reps.clear();
+    for (auto count = readCount(); count > 0; count--) {
+        read(reps.emplace_back());
+    }
+}
+
+void SnapshotReader::read(MPD &mpd)
+{
+    read(mpd.m_id);
+    read(mpd.m_profiles);
+    mpd.m_type = readEnum(MPD::DYNAMIC);
+    read(mpd.m_availabilityStartTime);
+    read(mpd.m_availabilityEndTime);
+    read(mpd.m_publishTime);
+    read(mpd.m_mediaPresentationDuration);
+    read(mpd.m_minimumUpdatePeriod);
+    read(mpd.m_minBufferTime);
+    read(mpd.m_timeShiftBufferDepth);
+    read(mpd.m_suggestedPresentationDelay);
+    read(mpd.m_maxSegmentDuration);
+    read(mpd.m_maxSubsegmentDuration);
+    read(mpd.m_programInformations);
+    read(mpd.m_baseURLs);
+    read(mpd.m_locations);
+    read(mpd.m_patchLocations);
+    read(mpd.m_serviceDescriptions);
+    read(mpd.m_initializationSets);
+    read(mpd.m_initializationGroups);
+    read(mpd.m_initializationPresentations);
+    read(mpd.m_contentProtections);
+    read(mpd.m_periods);
+    read(mpd.m_metrics);
+    read(mpd.m_essentialProperties);
+    read(mpd.m_supplementaryProperties);
+    read(mpd.m_utcTimings);
+    read(mpd.m_leapSecondInformation);
+    read(mpd.m_mpdURL);
+
+    mpd.relinkPeriods();
+}
+
+void SnapshotReader::read(Period &period)
+{
+    read(period.m_xlink);
+    read(period.m_id);
+    read(period.m_start);
+    read(period.m_duration);
+    read(period.m_bitstreamSwitching);
+    read(period.m_baseURLs);
+    read(period.m_segmentBase);
+    read(period.m_segmentList);
+    read(period.m_segmentTemplate);
+    read(period.m_assetIdentifier);
+    read(period.m_eventStreams);
+    read(period.m_serviceDescriptions);
+    read(period.m_contentProtections);
+    read(period.m_adaptationSets);
+    read(period.m_subsets);
+    read(period.m_supplementalProperties);
+    read(period.m_emptyAdaptationSets);
+    read(period.m_groupLabels);
+    read(period.m_preselections);
+
+    for (auto &adapt_set : period.m_adaptationSets) {
+        adapt_set.setPeriod(&period);
+    }
+    for (auto &adapt_set : period.m_emptyAdaptationSets) {
+        adapt_set.setPeriod(&period);
+    }
+}
+
+void SnapshotReader::read(AdaptationSet &adapt_set)
+{
+    read(static_cast<RepresentationBase&>(adapt_set));
+    read(adapt_set.m_xlink);
+    read(adapt_set.m_id);
+    read(adapt_set.m_group);
+    read(adapt_set.m_lang);
+    read(adapt_set.m_contentType);
+    read(adapt_set.m_par);
+    read(adapt_set.m_minBandwidth);
+    read(adapt_set.m_maxBandwidth);
+    read(adapt_set.m_minWidth);
+    read(adapt_set.m_maxWidth);
+    read(adapt_set.m_minHeight);
+    read(adapt_set.m_maxHeight);
+    read(adapt_set.m_minFrameRate);
+    read(adapt_set.m_maxFrameRate);
+    read(adapt_set.m_segmentAlignment);
+    read(adapt_set.m_subsegmentAlignment);
+    read(adapt_set.m_subsegmentStartsWithSAP);
+    read(adapt_set.m_bitstreamSwitching);
+    read(adapt_set.m_initializationSetRefs);
+    read(adapt_set.m_initializationPrincipal);
+    read(adapt_set.m_accessibilities);
+    read(adapt_set.m_roles);
+    read(adapt_set.m_ratings);
+    read(adapt_set.m_viewpoints);
+    read(adapt_set.m_contentComponents);
+    read(adapt_set.m_baseURLs);
+    read(adapt_set.m_segmentBase);
+    read(adapt_set.m_segmentList);
+    read(adapt_set.m_segmentTemplate);
+    read(adapt_set.m_representations);
+
+    std::vector<const Representation*> reps;
+    reps.reserve(adapt_set.m_representations.size());
+    for (auto &rep : adapt_set.m_representations) {
+        rep.setAdaptationSet(&adapt_set);
+        reps.push_back(&rep);
+    }
+
+    adapt_set.m_selectedRepresentations.clear();
+    for (auto count = readCount(); count > 0; count--) {
+        auto idx = readUnsigned();
+        if (idx >= reps.size()) throw ParseError("MPD snapshot selects a Representation that does not exist");
+        adapt_set.m_selectedRepresentations.insert(reps[idx]);
+    }
+}
+
+void SnapshotReader::read(Representation &rep)
+{
+    read(static_cast<RepresentationBase&>(rep));
+    read(rep.m_id);
+    read(rep.m_bandwidth);
+    read(rep.m_qualityRanking);
+    read(rep.m_dependencyIds);
+    read(rep.m_associationIds);
+    read(rep.m_associationTypes);
+    read(rep.m_mediaStreamStructureIds);
+    read(rep.m_baseURLs);
+    read(rep.m_extendedBandwidths);
+    read(rep.m_subRepresentations);
+    read(rep.m_segmentBase);
+    read(rep.m_segmentList);
+    read(rep.m_segmentTemplate);
+}
+
+void SnapshotReader::read(SubRepresentation &sub_rep)
+{
+    read(static_cast<RepresentationBase&>(sub_rep));
+    read(sub_rep.m_level);
+    read(sub_rep.m_dependencyLevel);
+    read(sub_rep.m_bandwidth);
+    read(sub_rep.m_contentComponent);
+}
+
+void SnapshotReader::read(RepresentationBase &rep_base)
+{
+    read(rep_base.m_profiles);
+    read(rep_base.m_width);
+    read(rep_base.m_height);
+    read(rep_base.m_sar);
+    read(rep_base.m_frameRate);
+    read(rep_base.m_audioSamplingRates);
+    read(rep_base.m_mimeType);
+    read(rep_base.m_segmentProfiles);
+    read(rep_base.m_codecs);
+    read(rep_base.m_containerProfiles);
+    read(rep_base.m_maximumSAPPeriod);
+    read(rep_base.m_startWithSAP);
+    read(rep_base.m_maxPlayoutRate);
+    read(rep_base.m_codingDependency);
+    bool have_scan_type;
+    read(have_scan_type);
+    if (have_scan_type) {
+        rep_base.m_scanType = readEnum(RepresentationBase::VIDEO_SCAN_UNKNOWN);
+    } else {
+        rep_base.m_scanType.reset();
+    }
+    read(rep_base.m_selectionPriority);
+    read(rep_base.m_tag);
+    read(rep_base.m_framePackings);
+    read(rep_base.m_audioChannelConfigurations);
+    read(rep_base.m_contentProtections);
+    read(rep_base.m_outputProtection);
+    read(rep_base.m_essentialProperties);
+    read(rep_base.m_supplementalProperties);
+    read(rep_base.m_inbandEventStreams);
+    read(rep_base.m_switchings);
+    read(rep_base.m_randomAccesses);
+    read(rep_base.m_groupLabels);
+    read(rep_base.m_labels);
+    read(rep_base.m_producerReferenceTimes);
+    read(rep_base.m_contentPopularityRates);
+    read(rep_base.m_resyncs);
+}
+
+void SnapshotReader::read(SegmentBase &seg_base)
+{
+    read(seg_base.m_timescale);
+    read(seg_base.m_eptDelta);
+    read(seg_base.m_pdDelta);
+    read(seg_base.m_presentationTimeOffset);
+    read(seg_base.m_presentationDuration);
+    read(seg_base.m_timeShiftBufferDepth);
+    read(seg_base.m_indexRange);
+    read(seg_base.m_indexRangeExact);
+    read(seg_base.m_availabilityTimeOffset);
+    read(seg_base.m_availabilityTimeComplete);
+    read(seg_base.m_initialization);
+    read(seg_base.m_representationIndex);
+    read(seg_base.m_failoverContent);
+}
+
+void SnapshotReader::read(MultipleSegmentBase &multi_seg_base)
+{
+    read(static_cast<SegmentBase&>(multi_seg_base));
+    read(multi_seg_base.m_duration);
+    read(multi_seg_base.m_startNumber);
+    read(multi_seg_base.m_endNumber);
+    read(multi_seg_base.m_segmentTimeline);
+    read(multi_seg_base.m_bitstreamSwitching);
+}
+
+void SnapshotReader::read(SegmentTemplate &seg_template)
+{
+    read(static_cast<MultipleSegmentBase&>(seg_template));
+    read(seg_template.m_media);
+    read(seg_template.m_index);
+    read(seg_template.m_initialization);
+    read(seg_template.m_bitstreamSwitching);
+    seg_template.compileTemplates();
+}
+
+void SnapshotReader::read(SegmentList &seg_list)
+{
+    read(static_cast<MultipleSegmentBase&>(seg_list));
+    read(seg_list.m_xLink);
+    read(seg_list.m_segmentURLs);
+}
+
+void SnapshotReader::read(SegmentTimeline &seg_timeline)
+{
+    read(seg_timeline.m_sLines);
+    seg_timeline.buildIndex();
+}
+
+void SnapshotReader::read(SegmentTimeline::S &s)
+{
+    read(s.m_t);
+    read(s.m_n);
+    read(s.m_d);
+    read(s.m_r);
+    read(s.m_k);
+}
+
+void SnapshotReader::read(SegmentURL &seg_url)
+{
+    read(seg_url.m_media);
+    read(seg_url.m_mediaRange);
+    read(seg_url.m_index);
+    read(seg_url.m_indexRange);
+}
+
+void SnapshotReader::read(URL &url)
+{
+    read(url.m_sourceURL);
+    read(url.m_range);
+}
+
+void SnapshotReader::read(BaseURL &base_url)
+{
+    read(static_cast<URI&>(base_url));
+    read(base_url.m_serviceLocation);
+    read(base_url.m_byteRange);
+    read(base_url.m_availabilityTimeOffset);
+    read(base_url.m_availabilityTimeComplete);
+    read(base_url.m_timeShiftBufferDepth);
+    read(base_url.m_rangeAccess);
+}
+
+void SnapshotReader::read(URI &uri)
+{
+    read(uri.m_uri);
+    // Validate to find the component offsets again, this also catches corrupted URI strings
+    try {
+        uri.validate();
+    } catch (std::domain_error &ex) {
+        throw ParseError("Snapshot contains an invalid URI");
+    }
+}
+
+void SnapshotReader::read(PatchLocation &patch_location)
+{
+    read(static_cast<URI&>(patch_location));
+}
+
+void SnapshotReader::read(Descriptor &descriptor)
+{
+    read(descriptor.m_schemeIdUri);
+    read(descriptor.m_value);
+    read(descriptor.m_id);
+}
+
+void SnapshotReader::read(ContentProtection &content_protection)
+{
+    read(static_cast<Descriptor&>(content_protection));
+    read(content_protection.m_robustness);
+    read(content_protection.m_refId);
+    read(content_protection.m_ref);
+}
+
+void SnapshotReader::read(Codecs &codecs)
+{
+    std::optional<Codecs::Encoding> encoding;
+    read(encoding);
+    codecs.encoding(std::move(encoding));
+    std::list<std::string> codec_list;
+    read(codec_list);
+    for (auto &codec : codec_list) {
+        codecs.codecsAdd(std::move(codec));
+    }
+}
+
+void SnapshotReader::read(ContentPopularityRate &content_popularity_rate)
+{
+    read(content_popularity_rate.m_prs);
+}
+
+void SnapshotReader::read(ContentPopularityRate::PR &pr)
+{
+    read(pr.m_popularityRate);
+    read(pr.m_start);
+    read(pr.m_r);
+}
+
+void SnapshotReader::read(FrameRate &frame_rate)
+{
+    frame_rate.m_numerator = readUnsigned<FrameRate::size_type>();
+    frame_rate.m_denominator = readUnsigned<FrameRate::size_type>();
+}
+
+void SnapshotReader::read(Ratio &ratio)
+{
+    ratio.m_numerator = readUnsigned<Ratio::size_type>();
+    ratio.m_denominator = readUnsigned<Ratio::size_type>();
+}
+
+void SnapshotReader::read(SingleRFC7233Range &range)
+{
+    range.m_fromByte = readUnsigned<SingleRFC7233Range::size_type>();
+    bool have_to_byte;
+    read(have_to_byte);
+    if (have_to_byte) {
+        range.m_toByte = readUnsigned<SingleRFC7233Range::size_type>();
+    } else {
+        range.m_toByte.reset();
+    }
+}
+
+void SnapshotReader::read(XLink &xlink)
+{
+    read(xlink.m_href);
+    xlink.m_actuate = readEnum(XLink::ACTUATE_ON_LOAD);
+    xlink.m_type = readEnum(XLink::TYPE_SIMPLE);
+    xlink.m_show = readEnum(XLink::SHOW_EMBED);
+}
+
+void SnapshotReader::read(UIntVWithID &uints)
+{
+    read(static_cast<std::list<unsigned int>&>(uints));
+    read(uints.m_id);
+    read(uints.m_profiles);
+    read(uints.m_contentType);
+}
+
+void SnapshotReader::read(Label &label)
+{
+    read(static_cast<std::string&>(label));
+    read(label.m_id);
+    read(label.m_lang);
+    read(label.m_label);
+}
+
+void SnapshotReader::read(ProgramInformation &program_info)
+{
+    read(program_info.m_lang);
+    read(program_info.m_moreInformationURL);
+    read(program_info.m_title);
+    read(program_info.m_source);
+    read(program_info.m_copyright);
+}
+
+void SnapshotReader::read(SAP &sap)
+{
+    read(sap.m_value);
+}
+
+void SnapshotReader::read(InitializationSet &init_set)
+{
+    read(static_cast<RepresentationBase&>(init_set));
+}
+
+void SnapshotReader::read(Preselection &preselection)
+{
+    read(static_cast<RepresentationBase&>(preselection));
+}
+
+template <>
+Descriptor SnapshotReader::readValue<Descriptor>()
+{
+    Descriptor descriptor{URI()};
+    read(descriptor);
+    return descriptor;
+}
+
+template <>
+ContentProtection SnapshotReader::readValue<ContentProtection>()
+{
+    ContentProtection content_protection{URI()};
+    read(content_protection);
+    return content_protection;
+}
+
+template <>
+UIntVWithID SnapshotReader::readValue<UIntVWithID>()
+{
+    UIntVWithID uints(0);
+    read(uints);
+    return uints;
+}
+
+template <>
+RFC6838ContentType SnapshotReader::readValue<RFC6838ContentType>()
+{
+    return RFC6838ContentType(readValue<std::string>());
+}
+
+template <>
+Codecs::Encoding SnapshotReader::readValue<Codecs::Encoding>()
+{
+    return Codecs::Encoding(readValue<std::string>());
+}
+
+template <>
+ContentPopularityRate::PR SnapshotReader::readValue<ContentPopularityRate::PR>()
+{
+    ContentPopularityRate::PR pr(std::nullopt, std::nullopt, 0);
+    read(pr);
+    return pr;
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,348 @@
+#ifndef _BBC_PARSE_DASH_MPD_SNAPSHOT_HH_
+#define _BBC_PARSE_DASH_MPD_SNAPSHOT_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: SnapshotReader and SnapshotWriter classes
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "libmpd++/macros.hh"
+#include "libmpd++/exceptions.hh"
+#include "libmpd++/Codecs.hh"
+#include "libmpd++/ContentPopularityRate.hh"
+#include "libmpd++/SegmentTimeline.hh"
+#include "libmpd++/SharedValue.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+class AdaptationSet;
+class BaseURL;
+class ContentComponent;
+class ContentProtection;
+class Descriptor;
+class EventStream;
+class ExtendedBandwidth;
+class FailoverContent;
+class FrameRate;
+class InitializationSet;
+class Label;
+class LeapSecondInformation;
+class Metrics;
+class MPD;
+class MultipleSegmentBase;
+class PatchLocation;
+class Period;
+class Preselection;
+class ProducerReferenceTime;
+class ProgramInformation;
+class RandomAccess;
+class Ratio;
+class Representation;
+class RepresentationBase;
+class Resync;
+class RFC6838ContentType;
+class SAP;
+class SegmentBase;
+class SegmentList;
+class SegmentTemplate;
+class SegmentURL;
+class ServiceDescription;
+class SingleRFC7233Range;
+class SubRepresentation;
+class Subset;
+class Switching;
+class UIntVWithID;
+class URI;
+class URL;
+class XLink;
+
+/* Binary MPD snapshot format
+ *
+ * A snapshot starts with the 8 byte magic string "LMPDSNAP" followed by the format version number. The rest of the snapshot is
+ * the MPD object graph written out member by member in declaration order:
+ *   - unsigned integers and enumerations are LEB128 variable length integers
+ *   - signed integers are zig-zag encoded and then written as unsigned integers
+ *   - booleans are a single 0 or 1 byte
+ *   - doubles are the 8 bytes of the IEEE 754 value in little endian order
+ *   - strings (and URIs) are the byte length followed by the bytes
+ *   - durations are the number of microseconds, date-times are the number of nanoseconds since the epoch
+ *   - optional values are a presence flag followed by the value if present
+ *   - lists are the number of entries followed by the entries
+ *   - classes which have no attributes yet are written as a single 0 byte so that later versions can add to them
+ *
+ * The selected Representations of an AdaptationSet are written as a list of indexes into its Representations. The parent and
+ * sibling pointers are not written, they are rebuilt as the objects are read back in.
+ *
+ * The format version must be incremented whenever the layout changes, snapshots with a different version are rejected.
+ */
+constexpr char SNAPSHOT_MAGIC[8] = {'L', 'M', 'P', 'D', 'S', 'N', 'A', 'P'};
+constexpr unsigned int SNAPSHOT_VERSION = 1;
+
+/* Writes an MPD as a binary snapshot
+ */
+class SnapshotWriter {
+public:
+    SnapshotWriter(std::vector<unsigned char> &buffer) :m_buffer(buffer) {};
+
+    // Append the snapshot header and the full object graph of mpd to the buffer
+    void writeSnapshot(const MPD &mpd);
+
+private:
+    void writeUnsigned(std::uint64_t val);
+    void writeSigned(std::int64_t val);
+    void writeBytes(const void *data, std::size_t length);
+
+    void write(bool val) { m_buffer.push_back(val?1:0); };
+    void write(int val) { writeSigned(val); };
+    void write(unsigned int val) { writeUnsigned(val); };
+    void write(unsigned long val) { writeUnsigned(val); };
+    void write(double val);
+    void write(const std::string &val);
+    void write(const std::chrono::microseconds &val) { writeSigned(val.count()); };
+    void write(const std::chrono::system_clock::time_point &val);
+
+    template <class T>
+    void write(const std::optional<T> &val) {
+        write(val.has_value());
+        if (val) write(*val);
+    };
+
+    template <class T>
+    void write(const SharedValue<T> &val) { write(val.get()); };
+
+    template <class T, class Alloc>
+    void write(const std::list<T, Alloc> &val) {
+        writeUnsigned(val.size());
+        for (const auto &entry : val) {
+            write(entry);
+        }
+    };
+
+    template <class T, class Alloc>
+    void write(const std::vector<T, Alloc> &val) {
+        writeUnsigned(val.size());
+        for (const auto &entry : val) {
+            write(entry);
+        }
+    };
+
+    void writePlaceholder() { m_buffer.push_back(0); };
+
+    void write(const MPD &mpd);
+    void write(const Period &period);
+    void write(const AdaptationSet &adapt_set);
+    void write(const Representation &rep);
+    void write(const SubRepresentation &sub_rep);
+    void write(const RepresentationBase &rep_base);
+    void write(const SegmentBase &seg_base);
+    void write(const MultipleSegmentBase &multi_seg_base);
+    void write(const SegmentTemplate &seg_template);
+    void write(const SegmentList &seg_list);
+    void write(const SegmentTimeline &seg_timeline);
+    void write(const SegmentTimeline::S &s);
+    void write(const SegmentURL &seg_url);
+    void write(const URL &url);
+    void write(const BaseURL &base_url);
+    void write(const URI &uri);
+    void write(const PatchLocation &patch_location);
+    void write(const Descriptor &descriptor);
+    void write(const ContentProtection &content_protection);
+    void write(const Codecs &codecs);
+    void write(const Codecs::Encoding &encoding);
+    void write(const ContentPopularityRate &content_popularity_rate);
+    void write(const ContentPopularityRate::PR &pr);
+    void write(const FrameRate &frame_rate);
+    void write(const Ratio &ratio);
+    void write(const SingleRFC7233Range &range);
+    void write(const XLink &xlink);
+    void write(const UIntVWithID &uints);
+    void write(const Label &label);
+    void write(const ProgramInformation &program_info);
+    void write(const SAP &sap);
+    void write(const RFC6838ContentType &content_type);
+    void write(const InitializationSet &init_set);
+    void write(const Preselection &preselection);
+    void write(const ContentComponent&) { writePlaceholder(); };
+    void write(const EventStream&) { writePlaceholder(); };
+    void write(const ExtendedBandwidth&) { writePlaceholder(); };
+    void write(const FailoverContent&) { writePlaceholder(); };
+    void write(const LeapSecondInformation&) { writePlaceholder(); };
+    void write(const Metrics&) { writePlaceholder(); };
+    void write(const ProducerReferenceTime&) { writePlaceholder(); };
+    void write(const RandomAccess&) { writePlaceholder(); };
+    void write(const Resync&) { writePlaceholder(); };
+    void write(const ServiceDescription&) { writePlaceholder(); };
+    void write(const Subset&) { writePlaceholder(); };
+    void write(const Switching&) { writePlaceholder(); };
+
+    std::vector<unsigned char> &m_buffer;
+};
+
+/* Reads an MPD back from a binary snapshot
+ *
+ * Throws ParseError if the snapshot is not a supported snapshot version or is truncated or corrupt.
+ */
+class SnapshotReader {
+public:
+    SnapshotReader(const unsigned char *data, std::size_t length)
+        :m_pos(data)
+        ,m_end(data + length)
+    {};
+
+    // Check the snapshot header and read the full object graph into mpd
+    void readSnapshot(MPD &mpd);
+
+private:
+    std::uint64_t readUnsigned();
+    std::int64_t readSigned();
+    void readBytes(void *data, std::size_t length);
+
+    // Read an unsigned value checking it will fit in the destination type
+    template <class T>
+    T readUnsigned() {
+        auto val = readUnsigned();
+        if (val > std::numeric_limits<T>::max()) throw ParseError("MPD snapshot value out of range");
+        return static_cast<T>(val);
+    };
+
+    // Read an enumeration value checking it is not beyond the last value of the enumeration
+    template <class E>
+    E readEnum(E last) {
+        auto val = readUnsigned();
+        if (val > static_cast<std::uint64_t>(last)) throw ParseError("MPD snapshot enumeration value out of range");
+        return static_cast<E>(val);
+    };
+
+    // Read a list entry or element count, each entry takes at least 1 byte so the count cannot exceed the remaining data
+    std::size_t readCount();
+
+    void read(bool &val);
+    void read(int &val);
+    void read(unsigned int &val) { val = readUnsigned<unsigned int>(); };
+    void read(unsigned long &val) { val = readUnsigned<unsigned long>(); };
+    void read(double &val);
+    void read(std::string &val);
+    void read(std::chrono::microseconds &val) { val = std::chrono::microseconds(readSigned()); };
+    void read(std::chrono::system_clock::time_point &val);
+
+    // Construct and read a value, specialised for types with no default constructor
+    template <class T>
+    T readValue() {
+        T val;
+        read(val);
+        return val;
+    };
+
+    template <class T>
+    void read(std::optional<T> &val) {
+        bool present;
+        read(present);
+        if (present) {
+            val = readValue<T>();
+        } else {
+            val.reset();
+        }
+    };
+
+    template <class T>
+    void read(SharedValue<T> &val) { val = readValue<T>(); };
+
+    template <class T, class Alloc>
+    void read(std::list<T, Alloc> &val) {
+        val.clear();
+        for (auto count = readCount(); count > 0; count--) {
+            val.push_back(readValue<T>());
+        }
+    };
+
+    template <class T, class Alloc>
+    void read(std::vector<T, Alloc> &val) {
+        val.clear();
+        auto count = readCount();
+        val.reserve(count);
+        for (; count > 0; count--) {
+            val.push_back(readValue<T>());
+        }
+    };
+
+    void readPlaceholder();
+
+    // These are read in place so that the parent pointers can be set to their final locations
+    void read(std::list<Period> &periods);
+    void read(std::list<AdaptationSet> &adapt_sets);
+    void read(std::list<Representation> &reps);
+
+    void read(MPD &mpd);
+    void read(Period &period);
+    void read(AdaptationSet &adapt_set);
+    void read(Representation &rep);
+    void read(SubRepresentation &sub_rep);
+    void read(RepresentationBase &rep_base);
+    void read(SegmentBase &seg_base);
+    void read(MultipleSegmentBase &multi_seg_base);
+    void read(SegmentTemplate &seg_template);
+    void read(SegmentList &seg_list);
+    void read(SegmentTimeline &seg_timeline);
+    void read(SegmentTimeline::S &s);
+    void read(SegmentURL &seg_url);
+    void read(URL &url);
+    void read(BaseURL &base_url);
+    void read(URI &uri);
+    void read(PatchLocation &patch_location);
+    void read(Descriptor &descriptor);
+    void read(ContentProtection &content_protection);
+    void read(Codecs &codecs);
+    void read(ContentPopularityRate &content_popularity_rate);
+    void read(ContentPopularityRate::PR &pr);
+    void read(FrameRate &frame_rate);
+    void read(Ratio &ratio);
+    void read(SingleRFC7233Range &range);
+    void read(XLink &xlink);
+    void read(UIntVWithID &uints);
+    void read(Label &label);
+    void read(ProgramInformation &program_info);
+    void read(SAP &sap);
+    void read(InitializationSet &init_set);
+    void read(Preselection &preselection);
+    void read(ContentComponent&) { readPlaceholder(); };
+    void read(EventStream&) { readPlaceholder(); };
+    void read(ExtendedBandwidth&) { readPlaceholder(); };
+    void read(FailoverContent&) { readPlaceholder(); };
+    void read(LeapSecondInformation&) { readPlaceholder(); };
+    void read(Metrics&) { readPlaceholder(); };
+    void read(ProducerReferenceTime&) { readPlaceholder(); };
+    void read(RandomAccess&) { readPlaceholder(); };
+    void read(Resync&) { readPlaceholder(); };
+    void read(ServiceDescription&) { readPlaceholder(); };
+    void read(Subset&) { readPlaceholder(); };
+    void read(Switching&) { readPlaceholder(); };
+
+    const unsigned char *m_pos;
+    const unsigned char *m_end;
+};
+
+template <> Descriptor SnapshotReader::readValue<Descriptor>();
+template <> ContentProtection SnapshotReader::readValue<ContentProtection>();
+template <> UIntVWithID SnapshotReader::readValue<UIntVWithID>();
+template <> RFC6838ContentType SnapshotReader::readValue<RFC6838ContentType>();
+template <> Codecs::Encoding SnapshotReader::readValue<Codecs::Encoding>();
+template <> ContentPopularityRate::PR SnapshotReader::readValue<ContentPopularityRate::PR>();
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_SNAPSHOT_HH_*/
@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: StringPool class
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+#include "libmpd++/macros.hh"
+#include "libmpd++/AdaptationSet.hh"
+#include "libmpd++/Codecs.hh"
+#include "libmpd++/ContentProtection.hh"
+#include "libmpd++/Descriptor.hh"
+#include "libmpd++/MPD.hh"
+#include "libmpd++/Period.hh"
+#include "libmpd++/Representation.hh"
+#include "libmpd++/RepresentationBase.hh"
+#include "libmpd++/SegmentTemplate.hh"
+#include "libmpd++/SharedValue.hh"
+#include "libmpd++/SubRepresentation.hh"
+#include "libmpd++/URI.hh"
+
+#include "libmpd++/StringPool.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+StringPool::StringPool()
+    :m_mutex()
+    ,m_strings()
+    ,m_codecs()
+{
+}
+
+StringPool::~StringPool()
+{
+}
+
+void StringPool::intern(MPD &mpd)
+{
+    for (auto &profile : mpd.m_profiles) intern(profile);
+    for (auto &base_url : mpd.m_baseURLs) intern(base_url);
+    for (auto &content_protection : mpd.m_contentProtections) intern(content_protection);
+    for (auto &descriptor : mpd.m_essentialProperties) intern(descriptor);
+    for (auto &descriptor : mpd.m_supplementaryProperties) intern(descriptor);
+    for (auto &descriptor : mpd.m_utcTimings) intern(descriptor);
+    for (auto &period : mpd.m_periods) intern(period);
+}
+
+void StringPool::intern(Period &period)
+{
+    // Members are used directly so that lazily parsed Periods are not materialised, they are interned when materialised instead
+    for (auto &base_url : period.m_baseURLs) intern(base_url);
+    if (period.m_segmentTemplate) intern(period.m_segmentTemplate.value());
+    if (period.m_assetIdentifier) intern(period.m_assetIdentifier.value());
+    for (auto &content_protection : period.m_contentProtections) intern(content_protection);
+    for (auto &adapt_set : period.m_adaptationSets) intern(adapt_set);
+    for (auto &descriptor : period.m_supplementalProperties) intern(descriptor);
+    for (auto &adapt_set : period.m_emptyAdaptationSets) intern(adapt_set);
+}
+
+void StringPool::intern(URI &uri)
+{
+    intern(uri.m_uri);
+}
+
+void StringPool::intern(SharedValue<std::string> &value)
+{
+    const std::string &str = value.get();
+    auto pooled = findOrAdd(str, [&str]() { return std::make_shared<const std::optional<std::string> >(str); });
+    // Share the string inside the pooled std::optional
+    if (&pooled->value() != &str) value = std::shared_ptr<const std::string>(pooled, &pooled->value());
+}
+
+void StringPool::intern(SharedValue<std::optional<std::string> > &value)
+{
+    if (!value.has_value()) return;
+    auto pooled = findOrAdd(value.value(), [&value]() { return value.shared(); });
+    if (pooled != value.shared()) value = SharedValue<std::optional<std::string> >(std::move(pooled));
+}
+
+void StringPool::intern(SharedValue<std::optional<Codecs> > &value)
+{
+    if (!value.has_value()) return;
+    std::string key(value.value());
+    {
+        std::shared_lock lock(m_mutex);
+        auto it = m_codecs.find(key);
+        if (it != m_codecs.end()) {
+            if (it->second != value.shared()) value = SharedValue<std::optional<Codecs> >(it->second);
+            return;
+        }
+    }
+    std::unique_lock lock(m_mutex);
+    auto [it, added] = m_codecs.try_emplace(std::move(key), value.shared());
+    if (!added) value = SharedValue<std::optional<Codecs> >(it->second);
+}
+
+std::size_t StringPool::size() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_strings.size() + m_codecs.size();
+}
+
+std::size_t StringPool::purge()
+{
+    std::unique_lock lock(m_mutex);
+    std::size_t removed = std::erase_if(m_strings, [](const auto &entry) { return entry.second.use_count() == 1; });
+    removed += std::erase_if(m_codecs, [](const auto &entry) { return entry.second.use_count() == 1; });
+    return removed;
+}
+
+// private:
+void StringPool::intern(AdaptationSet &adapt_set)
+{
+    intern(static_cast<RepresentationBase&>(adapt_set));
+    intern(adapt_set.m_lang);
+    for (auto &descriptor : adapt_set.m_accessibilities) intern(descriptor);
+    for (auto &descriptor : adapt_set.m_roles) intern(descriptor);
+    for (auto &descriptor : adapt_set.m_ratings) intern(descriptor);
+    for (auto &descriptor : adapt_set.m_viewpoints) intern(descriptor);
+    for (auto &base_url : adapt_set.m_baseURLs) intern(base_url);
+    if (adapt_set.m_segmentTemplate) intern(adapt_set.m_segmentTemplate.value());
+    for (auto &rep : adapt_set.m_representations) intern(rep);
+}
+
+void StringPool::intern(Representation &rep)
+{
+    intern(static_cast<RepresentationBase&>(rep));
+    for (auto &base_url : rep.m_baseURLs) intern(base_url);
+    for (auto &sub_rep : rep.m_subRepresentations) intern(static_cast<RepresentationBase&>(sub_rep));
+    if (rep.m_segmentTemplate) intern(rep.m_segmentTemplate.value());
+}
+
+void StringPool::intern(RepresentationBase &rep_base)
+{
+    for (auto &profile : rep_base.m_profiles) intern(profile);
+    intern(rep_base.m_mimeType);
+    intern(rep_base.m_codecs);
+    for (auto &descriptor : rep_base.m_framePackings) intern(descriptor);
+    for (auto &descriptor : rep_base.m_audioChannelConfigurations) intern(descriptor);
+    for (auto &content_protection : rep_base.m_contentProtections) intern(content_protection);
+    if (rep_base.m_outputProtection) intern(rep_base.m_outputProtection.value());
+    for (auto &descriptor : rep_base.m_essentialProperties) intern(descriptor);
+    for (auto &descriptor : rep_base.m_supplementalProperties) intern(descriptor);
+}
+
+void StringPool::intern(Descriptor &descriptor)
+{
+    intern(descriptor.m_schemeIdUri);
+}
+
+void StringPool::intern(ContentProtection &content_protection)
+{
+    intern(static_cast<Descriptor&>(content_protection));
+    intern(content_protection.m_robustness);
+}
+
+void StringPool::intern(SegmentTemplate &seg_template)
+{
+    intern(seg_template.m_media);
+    intern(seg_template.m_index);
+    intern(seg_template.m_initialization);
+    intern(seg_template.m_bitstreamSwitching);
+}
+
+template <class F>
+std::shared_ptr<const std::optional<std::string> > StringPool::findOrAdd(std::string_view str, F make_value)
+{
+    {
+        std::shared_lock lock(m_mutex);
+        auto it = m_strings.find(str);
+        if (it != m_strings.end()) return it->second;
+    }
+    std::unique_lock lock(m_mutex);
+    // Another thread may have added the value while the lock was released
+    auto it = m_strings.find(str);
+    if (it != m_strings.end()) return it->second;
+    std::shared_ptr<const std::optional<std::string> > value(make_value());
+    m_strings.emplace(std::string_view(value->value()), value);
+    return value;
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
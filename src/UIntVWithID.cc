@@ -10,8 +10,10 @@
  */
 #include <list>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <libxml++/libxml++.h>
 
@@ -21,13 +23,14 @@
 #include "libmpd++/URI.hh"
 
 #include "conversions.hh"
+#include "span_iterators.hh"
 
 #include "libmpd++/UIntVWithID.hh"
 
 LIBMPDPP_NAMESPACE_BEGIN
 
 UIntVWithID::UIntVWithID(unsigned int id,
-                const std::list<URI> &profiles,
+                const std::vector<URI> &profiles,
                 const std::optional<RFC6838ContentType> &content_type)
     :std::list<unsigned int>()
     ,m_id(id)
@@ -37,7 +40,7 @@ UIntVWithID::UIntVWithID(unsigned int id,
 }
 
 UIntVWithID::UIntVWithID(const std::list<unsigned int> &init, unsigned int id,
-                const std::list<URI> &profiles,
+                const std::vector<URI> &profiles,
                 const std::optional<RFC6838ContentType> &content_type)
     :std::list<unsigned int>(init)
     ,m_id(id)
@@ -47,7 +50,7 @@ UIntVWithID::UIntVWithID(const std::list<unsigned int> &init, unsigned int id,
 }
 
 UIntVWithID::UIntVWithID(std::list<unsigned int> &&init, unsigned int id,
-                const std::list<URI> &profiles,
+                const std::vector<URI> &profiles,
                 const std::optional<RFC6838ContentType> &content_type)
     :std::list<unsigned int>(std::move(init))
     ,m_id(id)
@@ -57,7 +60,7 @@ UIntVWithID::UIntVWithID(std::list<unsigned int> &&init, unsigned int id,
 }
 
 UIntVWithID::UIntVWithID(std::initializer_list<unsigned int> init, unsigned int id,
-                const std::list<URI> &profiles,
+                const std::vector<URI> &profiles,
                 const std::optional<RFC6838ContentType> &content_type)
     :std::list<unsigned int>(init)
     ,m_id(id)
@@ -108,7 +111,7 @@ bool UIntVWithID::operator==(const UIntVWithID &other) const
     if (m_contentType != other.m_contentType) return false;
     if (m_profiles.size() != other.m_profiles.size()) return false;
     {
-        std::list<URI> to_find(other.m_profiles);
+        std::vector<URI> to_find(other.m_profiles);
         for (const auto &profile : m_profiles) {
             auto it = std::find(to_find.begin(), to_find.end(), profile);
             if (it == to_find.end()) return false;
@@ -127,32 +130,36 @@ bool UIntVWithID::operator==(const UIntVWithID &other) const
     return true;
 }
 
-const URI &UIntVWithID::profile(std::list<URI>::size_type idx) const
+const URI &UIntVWithID::profile(std::vector<URI>::size_type idx) const
 {
     if (idx >= m_profiles.size())
         throw std::out_of_range("access of index beyond the @profiles entries in UIntVWithID type");
-    auto it = m_profiles.begin();
-    while (idx > 0) { it++; idx--; }
-    return *it;
+    return m_profiles[idx];
 }
 
 UIntVWithID &UIntVWithID::profilesRemove(const URI &val)
 {
-    return profilesRemove(std::find(m_profiles.begin(), m_profiles.end(), val));
+    auto it = std::find(m_profiles.begin(), m_profiles.end(), val);
+    if (it != m_profiles.end()) {
+        m_profiles.erase(it);
+    }
+    return *this;
 }
 
-UIntVWithID &UIntVWithID::profilesRemove(const std::list<URI>::const_iterator &it)
+UIntVWithID &UIntVWithID::profilesRemove(const std::span<const URI>::iterator &it)
 {
-    if (it != m_profiles.cend()) {
-        m_profiles.erase(it);
+    auto vec_it = vector_iterator(m_profiles, it);
+    if (vec_it != m_profiles.end()) {
+        m_profiles.erase(vec_it);
     }
     return *this;
 }
 
-UIntVWithID &UIntVWithID::profilesRemove(const std::list<URI>::iterator &it)
+UIntVWithID &UIntVWithID::profilesRemove(const std::span<URI>::iterator &it)
 {
-    if (it != m_profiles.end()) {
-        m_profiles.erase(it);
+    auto vec_it = vector_iterator(m_profiles, it);
+    if (vec_it != m_profiles.end()) {
+        m_profiles.erase(vec_it);
     }
     return *this;
 }
@@ -189,7 +196,7 @@ UIntVWithID::UIntVWithID(xmlpp::Node &node)
     node_set = node.find("@profiles");
     if (node_set.size() > 0) {
         xmlpp::Attribute *attr = dynamic_cast<xmlpp::Attribute*>(node_set.front());
-        m_profiles = str_to_list<URI>(attr->get_value());
+        m_profiles = str_to_vector<URI>(attr->get_value());
     }
 
     node_set = node.find("@contentType");
@@ -8,8 +8,11 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <regex>
+#include <stdexcept>
 #include <string>
 
 #include <libxml++/libxml++.h>
@@ -23,38 +26,244 @@
 
 LIBMPDPP_NAMESPACE_BEGIN
 
+namespace {
+
+// Character classes from RFC 3986 used when scanning URIs
+enum : unsigned char {
+    CHAR_ALPHA    = 0x01, // ALPHA
+    CHAR_DIGIT    = 0x02, // DIGIT
+    CHAR_HEX      = 0x04, // HEXDIG
+    CHAR_SCHEME   = 0x08, // ALPHA / DIGIT / "+" / "-" / "."
+    CHAR_USERINFO = 0x10, // unreserved / sub-delims / ":" (also used for IPvFuture)
+    CHAR_REG_NAME = 0x20, // unreserved / sub-delims
+    CHAR_PATH     = 0x40, // pchar / "/"
+    CHAR_QUERY    = 0x80  // pchar / "/" / "?" (also used for fragments)
+};
+
+constexpr std::array<unsigned char, 256> make_char_classes()
+{
+    std::array<unsigned char, 256> classes{};
+    auto add = [&classes](const char *chars, unsigned char cls) {
+        for (; *chars; chars++) classes[static_cast<unsigned char>(*chars)] |= cls;
+    };
+    const char *alpha = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    const char *digit = "0123456789";
+    const char *unreserved_extra = "-._~";
+    const char *sub_delims = "!$&'()*+,;=";
+    const unsigned char common = CHAR_USERINFO | CHAR_REG_NAME | CHAR_PATH | CHAR_QUERY;
+
+    add(alpha, CHAR_ALPHA | CHAR_SCHEME | common);
+    add(digit, CHAR_DIGIT | CHAR_HEX | CHAR_SCHEME | common);
+    add("ABCDEFabcdef", CHAR_HEX);
+    add("+-.", CHAR_SCHEME);
+    add(unreserved_extra, common);
+    add(sub_delims, common);
+    add(":", CHAR_USERINFO | CHAR_PATH | CHAR_QUERY);
+    add("@/", CHAR_PATH | CHAR_QUERY);
+    add("?", CHAR_QUERY);
+    return classes;
+}
+
+constexpr std::array<unsigned char, 256> g_char_classes = make_char_classes();
+
+inline bool is_char_class(char c, unsigned char cls)
+{
+    return (g_char_classes[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+// Skip characters in the class and percent-encoded octets, returns nullptr if a bad percent-encoding is found
+const char *skip_chars(const char *pos, const char *end, unsigned char cls)
+{
+    while (pos != end) {
+        if (is_char_class(*pos, cls)) {
+            pos++;
+        } else if (*pos == '%') {
+            if (end - pos < 3 || !is_char_class(pos[1], CHAR_HEX) || !is_char_class(pos[2], CHAR_HEX)) return nullptr;
+            pos += 3;
+        } else {
+            break;
+        }
+    }
+    return pos;
+}
+
+// IPv4address: dec-octet "." dec-octet "." dec-octet "." dec-octet
+bool is_ipv4_address(const char *pos, const char *end)
+{
+    for (int octet = 0; octet < 4; octet++) {
+        if (octet > 0) {
+            if (pos == end || *pos != '.') return false;
+            pos++;
+        }
+        const char *start = pos;
+        unsigned int val = 0;
+        while (pos != end && is_char_class(*pos, CHAR_DIGIT) && pos - start < 3) {
+            val = val * 10 + (*pos - '0');
+            pos++;
+        }
+        // 1 to 3 digits, no leading zeros, maximum of 255
+        if (pos == start || (pos - start > 1 && *start == '0') || val > 255) return false;
+    }
+    return pos == end;
+}
+
+// IPv6address: up to 8 groups of 1 to 4 hex digits, one "::" to elide groups, the last 2 groups may be an IPv4address
+bool is_ipv6_address(const char *pos, const char *end)
+{
+    unsigned int groups = 0;
+    bool elided = false;
+
+    if (end - pos >= 2 && pos[0] == ':' && pos[1] == ':') {
+        elided = true;
+        pos += 2;
+        if (pos == end) return true;
+    }
+    while (true) {
+        const char *start = pos;
+        while (pos != end && is_char_class(*pos, CHAR_HEX) && pos - start < 4) pos++;
+        if (pos == start) return false;
+        if (pos != end && *pos == '.') {
+            if (!is_ipv4_address(start, end)) return false;
+            groups += 2;
+            break;
+        }
+        groups++;
+        if (pos == end) break;
+        if (*pos != ':') return false;
+        pos++;
+        if (pos == end) return false;
+        if (*pos == ':') {
+            if (elided) return false;
+            elided = true;
+            pos++;
+            if (pos == end) break;
+        }
+    }
+    return elided?(groups < 8):(groups == 8);
+}
+
+// authority = [ userinfo "@" ] host [ ":" port ]
+bool is_authority(const char *pos, const char *end)
+{
+    auto at = static_cast<const char*>(std::memchr(pos, '@', end - pos));
+    if (at) {
+        if (skip_chars(pos, at, CHAR_USERINFO) != at) return false;
+        pos = at + 1;
+    }
+
+    if (pos != end && *pos == '[') {
+        // IP-literal = "[" ( IPv6address / IPvFuture  ) "]"
+        auto close = static_cast<const char*>(std::memchr(pos, ']', end - pos));
+        if (!close) return false;
+        const char *literal = pos + 1;
+        if (literal != close && (*literal == 'v' || *literal == 'V')) {
+            // IPvFuture = "v" 1*HEXDIG "." 1*( unreserved / sub-delims / ":" )
+            const char *hex_start = ++literal;
+            while (literal != close && is_char_class(*literal, CHAR_HEX)) literal++;
+            if (literal == hex_start || literal == close || *literal != '.') return false;
+            literal++;
+            if (literal == close) return false;
+            while (literal != close && is_char_class(*literal, CHAR_USERINFO)) literal++;
+            if (literal != close) return false;
+        } else if (!is_ipv6_address(literal, close)) {
+            return false;
+        }
+        pos = close + 1;
+    } else {
+        // IPv4address is a subset of reg-name so does not need checking separately
+        pos = skip_chars(pos, end, CHAR_REG_NAME);
+        if (!pos) return false;
+    }
+
+    if (pos != end) {
+        // port = *DIGIT
+        if (*pos != ':') return false;
+        for (pos++; pos != end; pos++) {
+            if (!is_char_class(*pos, CHAR_DIGIT)) return false;
+        }
+    }
+    return true;
+}
+
+}
+
 void URI::validate()
 {
-    // check m_uri is a valid URI string and throw std::domain_error if not
-    static const std::regex validator_regex("^(?:[a-zA-Z][-a-zA-Z0-9+.]*:)?(?://(?:(?:[-a-zA-Z0-9._~!$&'()*+,;=:]|%[a-fA-F0-9][a-fA-F0-9])*@)?(?:\\[(?:v[a-fA-F0-9]+\\.[-a-zA-Z0-9._~!$&'()*+,;=:]+|(?:(?:(?:[a-fA-F0-9]){1,4}:){6}(?:(?:[a-fA-F0-9]){1,4}:(?:[a-fA-F0-9]){1,4}|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3})|::(?:(?:[a-fA-F0-9]){1,4}:){5}(?:(?:[a-fA-F0-9]){1,4}:(?:[a-fA-F0-9]){1,4}|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3})|(?:(?:[a-fA-F0-9]){1,4})?::(?:(?:[a-fA-F0-9]){1,4}:){4}(?:(?:[a-fA-F0-9]){1,4}:(?:[a-fA-F0-9]){1,4}|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3})|(?:(?:(?:[a-fA-F0-9]){1,4}:){0,1}(?:[a-fA-F0-9]){1,4})?::(?:(?:[a-fA-F0-9]){1,4}:){3}(?:(?:[a-fA-F0-9]){1,4}:(?:[a-fA-F0-9]){1,4}|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3})|(?:(?:(?:[a-fA-F0-9]){1,4}:){0,2}(?:[a-fA-F0-9]){1,4})?::(?:(?:[a-fA-F0-9]){1,4}:){2}(?:(?:[a-fA-F0-9]){1,4}:(?:[a-fA-F0-9]){1,4}|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3})|(?:(?:(?:[a-fA-F0-9]){1,4}:){0,3}(?:[a-fA-F0-9]){1,4})?::(?:[a-fA-F0-9]){1,4}:(?:(?:[a-fA-F0-9]){1,4}:(?:[a-fA-F0-9]){1,4}|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3})|(?:(?:(?:[a-fA-F0-9]){1,4}:){0,4}(?:[a-fA-F0-9]){1,4})?::(?:(?:[a-fA-F0-9]){1,4}:(?:[a-fA-F0-9]){1,4}|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3})|(?:(?:(?:[a-fA-F0-9]){1,4}:){0,5}(?:[a-fA-F0-9]){1,4})?::(?:[a-fA-F0-9]){1,4}|(?:(?:(?:[a-fA-F0-9]){1,4}:){0,6}(?:[a-fA-F0-9]){1,4})?::))\\]|(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])(?:\\.(?:[0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])){3}|(?:[-a-zA-Z0-9._~!$&'()*+,;=]|%[a-fA-F0-9][a-fA-F0-9])*)(?::[0-9]*)?(?:/(?:[-a-zA-Z0-9._~!$&'()*+,;=:@]|%[a-fA-F0-9][a-fA-F0-9])*)*|/(?:(?:[-a-zA-Z0-9._~!$&'()*+,;=:@]|%[a-fA-F0-9][a-fA-F0-9])+(?:/(?:[-a-zA-Z0-9._~!$&'()*+,;=:@]|%[a-fA-F0-9][a-fA-F0-9])*)*)?|(?:[-a-zA-Z0-9._~!$&'()*+,;=:@]|%[a-fA-F0-9][a-fA-F0-9])+(?:/(?:[-a-zA-Z0-9._~!$&'()*+,;=:@]|%[a-fA-F0-9][a-fA-F0-9])*)*|)(?:\\?(?:[-a-zA-Z0-9._~!$&'()*+,;=:@/?]|%[a-fA-F0-9][a-fA-F0-9])*)?(?:#(?:[-a-zA-Z0-9._~!$&'()*+,;=:@/?]|%[a-fA-F0-9][a-fA-F0-9])*)?$", std::regex_constants::ECMAScript);
-    if (!std::regex_match(m_uri, validator_regex))
-        throw std::domain_error("Not a valid URI");
+    // check m_uri is a valid URI string and throw std::domain_error if not, recording the component offsets as we go
+    const std::string &uri = m_uri.get();
+    if (uri.size() >= Components::NONE) throw std::domain_error("Not a valid URI");
+
+    Components components;
+    const char *begin = uri.data();
+    const char *end = begin + uri.size();
+    const char *pos = begin;
+
+    // scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." ) followed by ":"
+    if (pos != end && is_char_class(*pos, CHAR_ALPHA)) {
+        const char *scheme_end = pos + 1;
+        while (scheme_end != end && is_char_class(*scheme_end, CHAR_SCHEME)) scheme_end++;
+        if (scheme_end != end && *scheme_end == ':') {
+            components.schemeLength = static_cast<std::uint32_t>(scheme_end - begin);
+            pos = scheme_end + 1;
+        }
+    }
+
+    // "//" authority
+    if (end - pos >= 2 && pos[0] == '/' && pos[1] == '/') {
+        pos += 2;
+        components.authorityStart = static_cast<std::uint32_t>(pos - begin);
+        const char *authority_end = pos;
+        while (authority_end != end && *authority_end != '/' && *authority_end != '?' && *authority_end != '#') authority_end++;
+        if (!is_authority(pos, authority_end)) throw std::domain_error("Not a valid URI");
+        pos = authority_end;
+    }
+
+    // path, this also allows ':' in the first segment of a relative path, which RFC 3986 does not, as the regular expression
+    // used previously allowed it.
+    components.pathStart = static_cast<std::uint32_t>(pos - begin);
+    pos = skip_chars(pos, end, CHAR_PATH);
+    if (!pos) throw std::domain_error("Not a valid URI");
+
+    // "?" query
+    if (pos != end && *pos == '?') {
+        components.queryStart = static_cast<std::uint32_t>(pos - begin);
+        pos = skip_chars(pos + 1, end, CHAR_QUERY);
+        if (!pos) throw std::domain_error("Not a valid URI");
+    }
+
+    // "#" fragment
+    if (pos != end && *pos == '#') {
+        components.fragmentStart = static_cast<std::uint32_t>(pos - begin);
+        pos = skip_chars(pos + 1, end, CHAR_QUERY);
+        if (!pos) throw std::domain_error("Not a valid URI");
+    }
+
+    if (pos != end) throw std::domain_error("Not a valid URI");
+
+    m_components = components;
 }
 
 URI::URI(xmlpp::Node &node)
 {
     // Take all text in the element as the URI
-    m_uri = node.eval_to_string(".//text()");
+    m_uri = std::string(node.eval_to_string(".//text()"));
     validate();
 }
 
 void URI::setXMLElement(xmlpp::Element &elem) const
 {
-    elem.add_child_text(m_uri);
+    elem.add_child_text(m_uri.get());
 }
 
-static const std::regex g_url_split("^(?:([^:/?#]+):)?(?://([^/?#]*))?([^?#]*)(?:\\?([^#]*))?(?:#(.*))?$");
-
 bool URI::isURL() const
 {
-    return std::regex_match(m_uri, g_url_split);
+    // Any valid URI can be split into the generic RFC 3986 components, which validate() has already done
+    return true;
 }
 
 bool URI::isAbsoluteURL() const
 {
-    std::smatch result;
-    if (!std::regex_match(m_uri, result, g_url_split)) return false;
-    return result[1].matched && result[2].matched;
+    return m_components.schemeLength != 0 && m_components.authorityStart != Components::NONE;
 }
 
 URI URI::resolveUsingBaseURLs(const std::list<BaseURL> &base_urls) const
@@ -65,9 +274,10 @@ URI URI::resolveUsingBaseURLs(const std::list<BaseURL> &base_urls) const
 
     // find BaseURL to use (just use first for now)
     const auto &base_url = base_urls.front();
-    std::string new_url = std::string(DecomposedURL(DecomposedURL(base_url.url()), m_uri));
+    std::string new_url;
+    DecomposedURL(base_url).resolve(m_uri.get(), new_url);
 
-    return URI(new_url);
+    return URI(std::move(new_url));
 }
 
 LIBMPDPP_NAMESPACE_END
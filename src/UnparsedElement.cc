@@ -0,0 +1,55 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: UnparsedElement and UnparsedDocument classes
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <memory>
+#include <new>
+
+#include <libxml/tree.h>
+#include <libxml++/libxml++.h>
+
+#include "libmpd++/macros.hh"
+
+#include "UnparsedElement.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+std::shared_ptr<UnparsedDocument> UnparsedDocument::create()
+{
+    return std::shared_ptr<UnparsedDocument>(new UnparsedDocument);
+}
+
+UnparsedDocument::UnparsedDocument()
+    :m_doc(xmlNewDoc(reinterpret_cast<const xmlChar*>("1.0")))
+    ,m_mutex()
+{
+    if (!m_doc) throw std::bad_alloc();
+}
+
+UnparsedDocument::~UnparsedDocument()
+{
+    for (xmlNodePtr node = m_doc->children; node; node = node->next) {
+        xmlpp::Node::free_wrappers(node);
+    }
+    xmlFreeDoc(m_doc);
+}
+
+std::shared_ptr<UnparsedElement> UnparsedDocument::copyElement(const xmlNode *node)
+{
+    // Namespaces declared on ancestors of node are redeclared on the copy
+    xmlNodePtr copy = xmlDocCopyNode(const_cast<xmlNodePtr>(node), m_doc, 1);
+    if (!copy) throw std::bad_alloc();
+    xmlAddChild(reinterpret_cast<xmlNodePtr>(m_doc), copy);
+    return std::make_shared<UnparsedElement>(shared_from_this(), copy);
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
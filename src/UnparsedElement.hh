@@ -0,0 +1,71 @@
+#ifndef _BBC_PARSE_DASH_MPD_UNPARSED_ELEMENT_HH_
+#define _BBC_PARSE_DASH_MPD_UNPARSED_ELEMENT_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: UnparsedElement and UnparsedDocument classes
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <memory>
+#include <mutex>
+
+#include <libxml/tree.h>
+
+#include "libmpd++/macros.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+class UnparsedElement;
+
+/* Holding document for XML subtrees that are parsed later
+ *
+ * Subtrees are deep copied into this document so that they outlive the parser that read them. The document is shared by all the
+ * UnparsedElement objects taken from it and is freed, along with any libxml++ wrappers, when the last one goes away.
+ */
+class UnparsedDocument : public std::enable_shared_from_this<UnparsedDocument> {
+public:
+    static std::shared_ptr<UnparsedDocument> create();
+
+    UnparsedDocument(const UnparsedDocument&) = delete;
+    UnparsedDocument &operator=(const UnparsedDocument&) = delete;
+    ~UnparsedDocument();
+
+    // Copy the subtree at node into this document
+    std::shared_ptr<UnparsedElement> copyElement(const xmlNode *node);
+
+    // Lock to hold while creating libxml++ wrappers for nodes in this document
+    std::mutex &mutex() { return m_mutex; };
+
+private:
+    UnparsedDocument();
+
+    xmlDocPtr m_doc;
+    std::mutex m_mutex;
+};
+
+/* An element in an UnparsedDocument
+ */
+class UnparsedElement {
+public:
+    UnparsedElement(const std::shared_ptr<UnparsedDocument> &document, xmlNodePtr node)
+        :m_document(document)
+        ,m_node(node)
+    {};
+
+    UnparsedDocument &document() const { return *m_document; };
+    xmlNodePtr node() const { return m_node; };
+
+private:
+    std::shared_ptr<UnparsedDocument> m_document;
+    xmlNodePtr m_node;
+};
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_UNPARSED_ELEMENT_HH_*/
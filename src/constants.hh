@@ -13,6 +13,8 @@
 
 #define MPD_NS "urn:mpeg:dash:schema:mpd:2011"
 #define XLINK_NS "http://www.w3.org/1999/xlink"
+#define MPD_PATCH_NS "urn:mpeg:dash:schema:mpd-patch:2020"
+#define PATCH_OPS_NS "urn:ietf:params:xml:schema:patch-ops"
 
 #define ISO8601_DATE_TIME_FORMAT "{0:%F}T{0:%T}Z"
 #define ISO8601_TIME_DURATION_FORMAT "PT{0:%H}H{0:%M}M{0:%S}S"
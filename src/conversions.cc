@@ -8,31 +8,131 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <charconv>
+#include <chrono>
 #include <list>
 #include <string>
+#include <string_view>
+#include <system_error>
 
 #include "libmpd++/macros.hh"
+#include "libmpd++/exceptions.hh"
 
 #include "conversions.hh"
 
 LIBMPDPP_NAMESPACE_BEGIN
 
 template<>
-std::list<unsigned int> str_to_list<unsigned int>(const std::string &attr_val, char sep)
+unsigned int str_to_list_entry<unsigned int>(const std::string &val)
 {
-    std::list<unsigned int> ret;
-    std::string::size_type start_pos = 0;
-    for (auto pos = attr_val.find_first_of(sep); pos != std::string::npos; start_pos = pos+1, pos = attr_val.find_first_of(sep, start_pos)) {
-        auto val = attr_val.substr(start_pos, pos - start_pos);
-        if (!val.empty()) {
-            ret.push_back(static_cast<unsigned int>(std::stoul(val)));
+    return static_cast<unsigned int>(std::stoul(val));
+}
+
+unsigned int str_to_ui(const std::string &str)
+{
+    return static_cast<unsigned int>(std::stoul(str));
+}
+
+/* Parse an xs:dateTime value
+ *
+ * Format: [-]YYYY-MM-DDThh:mm:ss[.s+][Z|(+|-)hh:mm]
+ *
+ * Fractional seconds are kept to nanosecond precision (any further digits are ignored), a time of 24:00:00 is the start of the
+ * next day and a value with no timezone is taken to be UTC. This does not allocate unless an error is thrown.
+ */
+std::chrono::system_clock::time_point str_to_time_point(std::string_view str)
+{
+    const char *pos = str.data();
+    const char *end = pos + str.size();
+
+    auto parse_error = [str]() {
+        return ParseError("\"" + std::string(str) + "\" is not a valid xs:dateTime value");
+    };
+
+    // Read exactly the given number of digits
+    auto fixed_digits = [&](int digits) {
+        unsigned int val = 0;
+        for (; digits > 0; digits--, pos++) {
+            if (pos == end || *pos < '0' || *pos > '9') throw parse_error();
+            val = val * 10 + (*pos - '0');
         }
+        return val;
+    };
+
+    auto separator = [&](char sep) {
+        if (pos == end || *pos != sep) throw parse_error();
+        pos++;
+    };
+
+    // Date
+    bool negative_year = (pos != end && *pos == '-');
+    if (negative_year) pos++;
+    if (pos == end || *pos < '0' || *pos > '9') throw parse_error();
+    int year;
+    auto [year_end, ec] = std::from_chars(pos, end, year);
+    if (ec != std::errc() || year_end - pos < 4 || (year_end - pos > 4 && *pos == '0')) throw parse_error();
+    pos = year_end;
+    if (negative_year) year = -year;
+    separator('-');
+    auto month = fixed_digits(2);
+    separator('-');
+    auto day = fixed_digits(2);
+    std::chrono::year_month_day ymd{std::chrono::year(year), std::chrono::month(month), std::chrono::day(day)};
+    if (year < static_cast<int>(std::chrono::year::min()) || year > static_cast<int>(std::chrono::year::max()) || !ymd.ok()) {
+        throw parse_error();
+    }
+
+    // Time
+    separator('T');
+    auto hours = fixed_digits(2);
+    separator(':');
+    auto minutes = fixed_digits(2);
+    separator(':');
+    auto seconds = fixed_digits(2);
+    unsigned long nanoseconds = 0;
+    if (pos != end && *pos == '.') {
+        const char *frac_start = ++pos;
+        unsigned long scale = 100000000;
+        for (; pos != end && *pos >= '0' && *pos <= '9'; pos++) {
+            nanoseconds += (*pos - '0') * scale;
+            scale /= 10;
+        }
+        if (pos == frac_start) throw parse_error();
     }
-    auto val = attr_val.substr(start_pos);
-    if (!val.empty()) {
-        ret.push_back(static_cast<unsigned int>(std::stoul(val)));
+    if (minutes > 59 || seconds > 59 || hours > 24 || (hours == 24 && (minutes != 0 || seconds != 0 || nanoseconds != 0))) {
+        throw parse_error();
     }
-    return ret;
+
+    // Timezone
+    std::chrono::minutes offset(0);
+    if (pos != end) {
+        if (*pos == 'Z') {
+            pos++;
+        } else if (*pos == '+' || *pos == '-') {
+            bool negative_offset = (*pos == '-');
+            pos++;
+            auto offset_hours = fixed_digits(2);
+            separator(':');
+            auto offset_minutes = fixed_digits(2);
+            if (offset_minutes > 59 || offset_hours > 14 || (offset_hours == 14 && offset_minutes != 0)) throw parse_error();
+            offset = std::chrono::hours(offset_hours) + std::chrono::minutes(offset_minutes);
+            if (negative_offset) offset = -offset;
+        }
+        if (pos != end) throw parse_error();
+    }
+
+    // Check the value is in the range of system_clock before converting to its (possibly nanosecond) resolution
+    std::chrono::sys_seconds whole_seconds = std::chrono::sys_days(ymd) + std::chrono::hours(hours) +
+                                             std::chrono::minutes(minutes) + std::chrono::seconds(seconds) - offset;
+    static const auto min_seconds = std::chrono::ceil<std::chrono::seconds>(std::chrono::system_clock::time_point::min());
+    static const auto max_seconds = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::time_point::max()) -
+                                    std::chrono::seconds(1);
+    if (whole_seconds < min_seconds || whole_seconds > max_seconds) {
+        throw ParseError("\"" + std::string(str) + "\" is outside the range of supported dates");
+    }
+
+    return std::chrono::time_point_cast<std::chrono::system_clock::duration>(whole_seconds) +
+           std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds));
 }
 
 LIBMPDPP_NAMESPACE_END
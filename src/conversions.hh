@@ -10,13 +10,20 @@
  * For full license terms please see the LICENSE file distributed with this
  * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
  */
+#include <charconv>
 #include <chrono>
+#include <initializer_list>
+#include <iomanip>
 #include <list>
-#include <regex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 #include "libmpd++/macros.hh"
+#include "libmpd++/exceptions.hh"
 
 LIBMPDPP_NAMESPACE_BEGIN
 
@@ -44,65 +51,140 @@ std::string format_duration(const std::chrono::duration<Rep,Period> &durn)
     if ((hours == 0 && mins == 0) || secs != 0 || ms != 0) {
         oss << secs;
         if (ms != 0) {
-            oss << "." << std::setw(3) << ms;
+            oss << "." << std::setfill('0') << std::setw(3) << ms;
         }
         oss << "S";
     }
     return oss.str();
 }
 
-template<class Durn>
-Durn str_to_duration(const std::string &str)
+/* Components of an ISO 8601 duration (xs:duration) value
+ */
+struct ISO8601Duration {
+    unsigned long years = 0;
+    unsigned long months = 0;
+    unsigned long weeks = 0;
+    unsigned long days = 0;
+    unsigned long hours = 0;
+    unsigned long minutes = 0;
+    unsigned long seconds = 0;
+    unsigned long nanoseconds = 0; // fractional part of the seconds
+};
+
+/* Parse an ISO 8601 duration string of the form PnYnMnWnDTnHnMn.nS
+ *
+ * This is a single pass over the string with no allocations (unless an error is thrown). Components may be omitted but at least
+ * one must be present and they must appear in this order, if the T separator is present it must be followed by at least one of
+ * the hours, minutes or seconds. Fractional seconds are kept to nanosecond precision, any further digits are ignored.
+ *
+ * Throws ParseError if the string is not a valid duration.
+ */
+inline ISO8601Duration parse_iso8601_duration(std::string_view str)
 {
-    Durn ret = Durn();
-    static const std::regex durn_parse_regex("^P(?!$)(?:(\\d+)Y)?(?:(\\d+)M)?(?:(\\d+)W)?(?:(\\d+)D)?(?:T(?=\\d+(?:[HM]|(?:\\.\\d+)?S))(?:(\\d+)H)?(?:(\\d+)M)?(?:(\\d+(\\.\\d+)?)S)?)?$");
-    std::smatch matches;
-    if (std::regex_match(str, matches, durn_parse_regex)) {
-        if (matches[1].matched) {
-            ret += std::chrono::years(std::stol(matches[1]));
-        }
-        if (matches[2].matched) {
-            ret += std::chrono::months(std::stol(matches[2]));
-        }
-        if (matches[3].matched) {
-            ret += std::chrono::weeks(std::stol(matches[3]));
-        }
-        if (matches[4].matched) {
-            ret += std::chrono::days(std::stol(matches[4]));
-        }
-        if (matches[5].matched) {
-            ret += std::chrono::hours(std::stol(matches[5]));
-        }
-        if (matches[6].matched) {
-            ret += std::chrono::minutes(std::stol(matches[6]));
-        }
-        if (matches[7].matched) {
-            ret += std::chrono::milliseconds(static_cast<long int>(std::stod(matches[7])*1000));
+    ISO8601Duration ret;
+    const char *pos = str.data();
+    const char *end = pos + str.size();
+    bool have_component = false;
+
+    auto parse_error = [str]() {
+        return ParseError("\"" + std::string(str) + "\" is not a valid ISO 8601 duration");
+    };
+
+    // Parse components from pos, the designators must appear in the order given
+    auto parse_components = [&](std::initializer_list<std::pair<char, unsigned long*> > components, bool allow_fraction) {
+        auto next = components.begin();
+        while (pos != end && *pos != 'T') {
+            unsigned long val;
+            auto [num_end, ec] = std::from_chars(pos, end, val);
+            if (ec != std::errc() || num_end == end) throw parse_error();
+            pos = num_end;
+            unsigned long nanoseconds = 0;
+            bool have_fraction = false;
+            if (allow_fraction && *pos == '.') {
+                const char *frac_start = ++pos;
+                unsigned long scale = 100000000;
+                for (; pos != end && *pos >= '0' && *pos <= '9'; pos++) {
+                    nanoseconds += (*pos - '0') * scale;
+                    scale /= 10;
+                }
+                if (pos == frac_start || pos == end) throw parse_error();
+                have_fraction = true;
+            }
+            while (next != components.end() && next->first != *pos) next++;
+            if (next == components.end() || (have_fraction && *pos != 'S')) throw parse_error();
+            *next->second = val;
+            if (have_fraction) ret.nanoseconds = nanoseconds;
+            next++;
+            pos++;
+            have_component = true;
         }
+    };
+
+    if (pos == end || *pos != 'P') throw parse_error();
+    pos++;
+    parse_components({{'Y', &ret.years}, {'M', &ret.months}, {'W', &ret.weeks}, {'D', &ret.days}}, false);
+    if (pos != end) {
+        // must be at the T separator, which must be followed by at least one time component
+        pos++;
+        if (pos == end) throw parse_error();
+        parse_components({{'H', &ret.hours}, {'M', &ret.minutes}, {'S', &ret.seconds}}, true);
+        if (pos != end) throw parse_error();
     }
+    if (!have_component) throw parse_error();
+
     return ret;
 }
 
+template<class Durn>
+Durn str_to_duration(const std::string &str)
+{
+    auto durn = parse_iso8601_duration(str);
+    return std::chrono::duration_cast<Durn>(std::chrono::years(durn.years)) +
+           std::chrono::duration_cast<Durn>(std::chrono::months(durn.months)) +
+           std::chrono::duration_cast<Durn>(std::chrono::weeks(durn.weeks)) +
+           std::chrono::duration_cast<Durn>(std::chrono::days(durn.days)) +
+           std::chrono::duration_cast<Durn>(std::chrono::hours(durn.hours)) +
+           std::chrono::duration_cast<Durn>(std::chrono::minutes(durn.minutes)) +
+           std::chrono::duration_cast<Durn>(std::chrono::seconds(durn.seconds)) +
+           std::chrono::duration_cast<Durn>(std::chrono::nanoseconds(durn.nanoseconds));
+}
+
 template<typename T>
-std::list<T> str_to_list(const std::string &attr_val, char sep = ',')
+T str_to_list_entry(const std::string &val)
+{
+    return T(val);
+}
+
+template<>
+unsigned int str_to_list_entry<unsigned int>(const std::string &val);
+
+template<typename T, class Container = std::list<T> >
+Container str_to_list(const std::string &attr_val, char sep = ',')
 {
-    std::list<T> ret;
+    Container ret;
     std::string::size_type start_pos = 0;
     for (auto pos = attr_val.find_first_of(sep); pos != std::string::npos; start_pos = pos+1, pos = attr_val.find_first_of(sep, start_pos)) {
         auto val = attr_val.substr(start_pos, pos - start_pos);
         if (!val.empty()) {
-            ret.push_back(T(val));
+            ret.push_back(str_to_list_entry<T>(val));
         }
     }
     auto val = attr_val.substr(start_pos);
     if (!val.empty()) {
-        ret.push_back(T(val));
+        ret.push_back(str_to_list_entry<T>(val));
     }
     return ret;
 }
 
-template<>
-std::list<unsigned int> str_to_list<unsigned int>(const std::string &attr_val, char sep);
+template<typename T>
+std::vector<T> str_to_vector(const std::string &attr_val, char sep = ',')
+{
+    return str_to_list<T, std::vector<T> >(attr_val, sep);
+}
+
+unsigned int str_to_ui(const std::string &str);
+
+std::chrono::system_clock::time_point str_to_time_point(std::string_view str);
 
 LIBMPDPP_NAMESPACE_END
 
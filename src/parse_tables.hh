@@ -0,0 +1,180 @@
+#ifndef _BBC_PARSE_DASH_MPD_PARSE_TABLES_HH_
+#define _BBC_PARSE_DASH_MPD_PARSE_TABLES_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: XML attribute and child element tables
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <libxml/tree.h>
+#include <libxml++/libxml++.h>
+
+#include "libmpd++/macros.hh"
+#include "libmpd++/exceptions.hh"
+#include "libmpd++/ParseFilter.hh"
+
+#include "constants.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/* Get the value of an attribute node as a string
+ *
+ * Attribute values are almost always a single text node, in which case the text is copied directly, otherwise libxml2 is used
+ * to concatenate the text and entity reference children.
+ */
+inline std::string xml_attribute_value(const xmlAttr *attr)
+{
+    const xmlNode *text = attr->children;
+    if (text && !text->next && text->type == XML_TEXT_NODE) {
+        return std::string(text->content?reinterpret_cast<const char*>(text->content):"");
+    }
+    xmlChar *val = xmlNodeListGetString(attr->doc, attr->children, 1);
+    std::string ret(val?reinterpret_cast<const char*>(val):"");
+    if (val) xmlFree(val);
+    return ret;
+}
+
+/* Parse filter scope
+ *
+ * Makes a ParseFilter available to the element tables in the current thread while an MPD, or part of one, is being parsed. Scopes
+ * can be nested and the previous filter is restored when a scope ends. A `nullptr` filter leaves the current filter in place.
+ */
+class ParseFilterScope {
+public:
+    explicit ParseFilterScope(const ParseFilter *filter) :m_previous(s_current) { if (filter) s_current = filter; };
+    ParseFilterScope(const ParseFilterScope&) = delete;
+    ParseFilterScope &operator=(const ParseFilterScope&) = delete;
+    ~ParseFilterScope() { s_current = m_previous; };
+
+    static const ParseFilter *current() { return s_current; };
+
+    // Check if the current filter skips an element, this is checked before any objects are created for the element
+    static bool skips(const xmlNode *cnode) {
+        return s_current && s_current->skipsElement(std::string_view(reinterpret_cast<const char*>(cnode->name)));
+    };
+
+    // Check if the current filter skips an AdaptationSet or EmptyAdaptationSet element
+    static bool skipsAdaptationSet(const xmlNode *cnode) {
+        return s_current && s_current->skipsAdaptationSet(ParseFilter::AdaptationSetInfo(cnode));
+    };
+
+private:
+    const ParseFilter *m_previous;
+    static inline thread_local const ParseFilter *s_current = nullptr;
+};
+
+/* Attribute dispatch table
+ *
+ * Maps un-namespaced attribute names to handler functions so that all the attributes of an element can be processed in a single
+ * pass over the element's attribute list, rather than one XPath query per possible attribute. Entries marked as mandatory will
+ * cause a ParseError if the attribute is not present.
+ *
+ * Tables are intended to be function local statics in the XML constructor of the class they populate, so that the handlers have
+ * the same access to private members as the constructor.
+ */
+template <class T>
+class AttributeTable {
+public:
+    using handler_type = void (*)(T&, const std::string&);
+
+    struct Entry {
+        std::string_view name;
+        handler_type handler;
+        bool mandatory = false;
+    };
+
+    AttributeTable(const char *element_path, std::initializer_list<Entry> entries)
+        :m_elementPath(element_path)
+        ,m_entries(entries)
+        ,m_index()
+        ,m_mandatoryMask(0)
+    {
+        if (m_entries.size() > 64) throw std::logic_error("AttributeTable can only hold up to 64 entries");
+        for (typename std::vector<Entry>::size_type i = 0; i < m_entries.size(); i++) {
+            m_index.emplace(m_entries[i].name, i);
+            if (m_entries[i].mandatory) m_mandatoryMask |= (std::uint64_t(1) << i);
+        }
+    };
+
+    void apply(T &obj, xmlpp::Node &node) const {
+        apply(obj, node.cobj());
+    };
+
+    void apply(T &obj, const xmlNode *cnode) const {
+        std::uint64_t seen = 0;
+        if (cnode->type == XML_ELEMENT_NODE) {
+            for (const xmlAttr *attr = cnode->properties; attr; attr = attr->next) {
+                if (attr->ns) continue; // only un-namespaced attributes are handled by the table
+                auto it = m_index.find(std::string_view(reinterpret_cast<const char*>(attr->name)));
+                if (it == m_index.end()) continue;
+                m_entries[it->second].handler(obj, xml_attribute_value(attr));
+                seen |= (std::uint64_t(1) << it->second);
+            }
+        }
+        auto missing = m_mandatoryMask & ~seen;
+        if (missing) {
+            const auto &entry = m_entries[std::countr_zero(missing)];
+            throw ParseError(m_elementPath + " must have a \"" + std::string(entry.name) + "\" attribute");
+        }
+    };
+
+private:
+    std::string m_elementPath;
+    std::vector<Entry> m_entries;
+    std::unordered_map<std::string_view, typename std::vector<Entry>::size_type> m_index;
+    std::uint64_t m_mandatoryMask;
+};
+
+/* Child element dispatch table
+ *
+ * Maps the names of child elements in the MPD namespace to handler functions so that all the children of an element can be
+ * processed in a single pass, in document order, rather than one XPath query per possible child element. Children in other
+ * namespaces, with names not in the table, or skipped by the current ParseFilterScope, are ignored.
+ */
+template <class T>
+class ElementTable {
+public:
+    using handler_type = void (*)(T&, xmlpp::Node&);
+
+    ElementTable(std::initializer_list<std::pair<const std::string_view, handler_type> > entries)
+        :m_handlers(entries)
+    {};
+
+    void apply(T &obj, xmlpp::Node &node) const {
+        for (auto child : node.get_children()) {
+            applyChild(obj, *child);
+        }
+    };
+
+    void applyChild(T &obj, xmlpp::Node &child) const {
+        const xmlNode *cnode = child.cobj();
+        if (cnode->type != XML_ELEMENT_NODE || !cnode->ns || !cnode->ns->href) return;
+        if (std::strcmp(reinterpret_cast<const char*>(cnode->ns->href), MPD_NS) != 0) return;
+        if (ParseFilterScope::skips(cnode)) return;
+        auto it = m_handlers.find(std::string_view(reinterpret_cast<const char*>(cnode->name)));
+        if (it != m_handlers.end()) it->second(obj, child);
+    };
+
+private:
+    std::unordered_map<std::string_view, handler_type> m_handlers;
+};
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_PARSE_TABLES_HH_*/
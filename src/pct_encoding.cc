@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * DASH MPD parsing library in C++: percent-encoding functions
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "libmpd++/macros.hh"
+#include "libmpd++/exceptions.hh"
+
+#include "pct_encoding.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/* The vector fast paths find the length of a run of characters that can be copied as is. Encoding looks for the end of a run of
+ * unreserved characters (plus '/' when that is allowed), which are in every character set and make up nearly all of the URL
+ * text we see, and then falls back to the classification table for the character that ends the run. Decoding looks for the
+ * next '%'.
+ *
+ * The instruction set is chosen at compile time, SSE2 is always available on x86-64 and AVX2 is used when the library is
+ * built for a target which has it (e.g. -march=x86-64-v3).
+ */
+
+#if defined(__AVX2__)
+
+static inline __m256i in_range_avx2(__m256i chars, char low, char high)
+{
+    // signed comparisons, so bytes above 0x7f are never in range
+    return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(low - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), chars));
+}
+
+static std::size_t copyable_run(const char *str, std::size_t length, bool slash_allowed)
+{
+    std::size_t pos = 0;
+    const __m256i slash = _mm256_set1_epi8(slash_allowed?'/':'-');
+    for (; length - pos >= 32; pos += 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + pos));
+        __m256i ok = _mm256_or_si256(
+                _mm256_or_si256(in_range_avx2(chars, 'a', 'z'), in_range_avx2(chars, 'A', 'Z')),
+                _mm256_or_si256(_mm256_or_si256(in_range_avx2(chars, '0', '9'), in_range_avx2(chars, '-', '.')),
+                                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')),
+                                                                _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('~'))),
+                                                _mm256_cmpeq_epi8(chars, slash))));
+        unsigned int bad = ~static_cast<unsigned int>(_mm256_movemask_epi8(ok));
+        if (bad != 0) return pos + __builtin_ctz(bad);
+    }
+    return pos;
+}
+
+static std::size_t find_percent(const char *str, std::size_t length)
+{
+    std::size_t pos = 0;
+    const __m256i percent = _mm256_set1_epi8('%');
+    for (; length - pos >= 32; pos += 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + pos));
+        unsigned int found = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, percent)));
+        if (found != 0) return pos + __builtin_ctz(found);
+    }
+    return pos;
+}
+
+#elif defined(__SSE2__)
+
+static inline __m128i in_range_sse2(__m128i chars, char low, char high)
+{
+    // signed comparisons, so bytes above 0x7f are never in range
+    return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(low - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8(high + 1)));
+}
+
+static std::size_t copyable_run(const char *str, std::size_t length, bool slash_allowed)
+{
+    std::size_t pos = 0;
+    const __m128i slash = _mm_set1_epi8(slash_allowed?'/':'-');
+    for (; length - pos >= 16; pos += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + pos));
+        __m128i ok = _mm_or_si128(
+                _mm_or_si128(in_range_sse2(chars, 'a', 'z'), in_range_sse2(chars, 'A', 'Z')),
+                _mm_or_si128(_mm_or_si128(in_range_sse2(chars, '0', '9'), in_range_sse2(chars, '-', '.')),
+                             _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('_')),
+                                                       _mm_cmpeq_epi8(chars, _mm_set1_epi8('~'))),
+                                          _mm_cmpeq_epi8(chars, slash))));
+        unsigned int bad = static_cast<unsigned int>(_mm_movemask_epi8(ok)) ^ 0xffffu;
+        if (bad != 0) return pos + __builtin_ctz(bad);
+    }
+    return pos;
+}
+
+static std::size_t find_percent(const char *str, std::size_t length)
+{
+    std::size_t pos = 0;
+    const __m128i percent = _mm_set1_epi8('%');
+    for (; length - pos >= 16; pos += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + pos));
+        unsigned int found = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, percent)));
+        if (found != 0) return pos + __builtin_ctz(found);
+    }
+    return pos;
+}
+
+#else
+
+// No vector instructions, the scalar loops below do all the work
+static std::size_t copyable_run(const char *, std::size_t, bool)
+{
+    return 0;
+}
+
+static std::size_t find_percent(const char *, std::size_t)
+{
+    return 0;
+}
+
+#endif
+
+void pct_encode_append(std::string &out, std::string_view str, PctCharSet allowed)
+{
+    const bool slash_allowed = pct_is_allowed('/', allowed);
+    const char *pos = str.data();
+    const char *end = pos + str.size();
+
+    while (pos != end) {
+        // copy the run of characters which do not need encoding
+        const char *run_end = pos + copyable_run(pos, end - pos, slash_allowed);
+        while (run_end != end && pct_is_allowed(*run_end, allowed)) run_end++;
+        out.append(pos, run_end - pos);
+        pos = run_end;
+
+        // encode characters until the next one that can be copied
+        for (; pos != end && !pct_is_allowed(*pos, allowed); pos++) {
+            const char encoded[3] = {'%', g_pct_hex_chars[static_cast<unsigned char>(*pos)>>4],
+                                     g_pct_hex_chars[static_cast<unsigned char>(*pos)&0xf]};
+            out.append(encoded, 3);
+        }
+    }
+}
+
+std::string pct_encode(std::string_view str, PctCharSet allowed)
+{
+    std::string ret;
+    ret.reserve(str.size());
+    pct_encode_append(ret, str, allowed);
+    return ret;
+}
+
+bool pct_decode_append(std::string &out, std::string_view str)
+{
+    const char *pos = str.data();
+    const char *end = pos + str.size();
+
+    while (pos != end) {
+        // copy up to the next '%'
+        const char *percent = pos + find_percent(pos, end - pos);
+        percent = static_cast<const char*>(std::memchr(percent, '%', end - percent));
+        if (!percent) {
+            out.append(pos, end - pos);
+            break;
+        }
+        out.append(pos, percent - pos);
+
+        if (end - percent < 3) return false;
+        int high = pct_hex_value(percent[1]);
+        int low = pct_hex_value(percent[2]);
+        if (high < 0 || low < 0) return false;
+        out += static_cast<char>(high * 16 + low);
+        pos = percent + 3;
+    }
+
+    return true;
+}
+
+std::string pct_decode(std::string_view str)
+{
+    std::string ret;
+    ret.reserve(str.size());
+    if (!pct_decode_append(ret, str)) throw ParseError("Bad percent-encoding in \"" + std::string(str) + "\"");
+    return ret;
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,96 @@
+#ifndef _BBC_PARSE_DASH_MPD_PCT_ENCODING_HH_
+#define _BBC_PARSE_DASH_MPD_PCT_ENCODING_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: percent-encoding functions
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "libmpd++/macros.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/* Sets of characters which can appear without percent-encoding, used as bit flags in the character classification table
+ *
+ * Unreserved characters (RFC 3986) are in every set.
+ */
+enum PctCharSet : unsigned char {
+    PCT_UNRESERVED = 0x01, // ALPHA / DIGIT / "-" / "." / "_" / "~"
+    PCT_USERINFO   = 0x02, // unreserved / sub-delims / ":"
+    PCT_HOST       = 0x04, // unreserved / sub-delims
+    PCT_IP_LITERAL = 0x08, // unreserved / sub-delims / ":"
+    PCT_PATH       = 0x10, // pchar / "/"
+    PCT_QUERY      = 0x20, // pchar / "/" / "?", also used for fragments
+    PCT_ATTR_CHAR  = 0x40  // attr-char from RFC 8187 (ALPHA / DIGIT / "!#$&+-.^_`|~"), used for @codecs
+};
+
+constexpr std::array<unsigned char, 256> make_pct_char_sets()
+{
+    std::array<unsigned char, 256> sets{};
+    auto add = [&sets](const char *chars, unsigned char flags) {
+        for (; *chars; chars++) sets[static_cast<unsigned char>(*chars)] |= flags;
+    };
+    const unsigned char url_sets = PCT_UNRESERVED | PCT_USERINFO | PCT_HOST | PCT_IP_LITERAL | PCT_PATH | PCT_QUERY;
+    add("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", url_sets | PCT_ATTR_CHAR);
+    add("-._~", url_sets);
+    add("!$&'()*+,;=", PCT_USERINFO | PCT_HOST | PCT_IP_LITERAL | PCT_PATH | PCT_QUERY);
+    add(":", PCT_USERINFO | PCT_IP_LITERAL | PCT_PATH | PCT_QUERY);
+    add("@/", PCT_PATH | PCT_QUERY);
+    add("?", PCT_QUERY);
+    add("!#$&+-.^_`|~", PCT_ATTR_CHAR);
+    return sets;
+}
+
+constexpr std::array<signed char, 256> make_pct_hex_values()
+{
+    std::array<signed char, 256> values{};
+    for (auto &val : values) val = -1;
+    for (int i = 0; i < 10; i++) values['0' + i] = static_cast<signed char>(i);
+    for (int i = 0; i < 6; i++) {
+        values['A' + i] = static_cast<signed char>(10 + i);
+        values['a' + i] = static_cast<signed char>(10 + i);
+    }
+    return values;
+}
+
+inline constexpr std::array<unsigned char, 256> g_pct_char_sets = make_pct_char_sets();
+inline constexpr std::array<signed char, 256> g_pct_hex_values = make_pct_hex_values();
+inline constexpr char g_pct_hex_chars[] = "0123456789ABCDEF";
+
+// Check if c can appear without percent-encoding in the character set
+inline bool pct_is_allowed(char c, PctCharSet allowed)
+{
+    return (g_pct_char_sets[static_cast<unsigned char>(c)] & allowed) != 0;
+}
+
+// Value of a hexadecimal digit or -1 if c is not a hexadecimal digit
+inline int pct_hex_value(char c)
+{
+    return g_pct_hex_values[static_cast<unsigned char>(c)];
+}
+
+// Append str to out, percent-encoding any character not in the allowed set
+void pct_encode_append(std::string &out, std::string_view str, PctCharSet allowed);
+
+// Percent-encode any character in str which is not in the allowed set
+std::string pct_encode(std::string_view str, PctCharSet allowed);
+
+// Append str to out, decoding percent-encoded octets. Returns false, leaving out partially appended, on a bad encoding.
+bool pct_decode_append(std::string &out, std::string_view str);
+
+// Decode the percent-encoded octets in str, throws ParseError on a bad encoding
+std::string pct_decode(std::string_view str);
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /* _BBC_PARSE_DASH_MPD_PCT_ENCODING_HH_ */
@@ -0,0 +1,35 @@
+#ifndef _BBC_PARSE_DASH_MPD_SPAN_ITERATORS_HH_
+#define _BBC_PARSE_DASH_MPD_SPAN_ITERATORS_HH_
+/*****************************************************************************
+ * DASH MPD parsing library in C++: span iterator conversions
+ *****************************************************************************
+ * Copyright: (C) 2025 British Broadcasting Corporation
+ * Author(s): David Waring <david.waring2@bbc.co.uk>
+ * License: LGPLv3
+ *
+ * For full license terms please see the LICENSE file distributed with this
+ * library or refer to: https://www.gnu.org/licenses/lgpl-3.0.txt.
+ */
+#include <memory>
+#include <vector>
+
+#include "libmpd++/macros.hh"
+
+LIBMPDPP_NAMESPACE_BEGIN
+
+/* Convert an iterator from a std::span view of a vector back into an iterator for the vector
+ *
+ * The public API gives out std::span views of the contiguous containers, this finds the same position in the vector so that it
+ * can be used to modify the container.
+ */
+template <class T, class Alloc, class SpanIterator>
+typename std::vector<T, Alloc>::iterator vector_iterator(std::vector<T, Alloc> &vec, const SpanIterator &it)
+{
+    return vec.begin() + (std::to_address(it) - vec.data());
+}
+
+LIBMPDPP_NAMESPACE_END
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
+#endif /*_BBC_PARSE_DASH_MPD_SPAN_ITERATORS_HH_*/
@@ -0,0 +1,91 @@
+#include <functional>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+bool test_codecs_plain()
+{
+    Codecs codecs("avc1.64001f,mp4a.40.2");
+    if (codecs.hasEncoding() || codecs.codecs() != std::list<std::string>({"avc1.64001f", "mp4a.40.2"})) {
+        std::cerr << "Plain @codecs value parsed incorrectly" << std::endl;
+        return false;
+    }
+    if (std::string(codecs) != "avc1.64001f,mp4a.40.2") {
+        std::cerr << "Plain @codecs value output as \"" << std::string(codecs) << "\"" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_codecs_encoded()
+{
+    Codecs codecs("utf-8'en'avc1.64001f,x%2Dcodec%2C%20one%25,caf%C3%A9");
+    if (!codecs.hasEncoding() || std::string(codecs.encoding().value()) != "utf-8'en'") {
+        std::cerr << "Encoded @codecs value has the wrong encoding" << std::endl;
+        return false;
+    }
+    if (codecs.codecs() != std::list<std::string>({"avc1.64001f", "x-codec, one%", "caf\xc3\xa9"})) {
+        std::cerr << "Encoded @codecs value was not percent-decoded correctly" << std::endl;
+        return false;
+    }
+    std::string encoded(codecs);
+    if (encoded != "utf-8'en'avc1.64001f,x-codec%2C%20one%25,caf%C3%A9") {
+        std::cerr << "Encoded @codecs value output as \"" << encoded << "\"" << std::endl;
+        return false;
+    }
+    if (Codecs(encoded) != codecs) {
+        std::cerr << "Encoded @codecs value did not survive a round trip" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_codecs_bad_encoding()
+{
+    for (const char *str : {"utf-8'en'avc1%2", "utf-8'en'avc1%zz.64001f"}) {
+        try {
+            Codecs codecs(str);
+            std::cerr << "Expected ParseError for bad percent-encoding in \"" << str << "\"" << std::endl;
+            return false;
+        } catch (ParseError &ex) {
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Plain @codecs values", test_codecs_plain },
+        { "Percent-encoded @codecs values", test_codecs_encoded },
+        { "Bad percent-encodings are rejected", test_codecs_bad_encoding }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
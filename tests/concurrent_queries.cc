@@ -0,0 +1,206 @@
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+using namespace std::chrono_literals;
+
+// Build with "meson setup -Db_sanitize=thread" to have ThreadSanitizer check these tests for data races
+
+static const unsigned int c_threads = 32;
+
+static const char *c_mpd_xml =
+    "<?xml version=\"1.0\"?>"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" type=\"dynamic\""
+    " availabilityStartTime=\"1970-01-01T00:00:00Z\" minimumUpdatePeriod=\"PT2S\" minBufferTime=\"PT2S\">"
+    "<BaseURL>https://cdn.example.com/live/</BaseURL>"
+    "<Period id=\"p0\" start=\"PT0S\"><BaseURL>p0/</BaseURL>"
+    "<AdaptationSet contentType=\"video\" mimeType=\"video/mp4\">"
+    "<SegmentTemplate timescale=\"1000\" duration=\"2000\" media=\"$RepresentationID$/$Number$.m4s\""
+    " initialization=\"$RepresentationID$/init.mp4\"/>"
+    "<Representation id=\"v1\" bandwidth=\"1000000\"/><Representation id=\"v2\" bandwidth=\"2000000\"/>"
+    "</AdaptationSet></Period>"
+    "<Period id=\"p1\" start=\"PT60S\"><BaseURL>p1/</BaseURL>"
+    "<AdaptationSet contentType=\"video\" mimeType=\"video/mp4\">"
+    "<SegmentTemplate timescale=\"1000\" duration=\"2000\" media=\"$RepresentationID$/$Number$.m4s\""
+    " initialization=\"$RepresentationID$/init.mp4\"/>"
+    "<Representation id=\"v1\" bandwidth=\"1000000\"/><Representation id=\"v2\" bandwidth=\"2000000\"/>"
+    "</AdaptationSet></Period>"
+    "</MPD>";
+
+// A live MPD with several Periods, built without parsing so that every cache starts empty
+static MPD make_mpd(const MPD::time_type &ast)
+{
+    SegmentTemplate seg_template;
+    seg_template.media("$RepresentationID$/$Number$.m4s").initialization("$RepresentationID$/init.mp4");
+    seg_template.timescale(1000);
+    seg_template.duration(2000);
+
+    auto make_period = [&seg_template](unsigned int i) {
+        AdaptationSet video;
+        video.baseURLsAdd(BaseURL("video/")).segmentTemplate(seg_template);
+        for (unsigned int bandwidth : {500000, 1000000, 2000000}) {
+            video.representationsAdd(Representation().id("v" + std::to_string(bandwidth)).bandwidth(bandwidth));
+        }
+        // SegmentBase only, addressed through a per-call MultipleSegmentBase
+        AdaptationSet audio;
+        audio.segmentBase(SegmentBase().timescale(48000));
+        audio.representationsAdd(Representation().id("a1").bandwidth(128000));
+
+        Period period;
+        period.id("p" + std::to_string(i)).start(Period::duration_type(i * 10min));
+        period.baseURLAdd(BaseURL("period" + std::to_string(i) + "/"));
+        period.adaptationSetAdd(std::move(video)).adaptationSetAdd(std::move(audio));
+        return period;
+    };
+
+    MPD mpd(2s, URI("urn:mpeg:dash:profile:isoff-live:2011"), make_period(0), MPD::DYNAMIC);
+    mpd.availabilityStartTime(ast);
+    mpd.baseURLAdd(BaseURL("https://cdn.example.com/live/"));
+    for (unsigned int i = 1; i < 6; i++) mpd.periodAdd(make_period(i));
+    mpd.selectAllRepresentations();
+    return mpd;
+}
+
+// Run queries from c_threads threads at once, each comparing its results to the expected results
+template <typename Query, typename Result>
+static bool run_concurrently(const std::vector<Result> &expected, Query &&query)
+{
+    std::atomic<bool> go(false);
+    std::atomic<unsigned int> mismatches(0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < c_threads; t++) {
+        threads.emplace_back([&, t]() {
+            while (!go.load()) std::this_thread::yield();
+            // each thread starts at a different query so that the caches are filled in different orders
+            for (std::size_t i = 0; i < expected.size(); i++) {
+                std::size_t n = (i + t * 7) % expected.size();
+                if (query(n) != expected[n]) mismatches++;
+            }
+        });
+    }
+    go = true;
+    for (auto &thread : threads) thread.join();
+
+    if (mismatches.load() != 0) {
+        std::cerr << mismatches.load() << " queries gave different results when run concurrently" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_concurrent_selected_segments()
+{
+    auto ast = std::chrono::time_point_cast<MPD::time_type::duration>(std::chrono::system_clock::now() - 1h);
+    MPD reference(make_mpd(ast));
+
+    std::vector<MPD::time_type> query_times;
+    for (unsigned int i = 0; i < 200; i++) query_times.push_back(ast + i * 17s);
+
+    std::vector<std::list<SegmentAvailability> > expected;
+    for (const auto &query_time : query_times) {
+        expected.push_back(reference.selectedSegmentAvailability(query_time));
+    }
+    if (expected.front().empty()) {
+        std::cerr << "No segments available from the reference MPD" << std::endl;
+        return false;
+    }
+
+    // A fresh MPD shared by all threads, so that the Period times and BaseURLs are first calculated concurrently
+    const MPD shared(make_mpd(ast));
+    return run_concurrently(expected, [&](std::size_t n) { return shared.selectedSegmentAvailability(query_times[n]); });
+}
+
+bool test_concurrent_representation_queries()
+{
+    auto ast = std::chrono::time_point_cast<MPD::time_type::duration>(std::chrono::system_clock::now() - 1h);
+    MPD reference(make_mpd(ast));
+    const MPD shared(make_mpd(ast));
+
+    std::vector<const Representation*> reference_reps;
+    std::vector<const Representation*> shared_reps;
+    for (const auto &period : reference.periods()) {
+        for (const auto &rep : period.adaptationSets().front().representations()) reference_reps.push_back(&rep);
+    }
+    for (const auto &period : shared.periods()) {
+        for (const auto &rep : period.adaptationSets().front().representations()) shared_reps.push_back(&rep);
+    }
+
+    std::vector<SegmentAvailability> expected;
+    std::vector<std::pair<std::size_t, MPD::time_type> > queries;
+    for (std::size_t r = 0; r < reference_reps.size(); r++) {
+        for (unsigned int i = 0; i < 20; i++) {
+            auto query_time = ast + r * 3min + i * 5s;
+            queries.emplace_back(r, query_time);
+            expected.push_back(reference_reps[r]->segmentAvailability(query_time));
+        }
+    }
+
+    return run_concurrently(expected, [&](std::size_t n) {
+        const auto &[r, query_time] = queries[n];
+        // mix in BaseURL lookups which share the cached lists
+        if (shared_reps[r]->getBaseURLs().empty()) return SegmentAvailability();
+        return shared_reps[r]->segmentAvailability(query_time);
+    });
+}
+
+bool test_concurrent_lazy_periods()
+{
+    std::string xml(c_mpd_xml);
+    std::vector<char> mpd_xml(xml.begin(), xml.end());
+    const MPD reference(mpd_xml);
+    const MPD shared(mpd_xml, std::nullopt, MPD::ParseOptions().lazyPeriods(true));
+
+    std::vector<std::string> expected;
+    for (const auto &period : reference.periods()) {
+        for (const auto &rep : period.adaptationSets().front().representations()) {
+            expected.push_back(rep.getInitializationURL().str());
+        }
+    }
+
+    // Many threads materialising the same lazy Periods at once
+    return run_concurrently(expected, [&](std::size_t n) {
+        const auto &period = *std::next(shared.periods().begin(), n / 2);
+        return std::next(period.adaptationSets().front().representations().begin(), n % 2)->getInitializationURL().str();
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Concurrent MPD segment queries", test_concurrent_selected_segments },
+        { "Concurrent Representation segment queries", test_concurrent_representation_queries },
+        { "Concurrent lazy Period parsing", test_concurrent_lazy_periods }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
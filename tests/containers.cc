@@ -0,0 +1,109 @@
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+std::filesystem::path g_test_live_mpd;
+
+bool test_profile_index()
+{
+    MPD mpd(g_test_live_mpd.string());
+    std::vector<URI>::size_type idx = 0;
+    for (auto it = mpd.profilesBegin(); it != mpd.profilesEnd(); it++, idx++) {
+        if (&mpd.profile(idx) != &(*it)) {
+            std::cerr << "MPD profile " << idx << " is not the entry found by iterating the profiles" << std::endl;
+            return false;
+        }
+    }
+    if (idx != mpd.profiles().size() || idx != 2) {
+        std::cerr << "Expected 2 MPD profiles, found " << idx << std::endl;
+        return false;
+    }
+    try {
+        mpd.profile(idx);
+        std::cerr << "Reading past the end of the MPD profiles did not throw" << std::endl;
+        return false;
+    } catch (const std::out_of_range&) {
+    }
+    return true;
+}
+
+bool test_remove_by_iterator()
+{
+    MPD mpd(g_test_live_mpd.string());
+    URI last(mpd.profiles().back());
+    mpd.profileRemove(mpd.profilesBegin());
+    if (mpd.profiles().size() != 1 || mpd.profile(0) != last) {
+        std::cerr << "Removing the first MPD profile by iterator did not leave the last profile" << std::endl;
+        return false;
+    }
+
+    SegmentList seg_list;
+    for (const char *media : {"1.m4s", "2.m4s", "3.m4s"}) {
+        seg_list.segmentURLAdd(SegmentURL().media(URI(media)));
+    }
+    seg_list.segmentURLRemove(std::next(seg_list.segmentURLsBegin()));
+    const SegmentList &const_seg_list = seg_list;
+    seg_list.segmentURLRemove(const_seg_list.segmentURLsBegin());
+    if (seg_list.segmentURLs().size() != 1 || seg_list.getMediaURLForSegment(0) != "3.m4s") {
+        std::cerr << "Removing SegmentURLs by iterator removed the wrong entries" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_audio_sampling_rates()
+{
+    Representation rep;
+    rep.audioSamplingRates(std::vector<unsigned int>{44100, 48000});
+    if (rep.audioSamplingRate(1) != 48000) {
+        std::cerr << "Wrong @audioSamplingRate at index 1" << std::endl;
+        return false;
+    }
+    rep.audioSamplingRatesRemove(rep.audioSamplingRatesBegin());
+    if (rep.audioSamplingRates().size() != 1 || rep.audioSamplingRate(0) != 48000) {
+        std::cerr << "Removing the first @audioSamplingRate left the wrong value" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    g_test_live_mpd = argv[1];
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Indexed profile access matches iteration", test_profile_index },
+        { "Entries can be removed using view iterators", test_remove_by_iterator },
+        { "Indexed @audioSamplingRate access", test_audio_sampling_rates }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+static MPD parse_with_publish_time(const std::string &publish_time)
+{
+    std::istringstream in("<?xml version=\"1.0\"?>"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" type=\"dynamic\""
+        " availabilityStartTime=\"1970-01-01T00:00:00Z\" publishTime=\"" + publish_time + "\" minBufferTime=\"PT2S\">"
+        "<Period id=\"p0\" start=\"PT0S\"/>"
+        "</MPD>");
+    return MPD(in, std::nullopt);
+}
+
+bool test_date_time_values()
+{
+    using namespace std::chrono;
+    const MPD::time_type new_year = sys_days(year(2025)/January/1);
+    static const std::vector<std::pair<std::string, MPD::time_type> > cases = {
+        {"2025-01-01T00:00:00Z", new_year},
+        {"2025-01-01T00:00:00", new_year},
+        {"2025-01-01T00:00:00.25Z", new_year + milliseconds(250)},
+        {"2025-01-01T00:00:00.000001Z", new_year + microseconds(1)},
+        {"2025-01-01T01:30:00+01:30", new_year},
+        {"2024-12-31T22:00:00-02:00", new_year},
+        {"2024-12-31T24:00:00Z", new_year},
+        {"2024-02-29T12:00:00Z", sys_days(year(2024)/February/29) + hours(12)}
+    };
+
+    for (const auto &[str, expected] : cases) {
+        MPD mpd(parse_with_publish_time(str));
+        if (mpd.publishTime() != expected) {
+            std::cerr << "Date-time \"" << str << "\" parsed incorrectly" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_date_time_invalid()
+{
+    for (const char *str : {"", "2025-01-01", "25-01-01T00:00:00Z", "2025-1-01T00:00:00Z", "2025-13-01T00:00:00Z",
+                            "2025-02-29T00:00:00Z", "2025-01-01 00:00:00Z", "2025-01-01T25:00:00Z", "2025-01-01T24:00:01Z",
+                            "2025-01-01T00:60:00Z", "2025-01-01T00:00:00.Z", "2025-01-01T00:00:00+1:00",
+                            "2025-01-01T00:00:00+15:00", "2025-01-01T00:00:00ZZ"}) {
+        try {
+            parse_with_publish_time(str);
+            std::cerr << "Expected ParseError for invalid date-time \"" << str << "\"" << std::endl;
+            return false;
+        } catch (ParseError &ex) {
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Date-time values", test_date_time_values },
+        { "Invalid date-times are rejected", test_date_time_invalid }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
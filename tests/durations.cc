@@ -0,0 +1,87 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+static MPD parse_with_durations(const std::string &min_buffer_time, const std::string &period_duration)
+{
+    std::istringstream in("<?xml version=\"1.0\"?>"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\" type=\"static\""
+        " minBufferTime=\"" + min_buffer_time + "\">"
+        "<Period id=\"p0\" start=\"PT0S\" duration=\"" + period_duration + "\"/>"
+        "</MPD>");
+    return MPD(in, std::nullopt);
+}
+
+bool test_duration_values()
+{
+    static const std::vector<std::pair<std::string, MPD::duration_type> > cases = {
+        {"PT2S", std::chrono::seconds(2)},
+        {"PT1H2M3.5S", std::chrono::hours(1) + std::chrono::minutes(2) + std::chrono::milliseconds(3500)},
+        {"P1DT12H", std::chrono::days(1) + std::chrono::hours(12)},
+        {"P1M", std::chrono::months(1)},
+        {"PT1M", std::chrono::minutes(1)},
+        {"PT0.000125S", std::chrono::microseconds(125)},
+        {"PT1.1234567S", std::chrono::microseconds(1123456)}
+    };
+
+    for (const auto &[str, expected] : cases) {
+        MPD mpd(parse_with_durations(str, str));
+        if (mpd.minBufferTime() != expected || mpd.periods().front().duration() != expected) {
+            std::cerr << "Duration \"" << str << "\" parsed as " << mpd.minBufferTime().count() << "us, expected "
+                      << expected.count() << "us" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_duration_invalid()
+{
+    for (const char *str : {"", "P", "PT", "2S", "PT2", "P1DT", "PT.5S", "PT1.S", "P1.5D", "PT1S2M", "PT1D", "P-1D", "PT1H1H"}) {
+        try {
+            parse_with_durations("PT2S", str);
+            std::cerr << "Expected ParseError for invalid duration \"" << str << "\"" << std::endl;
+            return false;
+        } catch (ParseError &ex) {
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Duration values", test_duration_values },
+        { "Invalid durations are rejected", test_duration_invalid }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,232 @@
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+// Memory resource which counts the allocations passed on to the default new/delete resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    CountingResource() :m_allocations(0), m_outstanding(0) {};
+
+    std::size_t allocations() const { return m_allocations; };
+    std::size_t outstanding() const { return m_outstanding; };
+
+private:
+    virtual void *do_allocate(std::size_t bytes, std::size_t alignment) {
+        m_allocations++;
+        m_outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    };
+
+    virtual void do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) {
+        m_outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    };
+
+    virtual bool do_is_equal(const std::pmr::memory_resource &other) const noexcept { return this == &other; };
+
+    std::atomic<std::size_t> m_allocations;
+    std::atomic<std::size_t> m_outstanding;
+};
+
+static std::string make_mpd(unsigned int periods)
+{
+    std::ostringstream os;
+    os << "<?xml version=\"1.0\"?>"
+          "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" type=\"static\""
+          " mediaPresentationDuration=\"PT" << periods * 60 << "S\" minBufferTime=\"PT2S\">";
+    for (unsigned int i = 0; i < periods; i++) {
+        os << "<Period id=\"p" << i << "\" duration=\"PT60S\">"
+              "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+              "<SegmentTemplate timescale=\"1000\" media=\"$RepresentationID$/$Time$.m4s\" initialization=\"init.m4s\">"
+              "<SegmentTimeline><S t=\"0\" d=\"2000\" r=\"19\"/><S d=\"1000\" r=\"9\"/><S d=\"2000\" r=\"4\"/></SegmentTimeline>"
+              "</SegmentTemplate>"
+              "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+              "</AdaptationSet>"
+              "</Period>";
+    }
+    os << "</MPD>";
+    return os.str();
+}
+
+static MPD parse(const std::string &xml, const MPD::ParseOptions &options = MPD::ParseOptions())
+{
+    return MPD(std::vector<char>(xml.begin(), xml.end()), std::nullopt, options);
+}
+
+bool test_resource_used_and_released()
+{
+    CountingResource resource;
+    {
+        MPD mpd(parse(make_mpd(2), MPD::ParseOptions().memoryResource(&resource)));
+        if (resource.allocations() == 0) {
+            std::cerr << "Nothing was allocated from the memory resource" << std::endl;
+            return false;
+        }
+        if (mpd.memoryResource() != &resource) {
+            std::cerr << "MPD does not report the memory resource it was parsed with" << std::endl;
+            return false;
+        }
+        if (mpd != parse(make_mpd(2))) {
+            std::cerr << "MPD parsed using a memory resource differs from one parsed without" << std::endl;
+            return false;
+        }
+    }
+    if (resource.outstanding() != 0) {
+        std::cerr << resource.outstanding() << " bytes were not returned to the memory resource" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_copy_outside_scope()
+{
+    CountingResource resource;
+    MPD mpd(parse(make_mpd(2), MPD::ParseOptions().memoryResource(&resource)));
+    std::size_t allocations = resource.allocations();
+    MPD copy(mpd);
+    if (resource.allocations() != allocations) {
+        std::cerr << "Copying an MPD outside of a MemoryResourceScope allocated from the memory resource" << std::endl;
+        return false;
+    }
+    if (copy != mpd || copy.memoryResource() != nullptr) {
+        std::cerr << "Copy of an MPD parsed using a memory resource is not a plain copy" << std::endl;
+        return false;
+    }
+    {
+        MemoryResourceScope scope(&resource);
+        MPD scoped_copy(mpd);
+        if (resource.allocations() == allocations) {
+            std::cerr << "Copying an MPD inside a MemoryResourceScope did not use the memory resource" << std::endl;
+            return false;
+        }
+    }
+    if (MemoryResourceScope::current() != std::pmr::get_default_resource()) {
+        std::cerr << "MemoryResourceScope did not restore the default resource" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_threaded_and_lazy_periods()
+{
+    CountingResource resource;
+    MPD threaded(parse(make_mpd(8), MPD::ParseOptions().memoryResource(&resource).periodParseThreads(4)));
+    if (threaded != parse(make_mpd(8))) {
+        std::cerr << "MPD parsed by several threads using a memory resource differs from one parsed without" << std::endl;
+        return false;
+    }
+
+    MPD lazy(parse(make_mpd(2), MPD::ParseOptions().memoryResource(&resource).lazyPeriods(true)));
+    std::size_t allocations = resource.allocations();
+    if (!lazy.periods().front().adaptationSets().front().segmentTemplate()->hasSegmentTimeline()) {
+        std::cerr << "Lazily parsed Period did not materialise its SegmentTimeline" << std::endl;
+        return false;
+    }
+    if (resource.allocations() == allocations) {
+        std::cerr << "Materialising a lazily parsed Period did not use the memory resource" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_patch_uses_resource()
+{
+    static const std::string xml = "<?xml version=\"1.0\"?>"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" id=\"live\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+        " type=\"dynamic\" availabilityStartTime=\"1970-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:00Z\""
+        " minimumUpdatePeriod=\"PT2S\" minBufferTime=\"PT2S\">"
+          "<Period id=\"p1\" start=\"PT0S\">"
+            "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+              "<SegmentTemplate timescale=\"1000\" media=\"$RepresentationID$/$Time$.m4s\" initialization=\"init.m4s\">"
+                "<SegmentTimeline><S t=\"0\" d=\"2000\" r=\"4\"/></SegmentTimeline>"
+              "</SegmentTemplate>"
+              "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+            "</AdaptationSet>"
+          "</Period>"
+        "</MPD>";
+    static const std::string patch = "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+        " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+          "<add sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline\"><S d=\"2000\"/></add>"
+        "</Patch>";
+
+    CountingResource resource;
+    MPD mpd(parse(xml, MPD::ParseOptions().memoryResource(&resource)));
+    std::size_t allocations = resource.allocations();
+    std::istringstream in(patch);
+    mpd.applyPatch(in);
+    if (resource.allocations() == allocations) {
+        std::cerr << "Applying a patch outside of a MemoryResourceScope did not use the MPD memory resource" << std::endl;
+        return false;
+    }
+    if (MemoryResourceScope::current() != std::pmr::get_default_resource()) {
+        std::cerr << "Applying a patch left the MPD memory resource in scope" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_arena_release()
+{
+    CountingResource upstream;
+    std::pmr::monotonic_buffer_resource arena(&upstream);
+    {
+        MPD mpd(parse(make_mpd(4), MPD::ParseOptions().memoryResource(&arena)));
+        if (upstream.allocations() == 0) {
+            std::cerr << "Nothing was allocated from the arena" << std::endl;
+            return false;
+        }
+        if (mpd.asXML(false) != parse(make_mpd(4)).asXML(false)) {
+            std::cerr << "MPD parsed into an arena outputs different XML" << std::endl;
+            return false;
+        }
+    }
+    arena.release();
+    if (upstream.outstanding() != 0) {
+        std::cerr << "Releasing the arena left " << upstream.outstanding() << " bytes allocated" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "MPD storage is allocated from and returned to the memory resource", test_resource_used_and_released },
+        { "Copies only use the memory resource inside a scope", test_copy_outside_scope },
+        { "Period threads and lazy Periods use the memory resource", test_threaded_and_lazy_periods },
+        { "Patches use the memory resource of the MPD", test_patch_uses_resource },
+        { "MPD can be parsed into an arena", test_arena_release }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
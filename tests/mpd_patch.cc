@@ -0,0 +1,325 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+static std::string make_mpd(const std::string &publish_time, const std::string &timeline, const std::string &representations,
+                            const std::string &extra_periods = std::string())
+{
+    return "<?xml version=\"1.0\"?>"
+           "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" id=\"live\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+           " type=\"dynamic\" availabilityStartTime=\"1970-01-01T00:00:00Z\" publishTime=\"" + publish_time + "\""
+           " minimumUpdatePeriod=\"PT2S\" minBufferTime=\"PT2S\">"
+             "<Period id=\"p1\" start=\"PT0S\">"
+               "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+                 "<SegmentTemplate timescale=\"1000\" media=\"$RepresentationID$/$Time$.m4s\""
+                 " initialization=\"$RepresentationID$/init.m4s\">"
+                   "<SegmentTimeline>" + timeline + "</SegmentTimeline>"
+                 "</SegmentTemplate>" + representations +
+               "</AdaptationSet>"
+             "</Period>" + extra_periods +
+           "</MPD>";
+}
+
+static const std::string g_representations = "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+                                             "<Representation id=\"v2\" bandwidth=\"2000000\"/>";
+
+static MPD parse(const std::string &xml)
+{
+    std::istringstream in(xml);
+    return MPD(in, std::string("http://example.com/live.mpd"));
+}
+
+static void apply(MPD &mpd, const std::string &patch)
+{
+    std::istringstream in(patch);
+    mpd.applyPatch(in);
+}
+
+bool test_patch_timeline()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\" r=\"4\"/>", g_representations)));
+    auto &adapt_set = *mpd.periodsBegin()->adaptationSetsBegin();
+    const Representation *selected = &adapt_set.representations().back();
+    adapt_set.selectRepresentation(*selected);
+
+    apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+               " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                 "<replace sel=\"/MPD/@publishTime\">2025-01-01T00:00:02Z</replace>"
+                 "<add sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline\">"
+                   "<S d=\"2000\"/>"
+                 "</add>"
+               "</Patch>");
+
+    if (mpd != parse(make_mpd("2025-01-01T00:00:02Z", "<S t=\"0\" d=\"2000\" r=\"4\"/><S d=\"2000\"/>", g_representations))) {
+        std::cerr << "Patched MPD differs from the expected MPD" << std::endl;
+        return false;
+    }
+    if (&adapt_set.representations().back() != selected || adapt_set.selectedRepresentations().size() != 1 ||
+        *adapt_set.selectedRepresentations().begin() != selected) {
+        std::cerr << "Representation selection was not kept when patching the AdaptationSet" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_patch_elements()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\"/>", g_representations)));
+
+    apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+               " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T01:00:00Z\">"
+                 "<remove sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/Representation[@id='v1']\"/>"
+                 "<replace sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/Representation[@id='v2']/@bandwidth\">"
+                   "2500000</replace>"
+                 "<add sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/Representation[@id='v2']\" pos=\"after\">"
+                   "<Representation id=\"v3\" bandwidth=\"4000000\"/>"
+                 "</add>"
+                 "<add sel=\"/MPD\"><Period id=\"p2\" start=\"PT3600S\"/></add>"
+               "</Patch>");
+
+    auto expected = parse(make_mpd("2025-01-01T01:00:00Z", "<S t=\"0\" d=\"2000\"/>",
+                                   "<Representation id=\"v2\" bandwidth=\"2500000\"/>"
+                                   "<Representation id=\"v3\" bandwidth=\"4000000\"/>",
+                                   "<Period id=\"p2\" start=\"PT3600S\"/>"));
+    if (mpd != expected) {
+        std::cerr << "Patched MPD differs from the expected MPD" << std::endl;
+        return false;
+    }
+    if (mpd.periods().back().getMPD() != &mpd ||
+        mpd.periods().front().calcDuration() != MPD::duration_type(std::chrono::seconds(3600))) {
+        std::cerr << "Added Period is not linked into the MPD" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_patch_wrong_version()
+{
+    std::string mpd_xml = make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\"/>", g_representations);
+    MPD mpd(parse(mpd_xml));
+
+    try {
+        apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+                   " originalPublishTime=\"2024-12-31T23:59:58Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                     "<replace sel=\"/MPD/@publishTime\">2025-01-01T00:00:02Z</replace>"
+                   "</Patch>");
+        std::cerr << "Patch for a different MPD version was applied" << std::endl;
+        return false;
+    } catch (const PatchError&) {
+    }
+    try {
+        apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+                   " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:00Z\"/>");
+        std::cerr << "Patch with a publishTime not after its originalPublishTime was applied" << std::endl;
+        return false;
+    } catch (const PatchError&) {
+    }
+    if (mpd != parse(mpd_xml)) {
+        std::cerr << "Rejected patch modified the MPD" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_patch_no_match()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\"/>", g_representations)));
+
+    try {
+        apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+                   " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                     "<remove sel=\"/MPD/Period[@id='p9']\"/>"
+                   "</Patch>");
+    } catch (const PatchError&) {
+        return true;
+    }
+
+    std::cerr << "Patch with a selector that does not match was applied" << std::endl;
+    return false;
+}
+
+bool test_patch_segment_lists()
+{
+    static const std::string audio_period =
+        "<Period id=\"p2\" start=\"PT3600S\">"
+          "<AdaptationSet id=\"2\" contentType=\"audio\" mimeType=\"audio/mp4\">"
+            "<Representation id=\"a1\" bandwidth=\"64000\"><SegmentBase indexRange=\"0-999\"/></Representation>"
+            "<Representation id=\"a2\" bandwidth=\"128000\">"
+              "<SegmentList timescale=\"1000\" duration=\"2000\">"
+                "<Initialization sourceURL=\"a2/init.m4s\"/><SegmentURL media=\"a2/1.m4s\"/><SegmentURL media=\"a2/2.m4s\"/>"
+              "</SegmentList>"
+            "</Representation>"
+          "</AdaptationSet>"
+        "</Period>";
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\"/>", g_representations, audio_period)));
+
+    // Attribute patches on the Representations round trip them through XML
+    apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+               " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                 "<replace sel=\"/MPD/Period[@id='p2']/AdaptationSet[@id='2']/Representation[@id='a1']/@bandwidth\">"
+                   "96000</replace>"
+                 "<replace sel=\"/MPD/Period[@id='p2']/AdaptationSet[@id='2']/Representation[@id='a2']/@bandwidth\">"
+                   "192000</replace>"
+               "</Patch>");
+
+    std::string expected_period(audio_period);
+    expected_period.replace(expected_period.find("64000"), 5, "96000");
+    expected_period.replace(expected_period.find("128000"), 6, "192000");
+    if (mpd != parse(make_mpd("2025-01-01T00:00:02Z", "<S t=\"0\" d=\"2000\"/>", g_representations, expected_period))) {
+        std::cerr << "Patching Representations changed their SegmentBase or SegmentList" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_patch_representation_id()
+{
+    std::string mpd_xml = make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\"/>", g_representations);
+    MPD mpd(parse(mpd_xml));
+
+    try {
+        apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+                   " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                     "<replace sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/Representation[@id='v1']\">"
+                       "<Representation id=\"v9\" bandwidth=\"1000000\"/>"
+                     "</replace>"
+                   "</Patch>");
+        std::cerr << "Patch replacing a Representation with a different @id was applied" << std::endl;
+        return false;
+    } catch (const PatchError&) {
+    }
+
+    apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+               " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                 "<replace sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/Representation[@id='v1']\">"
+                   "<Representation id=\"v1\" bandwidth=\"1500000\"/>"
+                 "</replace>"
+               "</Patch>");
+    if (mpd.periods().front().adaptationSets().front().representations().front().bandwidth() != 1500000) {
+        std::cerr << "Patch replacing a Representation with the same @id was not applied" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_patch_mpd_precision()
+{
+    // Dates and durations with more than millisecond precision
+    auto make_precise_mpd = [](const std::string &publish_time, const std::string &extra_attrs, const std::string &base_url) {
+        std::string xml = make_mpd(publish_time, "<S t=\"0\" d=\"2000\"/>", g_representations);
+        xml.replace(xml.find("1970-01-01T00:00:00Z"), 20, "1970-01-01T00:00:00.000250Z");
+        xml.replace(xml.find(" minBufferTime"), 0, " timeShiftBufferDepth=\"PT30.0005S\"" + extra_attrs);
+        xml.replace(xml.find("<Period"), 0, base_url);
+        return xml;
+    };
+    MPD mpd(parse(make_precise_mpd("2025-01-01T00:00:00Z", "", "")));
+
+    apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+               " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                 "<add sel=\"/MPD\" type=\"@maxSegmentDuration\">PT2S</add>"
+                 "<add sel=\"/MPD\"><BaseURL>https://cdn.example.com/</BaseURL></add>"
+               "</Patch>");
+
+    auto expected = parse(make_precise_mpd("2025-01-01T00:00:02Z", " maxSegmentDuration=\"PT2S\"",
+                                           "<BaseURL>https://cdn.example.com/</BaseURL>"));
+    if (mpd != expected || mpd.baseURLs().size() != 1) {
+        std::cerr << "Patching the MPD element changed its other attributes or children" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_patch_merged_segment_template()
+{
+    // The Representation SegmentTemplate is merged with the AdaptationSet SegmentTemplate holding the SegmentTimeline
+    std::string representations = "<Representation id=\"v1\" bandwidth=\"1000000\">"
+                                     "<SegmentTemplate media=\"$RepresentationID$/seg-$Time$.m4s\"/>"
+                                   "</Representation>";
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\" r=\"4\"/>", representations)));
+    const Representation &rep = mpd.periods().front().adaptationSets().front().representations().front();
+    if (rep.getMediaURL(1).str() != "http://example.com/v1/seg-2000.m4s") {
+        std::cerr << "Segment 1 URL before the patch is " << rep.getMediaURL(1) << std::endl;
+        return false;
+    }
+
+    apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+               " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                 "<replace sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']/SegmentTemplate/SegmentTimeline/S[1]/@t\">1000</replace>"
+               "</Patch>");
+    if (rep.getMediaURL(1).str() != "http://example.com/v1/seg-3000.m4s") {
+        std::cerr << "Segment 1 URL after patching the AdaptationSet SegmentTimeline is " << rep.getMediaURL(1) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_patch_base_url()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", "<S t=\"0\" d=\"2000\" r=\"4\"/>", g_representations)));
+    const Representation &rep = mpd.periods().front().adaptationSets().front().representations().front();
+    if (rep.getBaseURLs().front().url().str() != "http://example.com/live.mpd") {
+        std::cerr << "Representation BaseURL before the patch is " << rep.getBaseURLs().front().url() << std::endl;
+        return false;
+    }
+
+    apply(mpd, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"live\""
+               " originalPublishTime=\"2025-01-01T00:00:00Z\" publishTime=\"2025-01-01T00:00:02Z\">"
+                 "<add sel=\"/MPD/Period[@id='p1']/AdaptationSet[@id='1']\" pos=\"prepend\"><BaseURL>video/</BaseURL></add>"
+               "</Patch>");
+    if (rep.getBaseURLs().front().url().str() != "http://example.com/video/") {
+        std::cerr << "Representation BaseURL after patching the AdaptationSet BaseURL is " << rep.getBaseURLs().front().url() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Patch adds SegmentTimeline entries and updates publishTime", test_patch_timeline },
+        { "Patch adds, replaces and removes elements and attributes", test_patch_elements },
+        { "Patch for another MPD version is rejected", test_patch_wrong_version },
+        { "Patch selector that does not match is rejected", test_patch_no_match },
+        { "Patch keeps Representation SegmentBase and SegmentList", test_patch_segment_lists },
+        { "Patch cannot change a Representation@id", test_patch_representation_id },
+        { "Patch keeps the precision of MPD dates and durations", test_patch_mpd_precision },
+        { "Patch updates segment addressing from a changed SegmentTimeline", test_patch_merged_segment_template },
+        { "Patch updates resolved BaseURLs from a changed AdaptationSet BaseURL", test_patch_base_url }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,251 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+static std::string make_mpd(const std::string &publish_time, const std::string &periods)
+{
+    return "<?xml version=\"1.0\"?>"
+           "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" type=\"dynamic\""
+           " availabilityStartTime=\"1970-01-01T00:00:00Z\" publishTime=\"" + publish_time + "\" minimumUpdatePeriod=\"PT2S\""
+           " minBufferTime=\"PT2S\">" + periods + "</MPD>";
+}
+
+static const std::string g_period_1 =
+    "<Period id=\"p1\" start=\"PT0S\">"
+      "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+        "<SegmentTemplate timescale=\"1000\" duration=\"2000\" media=\"$RepresentationID$/$Number$.m4s\"/>"
+        "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+        "<Representation id=\"v2\" bandwidth=\"2000000\"/>"
+      "</AdaptationSet>"
+    "</Period>";
+
+static bool has_change(const std::list<MPD::RefreshChange> &changes, const MPD::RefreshChange &change)
+{
+    for (const auto &c : changes) {
+        if (c == change) return true;
+    }
+    return false;
+}
+
+static MPD parse(const std::string &xml)
+{
+    std::istringstream in(xml);
+    return MPD(in, std::string("http://example.com/manifest.mpd"));
+}
+
+bool test_refresh_unchanged()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", g_period_1)));
+    std::istringstream in(make_mpd("2025-01-01T00:00:00Z", g_period_1));
+    auto changes = mpd.refresh(in);
+    if (!changes.empty()) {
+        std::cerr << "Refresh from an identical MPD reported " << changes.size() << " changes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_refresh_publish_time()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", g_period_1)));
+    std::istringstream in(make_mpd("2025-01-01T00:00:10Z", g_period_1));
+    auto changes = mpd.refresh(in);
+    if (changes.size() != 1 || !(changes.front() == MPD::RefreshChange(MPD::RefreshChange::UPDATED,
+                                                                       MPD::RefreshChange::MPD_ELEMENT))) {
+        std::cerr << "Refresh with a new publishTime should only update the MPD element" << std::endl;
+        return false;
+    }
+    if (mpd != parse(make_mpd("2025-01-01T00:00:10Z", g_period_1))) {
+        std::cerr << "Refreshed MPD differs from the updated MPD" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_refresh_keeps_selection()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", g_period_1)));
+    auto &period = *mpd.periodsBegin();
+    auto &adapt_set = *period.adaptationSetsBegin();
+    const Representation *selected = &adapt_set.representations().back();
+    adapt_set.selectRepresentation(*selected);
+    const Period *period_ptr = &period;
+
+    // v1 changes bandwidth, v2 is unchanged, v3 is added and a new Period is appended
+    std::string updated_xml = make_mpd("2025-01-01T00:00:10Z",
+        "<Period id=\"p1\" start=\"PT0S\">"
+          "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+            "<SegmentTemplate timescale=\"1000\" duration=\"2000\" media=\"$RepresentationID$/$Number$.m4s\"/>"
+            "<Representation id=\"v1\" bandwidth=\"1500000\"/>"
+            "<Representation id=\"v2\" bandwidth=\"2000000\"/>"
+            "<Representation id=\"v3\" bandwidth=\"4000000\"/>"
+          "</AdaptationSet>"
+        "</Period>"
+        "<Period id=\"p2\" start=\"PT3600S\"/>");
+    std::istringstream in(updated_xml);
+    auto changes = mpd.refresh(in);
+
+    using RC = MPD::RefreshChange;
+    if (!has_change(changes, RC(RC::UPDATED, RC::REPRESENTATION_ELEMENT, std::string("p1"), 1u, std::string("v1"))) ||
+        !has_change(changes, RC(RC::ADDED, RC::REPRESENTATION_ELEMENT, std::string("p1"), 1u, std::string("v3"))) ||
+        !has_change(changes, RC(RC::ADDED, RC::PERIOD_ELEMENT, std::string("p2"))) ||
+        has_change(changes, RC(RC::UPDATED, RC::REPRESENTATION_ELEMENT, std::string("p1"), 1u, std::string("v2")))) {
+        std::cerr << "Refresh did not report the expected changes" << std::endl;
+        return false;
+    }
+    if (&mpd.periods().front() != period_ptr || &mpd.periods().front().adaptationSets().front() != &adapt_set) {
+        std::cerr << "Refresh replaced a Period or AdaptationSet that should have been updated in place" << std::endl;
+        return false;
+    }
+    const auto &selection = adapt_set.selectedRepresentations();
+    if (selection.size() != 1 || *selection.begin() != selected || selected->id() != "v2") {
+        std::cerr << "Representation selection was not kept across the refresh" << std::endl;
+        return false;
+    }
+    if (mpd != parse(updated_xml)) {
+        std::cerr << "Refreshed MPD differs from the updated MPD" << std::endl;
+        return false;
+    }
+    // The duration of the first Period now comes from the start of the added Period, which relies on the sibling links
+    if (mpd.periods().back().getMPD() != &mpd || period.calcDuration() != MPD::duration_type(std::chrono::seconds(3600))) {
+        std::cerr << "Added Period is not linked into the MPD" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_refresh_removes()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", g_period_1 + "<Period id=\"p2\" start=\"PT3600S\"/>")));
+    auto &adapt_set = *mpd.periodsBegin()->adaptationSetsBegin();
+    adapt_set.selectRepresentation(adapt_set.representations().front());
+
+    std::string updated_xml = make_mpd("2025-01-01T00:00:00Z",
+        "<Period id=\"p1\" start=\"PT0S\">"
+          "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+            "<SegmentTemplate timescale=\"1000\" duration=\"2000\" media=\"$RepresentationID$/$Number$.m4s\"/>"
+            "<Representation id=\"v2\" bandwidth=\"2000000\"/>"
+          "</AdaptationSet>"
+        "</Period>");
+    std::istringstream in(updated_xml);
+    auto changes = mpd.refresh(in);
+
+    using RC = MPD::RefreshChange;
+    if (changes.size() != 2 ||
+        !has_change(changes, RC(RC::REMOVED, RC::REPRESENTATION_ELEMENT, std::string("p1"), 1u, std::string("v1"))) ||
+        !has_change(changes, RC(RC::REMOVED, RC::PERIOD_ELEMENT, std::string("p2")))) {
+        std::cerr << "Refresh did not report the expected removals" << std::endl;
+        return false;
+    }
+    if (!adapt_set.selectedRepresentations().empty()) {
+        std::cerr << "Removed Representation is still selected" << std::endl;
+        return false;
+    }
+    if (mpd.periods().size() != 1) {
+        std::cerr << "Removed Period is still in the MPD" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static std::string make_timeline_period(const std::string &timeline)
+{
+    // The SegmentTemplate is split between the Period and the AdaptationSet, so the Representations use a merged template
+    return "<Period id=\"p1\" start=\"PT0S\">"
+             "<SegmentTemplate timescale=\"1000\" media=\"$RepresentationID$/$Time$.m4s\"/>"
+             "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+               "<SegmentTemplate><SegmentTimeline>" + timeline + "</SegmentTimeline></SegmentTemplate>"
+               "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+             "</AdaptationSet>"
+           "</Period>";
+}
+
+bool test_refresh_segment_timeline()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", make_timeline_period("<S t=\"0\" d=\"2000\" r=\"4\"/>"))));
+    const Representation &rep = mpd.periods().front().adaptationSets().front().representations().front();
+    if (rep.getMediaURL(1).str() != "http://example.com/v1/2000.m4s") {
+        std::cerr << "Segment 1 URL before the refresh is " << rep.getMediaURL(1) << std::endl;
+        return false;
+    }
+
+    std::istringstream in(make_mpd("2025-01-01T00:00:10Z", make_timeline_period("<S t=\"1000\" d=\"2000\" r=\"4\"/>")));
+    mpd.refresh(in);
+    if (rep.getMediaURL(1).str() != "http://example.com/v1/3000.m4s") {
+        std::cerr << "Segment 1 URL after refreshing the AdaptationSet SegmentTimeline is " << rep.getMediaURL(1) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static std::string make_base_url_period(const std::string &base_url)
+{
+    return "<Period id=\"p1\" start=\"PT0S\">"
+             "<BaseURL>" + base_url + "</BaseURL>"
+             "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+               "<SegmentTemplate timescale=\"1000\" duration=\"2000\" media=\"$RepresentationID$/$Number$.m4s\"/>"
+               "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+             "</AdaptationSet>"
+           "</Period>";
+}
+
+bool test_refresh_base_url()
+{
+    MPD mpd(parse(make_mpd("2025-01-01T00:00:00Z", make_base_url_period("a/"))));
+    const Representation &rep = mpd.periods().front().adaptationSets().front().representations().front();
+    if (rep.getBaseURLs().front().url().str() != "http://example.com/a/") {
+        std::cerr << "Representation BaseURL before the refresh is " << rep.getBaseURLs().front().url() << std::endl;
+        return false;
+    }
+
+    std::istringstream in(make_mpd("2025-01-01T00:00:10Z", make_base_url_period("b/")));
+    mpd.refresh(in);
+    if (rep.getBaseURLs().front().url().str() != "http://example.com/b/") {
+        std::cerr << "Representation BaseURL after refreshing the Period BaseURL is " << rep.getBaseURLs().front().url() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Refresh from identical MPD makes no changes", test_refresh_unchanged },
+        { "Refresh with new publishTime updates the MPD only", test_refresh_publish_time },
+        { "Refresh keeps Representation selection and object addresses", test_refresh_keeps_selection },
+        { "Refresh removes Periods and Representations", test_refresh_removes },
+        { "Refresh updates segment addressing from a changed SegmentTimeline", test_refresh_segment_timeline },
+        { "Refresh updates resolved BaseURLs from a changed Period BaseURL", test_refresh_base_url }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
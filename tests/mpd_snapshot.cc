@@ -0,0 +1,188 @@
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+std::filesystem::path g_test_live_mpd;
+
+static bool check_links(const MPD &mpd)
+{
+    for (auto period_it = mpd.periodsBegin(); period_it != mpd.periodsEnd(); period_it++) {
+        if (period_it->getMPD() != &mpd) {
+            std::cerr << "Period not linked to the loaded MPD" << std::endl;
+            return false;
+        }
+        for (const auto &adapt_set : period_it->adaptationSets()) {
+            if (adapt_set.getPeriod() != &(*period_it)) {
+                std::cerr << "AdaptationSet not linked to its Period" << std::endl;
+                return false;
+            }
+            for (const auto &rep : adapt_set.representations()) {
+                if (rep.getAdaptationSet() != &adapt_set) {
+                    std::cerr << "Representation not linked to its AdaptationSet" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool test_snapshot_round_trip()
+{
+    MPD mpd(g_test_live_mpd.string(), std::string("file:") + g_test_live_mpd.string());
+    auto snapshot = mpd.saveSnapshot();
+    MPD loaded(MPD::loadSnapshot(snapshot));
+    if (loaded != mpd) {
+        std::cerr << "MPD loaded from a snapshot differs from the original" << std::endl;
+        return false;
+    }
+    if (loaded.asXML(false) != mpd.asXML(false)) {
+        std::cerr << "XML output of MPD loaded from a snapshot differs from the original" << std::endl;
+        return false;
+    }
+    if (loaded.sourceURL() != mpd.sourceURL()) {
+        std::cerr << "Snapshot did not keep the MPD source URL" << std::endl;
+        return false;
+    }
+    return check_links(loaded);
+}
+
+bool test_snapshot_stream()
+{
+    MPD mpd(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().lazyPeriods(true));
+    std::stringstream snapshot;
+    mpd.saveSnapshot(snapshot);
+    MPD loaded(MPD::loadSnapshot(snapshot));
+    if (loaded != mpd) {
+        std::cerr << "MPD loaded from a snapshot stream differs from the original" << std::endl;
+        return false;
+    }
+    return check_links(loaded);
+}
+
+bool test_snapshot_selections()
+{
+    MPD mpd(g_test_live_mpd.string());
+    std::size_t expected = 0;
+    for (auto period_it = mpd.periodsBegin(); period_it != mpd.periodsEnd(); period_it++) {
+        for (auto adapt_it = period_it->adaptationSetsBegin(); adapt_it != period_it->adaptationSetsEnd(); adapt_it++) {
+            // select the last Representation of each AdaptationSet
+            if (adapt_it->representations().empty()) continue;
+            adapt_it->selectRepresentation(std::prev(adapt_it->representationsEnd()));
+            expected++;
+        }
+    }
+
+    MPD loaded(MPD::loadSnapshot(mpd.saveSnapshot()));
+    auto selected = loaded.selectedRepresentations();
+    if (selected.size() != expected) {
+        std::cerr << "Expected " << expected << " selected Representations after loading, got " << selected.size() << std::endl;
+        return false;
+    }
+    for (const auto *rep : selected) {
+        if (rep->getMPD() != &loaded || rep != &rep->getAdaptationSet()->representations().back()) {
+            std::cerr << "Selected Representation " << rep->id() << " is not the one selected before saving" << std::endl;
+            return false;
+        }
+    }
+    if (loaded.selectedSegmentAvailability(std::chrono::system_clock::now()).size() !=
+        mpd.selectedSegmentAvailability(std::chrono::system_clock::now()).size()) {
+        std::cerr << "Selected segment availability differs after loading a snapshot" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_snapshot_period_siblings()
+{
+    std::ostringstream mpd_xml;
+    mpd_xml << "<?xml version=\"1.0\"?>"
+               "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+               " minBufferTime=\"PT2S\" type=\"static\">";
+    for (int i = 0; i < 10; i++) {
+        mpd_xml << "<Period id=\"p" << i << "\"" << (i == 0?" start=\"PT0S\"":"") << " duration=\"PT" << (i + 1) << "S\"/>";
+    }
+    mpd_xml << "</MPD>";
+    std::istringstream in(mpd_xml.str());
+    MPD mpd(in, std::nullopt);
+
+    MPD loaded(MPD::loadSnapshot(mpd.saveSnapshot()));
+    int i = 0;
+    for (auto it = loaded.periodsBegin(); it != loaded.periodsEnd(); it++, i++) {
+        // Period n starts at the sum of the preceding durations, which relies on the sibling links
+        if (it->calcStart() != MPD::duration_type(std::chrono::seconds(i * (i + 1) / 2))) {
+            std::cerr << "Period " << i << " loaded from a snapshot has the wrong calculated start time" << std::endl;
+            return false;
+        }
+    }
+    return check_links(loaded);
+}
+
+bool test_snapshot_corrupt()
+{
+    MPD mpd(g_test_live_mpd.string());
+    auto snapshot = mpd.saveSnapshot();
+
+    std::vector<std::vector<unsigned char> > bad_snapshots;
+    bad_snapshots.emplace_back();                                                 // empty
+    bad_snapshots.emplace_back(snapshot.begin(), snapshot.begin() + snapshot.size() / 2); // truncated
+    bad_snapshots.push_back(snapshot);
+    bad_snapshots.back()[0] = 'X';                                                // bad magic
+    bad_snapshots.push_back(snapshot);
+    bad_snapshots.back()[8] = 0x7f;                                               // unsupported version
+
+    for (const auto &bad : bad_snapshots) {
+        try {
+            MPD loaded(MPD::loadSnapshot(bad));
+            std::cerr << "Expected ParseError loading a bad snapshot" << std::endl;
+            return false;
+        } catch (ParseError &ex) {
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    g_test_live_mpd = argv[1];
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Snapshot round trip matches original", test_snapshot_round_trip },
+        { "Snapshot round trip through a stream", test_snapshot_stream },
+        { "Snapshot keeps Representation selections", test_snapshot_selections },
+        { "Snapshot relinks Period siblings", test_snapshot_period_siblings },
+        { "Corrupt snapshots are rejected", test_snapshot_corrupt }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,186 @@
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+static const char *c_mpd_xml =
+    "<?xml version=\"1.0\"?>"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" type=\"static\""
+    " mediaPresentationDuration=\"PT120S\" minBufferTime=\"PT2S\">"
+    "<ProgramInformation><Title>Test</Title></ProgramInformation>"
+    "<Period id=\"p0\" duration=\"PT60S\">"
+    "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+    "<ContentProtection schemeIdUri=\"urn:mpeg:dash:mp4protection:2011\" value=\"cenc\"/>"
+    "<Viewpoint schemeIdUri=\"urn:example:viewpoint\" value=\"1\"/>"
+    "<Label>Main</Label>"
+    "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+    "</AdaptationSet>"
+    "<AdaptationSet id=\"2\" contentType=\"video\" mimeType=\"video/mp4\">"
+    "<EssentialProperty schemeIdUri=\"http://dashif.org/guidelines/trickmode\" value=\"1\"/>"
+    "<Representation id=\"t1\" bandwidth=\"100000\"/>"
+    "</AdaptationSet>"
+    "<AdaptationSet id=\"3\">"
+    "<Representation id=\"a1\" bandwidth=\"128000\" mimeType=\"audio/mp4\"/>"
+    "</AdaptationSet>"
+    "<AdaptationSet id=\"4\" mimeType=\"application/ttml+xml\">"
+    "<Representation id=\"s1\" bandwidth=\"1000\"/>"
+    "</AdaptationSet>"
+    "</Period>"
+    "<Period id=\"p1\" duration=\"PT60S\">"
+    "<AdaptationSet id=\"1\" contentType=\"video\" mimeType=\"video/mp4\">"
+    "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+    "</AdaptationSet>"
+    "<AdaptationSet id=\"4\" mimeType=\"application/ttml+xml\">"
+    "<Representation id=\"s1\" bandwidth=\"1000\"/>"
+    "</AdaptationSet>"
+    "</Period>"
+    "<Metrics metrics=\"DVBErrors\"><Reporting schemeIdUri=\"urn:dvb:dash:reporting:2014\" value=\"1\"/></Metrics>"
+    "</MPD>";
+
+static MPD parse(const MPD::ParseOptions &options = MPD::ParseOptions())
+{
+    std::string xml(c_mpd_xml);
+    return MPD(std::vector<char>(xml.begin(), xml.end()), std::nullopt, options);
+}
+
+static std::vector<unsigned int> adaptation_set_ids(const Period &period)
+{
+    std::vector<unsigned int> ids;
+    for (const auto &adapt_set : period.adaptationSets()) {
+        ids.push_back(adapt_set.id().value_or(0));
+    }
+    return ids;
+}
+
+bool test_skip_elements()
+{
+    ParseFilter filter;
+    filter.skipElement("ProgramInformation").skipElement("Metrics").skipElement("ContentProtection").skipElement("Label")
+          .skipElement("Viewpoint");
+
+    MPD unfiltered(parse());
+    const auto &unfiltered_adapt_set = unfiltered.periods().front().adaptationSets().front();
+    if (unfiltered.programInformations().empty() || unfiltered.metrics().empty() ||
+        unfiltered_adapt_set.contentProtections().empty() || unfiltered_adapt_set.labels().empty() ||
+        unfiltered_adapt_set.viewpoints().empty()) {
+        std::cerr << "Unfiltered MPD is missing elements" << std::endl;
+        return false;
+    }
+
+    MPD filtered(parse(MPD::ParseOptions().parseFilter(filter)));
+    const auto &adapt_set = filtered.periods().front().adaptationSets().front();
+    if (!filtered.programInformations().empty() || !filtered.metrics().empty() || !adapt_set.contentProtections().empty() ||
+        !adapt_set.labels().empty() || !adapt_set.viewpoints().empty()) {
+        std::cerr << "Filtered MPD still contains skipped elements" << std::endl;
+        return false;
+    }
+    if (filtered.periods().size() != 2 || adaptation_set_ids(filtered.periods().front()).size() != 4) {
+        std::cerr << "Filtering elements removed Periods or AdaptationSets" << std::endl;
+        return false;
+    }
+    if (!filtered.parseFilter() || !filtered.parseFilter()->skipsElement("Label") || unfiltered.parseFilter()) {
+        std::cerr << "MPD does not report the ParseFilter it was parsed with" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_skip_adaptation_sets()
+{
+    MPD by_content_type(parse(MPD::ParseOptions().parseFilter(ParseFilter().skipAdaptationSetContentType("audio"))));
+    if (adaptation_set_ids(by_content_type.periods().front()) != std::vector<unsigned int>{1, 2, 4}) {
+        std::cerr << "Skipping audio using the Representation @mimeType did not leave AdaptationSets 1, 2 and 4" << std::endl;
+        return false;
+    }
+
+    MPD by_mime_type(parse(MPD::ParseOptions().parseFilter(ParseFilter().skipAdaptationSetMimeType("application/ttml+xml"))));
+    if (adaptation_set_ids(by_mime_type.periods().front()) != std::vector<unsigned int>{1, 2, 3} ||
+        adaptation_set_ids(by_mime_type.periods().back()) != std::vector<unsigned int>{1}) {
+        std::cerr << "Skipping subtitles by @mimeType did not remove AdaptationSet 4 from both Periods" << std::endl;
+        return false;
+    }
+
+    MPD by_property(parse(MPD::ParseOptions().parseFilter(
+                        ParseFilter().skipAdaptationSetEssentialProperty("http://dashif.org/guidelines/trickmode"))));
+    if (adaptation_set_ids(by_property.periods().front()) != std::vector<unsigned int>{1, 3, 4}) {
+        std::cerr << "Skipping trick play by EssentialProperty did not remove AdaptationSet 2" << std::endl;
+        return false;
+    }
+
+    MPD by_predicate(parse(MPD::ParseOptions().parseFilter(ParseFilter().skipAdaptationSets(
+                        [](const ParseFilter::AdaptationSetInfo &info) { return info.contentType() != "video"; }))));
+    if (adaptation_set_ids(by_predicate.periods().front()) != std::vector<unsigned int>{1, 2}) {
+        std::cerr << "Predicate keeping only video did not leave AdaptationSets 1 and 2" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_parse_modes()
+{
+    ParseFilter filter;
+    filter.skipElement("ContentProtection").skipElement("Metrics").skipAdaptationSetContentType("text")
+          .skipAdaptationSetMimeType("application/ttml+xml");
+    auto shared_filter = std::make_shared<const ParseFilter>(filter);
+
+    MPD dom(parse(MPD::ParseOptions().parseFilter(shared_filter)));
+    MPD streaming(parse(MPD::ParseOptions().parseFilter(shared_filter).parserBackend(MPD::PARSER_STREAMING)));
+    MPD threaded(parse(MPD::ParseOptions().parseFilter(shared_filter).periodParseThreads(2)));
+    MPD lazy(parse(MPD::ParseOptions().parseFilter(shared_filter).lazyPeriods(true)));
+    MPD lazy_streaming(parse(MPD::ParseOptions().parseFilter(shared_filter).lazyPeriods(true)
+                                                .parserBackend(MPD::PARSER_STREAMING)));
+    MPD threaded_streaming(parse(MPD::ParseOptions().parseFilter(shared_filter).periodParseThreads(2)
+                                                    .parserBackend(MPD::PARSER_STREAMING)));
+    if (adaptation_set_ids(dom.periods().front()) != std::vector<unsigned int>{1, 2, 3} || !dom.metrics().empty()) {
+        std::cerr << "Filtered DOM parse gave the wrong result" << std::endl;
+        return false;
+    }
+    if (streaming != dom || threaded != dom || lazy != dom || lazy_streaming != dom || threaded_streaming != dom) {
+        std::cerr << "Filtered MPDs differ between parser backends, Period threads and lazy Periods" << std::endl;
+        return false;
+    }
+
+    MPD copy(lazy);
+    if (copy.parseFilter() != shared_filter || !copy.periods().front().adaptationSets().front().contentProtections().empty()) {
+        std::cerr << "Copy of a filtered MPD did not keep the filter for its lazy Periods" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Elements are skipped by name", test_skip_elements },
+        { "AdaptationSets are skipped by predicate", test_skip_adaptation_sets },
+        { "Filtering is the same for all parse modes", test_parse_modes }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -0,0 +1,263 @@
+#include <limits.h>
+#include <stdlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+MPD *g_dom_mpd = nullptr;
+std::filesystem::path g_test_live_mpd;
+
+bool test_initialise()
+{
+    std::ifstream in_file(g_test_live_mpd);
+    g_dom_mpd = new MPD(in_file, std::string("file:") + g_test_live_mpd.string(), MPD::PARSER_DOM);
+    return true;
+}
+
+bool test_streaming_istream()
+{
+    if (!g_dom_mpd) return false;
+
+    std::ifstream in_file(g_test_live_mpd);
+    MPD mpd(in_file, std::string("file:") + g_test_live_mpd.string(), MPD::PARSER_STREAMING);
+    if (mpd != *g_dom_mpd) {
+        std::cerr << "MPD parsed from a stream using PARSER_STREAMING differs from the PARSER_DOM result" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_streaming_memory()
+{
+    if (!g_dom_mpd) return false;
+
+    std::ifstream in_file(g_test_live_mpd, std::ios::binary);
+    std::vector<char> mpd_xml{std::istreambuf_iterator<char>(in_file), std::istreambuf_iterator<char>()};
+    MPD mpd(mpd_xml, std::string("file:") + g_test_live_mpd.string(), MPD::PARSER_STREAMING);
+    if (mpd != *g_dom_mpd) {
+        std::cerr << "MPD parsed from memory using PARSER_STREAMING differs from the PARSER_DOM result" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_streaming_file()
+{
+    if (!g_dom_mpd) return false;
+
+    MPD mpd(g_test_live_mpd.string(), std::string("file:") + g_test_live_mpd.string(), MPD::PARSER_STREAMING);
+    if (mpd != *g_dom_mpd) {
+        std::cerr << "MPD parsed from a file using PARSER_STREAMING differs from the PARSER_DOM result" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_streaming_output()
+{
+    if (!g_dom_mpd) return false;
+
+    MPD mpd(g_test_live_mpd.string(), std::string("file:") + g_test_live_mpd.string(), MPD::PARSER_STREAMING);
+    if (mpd.asXML(false) != g_dom_mpd->asXML(false)) {
+        std::cerr << "XML output of PARSER_STREAMING MPD differs from the PARSER_DOM MPD" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_streaming_bad_root()
+{
+    std::istringstream in_str("<?xml version=\"1.0\"?><NotAnMPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\"/>");
+    try {
+        MPD mpd(in_str, std::nullopt, MPD::PARSER_STREAMING);
+    } catch (ParseError &ex) {
+        return true;
+    }
+    std::cerr << "Expected ParseError exception for a non-MPD root element" << std::endl;
+    return false;
+}
+
+bool test_parallel_periods_dom()
+{
+    if (!g_dom_mpd) return false;
+
+    MPD mpd(g_test_live_mpd.string(), std::string("file:") + g_test_live_mpd.string(), MPD::PARSER_DOM, 4);
+    if (mpd != *g_dom_mpd) {
+        std::cerr << "MPD parsed with parallel Period parsing differs from the serial PARSER_DOM result" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_parallel_periods_streaming()
+{
+    if (!g_dom_mpd) return false;
+
+    MPD mpd(g_test_live_mpd.string(), std::string("file:") + g_test_live_mpd.string(), MPD::PARSER_STREAMING, 0);
+    if (mpd != *g_dom_mpd) {
+        std::cerr << "MPD parsed with parallel Period parsing and PARSER_STREAMING differs from the serial PARSER_DOM result"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_parallel_periods_order()
+{
+    std::ostringstream mpd_xml;
+    mpd_xml << "<?xml version=\"1.0\"?>"
+               "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+               " minBufferTime=\"PT2S\" type=\"static\">";
+    for (int i = 0; i < 50; i++) {
+        mpd_xml << "<Period id=\"p" << i << "\"" << (i == 0?" start=\"PT0S\"":"") << " duration=\"PT" << (i + 1) << "S\"/>";
+    }
+    mpd_xml << "</MPD>";
+
+    std::istringstream serial_in(mpd_xml.str());
+    MPD serial_mpd(serial_in, std::nullopt, MPD::PARSER_DOM, 1);
+    for (auto backend : {MPD::PARSER_DOM, MPD::PARSER_STREAMING}) {
+        std::istringstream parallel_in(mpd_xml.str());
+        MPD parallel_mpd(parallel_in, std::nullopt, backend, 8);
+        if (parallel_mpd != serial_mpd) {
+            std::cerr << "Multi-Period MPD parsed in parallel differs from serial parse" << std::endl;
+            return false;
+        }
+        int i = 0;
+        for (auto it = parallel_mpd.periodsBegin(); it != parallel_mpd.periodsEnd(); it++, i++) {
+            if (it->id() != std::string("p") + std::to_string(i)) {
+                std::cerr << "Period " << i << " out of document order" << std::endl;
+                return false;
+            }
+            // Period n starts at the sum of the preceding durations, which relies on the sibling links
+            if (it->calcStart() != MPD::duration_type(std::chrono::seconds(i * (i + 1) / 2))) {
+                std::cerr << "Period " << i << " has the wrong calculated start time" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool test_lazy_periods()
+{
+    if (!g_dom_mpd) return false;
+
+    for (auto backend : {MPD::PARSER_DOM, MPD::PARSER_STREAMING}) {
+        MPD mpd(g_test_live_mpd.string(), std::string("file:") + g_test_live_mpd.string(),
+                MPD::ParseOptions().parserBackend(backend).lazyPeriods(true));
+        for (auto it = mpd.periodsBegin(); it != mpd.periodsEnd(); it++) {
+            if (it->isMaterialised()) {
+                std::cerr << "Period was fully parsed during lazy parsing" << std::endl;
+                return false;
+            }
+        }
+        if (mpd != *g_dom_mpd) {
+            std::cerr << "MPD parsed with lazy Periods differs from the PARSER_DOM result" << std::endl;
+            return false;
+        }
+        if (mpd.asXML(false) != g_dom_mpd->asXML(false)) {
+            std::cerr << "XML output of MPD parsed with lazy Periods differs from the PARSER_DOM result" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool test_lazy_periods_on_access()
+{
+    std::istringstream in_str("<?xml version=\"1.0\"?>"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+        " minBufferTime=\"PT2S\" type=\"static\">"
+        "<Period id=\"p0\" start=\"PT0S\" duration=\"PT10S\"><AdaptationSet id=\"1\"/></Period>"
+        "<Period id=\"p1\" duration=\"PT10S\"><AdaptationSet id=\"2\"/></Period>"
+        "</MPD>");
+    MPD mpd(in_str, std::nullopt, MPD::ParseOptions().lazyPeriods(true));
+
+    auto first = mpd.periodsBegin();
+    auto second = std::next(first);
+    if (first->id() != "p0" || second->id() != "p1" || second->calcStart() != MPD::duration_type(std::chrono::seconds(10))) {
+        std::cerr << "Period attributes not available before the Period children are parsed" << std::endl;
+        return false;
+    }
+    if (first->isMaterialised() || second->isMaterialised()) {
+        std::cerr << "Reading Period attributes caused the Period children to be parsed" << std::endl;
+        return false;
+    }
+    if (first->adaptationSets().size() != 1 || first->adaptationSets().front().getPeriod() != &(*first)) {
+        std::cerr << "Lazily parsed AdaptationSet not attached to its Period" << std::endl;
+        return false;
+    }
+    if (!first->isMaterialised() || second->isMaterialised()) {
+        std::cerr << "Only the accessed Period should have been parsed" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool test_finalise()
+{
+    if (g_dom_mpd) delete g_dom_mpd;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    g_test_live_mpd = argv[1];
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "Initialise", test_initialise },
+        { "Streaming parser from stream matches DOM parser", test_streaming_istream },
+        { "Streaming parser from memory matches DOM parser", test_streaming_memory },
+        { "Streaming parser from file matches DOM parser", test_streaming_file },
+        { "Streaming parser XML output matches DOM parser", test_streaming_output },
+        { "Streaming parser rejects non-MPD documents", test_streaming_bad_root },
+        { "Parallel Period parsing matches serial parse", test_parallel_periods_dom },
+        { "Parallel Period parsing with streaming parser matches serial parse", test_parallel_periods_streaming },
+        { "Parallel Period parsing keeps document order and sibling links", test_parallel_periods_order },
+        { "Lazy Period parsing matches full parse", test_lazy_periods },
+        { "Lazy Period parsing only parses accessed Periods", test_lazy_periods_on_access },
+        { "Finish", test_finalise }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
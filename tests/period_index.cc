@@ -0,0 +1,167 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+using namespace std::chrono_literals;
+
+static Period make_period(const std::string &id, const std::optional<Period::duration_type> &start,
+                          const std::optional<Period::duration_type> &duration)
+{
+    Period period;
+    period.id(id).start(start).duration(duration);
+    return period;
+}
+
+static std::string period_id_at(const MPD &mpd, const MPD::time_type &pres_time)
+{
+    auto it = mpd.period(pres_time);
+    if (it == mpd.periodsEnd()) return "none";
+    return it->id().value_or("");
+}
+
+bool test_vod_period_times()
+{
+    // Static MPD, none of the Periods have a @start
+    MPD mpd(2s, URI("urn:mpeg:dash:profile:isoff-on-demand:2011"), make_period("p0", std::nullopt, 10s));
+    mpd.periodAdd(make_period("p1", std::nullopt, 20s)).periodAdd(make_period("p2", std::nullopt, std::nullopt));
+    mpd.mediaPresentationDuration(60s);
+
+    auto it = mpd.periodsBegin();
+    if (it->calcStart() != 0s || std::next(it)->calcStart() != 10s || std::next(it, 2)->calcStart() != 30s) {
+        std::cerr << "Period starts not calculated from the durations" << std::endl;
+        return false;
+    }
+    if (std::next(it, 2)->calcDuration() != 30s) {
+        std::cerr << "Last Period does not end at the mediaPresentationDuration" << std::endl;
+        return false;
+    }
+
+    static const std::vector<std::pair<MPD::duration_type, std::string> > lookups = {
+        {0s, "p0"}, {9s, "p0"}, {10s, "p1"}, {29s, "p1"}, {30s, "p2"}, {59s, "p2"}, {60s, "none"}
+    };
+    for (const auto &[offset, id] : lookups) {
+        if (period_id_at(mpd, MPD::time_type() + offset) != id) {
+            std::cerr << "Time " << offset.count() << "us gave Period " << period_id_at(mpd, MPD::time_type() + offset)
+                      << ", expected " << id << std::endl;
+            return false;
+        }
+    }
+
+    // Changing a Period duration moves the following Periods
+    mpd.periodsBegin()->duration(Period::duration_type(5s));
+    if (period_id_at(mpd, MPD::time_type() + 7s) != "p1" || std::next(mpd.periodsBegin(), 2)->calcStart() != 25s) {
+        std::cerr << "Period times not recalculated after a @duration change" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_live_period_times()
+{
+    MPD mpd(2s, URI("urn:mpeg:dash:profile:isoff-live:2011"), make_period("p0", 0s, std::nullopt), MPD::DYNAMIC);
+    auto ast = std::chrono::system_clock::now() - 24h;
+    mpd.availabilityStartTime(ast);
+
+    // A long running channel adding Periods as it goes
+    for (int i = 1; i < 500; i++) {
+        mpd.periodAdd(make_period("p" + std::to_string(i), i * 10s, std::nullopt));
+    }
+    if (period_id_at(mpd, ast + 1234s) != "p123" || period_id_at(mpd, ast - 1s) != "none" ||
+        period_id_at(mpd, ast + 100000s) != "p499") {
+        std::cerr << "Wrong Period found in a live MPD" << std::endl;
+        return false;
+    }
+    if (mpd.periodsBegin()->calcDuration() != 10s || std::prev(mpd.periodsEnd())->calcDuration()) {
+        std::cerr << "Period durations not derived from the next Period start" << std::endl;
+        return false;
+    }
+
+    // Old Periods drop off the front
+    mpd.periodRemove(mpd.periodsBegin()).periodRemove(mpd.periodsBegin());
+    if (period_id_at(mpd, ast + 15s) != "none" || period_id_at(mpd, ast + 25s) != "p2") {
+        std::cerr << "Removed Periods are still found" << std::endl;
+        return false;
+    }
+
+    // A Period added out of order goes in start order
+    mpd.periodAdd(make_period("early", 5s, 5s));
+    if (mpd.periodsBegin()->id() != "early" || period_id_at(mpd, ast + 7s) != "early" || period_id_at(mpd, ast + 4s) != "none") {
+        std::cerr << "Period added before the others was not found" << std::endl;
+        return false;
+    }
+
+    // The last Period gets a duration when a new Period is appended
+    mpd.periodAdd(make_period("last", 5000s, 10s));
+    auto last = std::prev(mpd.periodsEnd());
+    if (std::prev(last)->calcDuration() != 10s || period_id_at(mpd, ast + 5005s) != "last" ||
+        period_id_at(mpd, ast + 5010s) != "none") {
+        std::cerr << "Appended Period times are wrong" << std::endl;
+        return false;
+    }
+
+    MPD copy(mpd);
+    if (period_id_at(copy, ast + 1234s) != "p123" || copy.period(ast + 1234s)->getMPD() != &copy) {
+        std::cerr << "Copied MPD does not find its own Periods" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_live_first_period_without_start()
+{
+    // Dynamic MPD where the first Period has no @start
+    MPD mpd(2s, URI("urn:mpeg:dash:profile:isoff-live:2011"), make_period("p0", std::nullopt, std::nullopt), MPD::DYNAMIC);
+    auto ast = std::chrono::system_clock::now() - 1h;
+    mpd.availabilityStartTime(ast);
+    if (mpd.periodsBegin()->calcStart() != 0s || period_id_at(mpd, ast) != "p0" || period_id_at(mpd, ast + 30s) != "p0" ||
+        period_id_at(mpd, ast - 1s) != "none") {
+        std::cerr << "First Period of a dynamic MPD without a @start does not start at 0" << std::endl;
+        return false;
+    }
+
+    mpd.periodAdd(make_period("p1", 60s, std::nullopt));
+    if (mpd.periodsBegin()->calcDuration() != 60s || period_id_at(mpd, ast + 59s) != "p0" || period_id_at(mpd, ast + 60s) != "p1") {
+        std::cerr << "Wrong Period found after a Period was added to a dynamic MPD" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "On-demand Period times and lookup", test_vod_period_times },
+        { "Live Period times with added and removed Periods", test_live_period_times },
+        { "Live first Period without a start", test_live_first_period_without_start }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
@@ -3,6 +3,8 @@
 
 #include <functional>
 #include <iostream>
+#include <span>
+#include <string>
 #include <vector>
 
 #include "libmpd++/SegmentTemplate.hh"
@@ -100,13 +102,51 @@ bool test_segment_template_vars_missing()
     return true;
 }
 
+bool test_segment_template_buffer()
+{
+    SegmentTemplate seg_temp;
+    seg_temp.media("$RepresentationID$/$Number%05d$.m4s");
+    SegmentTemplate::Variables vars("video1", 9);
+
+    char buffer[64];
+    auto length = seg_temp.formatMediaTemplate(vars, std::span<char>(buffer, sizeof(buffer)));
+    if (std::string(buffer, length) != "video1/00010.m4s" || std::string(buffer, length) != seg_temp.formatMediaTemplate(vars)) {
+        std::cerr << "SegmentTemplate.formatMediaTemplate() into a buffer failed: expected \"video1/00010.m4s\" got \""
+                  << std::string(buffer, length) << "\"" << std::endl;
+        return false;
+    }
+
+    char small_buffer[8];
+    length = seg_temp.formatMediaTemplate(vars, std::span<char>(small_buffer, sizeof(small_buffer)));
+    if (length != 16 || std::string(small_buffer, sizeof(small_buffer)) != "video1/0") {
+        std::cerr << "SegmentTemplate.formatMediaTemplate() into a small buffer did not truncate and return the full length"
+                  << std::endl;
+        return false;
+    }
+
+    if (seg_temp.formatInitializationTemplate(vars, std::span<char>(buffer, sizeof(buffer))) != 0) {
+        std::cerr << "SegmentTemplate.formatInitializationTemplate() into a buffer failed when no @initialization template is set"
+                  << std::endl;
+        return false;
+    }
+
+    seg_temp.media(std::nullopt);
+    if (seg_temp.formatMediaTemplate(vars, std::span<char>(buffer, sizeof(buffer))) != 0) {
+        std::cerr << "SegmentTemplate.formatMediaTemplate() into a buffer still used a removed @media template" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
     int result = 0;
     static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
         { "default SegmentTemplate", test_segment_template_default },
         { "media formatting (all variables)", test_segment_template_media_template },
-        { "media formatting (missing variables)", test_segment_template_vars_missing }
+        { "media formatting (missing variables)", test_segment_template_vars_missing },
+        { "media formatting into a buffer", test_segment_template_buffer }
     };
 
     for (const auto &test : tests) {
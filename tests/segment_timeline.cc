@@ -0,0 +1,382 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+static const char *c_mpd_xml =
+    "<?xml version=\"1.0\"?>"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" type=\"static\""
+    " availabilityStartTime=\"1970-01-01T00:00:00Z\" mediaPresentationDuration=\"PT20S\" minBufferTime=\"PT2S\">"
+    "<BaseURL>https://cdn.example.com/live/</BaseURL>"
+    "<Period id=\"p0\" start=\"PT0S\" duration=\"PT20S\">"
+    "<AdaptationSet contentType=\"video\" mimeType=\"video/mp4\">"
+    "<SegmentTemplate timescale=\"100\" media=\"$RepresentationID$/$Time$.m4s\">"
+    "<SegmentTimeline><S t=\"0\" d=\"200\" r=\"2\"/><S d=\"100\" r=\"-1\"/></SegmentTimeline>"
+    "</SegmentTemplate>"
+    "<Representation id=\"v1\" bandwidth=\"1000000\"/>"
+    "</AdaptationSet>"
+    "</Period>"
+    "</MPD>";
+
+static const char *c_segment_list_mpd_xml =
+    "<?xml version=\"1.0\"?>"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\" type=\"static\""
+    " mediaPresentationDuration=\"PT8S\" minBufferTime=\"PT2S\">"
+    "<BaseURL>https://cdn.example.com/vod/</BaseURL>"
+    "<Period id=\"p0\" duration=\"PT8S\">"
+    "<AdaptationSet contentType=\"audio\" mimeType=\"audio/mp4\">"
+    "<SegmentList timescale=\"48000\" duration=\"96000\">"
+    "<Initialization sourceURL=\"init.mp4\"/>"
+    "<SegmentURL media=\"seg0.m4s\"/><SegmentURL media=\"seg1.m4s\"/>"
+    "<SegmentURL media=\"seg2.m4s\" mediaRange=\"0-999\"/><SegmentURL media=\"seg3.m4s\"/>"
+    "</SegmentList>"
+    "<Representation id=\"a1\" bandwidth=\"128000\"/>"
+    "</AdaptationSet>"
+    "</Period>"
+    "</MPD>";
+
+static const char *c_representation_segment_list_mpd_xml =
+    "<?xml version=\"1.0\"?>"
+    "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\" type=\"static\""
+    " mediaPresentationDuration=\"PT8S\" minBufferTime=\"PT2S\">"
+    "<BaseURL>https://cdn.example.com/vod/</BaseURL>"
+    "<Period id=\"p0\" duration=\"PT8S\">"
+    "<AdaptationSet contentType=\"audio\" mimeType=\"audio/mp4\">"
+    "<Representation id=\"a1\" bandwidth=\"128000\">"
+    "<SegmentList timescale=\"48000\" duration=\"96000\">"
+    "<Initialization sourceURL=\"a1/init.mp4\"/>"
+    "<SegmentURL media=\"a1/seg0.m4s\"/><SegmentURL media=\"a1/seg1.m4s\" mediaRange=\"0-999\"/>"
+    "<SegmentURL media=\"a1/seg2.m4s\"/><SegmentURL media=\"a1/seg3.m4s\"/>"
+    "</SegmentList>"
+    "</Representation>"
+    "</AdaptationSet>"
+    "</Period>"
+    "</MPD>";
+
+// t=1000: 3 x 100, then 2 x 50, gap, t=2000: 200 repeating until the end of the Period
+static SegmentTimeline make_timeline()
+{
+    SegmentTimeline timeline;
+    timeline.sLineAdd(SegmentTimeline::S().t(1000).d(100).r(2))
+            .sLineAdd(SegmentTimeline::S().d(50).r(1))
+            .sLineAdd(SegmentTimeline::S().t(2000).d(200).r(-1));
+    return timeline;
+}
+
+bool test_timeline_expansion()
+{
+    SegmentTimeline timeline(make_timeline());
+
+    if (timeline.segmentCount()) {
+        std::cerr << "Open ended SegmentTimeline has a segment count without an end time" << std::endl;
+        return false;
+    }
+    if (timeline.segmentCount(3000) != 5 + 5 || timeline.segmentCount(3001) != 5 + 6 || timeline.segmentCount(1500) != 5) {
+        std::cerr << "SegmentTimeline @r=-1 did not repeat to the end time" << std::endl;
+        return false;
+    }
+
+    static const unsigned long expected_starts[] = {1000, 1100, 1200, 1300, 1350, 2000, 2200, 2400};
+    for (unsigned long i = 0; i < std::size(expected_starts); i++) {
+        if (timeline.segmentStartTime(i) != expected_starts[i]) {
+            std::cerr << "Segment " << i << " starts at " << timeline.segmentStartTime(i) << ", expected " << expected_starts[i]
+                      << std::endl;
+            return false;
+        }
+    }
+    if (timeline.segmentDuration(3) != 50 || timeline.segmentDuration(100) != 200) {
+        std::cerr << "Wrong segment durations from the SegmentTimeline" << std::endl;
+        return false;
+    }
+
+    // @r=-1 followed by an S@t repeats up to that time
+    SegmentTimeline to_next;
+    to_next.sLineAdd(SegmentTimeline::S().t(0).d(10).r(-1)).sLineAdd(SegmentTimeline::S().t(95).d(5));
+    if (to_next.segmentCount() != 11 || to_next.segmentStartTime(10) != 95) {
+        std::cerr << "SegmentTimeline @r=-1 did not repeat until the next S@t" << std::endl;
+        return false;
+    }
+
+    SegmentTimeline copy(timeline);
+    if (copy != timeline || copy.segmentStartTime(6) != 2200) {
+        std::cerr << "Copied SegmentTimeline has a different index" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_timeline_time_lookup()
+{
+    SegmentTimeline timeline(make_timeline());
+
+    static const std::vector<std::pair<unsigned long, unsigned long> > lookups = {
+        {0, 0}, {1000, 0}, {1099, 0}, {1100, 1}, {1349, 3}, {1350, 4}, {1399, 4},
+        {1400, 5}, {1999, 5}, // gap before t=2000 gives the next segment
+        {2000, 5}, {2399, 6}, {1000000, 5 + (1000000 - 2000) / 200}
+    };
+    for (const auto &[media_time, index] : lookups) {
+        if (timeline.segmentIndexForTime(media_time) != index) {
+            std::cerr << "Time " << media_time << " gave segment " << timeline.segmentIndexForTime(media_time) << ", expected "
+                      << index << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_multiple_segment_base()
+{
+    SegmentTemplate seg_template;
+    seg_template.timescale(100);
+    seg_template.presentationTimeOffest(1000);
+    seg_template.segmentTimeline(make_timeline());
+
+    if (seg_template.segmentNumberToTime(1) != 100 || seg_template.segmentNumberToMediaTime(1) != 1100 ||
+        seg_template.segmentNumberToTime(5) != 1000) {
+        std::cerr << "SegmentTimeline segment times do not take @presentationTimeOffset into account" << std::endl;
+        return false;
+    }
+    if (seg_template.segmentNumberToDurationType(4) != std::chrono::milliseconds(3500) ||
+        seg_template.segmentDurationAsDurationType(4) != std::chrono::milliseconds(500)) {
+        std::cerr << "Wrong wallclock times for SegmentTimeline segments" << std::endl;
+        return false;
+    }
+    if (seg_template.timeOffsetToSegmentNumber(350) != 4 || seg_template.durationTypeToSegmentNumber(std::chrono::seconds(12)) != 6) {
+        std::cerr << "Wrong segment numbers for times into the Period" << std::endl;
+        return false;
+    }
+    if (seg_template.segmentCount(std::chrono::seconds(20)) != 10) {
+        std::cerr << "Wrong segment count for a 20s Period" << std::endl;
+        return false;
+    }
+
+    seg_template.startNumber(10);
+    seg_template.endNumber(16);
+    if (seg_template.segmentCount() != 7 || seg_template.timeOffsetToSegmentNumber(100000) != 6) {
+        std::cerr << "@endNumber does not limit the SegmentTimeline segments" << std::endl;
+        return false;
+    }
+
+    SegmentTemplate by_duration;
+    by_duration.timescale(1000);
+    by_duration.duration(2000);
+    if (by_duration.segmentCount(std::chrono::seconds(9)) != 5 || by_duration.durationTypeToSegmentNumber(std::chrono::seconds(7)) != 3 ||
+        by_duration.segmentNumberToDurationType(3) != std::chrono::seconds(6)) {
+        std::cerr << "Wrong segment addressing using @duration" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_segment_availabilities()
+{
+    std::string xml(c_mpd_xml);
+    MPD mpd(std::vector<char>(xml.begin(), xml.end()), std::nullopt, MPD::ParseOptions());
+    const Representation &rep = mpd.periods().front().adaptationSets().front().representations().front();
+
+    // 3 x 2s then 1s segments to the end of the 20s Period
+    auto segment_list = rep.segmentAvailabilities(0, 100);
+    std::vector<SegmentAvailability> segments(segment_list.begin(), segment_list.end());
+    if (segments.size() != 17) {
+        std::cerr << "Expected 17 segments in the Period, got " << segments.size() << std::endl;
+        return false;
+    }
+    for (unsigned long i = 0; i < segments.size(); i++) {
+        if (segments[i].segmentURL() != rep.getMediaURL(i)) {
+            std::cerr << "Segment " << i << " URL " << segments[i].segmentURL() << " does not match " << rep.getMediaURL(i)
+                      << std::endl;
+            return false;
+        }
+    }
+    if (segments[3].segmentURL().str() != "https://cdn.example.com/live/v1/600.m4s" ||
+        segments[2].segmentDuration() != std::chrono::seconds(2) || segments[3].segmentDuration() != std::chrono::seconds(1) ||
+        segments[3].availabilityStartTime() - segments[2].availabilityStartTime() != std::chrono::seconds(2)) {
+        std::cerr << "Wrong availability for the first segment after the duration change" << std::endl;
+        return false;
+    }
+
+    auto middle = rep.segmentAvailabilities(4, 2);
+    if (middle.size() != 2 || middle.front() != segments[4] || middle.back() != segments[5]) {
+        std::cerr << "Range from segment 4 does not match the full list" << std::endl;
+        return false;
+    }
+    if (!rep.segmentAvailabilities(17, 1).empty()) {
+        std::cerr << "Range after the end of the Period is not empty" << std::endl;
+        return false;
+    }
+
+    auto period_start = Representation::time_type();
+    auto by_time = rep.segmentAvailabilities(period_start + std::chrono::seconds(5), period_start + std::chrono::seconds(7));
+    if (by_time.size() != 2 || by_time.front() != segments[2] || by_time.back() != segments[3]) {
+        std::cerr << "Time range 5s to 7s did not give segments 2 and 3" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_inherited_segment_template()
+{
+    using namespace std::chrono_literals;
+
+    // Timing and the initialization template from the Period, media template and @startNumber from the AdaptationSet
+    SegmentTemplate period_template;
+    period_template.timescale(1000);
+    period_template.duration(2000);
+    period_template.initialization("$RepresentationID$/init.mp4");
+    SegmentTemplate adapt_set_template;
+    adapt_set_template.media("$RepresentationID$/$Number$.m4s");
+    adapt_set_template.startNumber(5);
+
+    AdaptationSet adapt_set;
+    adapt_set.segmentTemplate(adapt_set_template);
+    adapt_set.representationsAdd(Representation().id("v1").bandwidth(1000000));
+    Period period;
+    period.id(std::string("p0")).start(Period::duration_type(0s)).segmentTemplate(period_template);
+    period.adaptationSetAdd(std::move(adapt_set));
+    MPD mpd(2s, URI("urn:mpeg:dash:profile:isoff-on-demand:2011"), std::move(period), MPD::STATIC);
+    mpd.availabilityStartTime(MPD::time_type());
+    mpd.baseURLAdd(BaseURL("https://cdn.example.com/vod/"));
+
+    const Representation &rep = mpd.periods().front().adaptationSets().front().representations().front();
+    if (rep.getMediaURL(2).str() != "https://cdn.example.com/vod/v1/7.m4s" ||
+        rep.getInitializationURL().str() != "https://cdn.example.com/vod/v1/init.mp4") {
+        std::cerr << "SegmentTemplate attributes were not inherited from the Period" << std::endl;
+        return false;
+    }
+    auto segments = rep.segmentAvailabilities(0, 2);
+    if (segments.size() != 2 || segments.back().segmentDuration() != 2s ||
+        segments.back().availabilityStartTime() - segments.front().availabilityStartTime() != 2s) {
+        std::cerr << "Inherited @duration was not used for segment availability" << std::endl;
+        return false;
+    }
+
+    // Changing the Period SegmentTemplate must be seen by the Representation
+    period_template.initialization("init-$RepresentationID$.mp4");
+    mpd.periodsBegin()->segmentTemplate(period_template);
+    if (rep.getInitializationURL().str() != "https://cdn.example.com/vod/init-v1.mp4") {
+        std::cerr << "Representation did not see the changed Period SegmentTemplate" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_segment_list_lookup()
+{
+    SegmentList seg_list;
+    seg_list.timescale(100);
+    seg_list.segmentTimeline(make_timeline());
+    for (unsigned int i = 0; i < 20000; i++) seg_list.segmentURLAdd(SegmentURL().media(URI("seg" + std::to_string(i) + ".m4s")));
+
+    if (seg_list.getMediaURLForSegment(19999) != "seg19999.m4s" || !seg_list.getMediaURLForSegment(20000).empty()) {
+        std::cerr << "Wrong SegmentURL by index" << std::endl;
+        return false;
+    }
+    // Times from Period start, 1000 is the start of the first segment in the SegmentTimeline
+    if (seg_list.getMediaURLForSegmentTime(1099) != "seg0.m4s" || seg_list.getMediaURLForSegmentTime(1350) != "seg4.m4s" ||
+        seg_list.getMediaURLForSegmentTime(2400) != "seg7.m4s" ||
+        seg_list.getMediaURLForSegmentTime(std::chrono::seconds(24)) != "seg7.m4s") {
+        std::cerr << "Wrong SegmentURL by time using the SegmentTimeline" << std::endl;
+        return false;
+    }
+
+    SegmentList by_duration(seg_list);
+    by_duration.segmentTimeline(std::nullopt);
+    by_duration.duration(200);
+    if (by_duration.getMediaURLForSegmentTime(1999) != "seg9.m4s" ||
+        by_duration.getMediaURLForSegmentTime(std::chrono::milliseconds(4000)) != "seg2.m4s" ||
+        !by_duration.getMediaURLForSegmentTime(200 * 20000).empty()) {
+        std::cerr << "Wrong SegmentURL by time using @duration" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_segment_list_parsing()
+{
+    std::string xml(c_segment_list_mpd_xml);
+    MPD mpd(std::vector<char>(xml.begin(), xml.end()), std::nullopt, MPD::ParseOptions());
+    const AdaptationSet &adapt_set = mpd.periods().front().adaptationSets().front();
+
+    if (!adapt_set.hasSegmentList() || adapt_set.segmentList().value().segmentURLs().size() != 4 ||
+        adapt_set.segmentList().value().segmentURLs()[2].mediaRange() != SingleRFC7233Range(0, 999)) {
+        std::cerr << "SegmentURL elements were not parsed" << std::endl;
+        return false;
+    }
+
+    const Representation &rep = adapt_set.representations().front();
+    auto period_start = Representation::time_type();
+    if (rep.getMediaURL(3).str() != "https://cdn.example.com/vod/seg3.m4s" ||
+        rep.getMediaURL(period_start + std::chrono::seconds(5)).str() != "https://cdn.example.com/vod/seg2.m4s" ||
+        rep.getInitializationURL().str() != "https://cdn.example.com/vod/init.mp4") {
+        std::cerr << "Wrong URLs from the SegmentList" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_segment_list_round_trip()
+{
+    std::string xml(c_representation_segment_list_mpd_xml);
+    MPD mpd(std::vector<char>(xml.begin(), xml.end()), std::nullopt, MPD::ParseOptions());
+
+    // Write the MPD out and parse it again, the Representation SegmentList must survive
+    std::string written(mpd.asXML(false));
+    MPD reparsed(std::vector<char>(written.begin(), written.end()), std::nullopt, MPD::ParseOptions());
+    if (reparsed != mpd) {
+        std::cerr << "MPD with a Representation SegmentList changed when written and parsed again:" << std::endl << written
+                  << std::endl;
+        return false;
+    }
+
+    const Representation &rep = reparsed.periods().front().adaptationSets().front().representations().front();
+    if (rep.getMediaURL(2).str() != "https://cdn.example.com/vod/a1/seg2.m4s" ||
+        rep.getInitializationURL().str() != "https://cdn.example.com/vod/a1/init.mp4") {
+        std::cerr << "Wrong URLs from the Representation SegmentList after writing and parsing again" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "SegmentTimeline S entries are expanded", test_timeline_expansion },
+        { "SegmentTimeline segments are found by time", test_timeline_time_lookup },
+        { "Segment addressing uses the SegmentTimeline", test_multiple_segment_base },
+        { "Segment availability for a range of segments", test_segment_availabilities },
+        { "SegmentTemplate inherited from the Period", test_inherited_segment_template },
+        { "SegmentList lookup by index and time", test_segment_list_lookup },
+        { "SegmentList SegmentURL parsing", test_segment_list_parsing },
+        { "Representation SegmentList is written and parsed again", test_segment_list_round_trip }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */
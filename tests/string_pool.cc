@@ -0,0 +1,149 @@
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "libmpd++/libmpd++.hh"
+
+LIBMPDPP_NAMESPACE_USING_ALL;
+
+std::filesystem::path g_test_live_mpd;
+
+static const AdaptationSet &first_adaptation_set(const MPD &mpd)
+{
+    return mpd.periods().front().adaptationSets().front();
+}
+
+bool test_pool_shares_values()
+{
+    auto pool = std::make_shared<StringPool>();
+    MPD mpd1(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().stringPool(pool));
+    MPD mpd2(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().stringPool(pool));
+
+    const AdaptationSet &adapt_set1 = first_adaptation_set(mpd1);
+    const AdaptationSet &adapt_set2 = first_adaptation_set(mpd2);
+    if (&adapt_set1.mimeType() != &adapt_set2.mimeType() || &adapt_set1.lang() != &adapt_set2.lang()) {
+        std::cerr << "AdaptationSet @mimeType and @lang values are not shared between MPDs using the same pool" << std::endl;
+        return false;
+    }
+    if (&adapt_set1.segmentTemplate()->media() != &adapt_set2.segmentTemplate()->media()) {
+        std::cerr << "SegmentTemplate @media values are not shared between MPDs using the same pool" << std::endl;
+        return false;
+    }
+    if (&adapt_set1.representations().front().codecs() != &adapt_set2.representations().front().codecs()) {
+        std::cerr << "Representation @codecs values are not shared between MPDs using the same pool" << std::endl;
+        return false;
+    }
+    if (&mpd1.profiles().front().str() != &mpd2.profiles().front().str()) {
+        std::cerr << "MPD @profiles URIs are not shared between MPDs using the same pool" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_pool_keeps_values()
+{
+    auto pool = std::make_shared<StringPool>();
+    MPD pooled(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().stringPool(pool));
+    MPD unpooled(g_test_live_mpd.string());
+    if (pooled != unpooled || pooled.asXML(false) != unpooled.asXML(false)) {
+        std::cerr << "MPD parsed using a string pool differs from one parsed without" << std::endl;
+        return false;
+    }
+    if (pooled.stringPool() != pool || unpooled.stringPool()) {
+        std::cerr << "MPD does not report the string pool it was parsed with" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_pool_values_are_independent()
+{
+    auto pool = std::make_shared<StringPool>();
+    MPD mpd1(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().stringPool(pool));
+    MPD mpd2(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().stringPool(pool));
+
+    std::optional<std::string> original_lang(first_adaptation_set(mpd1).lang());
+    mpd2.periodsBegin()->adaptationSetsBegin()->lang(std::string("xx"));
+    if (first_adaptation_set(mpd1).lang() != original_lang || first_adaptation_set(mpd2).lang() != "xx") {
+        std::cerr << "Setting a pooled value in one MPD changed the value in another" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_pool_lazy_periods()
+{
+    auto pool = std::make_shared<StringPool>();
+    MPD mpd1(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().stringPool(pool));
+    MPD mpd2(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().lazyPeriods(true).stringPool(pool));
+    if (mpd2.periods().front().isMaterialised()) {
+        std::cerr << "Interning values materialised a lazily parsed Period" << std::endl;
+        return false;
+    }
+    if (&first_adaptation_set(mpd1).mimeType() != &first_adaptation_set(mpd2).mimeType()) {
+        std::cerr << "Values from a materialised Period are not interned" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_pool_purge()
+{
+    auto pool = std::make_shared<StringPool>();
+    {
+        MPD mpd(g_test_live_mpd.string(), std::nullopt, MPD::ParseOptions().stringPool(pool));
+        if (pool->size() == 0) {
+            std::cerr << "No values were added to the pool" << std::endl;
+            return false;
+        }
+        if (pool->purge() != 0) {
+            std::cerr << "Purge removed values still in use" << std::endl;
+            return false;
+        }
+    }
+    pool->purge();
+    if (pool->size() != 0) {
+        std::cerr << "Purge left " << pool->size() << " unused values in the pool" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int result = 0;
+
+    g_test_live_mpd = argv[1];
+
+    static const std::vector< std::pair< std::string, std::function<bool()> > > tests = {
+        { "MPDs using the same pool share values", test_pool_shares_values },
+        { "Pooled MPD matches an unpooled MPD", test_pool_keeps_values },
+        { "Changing a pooled value only changes one MPD", test_pool_values_are_independent },
+        { "Lazily parsed Periods are interned when materialised", test_pool_lazy_periods },
+        { "Purge removes only unused values", test_pool_purge }
+    };
+
+    for (const auto &test : tests) {
+        std::cout << test.first << ": ";
+        try {
+            if ((test.second)()) {
+                std::cout << "passed";
+            } else {
+                result = 1;
+                std::cout << "failed";
+            }
+        } catch (const std::exception &ex) {
+            result = 1;
+            std::cout << "failed (exception): " << ex.what();
+        }
+        std::cout << std::endl;
+    }
+
+    return result;
+}
+
+/* vim:ts=8:sts=4:sw=4:expandtab:
+ */